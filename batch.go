@@ -0,0 +1,104 @@
+package ginja
+
+import (
+	"runtime"
+	"unsafe"
+)
+
+// RenderResult is the outcome of a single item of a batch render.
+type RenderResult struct {
+	Rendered string
+	Err      error
+}
+
+// RenderItem is a single (template, context) pair of a mixed batch render.
+type RenderItem struct {
+	Name    string
+	Context map[string]any
+}
+
+// RenderBatch renders the named template once per context. The contexts are
+// rendered in parallel on a native worker pool within a single FFI call, and
+// the results are returned in the order of ctxs, each with its own error.
+// The contexts are encoded like those of RenderTemplate, so they share its
+// render cache entries and context pruning.
+//
+// The returned error is only set when a context cannot be marshaled.
+func (env *Environment) RenderBatch(name string, ctxs []map[string]any) (results []RenderResult, err error) {
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return
+	}
+	// The buffers are Go memory holding pointers to Go memory, which may
+	// only be passed to the library while those pointers are pinned.
+	var pinner runtime.Pinner
+	defer pinner.Unpin()
+	buffers := make([]mjBuffer, len(ctxs))
+	for i, ctx := range ctxs {
+		var value []byte
+		value, err = env.marshal(name, ctx)
+		if err != nil {
+			return
+		}
+		data := unsafe.SliceData(value)
+		pinner.Pin(data)
+		buffers[i] = mjBuffer{
+			data: data,
+			len:  uint(len(value)),
+		}
+	}
+	ret := env.ffi.MjEnvRenderBatch(env.inner, nptr, unsafe.SliceData(buffers), uint(len(buffers)))
+	return takeRenderBatchResult(env.ffi, ret), nil
+}
+
+// RenderBatchItems renders every (template, context) pair in parallel on a
+// native worker pool within a single FFI call.
+//
+// See RenderBatch for details.
+func (env *Environment) RenderBatchItems(items []RenderItem) (results []RenderResult, err error) {
+	// See RenderBatch for why the names and contexts are pinned.
+	var pinner runtime.Pinner
+	defer pinner.Unpin()
+	renderItems := make([]mjRenderItem, len(items))
+	for i, item := range items {
+		var nptr *byte
+		nptr, err = BytePtrFromString(item.Name)
+		if err != nil {
+			return
+		}
+		var value []byte
+		value, err = env.marshal(item.Name, item.Context)
+		if err != nil {
+			return
+		}
+		data := unsafe.SliceData(value)
+		pinner.Pin(nptr)
+		pinner.Pin(data)
+		renderItems[i] = mjRenderItem{
+			name: nptr,
+			data: data,
+			len:  uint(len(value)),
+		}
+	}
+	ret := env.ffi.MjEnvRenderBatchItems(env.inner, unsafe.SliceData(renderItems), uint(len(renderItems)))
+	return takeRenderBatchResult(env.ffi, ret), nil
+}
+
+func takeRenderBatchResult(ffi *ffi, ret unsafe.Pointer) (results []RenderResult) {
+	defer ffi.MjResultEnvRenderBatchFree(ret)
+	batch := (*mjResultEnvRenderBatch)(ret)
+	results = make([]RenderResult, batch.len)
+	if batch.len == 0 {
+		return
+	}
+	items := unsafe.Slice((*mjResultEnvRenderTemplate)(batch.results), batch.len)
+	for i := range items {
+		item := &items[i]
+		if item.error != nil {
+			results[i].Err = takeError(ffi, &item.error)
+			continue
+		}
+		results[i].Rendered = BytePtrToString(item.rendered)
+	}
+	return
+}
@@ -0,0 +1,59 @@
+package ginja_test
+
+import (
+	"fmt"
+
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestRenderBatch(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("batch_template", "Hello, {{ name }}!"))
+	ctxs := make([]map[string]any, 100)
+	for i := range ctxs {
+		ctxs[i] = map[string]any{"name": fmt.Sprintf("user%d", i)}
+	}
+	results, err := env.RenderBatch("batch_template", ctxs)
+	assert.Nil(err)
+	assert.Len(results, 100)
+	for i, result := range results {
+		assert.Nil(result.Err)
+		assert.Equal(fmt.Sprintf("Hello, user%d!", i), result.Rendered)
+	}
+}
+
+func (s *Suite) TestRenderBatchPerItemError(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("batch_divide", "{{ 10 // n }}"))
+	results, err := env.RenderBatch("batch_divide", []map[string]any{
+		{"n": 2},
+		{"n": 0},
+	})
+	assert.Nil(err)
+	assert.Len(results, 2)
+	assert.Nil(results[0].Err)
+	assert.Equal("5", results[0].Rendered)
+	assert.NotNil(results[1].Err)
+}
+
+func (s *Suite) TestRenderBatchItems(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("batch_item_a", "A{{ v }}"))
+	assert.Nil(env.AddTemplate("batch_item_b", "B{{ v }}"))
+	results, err := env.RenderBatchItems([]ginja.RenderItem{
+		{Name: "batch_item_a", Context: map[string]any{"v": 1}},
+		{Name: "batch_item_b", Context: map[string]any{"v": 2}},
+		{Name: "batch_item_missing", Context: map[string]any{}},
+	})
+	assert.Nil(err)
+	assert.Len(results, 3)
+	assert.Equal("A1", results[0].Rendered)
+	assert.Equal("B2", results[1].Rendered)
+	var e *ginja.Error
+	assert.ErrorAs(results[2].Err, &e)
+	assert.Equal(ginja.CodeTemplateNotFound, e.Code())
+}
@@ -1,12 +1,19 @@
 package ginja_test
 
 import (
+	"errors"
+	"os"
+	"path/filepath"
 	"reflect"
+	"strconv"
 	"strings"
+	"sync"
 	"testing"
 	"text/template"
+	"time"
 
 	"github.com/flosch/pongo2/v6"
+	"go.yuchanns.xyz/ginja"
 )
 
 type BenchmarkData struct {
@@ -570,3 +577,845 @@ func (s *Suite) BenchMemoryAllocation(b *testing.B) {
 		}
 	})
 }
+
+// BenchTemplateHandle - Rendering through a looked-up template handle
+func (s *Suite) BenchTemplateHandle(b *testing.B) {
+	ginjaTemplate := "Hello {{ name }}! You are {{ age }} years old."
+
+	data := map[string]any{
+		"name": "John",
+		"age":  30,
+	}
+
+	err := s.env.AddTemplate("handle", ginjaTemplate)
+	if err != nil {
+		b.Fatal(err)
+	}
+
+	b.Run("env", func(b *testing.B) {
+		b.ResetTimer()
+		for b.Loop() {
+			result, err := s.env.RenderTemplate("handle", data)
+			if err != nil {
+				b.Fatal(err)
+			}
+			_ = result
+		}
+	})
+
+	b.Run("handle", func(b *testing.B) {
+		tmpl, err := s.env.GetTemplate("handle")
+		if err != nil {
+			b.Fatal(err)
+		}
+		defer tmpl.Close()
+
+		b.ResetTimer()
+		for b.Loop() {
+			result, err := tmpl.Render(data)
+			if err != nil {
+				b.Fatal(err)
+			}
+			_ = result
+		}
+	})
+}
+
+// BenchAppendRender - Rendering into a reused caller-owned buffer
+func (s *Suite) BenchAppendRender(b *testing.B) {
+	ginjaTemplate := "Hello {{ name }}! You are {{ age }} years old."
+
+	data := map[string]any{
+		"name": "John",
+		"age":  30,
+	}
+
+	err := s.env.AddTemplate("append", ginjaTemplate)
+	if err != nil {
+		b.Fatal(err)
+	}
+
+	b.Run("string", func(b *testing.B) {
+		b.ReportAllocs()
+		b.ResetTimer()
+		for b.Loop() {
+			result, err := s.env.RenderTemplate("append", data)
+			if err != nil {
+				b.Fatal(err)
+			}
+			_ = result
+		}
+	})
+
+	b.Run("append", func(b *testing.B) {
+		var buf []byte
+		b.ReportAllocs()
+		b.ResetTimer()
+		for b.Loop() {
+			buf, err = s.env.AppendRender(buf[:0], "append", data)
+			if err != nil {
+				b.Fatal(err)
+			}
+		}
+	})
+}
+
+// BenchRenderBatch - Rendering many contexts through one batch call
+func (s *Suite) BenchRenderBatch(b *testing.B) {
+	ginjaTemplate := "Dear {{ name }}, your score is {{ score }}."
+
+	ctxs := make([]map[string]any, 1000)
+	for i := range ctxs {
+		ctxs[i] = map[string]any{
+			"name":  "User" + string(rune('A'+(i%26))),
+			"score": float64(i) * 10.5,
+		}
+	}
+
+	err := s.env.AddTemplate("batch", ginjaTemplate)
+	if err != nil {
+		b.Fatal(err)
+	}
+
+	b.Run("goroutines", func(b *testing.B) {
+		b.ResetTimer()
+		for b.Loop() {
+			var wg sync.WaitGroup
+			for _, ctx := range ctxs {
+				wg.Add(1)
+				go func() {
+					defer wg.Done()
+					result, err := s.env.RenderTemplate("batch", ctx)
+					if err != nil {
+						b.Error(err)
+					}
+					_ = result
+				}()
+			}
+			wg.Wait()
+		}
+	})
+
+	b.Run("batch", func(b *testing.B) {
+		b.ResetTimer()
+		for b.Loop() {
+			results, err := s.env.RenderBatch("batch", ctxs)
+			if err != nil {
+				b.Fatal(err)
+			}
+			_ = results
+		}
+	})
+}
+
+// BenchRenderValue - Rendering many templates against one parsed context
+func (s *Suite) BenchRenderValue(b *testing.B) {
+	items := make([]map[string]any, 500)
+	for i := range items {
+		items[i] = map[string]any{
+			"name":  "Item" + string(rune('A'+(i%26))),
+			"price": float64(i) * 1.5,
+		}
+	}
+	data := map[string]any{
+		"title": "Catalog",
+		"items": items,
+	}
+
+	names := []string{"value_first", "value_last", "value_count", "value_title"}
+	sources := []string{
+		"{{ items[0].name }}",
+		"{{ items[-1].name }}",
+		"{{ items|length }}",
+		"{{ title }}",
+	}
+	for i, name := range names {
+		err := s.env.AddTemplate(name, sources[i])
+		if err != nil {
+			b.Fatal(err)
+		}
+	}
+
+	b.Run("json", func(b *testing.B) {
+		b.ResetTimer()
+		for b.Loop() {
+			for _, name := range names {
+				result, err := s.env.RenderTemplate(name, data)
+				if err != nil {
+					b.Fatal(err)
+				}
+				_ = result
+			}
+		}
+	})
+
+	b.Run("value", func(b *testing.B) {
+		b.ResetTimer()
+		for b.Loop() {
+			value, err := s.env.NewValue(data)
+			if err != nil {
+				b.Fatal(err)
+			}
+			for _, name := range names {
+				result, err := s.env.RenderValue(name, value, nil)
+				if err != nil {
+					b.Fatal(err)
+				}
+				_ = result
+			}
+			value.Close()
+		}
+	})
+}
+
+// BenchGlobals - Shared site data as globals instead of per-render context
+func (s *Suite) BenchGlobals(b *testing.B) {
+	ginjaTemplate := "{% for item in nav %}{{ item.title }} {% endfor %}{{ name }}"
+
+	nav := make([]map[string]any, 50)
+	for i := range nav {
+		nav[i] = map[string]any{
+			"title": "Page" + string(rune('A'+(i%26))),
+			"url":   "/page/" + string(rune('a'+(i%26))),
+		}
+	}
+
+	err := s.env.AddTemplate("globals", ginjaTemplate)
+	if err != nil {
+		b.Fatal(err)
+	}
+
+	b.Run("context", func(b *testing.B) {
+		data := map[string]any{
+			"nav":  nav,
+			"name": "John",
+		}
+		b.ResetTimer()
+		for b.Loop() {
+			result, err := s.env.RenderTemplate("globals", data)
+			if err != nil {
+				b.Fatal(err)
+			}
+			_ = result
+		}
+	})
+
+	b.Run("global", func(b *testing.B) {
+		env, err := ginja.New()
+		if err != nil {
+			b.Fatal(err)
+		}
+		defer env.Close()
+		err = env.AddTemplate("globals", ginjaTemplate)
+		if err != nil {
+			b.Fatal(err)
+		}
+		err = env.AddGlobal("nav", nav)
+		if err != nil {
+			b.Fatal(err)
+		}
+		data := map[string]any{
+			"name": "John",
+		}
+		b.ResetTimer()
+		for b.Loop() {
+			result, err := env.RenderTemplate("globals", data)
+			if err != nil {
+				b.Fatal(err)
+			}
+			_ = result
+		}
+	})
+}
+
+// BenchRenderBinary - Binary context encoding versus the JSON path
+func (s *Suite) BenchRenderBinary(b *testing.B) {
+	ginjaTemplate := `{{ title }}{% for user in users %}{{ user.Name }}:{{ user.Age }}:{{ user.Score }};{% endfor %}`
+
+	users := make([]BenchmarkData, 100)
+	for i := range users {
+		users[i] = BenchmarkData{
+			Name:   "User" + string(rune('A'+(i%26))),
+			Age:    20 + i%50,
+			Active: i%2 == 0,
+			Score:  float64(i) * 10.5,
+		}
+	}
+	data := map[string]any{
+		"title": "Users",
+		"users": users,
+	}
+
+	err := s.env.AddTemplate("binary", ginjaTemplate)
+	if err != nil {
+		b.Fatal(err)
+	}
+
+	b.Run("json", func(b *testing.B) {
+		b.ReportAllocs()
+		b.ResetTimer()
+		for b.Loop() {
+			result, err := s.env.RenderTemplate("binary", data)
+			if err != nil {
+				b.Fatal(err)
+			}
+			_ = result
+		}
+	})
+
+	b.Run("binary", func(b *testing.B) {
+		b.ReportAllocs()
+		b.ResetTimer()
+		for b.Loop() {
+			result, err := s.env.RenderBinary("binary", data)
+			if err != nil {
+				b.Fatal(err)
+			}
+			_ = result
+		}
+	})
+}
+
+// BenchBulkUpdate - Adding many templates one by one versus in a transaction
+func (s *Suite) BenchBulkUpdate(b *testing.B) {
+	names := make([]string, 500)
+	for i := range names {
+		names[i] = "bulk_" + strconv.Itoa(i)
+	}
+
+	b.Run("single", func(b *testing.B) {
+		env, err := ginja.New()
+		if err != nil {
+			b.Fatal(err)
+		}
+		defer env.Close()
+		b.ResetTimer()
+		for b.Loop() {
+			for _, name := range names {
+				err := env.AddTemplate(name, "Hello {{ name }}!")
+				if err != nil {
+					b.Fatal(err)
+				}
+			}
+		}
+	})
+
+	b.Run("txn", func(b *testing.B) {
+		env, err := ginja.New()
+		if err != nil {
+			b.Fatal(err)
+		}
+		defer env.Close()
+		b.ResetTimer()
+		for b.Loop() {
+			err := env.Update(func(txn *ginja.Txn) error {
+				for _, name := range names {
+					if err := txn.AddTemplate(name, "Hello {{ name }}!"); err != nil {
+						return err
+					}
+				}
+				return nil
+			})
+			if err != nil {
+				b.Fatal(err)
+			}
+		}
+	})
+}
+
+// BenchColdStart - Registering a template tree eagerly, from a bundle, or lazily
+func (s *Suite) BenchColdStart(b *testing.B) {
+	dir := b.TempDir()
+	templates := make(map[string]string, 200)
+	for i := range 200 {
+		templates["page_"+strconv.Itoa(i)+".html"] = strings.Repeat("{% if flag %}{{ name }}{% endif %}\n", 50)
+	}
+	err := writeTemplates(dir, templates)
+	if err != nil {
+		b.Fatal(err)
+	}
+	data := map[string]any{"flag": true, "name": "John"}
+
+	b.Run("eager", func(b *testing.B) {
+		for b.Loop() {
+			env, err := ginja.New()
+			if err != nil {
+				b.Fatal(err)
+			}
+			for name := range templates {
+				source, err := os.ReadFile(filepath.Join(dir, name))
+				if err != nil {
+					b.Fatal(err)
+				}
+				err = env.AddTemplate(name, string(source))
+				if err != nil {
+					b.Fatal(err)
+				}
+			}
+			_, err = env.RenderTemplate("page_0.html", data)
+			if err != nil {
+				b.Fatal(err)
+			}
+			env.Close()
+		}
+	})
+
+	bundle := filepath.Join(b.TempDir(), "templates.bundle")
+	f, err := os.Create(bundle)
+	if err != nil {
+		b.Fatal(err)
+	}
+	err = ginja.WriteBundle(f, os.DirFS(dir))
+	if err != nil {
+		b.Fatal(err)
+	}
+	f.Close()
+
+	b.Run("bundle", func(b *testing.B) {
+		for b.Loop() {
+			env, err := ginja.New(ginja.WithBundle(bundle))
+			if err != nil {
+				b.Fatal(err)
+			}
+			_, err = env.RenderTemplate("page_0.html", data)
+			if err != nil {
+				b.Fatal(err)
+			}
+			env.Close()
+		}
+	})
+
+	b.Run("lazy", func(b *testing.B) {
+		for b.Loop() {
+			env, err := ginja.New(ginja.WithTemplateDir(dir))
+			if err != nil {
+				b.Fatal(err)
+			}
+			_, err = env.RenderTemplate("page_0.html", data)
+			if err != nil {
+				b.Fatal(err)
+			}
+			env.Close()
+		}
+	})
+}
+
+// BenchTenants - Setting up an environment per tenant from scratch versus forking a base
+func (s *Suite) BenchTenants(b *testing.B) {
+	templates := make(map[string]string, 100)
+	for i := range 100 {
+		templates["page_"+strconv.Itoa(i)+".html"] = strings.Repeat("{% if flag %}{{ name }}{% endif %}\n", 50)
+	}
+	data := map[string]any{"flag": true, "name": "John"}
+
+	b.Run("new", func(b *testing.B) {
+		for b.Loop() {
+			env, err := ginja.New()
+			if err != nil {
+				b.Fatal(err)
+			}
+			for name, source := range templates {
+				err = env.AddTemplate(name, source)
+				if err != nil {
+					b.Fatal(err)
+				}
+			}
+			_, err = env.RenderTemplate("page_0.html", data)
+			if err != nil {
+				b.Fatal(err)
+			}
+			env.Close()
+		}
+	})
+
+	base, err := ginja.New()
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer base.Close()
+	for name, source := range templates {
+		err = base.AddTemplate(name, source)
+		if err != nil {
+			b.Fatal(err)
+		}
+	}
+
+	b.Run("fork", func(b *testing.B) {
+		for b.Loop() {
+			env, err := base.Fork()
+			if err != nil {
+				b.Fatal(err)
+			}
+			_, err = env.RenderTemplate("page_0.html", data)
+			if err != nil {
+				b.Fatal(err)
+			}
+			env.Close()
+		}
+	})
+}
+
+// BenchStats - Rendering with render metrics disabled versus enabled
+func (s *Suite) BenchStats(b *testing.B) {
+	data := map[string]any{"name": "John"}
+	for _, enabled := range []bool{false, true} {
+		b.Run("enabled="+strconv.FormatBool(enabled), func(b *testing.B) {
+			env, err := ginja.New()
+			if err != nil {
+				b.Fatal(err)
+			}
+			defer env.Close()
+			err = env.AddTemplate("stats", "Hello {{ name }}!")
+			if err != nil {
+				b.Fatal(err)
+			}
+			env.SetStats(enabled)
+			for b.Loop() {
+				_, err := env.RenderTemplate("stats", data)
+				if err != nil {
+					b.Fatal(err)
+				}
+			}
+		})
+	}
+}
+
+// BenchRenderError - Failing renders that only inspect the error code
+func (s *Suite) BenchRenderError(b *testing.B) {
+	err := s.env.AddTemplate("bench_error", "{{ items }}{{ missing.attr }}")
+	if err != nil {
+		b.Fatal(err)
+	}
+	data := map[string]any{"items": []int{1, 2, 3}}
+	for b.Loop() {
+		_, err := s.env.RenderTemplate("bench_error", data)
+		var e *ginja.Error
+		if !errors.As(err, &e) || e.Code() != ginja.CodeUndefinedError {
+			b.Fatal(err)
+		}
+	}
+}
+
+// BenchRenderCache - Rendering the same context with the render cache disabled versus enabled
+func (s *Suite) BenchRenderCache(b *testing.B) {
+	source := strings.Repeat("{% for item in items %}{{ item.name }}: {{ item.price }}\n{% endfor %}", 10)
+	items := make([]map[string]any, 20)
+	for i := range items {
+		items[i] = map[string]any{"name": "item" + strconv.Itoa(i), "price": i * 10}
+	}
+	data := map[string]any{"items": items}
+	for _, budget := range []int{0, 1 << 20} {
+		b.Run("budget="+strconv.Itoa(budget), func(b *testing.B) {
+			env, err := ginja.New()
+			if err != nil {
+				b.Fatal(err)
+			}
+			defer env.Close()
+			err = env.AddTemplate("cached", source)
+			if err != nil {
+				b.Fatal(err)
+			}
+			env.SetRenderCache(budget)
+			for b.Loop() {
+				_, err := env.RenderTemplate("cached", data)
+				if err != nil {
+					b.Fatal(err)
+				}
+			}
+		})
+	}
+}
+
+// BenchRenderBlock - Rendering one block of a large page versus the whole page
+func (s *Suite) BenchRenderBlock(b *testing.B) {
+	env, err := ginja.New()
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer env.Close()
+	rows := strings.Repeat("{% for item in items %}<tr><td>{{ item.name }}</td><td>{{ item.price }}</td></tr>{% endfor %}", 20)
+	err = env.AddTemplate("block_bench", "<table>"+rows+"</table>{% block summary %}{{ items | length }} items{% endblock %}")
+	if err != nil {
+		b.Fatal(err)
+	}
+	items := make([]map[string]any, 50)
+	for i := range items {
+		items[i] = map[string]any{"name": "item" + strconv.Itoa(i), "price": i * 10}
+	}
+	data := map[string]any{"items": items}
+
+	b.Run("template", func(b *testing.B) {
+		for b.Loop() {
+			_, err := env.RenderTemplate("block_bench", data)
+			if err != nil {
+				b.Fatal(err)
+			}
+		}
+	})
+	b.Run("block", func(b *testing.B) {
+		for b.Loop() {
+			_, err := env.RenderBlock("block_bench", "summary", data)
+			if err != nil {
+				b.Fatal(err)
+			}
+		}
+	})
+}
+
+// BenchRenderLimits - Rendering without limits versus with fuel and a deadline
+func (s *Suite) BenchRenderLimits(b *testing.B) {
+	env, err := ginja.New()
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer env.Close()
+	err = env.AddTemplate("limits", "{% for item in items %}<li>{{ item.name }}: {{ item.price }}</li>{% endfor %}")
+	if err != nil {
+		b.Fatal(err)
+	}
+	items := make([]map[string]any, 100)
+	for i := range items {
+		items[i] = map[string]any{"name": "item" + strconv.Itoa(i), "price": i * 10}
+	}
+	data := map[string]any{"items": items}
+
+	for _, bench := range []struct {
+		name   string
+		limits ginja.Limits
+	}{
+		{"none", ginja.Limits{}},
+		{"fuel", ginja.Limits{Fuel: 1 << 20}},
+		{"deadline", ginja.Limits{Timeout: time.Second}},
+	} {
+		limits := bench.limits
+		b.Run(bench.name, func(b *testing.B) {
+			for b.Loop() {
+				_, err := env.RenderTemplateWithLimits("limits", data, limits)
+				if err != nil {
+					b.Fatal(err)
+				}
+			}
+		})
+	}
+}
+
+// BenchAutoEscape - Rendering text-heavy values with and without HTML auto-escaping
+func (s *Suite) BenchAutoEscape(b *testing.B) {
+	env, err := ginja.New()
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer env.Close()
+	source := "{% for p in paragraphs %}<p>{{ p }}</p>{% endfor %}"
+	for _, name := range []string{"escape.txt", "escape.html"} {
+		err = env.AddTemplate(name, source)
+		if err != nil {
+			b.Fatal(err)
+		}
+	}
+	paragraph := strings.Repeat("Lorem ipsum dolor sit amet, consectetur adipiscing elit. ", 20) + "Tom & Jerry <3"
+	paragraphs := make([]string, 50)
+	for i := range paragraphs {
+		paragraphs[i] = paragraph
+	}
+	data := map[string]any{"paragraphs": paragraphs}
+
+	for _, name := range []string{"escape.txt", "escape.html"} {
+		b.Run(name, func(b *testing.B) {
+			for b.Loop() {
+				_, err := env.RenderTemplate(name, data)
+				if err != nil {
+					b.Fatal(err)
+				}
+			}
+		})
+	}
+}
+
+// BenchLazyContext - Rendering a few fields of a large context, decoded eagerly and lazily
+func (s *Suite) BenchLazyContext(b *testing.B) {
+	env, err := ginja.New()
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer env.Close()
+	err = env.AddTemplate("lazy", "{{ user.name }} ({{ user.email }}) has {{ orders | length }} orders")
+	if err != nil {
+		b.Fatal(err)
+	}
+	orders := make([]map[string]any, 1000)
+	for i := range orders {
+		orders[i] = map[string]any{
+			"id":    i,
+			"item":  "Item " + strconv.Itoa(i),
+			"price": float64(i) * 1.25,
+			"tags":  []string{"new", "sale"},
+		}
+	}
+	data := map[string]any{
+		"user":   map[string]any{"name": "John Doe", "email": "john@example.com"},
+		"orders": orders,
+	}
+
+	for _, lazy := range []bool{false, true} {
+		b.Run("lazy="+strconv.FormatBool(lazy), func(b *testing.B) {
+			env.SetLazyContext(lazy)
+			for b.Loop() {
+				_, err := env.RenderTemplate("lazy", data)
+				if err != nil {
+					b.Fatal(err)
+				}
+			}
+		})
+	}
+}
+
+// BenchContextPruning - Rendering a template that reads a small part of a large context, with and without pruning
+func (s *Suite) BenchContextPruning(b *testing.B) {
+	env, err := ginja.New()
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer env.Close()
+	err = env.AddTemplate("pruning", "Hello {{ user.name }}, you have {{ unread }} unread messages")
+	if err != nil {
+		b.Fatal(err)
+	}
+	data := map[string]any{
+		"user":   map[string]any{"name": "John Doe", "email": "john@example.com"},
+		"unread": 3,
+	}
+	for i := range 100 {
+		data["section"+strconv.Itoa(i)] = map[string]any{
+			"title": "Section " + strconv.Itoa(i),
+			"items": []int{1, 2, 3, 4, 5},
+		}
+	}
+
+	for _, pruned := range []bool{false, true} {
+		b.Run("pruned="+strconv.FormatBool(pruned), func(b *testing.B) {
+			env.SetContextPruning(pruned)
+			for b.Loop() {
+				_, err := env.RenderTemplate("pruning", data)
+				if err != nil {
+					b.Fatal(err)
+				}
+			}
+		})
+	}
+}
+
+// BenchExpression - Evaluating a feature-flag rule as a compiled expression and as a rendered template
+func (s *Suite) BenchExpression(b *testing.B) {
+	env, err := ginja.New()
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer env.Close()
+	rule := `user.age >= 18 and "beta" in user.flags and country in ["DE", "FR"]`
+	expr, err := env.CompileExpression(rule)
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer expr.Close()
+	err = env.AddTemplate("rule", "{{ "+rule+" }}")
+	if err != nil {
+		b.Fatal(err)
+	}
+	data := map[string]any{
+		"user":    map[string]any{"age": 21, "flags": []string{"beta"}},
+		"country": "DE",
+	}
+
+	b.Run("expression", func(b *testing.B) {
+		for b.Loop() {
+			value, err := expr.Eval(data)
+			if err != nil || value != true {
+				b.Fatal(value, err)
+			}
+		}
+	})
+	b.Run("template", func(b *testing.B) {
+		for b.Loop() {
+			rendered, err := env.RenderTemplate("rule", data)
+			if err != nil || rendered != "true" {
+				b.Fatal(rendered, err)
+			}
+		}
+	})
+}
+
+// BenchQueue - Rendering concurrently through a queue versus direct calls
+func (s *Suite) BenchQueue(b *testing.B) {
+	err := s.env.AddTemplate("queue", "Dear {{ name }}, your score is {{ score }}.")
+	if err != nil {
+		b.Fatal(err)
+	}
+	queue, err := s.env.NewQueue(256, 0)
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer queue.Close()
+	data := map[string]any{"name": "User", "score": 10.5}
+
+	b.Run("direct", func(b *testing.B) {
+		b.RunParallel(func(pb *testing.PB) {
+			for pb.Next() {
+				_, err := s.env.RenderTemplate("queue", data)
+				if err != nil {
+					b.Error(err)
+				}
+			}
+		})
+	})
+	b.Run("queue", func(b *testing.B) {
+		b.RunParallel(func(pb *testing.PB) {
+			for pb.Next() {
+				_, err := queue.RenderTemplate("queue", data)
+				if err != nil {
+					b.Error(err)
+				}
+			}
+		})
+	})
+}
+
+// BenchTemplateBudget - Rendering mostly hot tenant templates with and without a budget for compiled templates
+func (s *Suite) BenchTemplateBudget(b *testing.B) {
+	source := strings.Repeat("{% for item in items %}{{ item.name }}: {{ item.price }}\n{% endfor %}", 10)
+	data := map[string]any{"items": []map[string]any{{"name": "item", "price": 10}}}
+	for _, budget := range []int{0, 64 << 10} {
+		b.Run("budget="+strconv.Itoa(budget), func(b *testing.B) {
+			env, err := ginja.New()
+			if err != nil {
+				b.Fatal(err)
+			}
+			defer env.Close()
+			env.SetTemplateBudget(budget, true)
+			names := make([]string, 1000)
+			for i := range names {
+				names[i] = "tenant" + strconv.Itoa(i)
+				err = env.AddTemplate(names[i], source)
+				if err != nil {
+					b.Fatal(err)
+				}
+			}
+			i := 0
+			for b.Loop() {
+				// One render in a hundred goes to a cold template
+				name := names[i%10]
+				if i%100 == 0 {
+					name = names[10+i/100%990]
+				}
+				i++
+				_, err := env.RenderTemplate(name, data)
+				if err != nil {
+					b.Fatal(err)
+				}
+			}
+			stats := env.TemplateStoreStats()
+			b.ReportMetric(float64(stats.CompiledBytes+stats.StoredBytes), "template-bytes")
+			b.ReportMetric(float64(stats.Recompiles), "recompiles")
+		})
+	}
+}
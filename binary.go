@@ -0,0 +1,567 @@
+package ginja
+
+import (
+	"encoding"
+	"encoding/base64"
+	"encoding/binary"
+	"encoding/json"
+	"fmt"
+	"math"
+	"reflect"
+	"slices"
+	"strconv"
+	"strings"
+	"sync"
+
+	"github.com/bytedance/sonic"
+)
+
+// extJSON is the MessagePack extension type the native library decodes as
+// an embedded JSON document. It carries values that implement json.Marshaler
+// and therefore have no native representation.
+const extJSON = 1
+
+// binaryEncoder writes MessagePack into a buffer that is pooled across
+// renders, so steady-state encoding does not allocate.
+type binaryEncoder struct {
+	buf []byte
+}
+
+var binaryEncoders = sync.Pool{
+	New: func() any {
+		return new(binaryEncoder)
+	},
+}
+
+// encodeFunc encodes v, whose type is fixed by the plan it belongs to.
+type encodeFunc func(e *binaryEncoder, v reflect.Value) error
+
+// plans caches the encodeFunc of every type seen so far, so the reflection
+// walk over struct fields and tags happens once per type.
+var plans sync.Map // map[reflect.Type]encodeFunc
+
+var (
+	jsonMarshalerType = reflect.TypeFor[json.Marshaler]()
+	textMarshalerType = reflect.TypeFor[encoding.TextMarshaler]()
+)
+
+// RenderBinary renders the named template like RenderTemplate, but sends
+// the context in a compact binary format instead of JSON text. ctx may be
+// a map or a struct; struct fields honour their json tags.
+func (env *Environment) RenderBinary(name string, ctx any) (rendered string, err error) {
+	e := binaryEncoders.Get().(*binaryEncoder)
+	defer binaryEncoders.Put(e)
+	if err = e.reset(ctx); err != nil {
+		return
+	}
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return
+	}
+	ret := env.ffi.MjEnvRenderBinary(env.inner, nptr, &e.buf[0], uint(len(e.buf)))
+	return takeRenderResult(env.ffi, ret)
+}
+
+// RenderBinary renders the template with ctx sent in the binary format.
+//
+// See Environment.RenderBinary for details.
+func (tmpl *Template) RenderBinary(ctx any) (rendered string, err error) {
+	e := binaryEncoders.Get().(*binaryEncoder)
+	defer binaryEncoders.Put(e)
+	if err = e.reset(ctx); err != nil {
+		return
+	}
+	ret := tmpl.ffi.MjTemplateRenderBinary(tmpl.inner, &e.buf[0], uint(len(e.buf)))
+	return takeRenderResult(tmpl.ffi, ret)
+}
+
+func (e *binaryEncoder) reset(v any) error {
+	e.buf = e.buf[:0]
+	return e.encodeAny(v)
+}
+
+// encodeAny handles the types that dominate contexts built from
+// map[string]any without going through reflection at all.
+func (e *binaryEncoder) encodeAny(v any) error {
+	switch v := v.(type) {
+	case nil:
+		e.writeNil()
+	case string:
+		e.writeString(v)
+	case bool:
+		e.writeBool(v)
+	case int:
+		e.writeInt(int64(v))
+	case int64:
+		e.writeInt(v)
+	case float64:
+		e.writeFloat64(v)
+	case map[string]any:
+		return e.encodeMap(v)
+	case []any:
+		e.writeArrayLen(len(v))
+		for _, item := range v {
+			if err := e.encodeAny(item); err != nil {
+				return err
+			}
+		}
+	case []map[string]any:
+		e.writeArrayLen(len(v))
+		for _, item := range v {
+			if err := e.encodeMap(item); err != nil {
+				return err
+			}
+		}
+	default:
+		rv := reflect.ValueOf(v)
+		return planFor(rv.Type())(e, rv)
+	}
+	return nil
+}
+
+func (e *binaryEncoder) encodeMap(m map[string]any) error {
+	if m == nil {
+		e.writeNil()
+		return nil
+	}
+	e.writeMapLen(len(m))
+	for k, v := range m {
+		e.writeString(k)
+		if err := e.encodeAny(v); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+// planFor returns the cached encodeFunc for t, building it on first use.
+func planFor(t reflect.Type) encodeFunc {
+	if f, ok := plans.Load(t); ok {
+		return f.(encodeFunc)
+	}
+
+	// Publish an indirect func before building the plan, so that recursive
+	// types resolve to it instead of recursing forever.
+	var (
+		wg sync.WaitGroup
+		f  encodeFunc
+	)
+	wg.Add(1)
+	fi, loaded := plans.LoadOrStore(t, encodeFunc(func(e *binaryEncoder, v reflect.Value) error {
+		wg.Wait()
+		return f(e, v)
+	}))
+	if loaded {
+		return fi.(encodeFunc)
+	}
+	f = newPlan(t)
+	wg.Done()
+	plans.Store(t, f)
+	return f
+}
+
+func newPlan(t reflect.Type) encodeFunc {
+	if t.Implements(jsonMarshalerType) {
+		switch t.Kind() {
+		case reflect.Pointer, reflect.Interface:
+			return nilable(t, jsonPlan)
+		default:
+			return jsonPlan
+		}
+	}
+	if t.Kind() != reflect.Pointer && reflect.PointerTo(t).Implements(jsonMarshalerType) {
+		return addressable(t, jsonPlan)
+	}
+	switch t.Kind() {
+	case reflect.Bool:
+		return func(e *binaryEncoder, v reflect.Value) error {
+			e.writeBool(v.Bool())
+			return nil
+		}
+	case reflect.Int, reflect.Int8, reflect.Int16, reflect.Int32, reflect.Int64:
+		return func(e *binaryEncoder, v reflect.Value) error {
+			e.writeInt(v.Int())
+			return nil
+		}
+	case reflect.Uint, reflect.Uint8, reflect.Uint16, reflect.Uint32, reflect.Uint64, reflect.Uintptr:
+		return func(e *binaryEncoder, v reflect.Value) error {
+			e.writeUint(v.Uint())
+			return nil
+		}
+	case reflect.Float32:
+		return func(e *binaryEncoder, v reflect.Value) error {
+			e.writeFloat32(float32(v.Float()))
+			return nil
+		}
+	case reflect.Float64:
+		return func(e *binaryEncoder, v reflect.Value) error {
+			e.writeFloat64(v.Float())
+			return nil
+		}
+	case reflect.String:
+		return func(e *binaryEncoder, v reflect.Value) error {
+			e.writeString(v.String())
+			return nil
+		}
+	case reflect.Interface:
+		return func(e *binaryEncoder, v reflect.Value) error {
+			if v.IsNil() {
+				e.writeNil()
+				return nil
+			}
+			return e.encodeAny(v.Elem().Interface())
+		}
+	case reflect.Pointer:
+		elem := planFor(t.Elem())
+		return func(e *binaryEncoder, v reflect.Value) error {
+			if v.IsNil() {
+				e.writeNil()
+				return nil
+			}
+			return elem(e, v.Elem())
+		}
+	case reflect.Slice:
+		if t.Elem().Kind() == reflect.Uint8 {
+			// Byte slices are sent as base64 strings, as encoding/json
+			// does, so templates see the same value on both paths.
+			return func(e *binaryEncoder, v reflect.Value) error {
+				if v.IsNil() {
+					e.writeNil()
+					return nil
+				}
+				e.writeBase64(v.Bytes())
+				return nil
+			}
+		}
+		return nilable(t, arrayPlan(t))
+	case reflect.Array:
+		return arrayPlan(t)
+	case reflect.Map:
+		return nilable(t, mapPlan(t))
+	case reflect.Struct:
+		return structPlan(t)
+	default:
+		return func(e *binaryEncoder, v reflect.Value) error {
+			return fmt.Errorf("ginja: unsupported context type %s", t)
+		}
+	}
+}
+
+func nilable(t reflect.Type, f encodeFunc) encodeFunc {
+	return func(e *binaryEncoder, v reflect.Value) error {
+		if v.IsNil() {
+			e.writeNil()
+			return nil
+		}
+		return f(e, v)
+	}
+}
+
+// addressable makes the pointer receiver methods of t reachable for values
+// that are not addressable, by copying them first.
+func addressable(t reflect.Type, f encodeFunc) encodeFunc {
+	return func(e *binaryEncoder, v reflect.Value) error {
+		if !v.CanAddr() {
+			ptr := reflect.New(t)
+			ptr.Elem().Set(v)
+			v = ptr.Elem()
+		}
+		return f(e, v.Addr())
+	}
+}
+
+func jsonPlan(e *binaryEncoder, v reflect.Value) error {
+	data, err := sonic.Marshal(v.Interface())
+	if err != nil {
+		return err
+	}
+	e.writeExt(extJSON, data)
+	return nil
+}
+
+func arrayPlan(t reflect.Type) encodeFunc {
+	elem := planFor(t.Elem())
+	return func(e *binaryEncoder, v reflect.Value) error {
+		n := v.Len()
+		e.writeArrayLen(n)
+		for i := range n {
+			if err := elem(e, v.Index(i)); err != nil {
+				return err
+			}
+		}
+		return nil
+	}
+}
+
+func mapPlan(t reflect.Type) encodeFunc {
+	key := mapKeyPlan(t.Key())
+	if key == nil {
+		return func(e *binaryEncoder, v reflect.Value) error {
+			return fmt.Errorf("ginja: unsupported map key type %s", t.Key())
+		}
+	}
+	elem := planFor(t.Elem())
+	return func(e *binaryEncoder, v reflect.Value) error {
+		e.writeMapLen(v.Len())
+		iter := v.MapRange()
+		for iter.Next() {
+			if err := key(e, iter.Key()); err != nil {
+				return err
+			}
+			if err := elem(e, iter.Value()); err != nil {
+				return err
+			}
+		}
+		return nil
+	}
+}
+
+// mapKeyPlan encodes map keys as strings, following encoding/json.
+func mapKeyPlan(t reflect.Type) encodeFunc {
+	if t.Kind() == reflect.String {
+		return func(e *binaryEncoder, v reflect.Value) error {
+			e.writeString(v.String())
+			return nil
+		}
+	}
+	if t.Implements(textMarshalerType) {
+		return func(e *binaryEncoder, v reflect.Value) error {
+			text, err := v.Interface().(encoding.TextMarshaler).MarshalText()
+			if err != nil {
+				return err
+			}
+			e.writeString(string(text))
+			return nil
+		}
+	}
+	switch t.Kind() {
+	case reflect.Int, reflect.Int8, reflect.Int16, reflect.Int32, reflect.Int64:
+		return func(e *binaryEncoder, v reflect.Value) error {
+			e.writeString(strconv.FormatInt(v.Int(), 10))
+			return nil
+		}
+	case reflect.Uint, reflect.Uint8, reflect.Uint16, reflect.Uint32, reflect.Uint64, reflect.Uintptr:
+		return func(e *binaryEncoder, v reflect.Value) error {
+			e.writeString(strconv.FormatUint(v.Uint(), 10))
+			return nil
+		}
+	}
+	return nil
+}
+
+type fieldPlan struct {
+	name      string
+	index     []int
+	omitEmpty bool
+	encode    encodeFunc
+}
+
+// structPlan encodes a struct as a map of its exported fields, named and
+// filtered by their json tags like encoding/json does.
+func structPlan(t reflect.Type) encodeFunc {
+	var (
+		fields []fieldPlan
+		// Embedded fields that are encoded as a whole or skipped, whose
+		// promoted fields must therefore not be flattened.
+		opaque [][]int
+		// Whether the number of encoded fields depends on the value.
+		dynamic bool
+	)
+	for _, sf := range reflect.VisibleFields(t) {
+		if slices.ContainsFunc(opaque, func(prefix []int) bool {
+			return len(sf.Index) > len(prefix) && slices.Equal(sf.Index[:len(prefix)], prefix)
+		}) {
+			continue
+		}
+		tag := sf.Tag.Get("json")
+		name, opts, _ := strings.Cut(tag, ",")
+		// Untagged embedded structs are flattened; VisibleFields lists
+		// their promoted fields right after them.
+		if sf.Anonymous {
+			ft := sf.Type
+			if ft.Kind() == reflect.Pointer {
+				ft = ft.Elem()
+			}
+			if ft.Kind() == reflect.Struct && name == "" {
+				continue
+			}
+			opaque = append(opaque, sf.Index)
+		}
+		if !sf.IsExported() || tag == "-" {
+			continue
+		}
+		if name == "" {
+			name = sf.Name
+		}
+		omitEmpty := slices.Contains(strings.Split(opts, ","), "omitempty")
+		dynamic = dynamic || omitEmpty || len(sf.Index) > 1
+		fields = append(fields, fieldPlan{
+			name:      name,
+			index:     sf.Index,
+			omitEmpty: omitEmpty,
+			encode:    planFor(sf.Type),
+		})
+	}
+
+	return func(e *binaryEncoder, v reflect.Value) error {
+		n := len(fields)
+		if dynamic {
+			n = 0
+			for i := range fields {
+				if _, ok := fieldValue(v, &fields[i]); ok {
+					n++
+				}
+			}
+		}
+		e.writeMapLen(n)
+		for i := range fields {
+			fv, ok := fieldValue(v, &fields[i])
+			if !ok {
+				continue
+			}
+			e.writeString(fields[i].name)
+			if err := fields[i].encode(e, fv); err != nil {
+				return err
+			}
+		}
+		return nil
+	}
+}
+
+// fieldValue resolves a field, reporting false for fields behind a nil
+// embedded pointer and for empty fields tagged omitempty.
+func fieldValue(v reflect.Value, f *fieldPlan) (reflect.Value, bool) {
+	fv, err := v.FieldByIndexErr(f.index)
+	if err != nil {
+		return fv, false
+	}
+	if f.omitEmpty && isEmptyValue(fv) {
+		return fv, false
+	}
+	return fv, true
+}
+
+func isEmptyValue(v reflect.Value) bool {
+	switch v.Kind() {
+	case reflect.Array, reflect.Map, reflect.Slice, reflect.String:
+		return v.Len() == 0
+	case reflect.Bool,
+		reflect.Int, reflect.Int8, reflect.Int16, reflect.Int32, reflect.Int64,
+		reflect.Uint, reflect.Uint8, reflect.Uint16, reflect.Uint32, reflect.Uint64, reflect.Uintptr,
+		reflect.Float32, reflect.Float64,
+		reflect.Interface, reflect.Pointer:
+		return v.IsZero()
+	}
+	return false
+}
+
+func (e *binaryEncoder) writeNil() {
+	e.buf = append(e.buf, 0xc0)
+}
+
+func (e *binaryEncoder) writeBool(b bool) {
+	if b {
+		e.buf = append(e.buf, 0xc3)
+	} else {
+		e.buf = append(e.buf, 0xc2)
+	}
+}
+
+func (e *binaryEncoder) writeInt(i int64) {
+	switch {
+	case i >= 0:
+		e.writeUint(uint64(i))
+	case i >= -32:
+		e.buf = append(e.buf, byte(i))
+	case i >= math.MinInt8:
+		e.buf = append(e.buf, 0xd0, byte(i))
+	case i >= math.MinInt16:
+		e.buf = binary.BigEndian.AppendUint16(append(e.buf, 0xd1), uint16(i))
+	case i >= math.MinInt32:
+		e.buf = binary.BigEndian.AppendUint32(append(e.buf, 0xd2), uint32(i))
+	default:
+		e.buf = binary.BigEndian.AppendUint64(append(e.buf, 0xd3), uint64(i))
+	}
+}
+
+func (e *binaryEncoder) writeUint(u uint64) {
+	switch {
+	case u <= 0x7f:
+		e.buf = append(e.buf, byte(u))
+	case u <= math.MaxUint8:
+		e.buf = append(e.buf, 0xcc, byte(u))
+	case u <= math.MaxUint16:
+		e.buf = binary.BigEndian.AppendUint16(append(e.buf, 0xcd), uint16(u))
+	case u <= math.MaxUint32:
+		e.buf = binary.BigEndian.AppendUint32(append(e.buf, 0xce), uint32(u))
+	default:
+		e.buf = binary.BigEndian.AppendUint64(append(e.buf, 0xcf), u)
+	}
+}
+
+func (e *binaryEncoder) writeFloat32(f float32) {
+	e.buf = binary.BigEndian.AppendUint32(append(e.buf, 0xca), math.Float32bits(f))
+}
+
+func (e *binaryEncoder) writeFloat64(f float64) {
+	e.buf = binary.BigEndian.AppendUint64(append(e.buf, 0xcb), math.Float64bits(f))
+}
+
+func (e *binaryEncoder) writeString(s string) {
+	e.writeStringHeader(len(s))
+	e.buf = append(e.buf, s...)
+}
+
+func (e *binaryEncoder) writeBase64(b []byte) {
+	e.writeStringHeader(base64.StdEncoding.EncodedLen(len(b)))
+	e.buf = base64.StdEncoding.AppendEncode(e.buf, b)
+}
+
+func (e *binaryEncoder) writeStringHeader(n int) {
+	switch {
+	case n <= 31:
+		e.buf = append(e.buf, 0xa0|byte(n))
+	case n <= math.MaxUint8:
+		e.buf = append(e.buf, 0xd9, byte(n))
+	case n <= math.MaxUint16:
+		e.buf = binary.BigEndian.AppendUint16(append(e.buf, 0xda), uint16(n))
+	default:
+		e.buf = binary.BigEndian.AppendUint32(append(e.buf, 0xdb), uint32(n))
+	}
+}
+
+func (e *binaryEncoder) writeExt(typ int8, data []byte) {
+	n := len(data)
+	switch {
+	case n <= math.MaxUint8:
+		e.buf = append(e.buf, 0xc7, byte(n))
+	case n <= math.MaxUint16:
+		e.buf = binary.BigEndian.AppendUint16(append(e.buf, 0xc8), uint16(n))
+	default:
+		e.buf = binary.BigEndian.AppendUint32(append(e.buf, 0xc9), uint32(n))
+	}
+	e.buf = append(e.buf, byte(typ))
+	e.buf = append(e.buf, data...)
+}
+
+func (e *binaryEncoder) writeArrayLen(n int) {
+	switch {
+	case n <= 15:
+		e.buf = append(e.buf, 0x90|byte(n))
+	case n <= math.MaxUint16:
+		e.buf = binary.BigEndian.AppendUint16(append(e.buf, 0xdc), uint16(n))
+	default:
+		e.buf = binary.BigEndian.AppendUint32(append(e.buf, 0xdd), uint32(n))
+	}
+}
+
+func (e *binaryEncoder) writeMapLen(n int) {
+	switch {
+	case n <= 15:
+		e.buf = append(e.buf, 0x80|byte(n))
+	case n <= math.MaxUint16:
+		e.buf = binary.BigEndian.AppendUint16(append(e.buf, 0xde), uint16(n))
+	default:
+		e.buf = binary.BigEndian.AppendUint32(append(e.buf, 0xdf), uint32(n))
+	}
+}
@@ -0,0 +1,130 @@
+package ginja_test
+
+import (
+	"encoding/json"
+	"math"
+
+	"github.com/stretchr/testify/require"
+)
+
+type binaryAddress struct {
+	City string `json:"city"`
+}
+
+type binaryMeta struct {
+	Version int `json:"version"`
+}
+
+type binaryUser struct {
+	binaryMeta
+	Name    string         `json:"name"`
+	Nick    string         `json:"nick,omitempty"`
+	Age     uint8          `json:"age"`
+	Score   float32        `json:"score"`
+	Tags    []string       `json:"tags"`
+	Address *binaryAddress `json:"address"`
+	Friends []*binaryUser  `json:"friends,omitempty"`
+	Secret  string         `json:"-"`
+	Stamp   binaryStamp    `json:"stamp"`
+}
+
+type binaryStamp struct {
+	Unix int64
+}
+
+func (s binaryStamp) MarshalJSON() ([]byte, error) {
+	return json.Marshal(map[string]any{"unix": s.Unix})
+}
+
+func (s *Suite) TestRenderBinaryMap(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("binary_map",
+		"{{ name }} {{ n }} {{ big }} {{ f }} {{ items|join(',') }} {{ ok }} {{ none is none }}"))
+
+	result, err := env.RenderBinary("binary_map", map[string]any{
+		"name":  "World",
+		"n":     -300,
+		"big":   uint64(math.MaxUint64),
+		"f":     1.5,
+		"items": []any{1, "two", 3.5},
+		"ok":    true,
+		"none":  nil,
+	})
+	assert.Nil(err)
+	assert.Equal("World -300 18446744073709551615 1.5 1,two,3.5 true true", result)
+}
+
+func (s *Suite) TestRenderBinaryStruct(assert *require.Assertions) {
+	env := s.env
+
+	source := "{{ version }} {{ name }}/{{ nick }}/{{ age }}/{{ score }} {{ tags|join(',') }} " +
+		"{{ address.city }} {{ friends|length }} {{ secret is undefined }} {{ stamp.unix }}" +
+		"{% for f in friends %} {{ f.name }}{% endfor %}"
+	assert.Nil(env.AddTemplate("binary_struct", source))
+
+	user := binaryUser{
+		binaryMeta: binaryMeta{Version: 2},
+		Name:       "Alice",
+		Age:        30,
+		Score:      0.1,
+		Tags:       []string{"a", "b"},
+		Address:    &binaryAddress{City: "Paris"},
+		Friends:    []*binaryUser{{Name: "Bob"}, {Name: "Carol"}},
+		Secret:     "hidden",
+		Stamp:      binaryStamp{Unix: 1700000000},
+	}
+
+	result, err := env.RenderBinary("binary_struct", &user)
+	assert.Nil(err)
+	assert.Equal("2 Alice//30/0.1 a,b Paris 2 true 1700000000 Bob Carol", result)
+
+	// The binary path renders the same as the JSON path
+	data, err := json.Marshal(user)
+	assert.Nil(err)
+	var ctx map[string]any
+	assert.Nil(json.Unmarshal(data, &ctx))
+	expected, err := env.RenderTemplate("binary_struct", ctx)
+	assert.Nil(err)
+	assert.Equal(expected, result)
+}
+
+func (s *Suite) TestRenderBinaryTemplate(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("binary_handle", "{% for k, v in counts|dictsort %}{{ k }}={{ v }};{% endfor %}"))
+	tmpl, err := env.GetTemplate("binary_handle")
+	assert.Nil(err)
+	defer tmpl.Close()
+
+	result, err := tmpl.RenderBinary(map[string]map[string]int{
+		"counts": {"b": 2, "a": 1},
+	})
+	assert.Nil(err)
+	assert.Equal("a=1;b=2;", result)
+}
+
+func (s *Suite) TestRenderBinaryBytes(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("binary_bytes", "{{ data }}"))
+	ctx := map[string]any{"data": []byte("hello")}
+	result, err := env.RenderBinary("binary_bytes", ctx)
+	assert.Nil(err)
+
+	// Test that byte slices render as base64, as on the JSON path
+	expected, err := env.RenderTemplate("binary_bytes", ctx)
+	assert.Nil(err)
+	assert.Equal("aGVsbG8=", expected)
+	assert.Equal(expected, result)
+}
+
+func (s *Suite) TestRenderBinaryUnsupported(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("binary_unsupported", "{{ ch }}"))
+	_, err := env.RenderBinary("binary_unsupported", map[string]any{
+		"ch": make(chan int),
+	})
+	assert.NotNil(err)
+}
@@ -0,0 +1,58 @@
+package ginja
+
+import (
+	"github.com/bytedance/sonic"
+)
+
+// RenderBlock renders only the named block of a template, which is cheaper
+// than rendering the whole template when only a fragment of a page is
+// needed. The top-level code of the template still runs with its output
+// discarded, so the block sees the templates it extends and the variables
+// it sets.
+func (env *Environment) RenderBlock(name, block string, ctx map[string]any) (rendered string, err error) {
+	value, err := sonic.Marshal(ctx)
+	if err != nil {
+		return
+	}
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return
+	}
+	bptr, err := BytePtrFromString(block)
+	if err != nil {
+		return
+	}
+	ret := env.ffi.MjEnvRenderBlock(env.inner, nptr, bptr, &value[0], uint(len(value)))
+	return takeRenderResult(env.ffi, ret)
+}
+
+// CallMacro calls a macro defined by a template with the given positional
+// arguments and returns its output.
+func (env *Environment) CallMacro(name, macro string, ctx map[string]any, args ...any) (rendered string, err error) {
+	value, err := sonic.Marshal(ctx)
+	if err != nil {
+		return
+	}
+	var (
+		aptr *byte
+		alen int
+	)
+	if len(args) > 0 {
+		var encoded []byte
+		encoded, err = sonic.Marshal(args)
+		if err != nil {
+			return
+		}
+		aptr, alen = &encoded[0], len(encoded)
+	}
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return
+	}
+	mptr, err := BytePtrFromString(macro)
+	if err != nil {
+		return
+	}
+	ret := env.ffi.MjEnvCallMacro(env.inner, nptr, mptr, &value[0], uint(len(value)), aptr, uint(alen))
+	return takeRenderResult(env.ffi, ret)
+}
@@ -0,0 +1,43 @@
+package ginja_test
+
+import (
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestRenderBlock(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("block_layout", "<html>{% block title %}Default{% endblock %}|{% block body %}{% endblock %}</html>"))
+	assert.Nil(env.AddTemplate("block_page", `{% extends "block_layout" %}{% set greeting = "Hello" %}{% block body %}{{ greeting }} {{ name }}!{% endblock %}`))
+
+	result, err := env.RenderBlock("block_page", "body", map[string]any{"name": "World"})
+	assert.Nil(err)
+	assert.Equal("Hello World!", result)
+
+	result, err = env.RenderBlock("block_page", "title", map[string]any{})
+	assert.Nil(err)
+	assert.Equal("Default", result)
+
+	_, err = env.RenderBlock("block_page", "missing", map[string]any{})
+	var e *ginja.Error
+	assert.ErrorAs(err, &e)
+	assert.Equal(ginja.CodeUnknownBlock, e.Code())
+}
+
+func (s *Suite) TestCallMacro(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("block_macros", `{% macro item(label, price=0) %}<li>{{ label }}: {{ price }}{{ currency }}</li>{% endmacro %}`))
+
+	result, err := env.CallMacro("block_macros", "item", map[string]any{"currency": "$"}, "Tea", 3)
+	assert.Nil(err)
+	assert.Equal("<li>Tea: 3$</li>", result)
+
+	result, err = env.CallMacro("block_macros", "item", map[string]any{"currency": "$"}, "Water")
+	assert.Nil(err)
+	assert.Equal("<li>Water: 0$</li>", result)
+
+	_, err = env.CallMacro("block_macros", "missing", map[string]any{})
+	assert.NotNil(err)
+}
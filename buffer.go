@@ -0,0 +1,82 @@
+package ginja
+
+import (
+	"slices"
+	"sync"
+	"unsafe"
+
+	"github.com/bytedance/sonic/encoder"
+)
+
+// renderScratch holds the per-call state of a buffered render, pooled so a
+// steady-state render loop does not allocate.
+type renderScratch struct {
+	ctx    []byte
+	outLen uint
+}
+
+var renderScratches = sync.Pool{
+	New: func() any {
+		return new(renderScratch)
+	},
+}
+
+func (sc *renderScratch) encode(ctx map[string]any) error {
+	sc.ctx = sc.ctx[:0]
+	return encoder.EncodeInto(&sc.ctx, ctx, 0)
+}
+
+// AppendRender renders the named template and appends the output to dst,
+// returning the extended buffer.
+//
+// The output is written by the native library straight into the spare
+// capacity of dst, so reusing the returned buffer across calls (for example
+// through a sync.Pool) avoids any per-call allocation for the output. dst is
+// grown and the template rendered again only when its capacity is too small.
+func (env *Environment) AppendRender(dst []byte, name string, ctx map[string]any) ([]byte, error) {
+	sc := renderScratches.Get().(*renderScratch)
+	defer renderScratches.Put(sc)
+	sc.ctx = sc.ctx[:0]
+	if err := env.marshalInto(&sc.ctx, name, ctx); err != nil {
+		return dst, err
+	}
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return dst, err
+	}
+	for {
+		avail := dst[len(dst):cap(dst)]
+		ret := env.ffi.MjEnvRenderInto(env.inner, nptr, &sc.ctx[0], uint(len(sc.ctx)),
+			unsafe.SliceData(avail), uint(len(avail)), &sc.outLen)
+		if ret != nil {
+			return dst, parseError(env.ffi, ret)
+		}
+		if int(sc.outLen) <= len(avail) {
+			return dst[:len(dst)+int(sc.outLen)], nil
+		}
+		dst = slices.Grow(dst, int(sc.outLen))
+	}
+}
+
+// AppendRender renders the template and appends the output to dst.
+//
+// See Environment.AppendRender for details.
+func (tmpl *Template) AppendRender(dst []byte, ctx map[string]any) ([]byte, error) {
+	sc := renderScratches.Get().(*renderScratch)
+	defer renderScratches.Put(sc)
+	if err := sc.encode(ctx); err != nil {
+		return dst, err
+	}
+	for {
+		avail := dst[len(dst):cap(dst)]
+		ret := tmpl.ffi.MjTemplateRenderInto(tmpl.inner, &sc.ctx[0], uint(len(sc.ctx)),
+			unsafe.SliceData(avail), uint(len(avail)), &sc.outLen)
+		if ret != nil {
+			return dst, parseError(tmpl.ffi, ret)
+		}
+		if int(sc.outLen) <= len(avail) {
+			return dst[:len(dst)+int(sc.outLen)], nil
+		}
+		dst = slices.Grow(dst, int(sc.outLen))
+	}
+}
@@ -0,0 +1,58 @@
+package ginja_test
+
+import (
+	"strings"
+
+	"github.com/stretchr/testify/require"
+)
+
+func (s *Suite) TestAppendRender(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("append_render_template", "Hello, {{ name }}!"))
+	buf, err := env.AppendRender([]byte("> "), "append_render_template", map[string]any{
+		"name": "World",
+	})
+	assert.Nil(err)
+	assert.Equal("> Hello, World!", string(buf))
+
+	buf, err = env.AppendRender(buf[:0], "append_render_template", map[string]any{
+		"name": "Alice",
+	})
+	assert.Nil(err)
+	assert.Equal("Hello, Alice!", string(buf))
+}
+
+func (s *Suite) TestAppendRenderGrow(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("append_render_grow", "{% for i in range(count) %}{{ line }}{% endfor %}"))
+	buf := make([]byte, 0, 8)
+	buf, err := env.AppendRender(buf, "append_render_grow", map[string]any{
+		"count": 1000,
+		"line":  "abcdef",
+	})
+	assert.Nil(err)
+	assert.Equal(strings.Repeat("abcdef", 1000), string(buf))
+}
+
+func (s *Suite) TestAppendRenderError(assert *require.Assertions) {
+	env := s.env
+
+	buf, err := env.AppendRender([]byte("keep"), "append_render_missing", map[string]any{})
+	assert.NotNil(err)
+	assert.Equal("keep", string(buf))
+}
+
+func (s *Suite) TestTemplateAppendRender(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("append_render_handle", "{{ a }}-{{ b }}"))
+	tmpl, err := env.GetTemplate("append_render_handle")
+	assert.Nil(err)
+	defer tmpl.Close()
+
+	buf, err := tmpl.AppendRender(nil, map[string]any{"a": "x", "b": "y"})
+	assert.Nil(err)
+	assert.Equal("x-y", string(buf))
+}
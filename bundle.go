@@ -0,0 +1,101 @@
+package ginja
+
+import (
+	"encoding/binary"
+	"errors"
+	"io"
+	"io/fs"
+	"unsafe"
+)
+
+// bundleMagic starts every bundle written by WriteBundle.
+const bundleMagic = "GJB1"
+
+// LoadBundle loads every template of the bundle file at path, as written by
+// WriteBundle or the ginja-bundle command. All templates are validated in
+// parallel, and the syntax errors of all of them are returned at once,
+// joined into a single error. The bundle is only installed if every
+// template is valid; templates are compiled on first use. A bundle that
+// names a template more than once is rejected.
+//
+// Templates of a bundle replace templates of the same name, and bundles
+// loaded later take precedence over earlier ones.
+//
+// The file stays memory mapped for the life of the environment, so it must
+// only be replaced by renaming a new file over it, as ginja-bundle does.
+// Rewriting it in place crashes the process.
+func (env *Environment) LoadBundle(path string) (err error) {
+	pptr, err := BytePtrFromString(path)
+	if err != nil {
+		return
+	}
+	ret := env.ffi.MjEnvLoadBundle(env.inner, pptr)
+	return takeBundleResult(env.ffi, ret)
+}
+
+// LoadBundleBytes loads a bundle from memory.
+//
+// See LoadBundle for details.
+func (env *Environment) LoadBundleBytes(data []byte) (err error) {
+	var ptr *byte
+	if len(data) > 0 {
+		ptr = &data[0]
+	}
+	ret := env.ffi.MjEnvLoadBundleBytes(env.inner, ptr, uint(len(data)))
+	return takeBundleResult(env.ffi, ret)
+}
+
+func takeBundleResult(ffi *ffi, ret unsafe.Pointer) (err error) {
+	defer ffi.MjResultEnvLoadBundleFree(ret)
+	result := (*mjResultEnvLoadBundle)(ret)
+	if result.len == 0 {
+		return
+	}
+	errs := make([]error, 0, result.len)
+	native := unsafe.Slice((*unsafe.Pointer)(result.errors), result.len)
+	for i := range native {
+		errs = append(errs, takeError(ffi, &native[i]))
+	}
+	return errors.Join(errs...)
+}
+
+// WriteBundle writes every regular file of fsys to w as a template bundle.
+// Template names are the slash-separated paths of the files, so a bundle
+// of a directory serves the same names as WithTemplateDir on it.
+func WriteBundle(w io.Writer, fsys fs.FS) (err error) {
+	type entry struct {
+		name   string
+		source []byte
+	}
+	var entries []entry
+	err = fs.WalkDir(fsys, ".", func(name string, d fs.DirEntry, err error) error {
+		if err != nil || !d.Type().IsRegular() {
+			return err
+		}
+		source, err := fs.ReadFile(fsys, name)
+		if err != nil {
+			return err
+		}
+		entries = append(entries, entry{name: name, source: source})
+		return nil
+	})
+	if err != nil {
+		return
+	}
+
+	index := binary.LittleEndian.AppendUint32([]byte(bundleMagic), uint32(len(entries)))
+	for _, e := range entries {
+		index = binary.LittleEndian.AppendUint32(index, uint32(len(e.name)))
+		index = binary.LittleEndian.AppendUint32(index, uint32(len(e.source)))
+		index = append(index, e.name...)
+	}
+	if _, err = w.Write(index); err != nil {
+		return
+	}
+	for _, e := range entries {
+		if _, err = w.Write(e.source); err != nil {
+			return
+		}
+	}
+	return
+}
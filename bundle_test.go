@@ -0,0 +1,91 @@
+package ginja_test
+
+import (
+	"bytes"
+	"os"
+	"path/filepath"
+	"testing/fstest"
+
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestBundle(assert *require.Assertions) {
+	var buf bytes.Buffer
+	assert.Nil(ginja.WriteBundle(&buf, fstest.MapFS{
+		"layout/base.html": {Data: []byte("<title>{% block title %}{% endblock %}</title>")},
+		"page.html":        {Data: []byte(`{% extends "layout/base.html" %}{% block title %}{{ title }}{% endblock %}`)},
+		"hello.txt":        {Data: []byte("Hello {{ name }}!")},
+	}))
+
+	env, err := ginja.New()
+	assert.Nil(err)
+	defer env.Close()
+	assert.Nil(env.AddTemplate("hello.txt", "Added {{ name }}"))
+	assert.Nil(env.LoadBundleBytes(buf.Bytes()))
+
+	result, err := env.RenderTemplate("page.html", map[string]any{"title": "Home"})
+	assert.Nil(err)
+	assert.Equal("<title>Home</title>", result)
+
+	// Bundle entries replace templates of the same name
+	result, err = env.RenderTemplate("hello.txt", map[string]any{"name": "World"})
+	assert.Nil(err)
+	assert.Equal("Hello World!", result)
+}
+
+func (s *Suite) TestBundleFile(assert *require.Assertions) {
+	dir, err := os.MkdirTemp("", "ginja-bundle")
+	assert.Nil(err)
+	defer os.RemoveAll(dir)
+	assert.Nil(writeTemplates(filepath.Join(dir, "templates"), map[string]string{
+		"hello.txt": "Hello {{ name }}!",
+	}))
+	path := filepath.Join(dir, "templates.bundle")
+	f, err := os.Create(path)
+	assert.Nil(err)
+	assert.Nil(ginja.WriteBundle(f, os.DirFS(filepath.Join(dir, "templates"))))
+	assert.Nil(f.Close())
+
+	env, err := ginja.New(ginja.WithBundle(path))
+	assert.Nil(err)
+	defer env.Close()
+
+	result, err := env.RenderTemplate("hello.txt", map[string]any{"name": "World"})
+	assert.Nil(err)
+	assert.Equal("Hello World!", result)
+
+	_, err = ginja.New(ginja.WithBundle(filepath.Join(dir, "missing.bundle")))
+	var e *ginja.Error
+	assert.ErrorAs(err, &e)
+	assert.Equal(ginja.CodeInvalidOperation, e.Code())
+}
+
+func (s *Suite) TestBundleErrors(assert *require.Assertions) {
+	var buf bytes.Buffer
+	assert.Nil(ginja.WriteBundle(&buf, fstest.MapFS{
+		"good.txt": {Data: []byte("Good {{ name }}")},
+		"bad1.txt": {Data: []byte("{% if %}")},
+		"bad2.txt": {Data: []byte("{{ name")},
+	}))
+
+	env, err := ginja.New()
+	assert.Nil(err)
+	defer env.Close()
+
+	// Every failing template is reported, and none of them is installed
+	err = env.LoadBundleBytes(buf.Bytes())
+	assert.NotNil(err)
+	errs := err.(interface{ Unwrap() []error }).Unwrap()
+	assert.Len(errs, 2)
+	for _, err := range errs {
+		var e *ginja.Error
+		assert.ErrorAs(err, &e)
+		assert.Equal(ginja.CodeSyntaxError, e.Code())
+	}
+
+	_, err = env.RenderTemplate("good.txt", map[string]any{"name": "World"})
+	var e *ginja.Error
+	assert.ErrorAs(err, &e)
+	assert.Equal(ginja.CodeTemplateNotFound, e.Code())
+}
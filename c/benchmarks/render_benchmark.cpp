@@ -0,0 +1,156 @@
+#include "minijinja.h"
+#include <benchmark/benchmark.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+
+namespace {
+
+const char* kListTemplate = "<ul>{% for item in items %}"
+                            "<li class=\"{{ loop.cycle('odd', 'even') }}\">{{ item.name | title }}: {{ item.price }}</li>"
+                            "{% endfor %}</ul>";
+
+const char* kPageTemplate = "<html><head><title>{{ title }}</title></head><body>"
+                            "{% if user %}<p>Welcome, {{ user.name }}!</p>{% else %}<p>Please sign in.</p>{% endif %}"
+                            "{% for section in sections %}<h2>{{ section.title }}</h2>"
+                            "{% for item in section['items'] %}<p>{{ item | upper }}</p>{% endfor %}{% endfor %}"
+                            "{% macro link(url, text) %}<a href=\"{{ url }}\">{{ text }}</a>{% endmacro %}"
+                            "{{ link('/about', 'About') }}</body></html>";
+
+// Builds the JSON context of kListTemplate with the given number of items
+std::string makeItems(int64_t count)
+{
+    std::string json = "{\"items\": [";
+    for (int64_t i = 0; i < count; i++) {
+        if (i > 0) {
+            json += ", ";
+        }
+        json += "{\"name\": \"item " + std::to_string(i) + "\", \"price\": " + std::to_string(i * 10) + "}";
+    }
+    json += "]}";
+    return json;
+}
+
+const uint8_t* bytes(const std::string& json)
+{
+    return reinterpret_cast<const uint8_t*>(json.data());
+}
+
+mj_env* newEnv()
+{
+    auto env = mj_env_new();
+    auto error = mj_env_add_template(env, "list.html", kListTemplate);
+    if (error != nullptr) {
+        mj_error_free(error);
+    }
+    return env;
+}
+
+// Frees a render result, reporting a failed render as a benchmark error
+bool checkResult(benchmark::State& state, mj_result_env_render_template* result)
+{
+    bool ok = result->error == nullptr;
+    if (!ok) {
+        state.SkipWithError(mj_error_message(result->error));
+    }
+    mj_result_env_render_template_free(result);
+    return ok;
+}
+
+} // namespace
+
+// Compiling and publishing a template
+static void BM_AddTemplate(benchmark::State& state)
+{
+    auto env = mj_env_new();
+    for (auto _ : state) {
+        auto error = mj_env_add_template(env, "page.html", kPageTemplate);
+        if (error != nullptr) {
+            state.SkipWithError(mj_error_message(error));
+            mj_error_free(error);
+            break;
+        }
+    }
+    mj_env_free(env);
+}
+BENCHMARK(BM_AddTemplate);
+
+// Rendering a list across payload sizes, including parsing the context
+static void BM_Render(benchmark::State& state)
+{
+    auto env = newEnv();
+    auto json = makeItems(state.range(0));
+    for (auto _ : state) {
+        if (!checkResult(state, mj_env_render(env, "list.html", bytes(json), json.size()))) {
+            break;
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * json.size()));
+    mj_env_free(env);
+}
+BENCHMARK(BM_Render)->RangeMultiplier(10)->Range(1, 10000);
+
+// Parsing the JSON context on its own
+static void BM_ParseJson(benchmark::State& state)
+{
+    auto json = makeItems(state.range(0));
+    for (auto _ : state) {
+        auto result = mj_value_from_json(bytes(json), json.size());
+        mj_value_free(result->value);
+        mj_result_value_from_json_free(result);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * json.size()));
+}
+BENCHMARK(BM_ParseJson)->RangeMultiplier(10)->Range(1, 10000);
+
+// Rendering a template that fails, including creating and freeing the error
+static void BM_RenderError(benchmark::State& state)
+{
+    auto env = mj_env_new();
+    auto error = mj_env_add_template(env, "error.html", "{{ missing.attr }}");
+    if (error != nullptr) {
+        mj_error_free(error);
+    }
+    std::string json = "{}";
+    for (auto _ : state) {
+        auto result = mj_env_render(env, "error.html", bytes(json), json.size());
+        benchmark::DoNotOptimize(result->error->code);
+        mj_result_env_render_template_free(result);
+    }
+    mj_env_free(env);
+}
+BENCHMARK(BM_RenderError);
+
+// Rendering a template that does not exist
+static void BM_RenderNotFound(benchmark::State& state)
+{
+    auto env = mj_env_new();
+    std::string json = "{}";
+    for (auto _ : state) {
+        auto result = mj_env_render(env, "missing.html", bytes(json), json.size());
+        benchmark::DoNotOptimize(result->error->code);
+        mj_result_env_render_template_free(result);
+    }
+    mj_env_free(env);
+}
+BENCHMARK(BM_RenderNotFound);
+
+// Rendering from 1 to N threads that share one environment, exposing
+// contention on the shared snapshot
+static void BM_RenderThreads(benchmark::State& state)
+{
+    // Shared by all threads of the benchmark and never freed
+    static mj_env* env = newEnv();
+    static const std::string json = makeItems(10);
+    for (auto _ : state) {
+        if (!checkResult(state, mj_env_render(env, "list.html", bytes(json), json.size()))) {
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RenderThreads)->ThreadRange(1, static_cast<int>(std::max(1u, std::thread::hardware_concurrency())))->UseRealTime();
+
+BENCHMARK_MAIN();
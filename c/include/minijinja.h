@@ -118,6 +118,14 @@ typedef enum mj_code {
    * Unknown or undefined block used in template
    */
   MJ_UNKNOWN_BLOCK,
+  /**
+   * The render consumed all of its fuel
+   */
+  MJ_OUT_OF_FUEL,
+  /**
+   * The render did not finish before its deadline
+   */
+  MJ_DEADLINE_EXCEEDED,
 } mj_code;
 
 /**
@@ -146,6 +154,98 @@ typedef enum mj_undefined_behavior {
   MJ_UNDEFINED_BEHAVIOR_CHAINABLE,
 } mj_undefined_behavior;
 
+/**
+ * \brief Defines how values printed by a template are escaped.
+ *
+ * @see mj_env_set_auto_escape Function to choose the escaping by template name
+ */
+typedef enum mj_auto_escape {
+  /**
+   * Values are printed as is.
+   */
+  MJ_AUTO_ESCAPE_NONE,
+  /**
+   * Values are escaped for HTML and XML, where `<`, `>`, `&`, `"`, `'`
+   * and `/` are replaced by entities.
+   */
+  MJ_AUTO_ESCAPE_HTML,
+  /**
+   * Values are printed as JSON, with `<`, `>`, `&` and `'` escaped so
+   * that the output can be embedded in HTML.
+   */
+  MJ_AUTO_ESCAPE_JSON,
+} mj_auto_escape;
+
+/**
+ * \brief Defines the type of the value of an evaluated expression.
+ *
+ * @see mj_expression_eval Function whose result carries this type
+ */
+typedef enum mj_eval_kind {
+  /**
+   * The value is none or undefined.
+   */
+  MJ_EVAL_NONE,
+  /**
+   * The value is a boolean, stored in the boolean field.
+   */
+  MJ_EVAL_BOOL,
+  /**
+   * The value is an integer that fits 64 bits, stored in the integer
+   * field.
+   */
+  MJ_EVAL_INT,
+  /**
+   * The value is a float, stored in the number field.
+   */
+  MJ_EVAL_FLOAT,
+  /**
+   * The value is a string, stored in the string field.
+   */
+  MJ_EVAL_STRING,
+  /**
+   * The value is of any other type, such as a list or a map, stored as
+   * JSON in the string field.
+   */
+  MJ_EVAL_JSON,
+} mj_eval_kind;
+
+/**
+ * \brief Describes a borrowed, length-prefixed byte buffer.
+ *
+ * @see mj_env_render_batch Function that takes an array of buffers
+ */
+typedef struct mj_buffer {
+  /**
+   * Pointer to the first byte of the buffer
+   */
+  const uint8_t *data;
+  /**
+   * Length of the buffer in bytes
+   */
+  uintptr_t len;
+} mj_buffer;
+
+/**
+ * \brief Describes a single render job of a mixed batch.
+ *
+ * @see mj_env_render_batch_items Function that takes an array of items
+ */
+typedef struct mj_render_item {
+  /**
+   * Null-terminated string containing the name of the template
+   */
+  const char *name;
+  /**
+   * Pointer to the JSON encoded context
+   */
+  const uint8_t *data;
+  /**
+   * Length of the context in bytes
+   */
+  uintptr_t len;
+} mj_render_item;
+
 /**
  * \brief Represents a MiniJinja template environment that manages templates
  * and their rendering configuration.
@@ -153,35 +253,41 @@ typedef enum mj_undefined_behavior {
  * @see mj_env_new This function constructs a new environment
  * @see mj_env_free This function frees the heap memory of the environment
  *
- * \note The mj_env actually owns a pointer to a Arc<RwLock<minijinja::Environment>>,
- * which is inside the Rust core code and supports concurrent access.
+ * \note The mj_env publishes its minijinja::Environment as an immutable
+ * snapshot that is swapped atomically on every change. Renders load the
+ * current snapshot without taking a lock, and changes never block renders
+ * that are already in flight; they only see the change once it is published.
  *
  * \remark You may use the field `inner` to check whether this is a NULL
  * environment.
  */
 typedef struct mj_env {
   /**
-   * The pointer to the Arc<RwLock<minijinja::Environment>> in the Rust code.
+   * The pointer to the environment state in the Rust code.
    * Only touch this on judging whether it is NULL.
    */
   void *inner;
 } mj_env;
 
 /**
- * \brief Represents a MiniJinja error with code and message information.
+ * \brief Represents a MiniJinja error with code and location information.
  *
- * This structure encapsulates error information from MiniJinja operations,
- * including both an error code that categorizes the error type and a
- * human-readable error message with full error chain details.
+ * This structure carries the error code that categorizes the error type
+ * and, for errors raised by a template, where in the template it occurred.
+ * The human-readable message with the full error chain and the template
+ * name are only formatted when requested through mj_error_message and
+ * mj_error_template_name, so creating and discarding errors stays cheap.
  *
  * @see mj_code The error code enumeration
+ * @see mj_error_message This function returns the error message
+ * @see mj_error_template_name This function returns the template name
  * @see mj_error_free This function frees the heap memory of the error
  *
- * \note The mj_error structure owns the error message string, which must
- * be freed using mj_error_free to prevent memory leaks.
+ * \note The mj_error structure owns its message and template name, which
+ * are freed together with it using mj_error_free.
  *
- * \remark The message field contains the complete error chain, including
- * the root cause and all intermediate error causes.
+ * \remark Columns are only known for templates compiled in debug mode;
+ * see mj_env_set_debug.
  */
 typedef struct mj_error {
   /**
@@ -189,9 +295,28 @@ typedef struct mj_error {
    */
   enum mj_code code;
   /**
-   * Pointer to a null-terminated C string containing the error message
+   * The 1-based line of the template the error occurred on, or 0 if
+   * unknown
    */
-  const char *message;
+  uintptr_t line;
+  /**
+   * The 1-based column the error starts at, or 0 if unknown
+   */
+  uintptr_t column;
+  /**
+   * Byte offset into the template source where the error starts
+   */
+  uintptr_t range_start;
+  /**
+   * Byte offset into the template source where the error ends, equal to
+   * range_start if the range is unknown
+   */
+  uintptr_t range_end;
+  /**
+   * The pointer to the error details in the Rust code.
+   * Only touch this on judging whether it is NULL.
+   */
+  void *inner;
 } mj_error;
 
 /**
@@ -217,175 +342,1851 @@ typedef struct mj_result_env_render_template {
   struct mj_error *error;
 } mj_result_env_render_template;
 
-#ifdef __cplusplus
-extern "C" {
-#endif // __cplusplus
-
-void mj_env_free(struct mj_env *ptr);
-
 /**
- * \brief Creates a new MiniJinja template environment.
+ * \brief Result structure for batch rendering functions.
  *
- * This function allocates and initializes a new MiniJinja environment
- * that can be used to manage templates and render them with context data.
+ * This structure holds one mj_result_env_render_template per input, in the
+ * order of the inputs. Each entry carries either its rendered string or its
+ * own error, so a failing item does not affect the others.
  *
- * @return mj_result_env_new A result structure containing the newly created
- * environment or error information if creation fails.
+ * @see mj_env_render_batch Function that returns this result type
+ * @see mj_env_render_batch_items Function that returns this result type
  *
- * \note The returned environment should be freed using mj_env_free when
- * no longer needed to prevent memory leaks.
+ * \note The whole batch, including every entry, is freed using
+ * mj_result_env_render_batch_free.
  */
-struct mj_env *mj_env_new(void);
+typedef struct mj_result_env_render_batch {
+  /**
+   * Pointer to the array of per-item results
+   */
+  struct mj_result_env_render_template *results;
+  /**
+   * Number of entries in the results array
+   */
+  uintptr_t len;
+} mj_result_env_render_batch;
 
 /**
- * \brief Adds a template to the environment with the given name and source code.
- *
- * This function compiles and stores a template in the environment so it can
- * be rendered later using mj_env_render_template.
+ * \brief Result structure for bundle loading functions.
  *
- * @param env Pointer to the environment to add the template to
- * @param name Null-terminated string containing the name of the template
- * @param source Null-terminated string containing the template source code
+ * On success, errors is NULL and len is 0. On failure, errors points to an
+ * array of len errors, one for every template with a syntax error, or a
+ * single error if the bundle itself could not be read or is malformed.
  *
- * @return mj_result_env_add_template A result structure indicating success
- * or containing error information if compilation fails.
+ * @see mj_env_load_bundle Function that returns this result type
+ * @see mj_env_load_bundle_bytes Function that returns this result type
  *
- * \note Both name and source parameters must not be NULL.
+ * \note The result, including every error in it, is freed using
+ * mj_result_env_load_bundle_free.
  */
-struct mj_error *mj_env_add_template(struct mj_env *env, const char *name, const char *source);
+typedef struct mj_result_env_load_bundle {
+  /**
+   * Pointer to the array of errors, or NULL on success
+   */
+  struct mj_error **errors;
+  /**
+   * Number of entries in the errors array
+   */
+  uintptr_t len;
+} mj_result_env_load_bundle;
 
 /**
- * \brief Removes a template from the environment by name.
- *
- * This function removes a previously added template from the environment.
- * After removal, the template can no longer be rendered.
- *
- * @param env Pointer to the environment to remove the template from
- * @param name Null-terminated string containing the name of the template to remove
+ * \brief Counters of the render cache of an environment.
  *
- * \note The name parameter must not be NULL.
+ * @see mj_env_render_cache_stats Function that fills this structure
  */
-void mj_env_remove_template(struct mj_env *env, const char *name);
+typedef struct mj_render_cache_stats {
+  /**
+   * Number of renders served from the cache
+   */
+  uint64_t hits;
+  /**
+   * Number of renders that were not in the cache
+   */
+  uint64_t misses;
+  /**
+   * Number of entries evicted to stay within the budget
+   */
+  uint64_t evictions;
+  /**
+   * Number of cached entries
+   */
+  uintptr_t entries;
+  /**
+   * Bytes charged for the cached entries
+   */
+  uintptr_t bytes;
+  /**
+   * The byte budget of the cache, or 0 if it is disabled
+   */
+  uintptr_t budget;
+} mj_render_cache_stats;
 
 /**
- * \brief Clears all templates from the environment.
+ * \brief Represents a compiled expression that can be evaluated repeatedly.
  *
- * This function removes all previously added templates from the environment.
- * After clearing, no templates can be rendered until new ones are added.
+ * @see mj_env_compile_expression This function constructs a new expression
+ * @see mj_expression_free This function frees the heap memory of the
+ * expression
  *
- * @param env Pointer to the environment to clear templates from
+ * \note Like a template handle, the expression keeps its own reference to
+ * the environment snapshot it was compiled with, so later changes to the
+ * environment, such as new filters, are not visible to it. Evaluations
+ * keep the timeout the environment had when the expression was compiled.
+ *
+ * \remark The expression is safe to evaluate from multiple threads at once.
  */
-void mj_env_clear_templates(struct mj_env *env);
-
-struct mj_result_env_render_template *mj_env_render(struct mj_env *env,
-                                                    const char *name,
-                                                    const uint8_t *data,
-                                                    uintptr_t len);
+typedef struct mj_expression {
+  /**
+   * The pointer to the expression in the Rust code.
+   * Only touch this on judging whether it is NULL.
+   */
+  void *inner;
+} mj_expression;
 
 /**
- * \brief Renders a template from source code without storing it in the environment.
+ * \brief Result structure for expression compilation.
  *
- * This function renders a template directly from source code using the provided
- * context value, without permanently adding it to the environment.
- *
- * @param env Pointer to the environment to use for rendering
- * @param name Null-terminated string containing the name for the template (used for error reporting)
- * @param source Null-terminated string containing the template source code
- * @param value Pointer to the context value to use for rendering
+ * On success, the expr field contains the expression and error is NULL.
+ * On failure, expr is NULL and error contains error information.
  *
- * @return mj_result_env_render_template A result structure containing the
- * rendered string or error information if rendering fails.
+ * @see mj_env_compile_expression Function that returns this result type
  *
- * \note All parameters must not be NULL. The returned string should be
- * freed using mj_str_free when no longer needed.
+ * \note The expression is owned by the caller and must be freed using
+ * mj_expression_free, it is not released by
+ * mj_result_env_compile_expression_free.
  */
-struct mj_result_env_render_template *mj_env_render_named_string(struct mj_env *env,
-                                                                 const char *name,
-                                                                 const char *source,
-                                                                 const uint8_t *data,
-                                                                 uintptr_t len);
+typedef struct mj_result_env_compile_expression {
+  /**
+   * Pointer to the compiled expression, or NULL on failure
+   */
+  struct mj_expression *expr;
+  /**
+   * Pointer to error information, or NULL on success
+   */
+  struct mj_error *error;
+} mj_result_env_compile_expression;
 
 /**
- * \brief Sets whether to strip leading whitespace from blocks.
+ * \brief Result structure for expression evaluation.
  *
- * This function configures the environment to automatically strip leading
- * whitespace from template blocks when enabled.
+ * On success, kind tells which field holds the value and error is NULL.
+ * On failure, kind is MJ_EVAL_NONE and error contains error information.
  *
- * @param env Pointer to the environment to configure
- * @param value Boolean value indicating whether to enable lstrip blocks
+ * @see mj_expression_eval Function that returns this result type
+ *
+ * \note The result, including its string, is freed using
+ * mj_result_expression_eval_free.
  */
-void mj_env_set_lstrip_blocks(struct mj_env *env, bool value);
+typedef struct mj_result_expression_eval {
+  /**
+   * The type of the value
+   */
+  enum mj_eval_kind kind;
+  /**
+   * The value if kind is MJ_EVAL_BOOL
+   */
+  bool boolean;
+  /**
+   * The value if kind is MJ_EVAL_INT
+   */
+  int64_t integer;
+  /**
+   * The value if kind is MJ_EVAL_FLOAT
+   */
+  double number;
+  /**
+   * The null-terminated value if kind is MJ_EVAL_STRING or MJ_EVAL_JSON,
+   * NULL otherwise
+   */
+  char *string;
+  /**
+   * Pointer to error information, or NULL on success
+   */
+  struct mj_error *error;
+} mj_result_expression_eval;
 
 /**
- * \brief Sets whether to strip trailing whitespace from blocks.
+ * \brief Limits of a single render that override those of the environment.
  *
- * This function configures the environment to automatically strip trailing
- * whitespace from template blocks when enabled.
+ * A field of 0 keeps the limit configured on the environment, and
+ * UINT64_MAX lifts it for this render.
  *
- * @param env Pointer to the environment to configure
- * @param value Boolean value indicating whether to enable trim blocks
+ * @see mj_env_render_with_limits Function that takes these limits
  */
-void mj_env_set_trim_blocks(struct mj_env *env, bool value);
+typedef struct mj_render_limits {
+  /**
+   * Fuel the render may consume, see mj_env_set_fuel
+   */
+  uint64_t fuel;
+  /**
+   * Wall-clock time the render may take in nanoseconds, see mj_env_set_timeout
+   */
+  uint64_t timeout_ns;
+} mj_render_limits;
 
 /**
- * \brief Sets whether to keep trailing newlines in template output.
- *
- * This function configures the environment to keep or remove trailing
- * newlines in the rendered template output.
+ * \brief A completed render of a queue.
  *
- * @param env Pointer to the environment to configure
- * @param value Boolean value indicating whether to keep trailing newlines
+ * @see mj_completion_ring The ring completions are published to
  */
-void mj_env_set_keep_trailing_newline(struct mj_env *env, bool value);
+typedef struct mj_completion {
+  /**
+   * The id the render was submitted with
+   */
+  uint64_t id;
+  /**
+   * The result of the render, to be freed using
+   * mj_result_env_render_template_free
+   */
+  struct mj_result_env_render_template *result;
+} mj_completion;
 
 /**
- * \brief Sets the maximum recursion depth for template rendering.
+ * \brief A single-consumer ring the renders of a queue are published to.
  *
- * This function configures the maximum depth of recursive template calls
- * to prevent infinite recursion and stack overflow.
+ * Workers append completions at `tail`, and the consumer takes them from
+ * `head`. Both counters only grow, and completion `i` is stored in slot
+ * `i & (capacity - 1)`. The ring lives in native memory, so the consumer
+ * reads completions without calling into the library:
  *
- * @param env Pointer to the environment to configure
- * @param value Maximum recursion depth allowed
+ * 1. Load `tail` atomically. Every completion from `head` up to `tail` is
+ *    ready to be read.
+ * 2. Read and handle the completions, freeing their results.
+ * 3. Store the new `head` atomically, then load `tail` again. If it moved,
+ *    continue with step 2. Otherwise, wait for the notifier of the queue
+ *    before starting over.
+ *
+ * All loads and stores of `head` and `tail` must be sequentially
+ * consistent. Workers only signal the notifier when they publish to a ring
+ * that the consumer has drained, which is what step 3 relies on.
+ *
+ * @see mj_queue The queue that owns the ring
  */
-void mj_env_set_recursion_limit(struct mj_env *env, uintptr_t value);
+typedef struct mj_completion_ring {
+  /**
+   * Pointer to the array of slots
+   */
+  struct mj_completion *slots;
+  /**
+   * Number of slots, a power of two
+   */
+  uintptr_t capacity;
+  /**
+   * Number of completions taken by the consumer, written by it only
+   */
+  uint64_t head;
+  /**
+   * Number of completions published by workers, written by them only
+   */
+  uint64_t tail;
+} mj_completion_ring;
 
 /**
- * \brief Sets whether to enable debug mode for template rendering.
+ * \brief A queue of renders that a native worker pool performs in the
+ * background.
  *
- * This function configures the environment to enable or disable debug mode,
- * which affects error reporting and template debugging capabilities.
+ * Submitting a render with mj_queue_submit only copies its name and
+ * context and returns, so no thread of the caller is held up while it
+ * renders. Workers publish the results to `ring`, and signal `notify_fd`
+ * when the consumer has drained the ring, so that a consumer can wait for
+ * completions with poll, epoll or an event loop.
  *
- * @param env Pointer to the environment to configure
- * @param value Boolean value indicating whether to enable debug mode
+ * @see mj_env_queue_new This function constructs a new queue
+ * @see mj_queue_free This function frees the queue
+ *
+ * \note Renders use the environment the queue was created from, which
+ * must outlive the queue. A queue has a single consumer.
  */
-void mj_env_set_debug(struct mj_env *env, bool value);
+typedef struct mj_queue {
+  /**
+   * The pointer to the queue in the Rust code.
+   * Only touch this on judging whether it is NULL.
+   */
+  void *inner;
+  /**
+   * Pointer to the completion ring
+   */
+  struct mj_completion_ring *ring;
+  /**
+   * A non-blocking file descriptor that becomes readable when renders
+   * complete: an eventfd on Linux and the read end of a pipe on other
+   * Unix systems. -1 where neither is available, in which case the
+   * consumer has to poll the ring. Read it to reset it.
+   */
+  int32_t notify_fd;
+} mj_queue;
 
 /**
- * \brief Sets the undefined behavior policy for the environment.
+ * \brief A latency histogram of one phase of rendering.
  *
- * This function configures how the environment handles undefined variables
- * and expressions in templates.
- *
- * @param env Pointer to the environment to configure
- * @param behavior The undefined behavior policy to set
+ * Bucket i counts the durations of at least 2^(i-1) and less than 2^i
+ * nanoseconds; bucket 0 counts durations of zero.
  */
-void mj_env_set_undefined_behavior(struct mj_env *env, enum mj_undefined_behavior behavior);
+typedef struct mj_histogram {
+  /**
+   * Number of recorded durations
+   */
+  uint64_t count;
+  /**
+   * Sum of all recorded durations in nanoseconds
+   */
+  uint64_t sum_ns;
+  /**
+   * Number of recorded durations per power-of-two bucket
+   */
+  uint64_t buckets[64];
+} mj_histogram;
 
 /**
- * \brief Frees the memory allocated for a MiniJinja error.
- *
- * This function properly deallocates both the error structure and its
- * associated error message string, preventing memory leaks.
- *
- * @param ptr Pointer to the error structure to free
- *
- * \note It is safe to pass NULL to this function.
- * \note Only use this function on error pointers returned by MiniJinja C API functions.
- * \note After calling this function, the pointer becomes invalid and should not be used.
+ * \brief The number of failed renders of a template with a given error code.
  */
-void mj_error_free(struct mj_error *ptr);
+typedef struct mj_error_count {
+  /**
+   * The error code
+   */
+  enum mj_code code;
+  /**
+   * Number of renders that failed with the code
+   */
+  uint64_t count;
+} mj_error_count;
 
-void mj_result_env_render_template_free(struct mj_result_env_render_template *result);
+/**
+ * \brief Render metrics of a single template.
+ */
+typedef struct mj_template_stats {
+  /**
+   * Null-terminated name of the template, or "(other)"
+   */
+  char *name;
+  /**
+   * Number of renders, failed ones included
+   */
+  uint64_t calls;
+  /**
+   * Total bytes of rendered output
+   */
+  uint64_t output_bytes;
+  /**
+   * Pointer to the failed render counts per error code
+   */
+  struct mj_error_count *errors;
+  /**
+   * Number of entries in the errors array
+   */
+  uintptr_t errors_len;
+  /**
+   * Time spent looking up the template
+   */
+  struct mj_histogram lookup;
+  /**
+   * Time spent parsing the context
+   */
+  struct mj_histogram parse;
+  /**
+   * Time spent rendering, including compilation for named strings
+   */
+  struct mj_histogram render;
+  /**
+   * Time spent handing the output over to the caller
+   */
+  struct mj_histogram output;
+} mj_template_stats;
+
+/**
+ * \brief A snapshot of the render metrics of an environment.
+ *
+ * @see mj_env_stats Function that returns this type
+ *
+ * \note The snapshot is freed using mj_stats_free.
+ */
+typedef struct mj_stats {
+  /**
+   * Pointer to the metrics of every template rendered while enabled
+   */
+  struct mj_template_stats *templates;
+  /**
+   * Number of entries in the templates array
+   */
+  uintptr_t len;
+} mj_stats;
+
+/**
+ * \brief Memory taken by a template added to an environment.
+ *
+ * @see mj_env_template_memory Function that fills this structure
+ */
+typedef struct mj_template_memory {
+  /**
+   * Whether the compiled template is loaded, false if it was evicted
+   */
+  bool resident;
+  /**
+   * Estimated bytes of the compiled template, or 0 if it was evicted
+   */
+  uintptr_t compiled_bytes;
+  /**
+   * Length of the source in bytes
+   */
+  uintptr_t source_bytes;
+  /**
+   * Bytes kept to compile the template again, compressed if enabled, or
+   * 0 if it was never evicted
+   */
+  uintptr_t stored_bytes;
+} mj_template_memory;
+
+/**
+ * \brief Counters of the templates added to an environment.
+ *
+ * @see mj_env_template_store_stats Function that fills this structure
+ */
+typedef struct mj_template_store_stats {
+  /**
+   * Number of templates evicted to stay within the budget
+   */
+  uint64_t evictions;
+  /**
+   * Number of times an evicted template was compiled again
+   */
+  uint64_t recompiles;
+  /**
+   * Number of templates added
+   */
+  uintptr_t templates;
+  /**
+   * Number of templates whose compiled form is loaded
+   */
+  uintptr_t resident;
+  /**
+   * Estimated bytes of the loaded compiled templates
+   */
+  uintptr_t compiled_bytes;
+  /**
+   * Bytes kept to compile evicted templates again
+   */
+  uintptr_t stored_bytes;
+  /**
+   * The byte budget of the compiled templates, or 0 if there is none
+   */
+  uintptr_t budget;
+} mj_template_store_stats;
+
+/**
+ * \brief Represents a compiled template that was looked up once from an
+ * environment and can be rendered repeatedly.
+ *
+ * @see mj_env_get_template This function constructs a new template handle
+ * @see mj_template_free This function frees the heap memory of the handle
+ *
+ * \note The handle keeps its own reference to the compiled template and to
+ * the environment snapshot it was looked up from, so rendering it does
+ * neither validate a name nor load the current snapshot. Later changes to
+ * the environment are not visible through an existing handle, and renders
+ * keep the timeout and context decoding mode the environment had when the
+ * handle was taken.
+ *
+ * \remark The handle is safe to render from multiple threads at once.
+ */
+typedef struct mj_template {
+  /**
+   * The pointer to the template handle in the Rust code.
+   * Only touch this on judging whether it is NULL.
+   */
+  void *inner;
+} mj_template;
+
+/**
+ * \brief Result structure for template lookup functions.
+ *
+ * On success, the tmpl field contains the template handle and error is NULL.
+ * On failure, tmpl is NULL and error contains error information.
+ *
+ * @see mj_env_get_template Function that returns this result type
+ *
+ * \note The template handle is owned by the caller and must be freed using
+ * mj_template_free, it is not released by mj_result_env_get_template_free.
+ */
+typedef struct mj_result_env_get_template {
+  /**
+   * Pointer to the template handle, or NULL on failure
+   */
+  struct mj_template *tmpl;
+  /**
+   * Pointer to error information, or NULL on success
+   */
+  struct mj_error *error;
+} mj_result_env_get_template;
+
+/**
+ * \brief Represents a pending bulk update of an environment.
+ *
+ * A transaction works on a private copy of the environment. None of its
+ * changes are visible to renders until mj_txn_commit publishes all of
+ * them at once, so swapping hundreds of templates costs a single publish.
+ *
+ * @see mj_env_begin_txn This function starts a new transaction
+ * @see mj_txn_commit This function publishes and frees the transaction
+ * @see mj_txn_abort This function discards and frees the transaction
+ *
+ * \note Only one writer is active per environment at a time. While a
+ * transaction is open, other transactions and single-call updates such as
+ * mj_env_add_template block until it is committed or aborted, so they must
+ * not be called from the thread holding the transaction. Renders are never
+ * blocked.
+ */
+typedef struct mj_txn {
+  /**
+   * The pointer to the transaction in the Rust code.
+   * Only touch this on judging whether it is NULL.
+   */
+  void *inner;
+} mj_txn;
+
+/**
+ * \brief Represents a context value that was parsed once and can be
+ * rendered against any number of templates.
+ *
+ * @see mj_value_from_json This function constructs a new value
+ * @see mj_value_free This function frees the heap memory of the value
+ *
+ * \note The value is immutable and reference counted inside the Rust core,
+ * so it is safe to render with from multiple threads at once.
+ */
+typedef struct mj_value {
+  /**
+   * The pointer to the minijinja::Value in the Rust code.
+   * Only touch this on judging whether it is NULL.
+   */
+  void *inner;
+} mj_value;
+
+/**
+ * \brief Result structure for context value construction functions.
+ *
+ * On success, the value field contains the parsed value and error is NULL.
+ * On failure, value is NULL and error contains error information.
+ *
+ * @see mj_value_from_json Function that returns this result type
+ *
+ * \note The value is owned by the caller and must be freed using
+ * mj_value_free, it is not released by mj_result_value_from_json_free.
+ */
+typedef struct mj_result_value_from_json {
+  /**
+   * Pointer to the parsed value, or NULL on failure
+   */
+  struct mj_value *value;
+  /**
+   * Pointer to error information, or NULL on success
+   */
+  struct mj_error *error;
+} mj_result_value_from_json;
+
+/**
+ * \brief Result structure for template variable functions.
+ *
+ * On success, variables holds the sorted names of the variables the
+ * template reads from its context and error is NULL. On failure, variables
+ * is NULL and error contains error information.
+ *
+ * @see mj_env_template_undeclared_variables Function that returns this
+ * result type
+ * @see mj_template_undeclared_variables Function that returns this result
+ * type
+ *
+ * \note The result, including the names in it, is freed using
+ * mj_result_env_template_undeclared_variables_free.
+ */
+typedef struct mj_result_env_template_undeclared_variables {
+  /**
+   * Pointer to the array of null-terminated names, or NULL if there are
+   * none
+   */
+  char **variables;
+  /**
+   * Number of entries in the variables array
+   */
+  uintptr_t len;
+  /**
+   * Whether the names cover every variable rendering the template reads.
+   * False if the template includes, extends or imports other templates,
+   * whose variables are not listed.
+   */
+  bool complete;
+  /**
+   * Pointer to error information, or NULL on success
+   */
+  struct mj_error *error;
+} mj_result_env_template_undeclared_variables;
+
+/**
+ * \brief Callback receiving rendered output in chunks.
+ *
+ * The callback is invoked with the user data pointer given to the render
+ * function, a pointer to the next chunk of output and its length in bytes.
+ * The chunk is only valid for the duration of the call.
+ *
+ * \note Return 0 to continue rendering, any other value aborts the render
+ * with an MJ_WRITE_FAILURE error.
+ */
+typedef int (*mj_write_callback)(void *user_data, const uint8_t *data, uintptr_t len);
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+void mj_result_env_render_batch_free(struct mj_result_env_render_batch *result);
+
+/**
+ * \brief Renders one template against many contexts in parallel.
+ *
+ * The contexts are rendered on a native worker pool sized to the machine,
+ * all within a single call, which avoids paying the FFI overhead once per
+ * context. Every context is otherwise rendered like in mj_env_render,
+ * with the render cache, timeout, context decoding mode and metrics of
+ * the environment.
+ *
+ * @param env Pointer to the environment holding the template
+ * @param name Null-terminated string containing the name of the template
+ * @param contexts Pointer to an array of JSON encoded contexts
+ * @param count Number of contexts in the array
+ *
+ * @return mj_result_env_render_batch A result structure containing one
+ * result per context, in the order of the contexts.
+ *
+ * \note The name parameter must not be NULL. The returned result should be
+ * freed using mj_result_env_render_batch_free when no longer needed.
+ */
+struct mj_result_env_render_batch *mj_env_render_batch(struct mj_env *env,
+                                                       const char *name,
+                                                       const struct mj_buffer *contexts,
+                                                       uintptr_t count);
+
+/**
+ * \brief Renders many (template, context) pairs in parallel.
+ *
+ * This is the mixed form of mj_env_render_batch, where every item names its
+ * own template.
+ *
+ * @param env Pointer to the environment holding the templates
+ * @param items Pointer to an array of render items
+ * @param count Number of items in the array
+ *
+ * @return mj_result_env_render_batch A result structure containing one
+ * result per item, in the order of the items.
+ *
+ * \note The name of every item must not be NULL. The returned result should
+ * be freed using mj_result_env_render_batch_free when no longer needed.
+ */
+struct mj_result_env_render_batch *mj_env_render_batch_items(struct mj_env *env,
+                                                             const struct mj_render_item *items,
+                                                             uintptr_t count);
+
+/**
+ * \brief Renders a template stored in the environment with a binary
+ * encoded context.
+ *
+ * The context is a MessagePack document, which is decoded straight into
+ * template values instead of being formatted to and parsed from JSON text.
+ * Values without a native MessagePack representation may be embedded as
+ * extension type 1 holding a JSON document.
+ *
+ * @param env Pointer to the environment holding the template
+ * @param name Null-terminated string containing the name of the template
+ * @param data Pointer to the MessagePack encoded context
+ * @param len Length of the context in bytes
+ *
+ * @return mj_result_env_render_template A result structure containing the
+ * rendered string or error information if rendering fails.
+ *
+ * \note The name parameter must not be NULL. The returned result should be
+ * freed using mj_result_env_render_template_free when no longer needed.
+ */
+struct mj_result_env_render_template *mj_env_render_binary(struct mj_env *env,
+                                                           const char *name,
+                                                           const uint8_t *data,
+                                                           uintptr_t len);
+
+/**
+ * \brief Renders a template handle with a binary encoded context.
+ *
+ * @param tmpl Pointer to the template handle to render
+ * @param data Pointer to the MessagePack encoded context
+ * @param len Length of the context in bytes
+ *
+ * @return mj_result_env_render_template A result structure containing the
+ * rendered string or error information if rendering fails.
+ *
+ * @see mj_env_render_binary For the format of the context
+ */
+struct mj_result_env_render_template *mj_template_render_binary(struct mj_template *tmpl,
+                                                                const uint8_t *data,
+                                                                uintptr_t len);
+
+void mj_result_env_load_bundle_free(struct mj_result_env_load_bundle *result);
+
+/**
+ * \brief Loads a template bundle file into the environment.
+ *
+ * A bundle holds many templates in a single file, as written by the
+ * ginja-bundle command. The file is memory mapped, every template in it is
+ * validated in parallel across all cores, and all syntax errors are
+ * reported at once. Only if every template is valid is the bundle
+ * installed, in a single step; otherwise the environment is left as is.
+ * Templates are compiled on first use, like those of a search path.
+ *
+ * A bundle that names a template more than once is malformed.
+ *
+ * Templates of a bundle replace templates of the same name, and bundles
+ * loaded later take precedence over earlier ones.
+ *
+ * The mapping stays live for as long as the environment, so a bundle file
+ * must only be replaced by renaming a new file over it, as ginja-bundle
+ * does. Truncating or rewriting it in place crashes the process with
+ * SIGBUS once a template that was not compiled yet is read from it.
+ *
+ * @param env Pointer to the environment to load the bundle into
+ * @param path Null-terminated string containing the path of the bundle
+ *
+ * @return mj_result_env_load_bundle A result structure listing the errors,
+ * if any.
+ *
+ * \note The path parameter must not be NULL. The returned result should be
+ * freed using mj_result_env_load_bundle_free when no longer needed.
+ */
+struct mj_result_env_load_bundle *mj_env_load_bundle(struct mj_env *env, const char *path);
+
+/**
+ * \brief Loads a template bundle from memory into the environment.
+ *
+ * @param env Pointer to the environment to load the bundle into
+ * @param data Pointer to the bundle
+ * @param len Length of the bundle in bytes
+ *
+ * @return mj_result_env_load_bundle A result structure listing the errors,
+ * if any.
+ *
+ * \note The bundle is copied, so the buffer may be released after the
+ * call.
+ *
+ * @see mj_env_load_bundle For the semantics of loading a bundle
+ */
+struct mj_result_env_load_bundle *mj_env_load_bundle_bytes(struct mj_env *env,
+                                                           const uint8_t *data,
+                                                           uintptr_t len);
+
+/**
+ * \brief Enables, resizes or disables the render cache of the environment.
+ *
+ * While enabled, mj_env_render caches its output keyed by the template
+ * name and the exact context bytes. A render of the same template with
+ * byte-identical context is then served from the cache without parsing the
+ * context or rendering. Entries are evicted least recently used first to
+ * keep the cache within `budget` bytes, which covers the name, context and
+ * output of every entry.
+ *
+ * Every change to the environment, such as mj_env_add_template,
+ * mj_env_remove_template, a change of globals or a committed transaction,
+ * invalidates all cached output, since templates may depend on each other
+ * and on globals.
+ *
+ * @param env Pointer to the environment to configure
+ * @param budget Byte budget of the cache, or 0 to disable it
+ *
+ * \note The cache is disabled by default. Setting a budget replaces the
+ * cache with a new, empty one. Only enable the cache for templates whose
+ * output depends on nothing but the context and the environment.
+ *
+ * @see mj_env_render_cache_stats Reads the counters of the cache
+ */
+void mj_env_set_render_cache(struct mj_env *env, uintptr_t budget);
+
+/**
+ * \brief Reads the counters of the render cache of the environment.
+ *
+ * @param env Pointer to the environment
+ * @param stats Pointer to the structure to fill; all counters are 0 while
+ * the cache is disabled
+ *
+ * \note The stats parameter must not be NULL.
+ */
+void mj_env_render_cache_stats(struct mj_env *env, struct mj_render_cache_stats *stats);
+
+/**
+ * \brief Adds a pack of formatting filters and functions to the environment.
+ *
+ * Formatting data in the render pass saves sending it pre-formatted in
+ * the context. The pack adds:
+ *
+ * - the filters and functions of minijinja-contrib, among them
+ *   `datetimeformat`, `dateformat`, `timeformat` and `now` for dates and
+ *   times, `filesizeformat`, `pluralize`, `truncate`, `wordcount` and
+ *   `wordwrap`;
+ * - `urlencode`, which percent-encodes a string or turns a map into a
+ *   query string;
+ * - `tojson`, which embeds a value as JSON that is safe inside HTML,
+ *   indented with `indent=true`;
+ * - `numberformat`, which formats a number with grouped thousands, taking
+ *   the keyword arguments `decimals` (0), `thousands` (",") and `point`
+ *   (".").
+ *
+ * @param env Pointer to the environment to add the pack to
+ *
+ * \note None of these are available until the pack is added. Adding it
+ * replaces filters and functions of the same names.
+ */
+void mj_env_add_contrib(struct mj_env *env);
+
+void mj_env_free(struct mj_env *ptr);
+
+/**
+ * \brief Creates a new MiniJinja template environment.
+ *
+ * This function allocates and initializes a new MiniJinja environment
+ * that can be used to manage templates and render them with context data.
+ *
+ * @return mj_result_env_new A result structure containing the newly created
+ * environment or error information if creation fails.
+ *
+ * \note The returned environment should be freed using mj_env_free when
+ * no longer needed to prevent memory leaks.
+ */
+struct mj_env *mj_env_new(void);
+
+/**
+ * \brief Creates a child environment that starts out as a copy of the given
+ * one.
+ *
+ * The child shares the compiled templates, globals and settings of the
+ * parent instead of copying them, so creating it costs the same regardless
+ * of how many templates the parent holds. Templates, globals and settings
+ * changed on the child override those of the parent for the child only.
+ *
+ * @param env Pointer to the parent environment
+ *
+ * @return mj_env The child environment.
+ *
+ * \note Changes made to the parent after this call are not visible to the
+ * child. Parent and child are independent and may be freed in any order,
+ * each using mj_env_free.
+ */
+struct mj_env *mj_env_clone(struct mj_env *env);
+
+/**
+ * \brief Adds a template to the environment with the given name and source code.
+ *
+ * This function compiles and stores a template in the environment so it can
+ * be rendered later using mj_env_render_template.
+ *
+ * @param env Pointer to the environment to add the template to
+ * @param name Null-terminated string containing the name of the template
+ * @param source Null-terminated string containing the template source code
+ *
+ * @return mj_result_env_add_template A result structure indicating success
+ * or containing error information if compilation fails.
+ *
+ * \note Both name and source parameters must not be NULL.
+ */
+struct mj_error *mj_env_add_template(struct mj_env *env, const char *name, const char *source);
+
+/**
+ * \brief Removes a template from the environment by name.
+ *
+ * This function removes a previously added template from the environment.
+ * After removal, the template can no longer be rendered.
+ *
+ * @param env Pointer to the environment to remove the template from
+ * @param name Null-terminated string containing the name of the template to remove
+ *
+ * \note The name parameter must not be NULL.
+ */
+void mj_env_remove_template(struct mj_env *env, const char *name);
+
+/**
+ * \brief Clears all templates from the environment.
+ *
+ * This function removes all previously added templates from the environment.
+ * After clearing, no templates can be rendered until new ones are added.
+ *
+ * @param env Pointer to the environment to clear templates from
+ */
+void mj_env_clear_templates(struct mj_env *env);
+
+/**
+ * \brief Adds a global variable to the environment.
+ *
+ * Globals are visible to every template rendered from the environment, so
+ * data shared by all renders (navigation, feature flags, locale tables and
+ * the like) is parsed once here instead of being part of every context.
+ * A key of the render context shadows a global of the same name.
+ *
+ * @param env Pointer to the environment to add the global to
+ * @param name Null-terminated string containing the name of the global
+ * @param data Pointer to the JSON encoded value of the global
+ * @param len Length of the value in bytes
+ *
+ * @return mj_error NULL on success, or error information if the value
+ * cannot be parsed.
+ *
+ * \note The name parameter must not be NULL. Adding a global with an
+ * existing name replaces the previous value.
+ */
+struct mj_error *mj_env_add_global(struct mj_env *env,
+                                   const char *name,
+                                   const uint8_t *data,
+                                   uintptr_t len);
+
+/**
+ * \brief Removes a global variable from the environment by name.
+ *
+ * @param env Pointer to the environment to remove the global from
+ * @param name Null-terminated string containing the name of the global
+ *
+ * \note The name parameter must not be NULL.
+ */
+void mj_env_remove_global(struct mj_env *env, const char *name);
+
+/**
+ * \brief Renders a template stored in the environment.
+ *
+ * This function looks up the template by name and renders it with the
+ * JSON encoded context passed in `data`.
+ *
+ * @param env Pointer to the environment holding the template
+ * @param name Null-terminated string containing the name of the template
+ * @param data Pointer to the JSON encoded context
+ * @param len Length of the context in bytes
+ *
+ * @return mj_result_env_render_template A result structure containing the
+ * rendered string or error information if rendering fails.
+ *
+ * \note The name parameter must not be NULL. The returned result should be
+ * freed using mj_result_env_render_template_free when no longer needed.
+ *
+ * @see mj_env_get_template Looks the template up once for repeated renders
+ */
+struct mj_result_env_render_template *mj_env_render(struct mj_env *env,
+                                                    const char *name,
+                                                    const uint8_t *data,
+                                                    uintptr_t len);
+
+/**
+ * \brief Renders a template stored in the environment, streaming the output
+ * to a callback.
+ *
+ * Instead of building the whole output in memory, the rendered output is
+ * pushed to `callback` in chunks of a fixed size as rendering progresses,
+ * so peak memory does not grow with the size of the output.
+ *
+ * @param env Pointer to the environment holding the template
+ * @param name Null-terminated string containing the name of the template
+ * @param data Pointer to the JSON encoded context
+ * @param len Length of the context in bytes
+ * @param callback Callback receiving the chunks of rendered output
+ * @param user_data Opaque pointer passed through to every callback invocation
+ *
+ * @return mj_error NULL on success, or error information if rendering fails
+ * or the callback aborts it.
+ *
+ * \note The name and callback parameters must not be NULL. On failure, part
+ * of the output may already have been passed to the callback.
+ */
+struct mj_error *mj_env_render_to_writer(struct mj_env *env,
+                                         const char *name,
+                                         const uint8_t *data,
+                                         uintptr_t len,
+                                         mj_write_callback callback,
+                                         void *user_data);
+
+/**
+ * \brief Renders a template stored in the environment into a caller owned buffer.
+ *
+ * The rendered output is written to `buf` without a terminating NUL byte and
+ * its length is stored in `out_len`. If the output does not fit into `cap`
+ * bytes, nothing is allocated for it: `out_len` receives the required length
+ * and the content of `buf` is unspecified, so the caller can grow the buffer
+ * and render again.
+ *
+ * @param env Pointer to the environment holding the template
+ * @param name Null-terminated string containing the name of the template
+ * @param data Pointer to the JSON encoded context
+ * @param len Length of the context in bytes
+ * @param buf Pointer to the output buffer, may be NULL if cap is 0
+ * @param cap Capacity of the output buffer in bytes
+ * @param out_len Receives the length of the rendered output
+ *
+ * @return mj_error NULL on success, or error information if rendering fails.
+ *
+ * \note The name and out_len parameters must not be NULL. The call succeeded
+ * and the output is complete only if the error is NULL and out_len <= cap.
+ */
+struct mj_error *mj_env_render_into(struct mj_env *env,
+                                    const char *name,
+                                    const uint8_t *data,
+                                    uintptr_t len,
+                                    uint8_t *buf,
+                                    uintptr_t cap,
+                                    uintptr_t *out_len);
+
+/**
+ * \brief Renders a single block of a template stored in the environment.
+ *
+ * The top-level code of the template is evaluated with its output
+ * discarded, which sets up the templates it extends and the variables it
+ * sets, and then only the named block is rendered into the result. This
+ * saves building, copying and returning the output of the whole page when
+ * only a fragment of it is needed.
+ *
+ * @param env Pointer to the environment holding the template
+ * @param name Null-terminated string containing the name of the template
+ * @param block Null-terminated string containing the name of the block
+ * @param data Pointer to the JSON encoded context
+ * @param len Length of the context in bytes
+ *
+ * @return mj_result_env_render_template A result structure containing the
+ * rendered block or error information if rendering fails. A template
+ * without the block fails with MJ_UNKNOWN_BLOCK.
+ *
+ * \note The name and block parameters must not be NULL. The returned result
+ * should be freed using mj_result_env_render_template_free when no longer
+ * needed.
+ */
+struct mj_result_env_render_template *mj_env_render_block(struct mj_env *env,
+                                                         const char *name,
+                                                         const char *block,
+                                                         const uint8_t *data,
+                                                         uintptr_t len);
+
+/**
+ * \brief Calls a macro defined by a template stored in the environment.
+ *
+ * The template is evaluated as for mj_env_render_block and the named macro
+ * is called with the given arguments; its output is returned.
+ *
+ * @param env Pointer to the environment holding the template
+ * @param name Null-terminated string containing the name of the template
+ * @param macro_name Null-terminated string containing the name of the macro
+ * @param data Pointer to the JSON encoded context
+ * @param len Length of the context in bytes
+ * @param args Pointer to the JSON encoded array of positional arguments
+ * @param args_len Length of the arguments in bytes, 0 for no arguments
+ *
+ * @return mj_result_env_render_template A result structure containing the
+ * output of the macro or error information if the call fails.
+ *
+ * \note The name and macro_name parameters must not be NULL. Arguments that
+ * are not a JSON array fail with MJ_CANNOT_DESERIALIZE. The returned result
+ * should be freed using mj_result_env_render_template_free when no longer
+ * needed.
+ */
+struct mj_result_env_render_template *mj_env_call_macro(struct mj_env *env,
+                                                       const char *name,
+                                                       const char *macro_name,
+                                                       const uint8_t *data,
+                                                       uintptr_t len,
+                                                       const uint8_t *args,
+                                                       uintptr_t args_len);
+
+/**
+ * \brief Renders a template from source code without storing it in the environment.
+ *
+ * This function renders a template directly from source code using the provided
+ * context value, without permanently adding it to the environment.
+ *
+ * @param env Pointer to the environment to use for rendering
+ * @param name Null-terminated string containing the name for the template (used for error reporting)
+ * @param source Null-terminated string containing the template source code
+ * @param value Pointer to the context value to use for rendering
+ *
+ * @return mj_result_env_render_template A result structure containing the
+ * rendered string or error information if rendering fails.
+ *
+ * \note All parameters must not be NULL. The returned string should be
+ * freed using mj_str_free when no longer needed.
+ */
+struct mj_result_env_render_template *mj_env_render_named_string(struct mj_env *env,
+                                                                 const char *name,
+                                                                 const char *source,
+                                                                 const uint8_t *data,
+                                                                 uintptr_t len);
+
+/**
+ * \brief Sets whether to strip leading whitespace from blocks.
+ *
+ * This function configures the environment to automatically strip leading
+ * whitespace from template blocks when enabled.
+ *
+ * @param env Pointer to the environment to configure
+ * @param value Boolean value indicating whether to enable lstrip blocks
+ */
+void mj_env_set_lstrip_blocks(struct mj_env *env, bool value);
+
+/**
+ * \brief Sets whether to strip trailing whitespace from blocks.
+ *
+ * This function configures the environment to automatically strip trailing
+ * whitespace from template blocks when enabled.
+ *
+ * @param env Pointer to the environment to configure
+ * @param value Boolean value indicating whether to enable trim blocks
+ */
+void mj_env_set_trim_blocks(struct mj_env *env, bool value);
+
+/**
+ * \brief Sets whether to keep trailing newlines in template output.
+ *
+ * This function configures the environment to keep or remove trailing
+ * newlines in the rendered template output.
+ *
+ * @param env Pointer to the environment to configure
+ * @param value Boolean value indicating whether to keep trailing newlines
+ */
+void mj_env_set_keep_trailing_newline(struct mj_env *env, bool value);
+
+/**
+ * \brief Sets the maximum recursion depth for template rendering.
+ *
+ * This function configures the maximum depth of recursive template calls
+ * to prevent infinite recursion and stack overflow.
+ *
+ * @param env Pointer to the environment to configure
+ * @param value Maximum recursion depth allowed
+ */
+void mj_env_set_recursion_limit(struct mj_env *env, uintptr_t value);
+
+/**
+ * \brief Sets whether to enable debug mode for template rendering.
+ *
+ * This function configures the environment to enable or disable debug mode,
+ * which affects error reporting and template debugging capabilities.
+ *
+ * @param env Pointer to the environment to configure
+ * @param value Boolean value indicating whether to enable debug mode
+ */
+void mj_env_set_debug(struct mj_env *env, bool value);
+
+/**
+ * \brief Sets the undefined behavior policy for the environment.
+ *
+ * This function configures how the environment handles undefined variables
+ * and expressions in templates.
+ *
+ * @param env Pointer to the environment to configure
+ * @param behavior The undefined behavior policy to set
+ */
+void mj_env_set_undefined_behavior(struct mj_env *env, enum mj_undefined_behavior behavior);
+
+/**
+ * \brief Frees the memory allocated for a MiniJinja error.
+ *
+ * This function properly deallocates the error structure together with
+ * its message and template name, preventing memory leaks.
+ *
+ * @param ptr Pointer to the error structure to free
+ *
+ * \note It is safe to pass NULL to this function.
+ * \note Only use this function on error pointers returned by MiniJinja C API functions.
+ * \note After calling this function, the pointer becomes invalid and should not be used.
+ */
+void mj_error_free(struct mj_error *ptr);
+
+/**
+ * \brief Returns the message of the error.
+ *
+ * The message includes the complete error chain, the root cause and all
+ * intermediate causes. It is formatted on the first call only.
+ *
+ * @param error Pointer to the error
+ *
+ * @return A null-terminated string owned by the error, valid until the
+ * error is freed.
+ */
+const char *mj_error_message(const struct mj_error *error);
+
+/**
+ * \brief Returns the name of the template the error occurred in.
+ *
+ * @param error Pointer to the error
+ *
+ * @return A null-terminated string owned by the error, valid until the
+ * error is freed, or NULL if the error is not tied to a template.
+ */
+const char *mj_error_template_name(const struct mj_error *error);
+
+/**
+ * \brief Sets how templates whose name ends with a suffix are escaped.
+ *
+ * Values printed by templates matching `suffix` are escaped according to
+ * `mode`. When several suffixes match a name, the longest one applies, and
+ * setting a suffix again replaces its mode. Templates matching no suffix
+ * keep the defaults: `.html`, `.htm` and `.xml` are escaped as HTML and
+ * everything else is not escaped.
+ *
+ * HTML escaping scans for the characters to escape 16 or 32 bytes at a
+ * time with SSE2, AVX2 or NEON where available, and copies the runs of
+ * text between them as a whole.
+ *
+ * @param env Pointer to the environment to configure
+ * @param suffix Null-terminated suffix of template names, such as ".html"
+ * @param mode The escaping to apply to matching templates
+ *
+ * \note The suffix parameter must not be NULL. An empty suffix matches
+ * every template. Values marked safe, for instance by the `safe` filter,
+ * are never escaped.
+ */
+void mj_env_set_auto_escape(struct mj_env *env,
+                            const char *suffix,
+                            enum mj_auto_escape mode);
+
+/**
+ * \brief Frees the memory allocated for an expression.
+ *
+ * @param ptr Pointer to the expression to free
+ *
+ * \note It is safe to pass NULL to this function.
+ */
+void mj_expression_free(struct mj_expression *ptr);
+
+void mj_result_env_compile_expression_free(struct mj_result_env_compile_expression *result);
+
+void mj_result_expression_eval_free(struct mj_result_expression_eval *result);
+
+/**
+ * \brief Compiles an expression once for repeated evaluation.
+ *
+ * Expressions use the syntax of template expressions, such as
+ * `user.age >= 18 and "beta" in user.flags`, and have access to the
+ * filters, tests, functions and globals of the environment. Evaluating a
+ * compiled expression neither parses it again nor formats its value as a
+ * string, which makes it suited to rules evaluated at a high rate.
+ *
+ * @param env Pointer to the environment to compile the expression with
+ * @param source Null-terminated string containing the expression
+ *
+ * @return mj_result_env_compile_expression A result structure containing
+ * the expression or error information if it does not compile.
+ *
+ * \note The source parameter must not be NULL. The returned expression
+ * must be freed using mj_expression_free, and the result itself using
+ * mj_result_env_compile_expression_free.
+ */
+struct mj_result_env_compile_expression *mj_env_compile_expression(struct mj_env *env,
+                                                                   const char *source);
+
+/**
+ * \brief Evaluates a compiled expression with the given context.
+ *
+ * Booleans, integers that fit 64 bits and floats are returned as such,
+ * strings as null-terminated strings, and everything else, such as lists
+ * and maps, as JSON. None and undefined values are returned as
+ * MJ_EVAL_NONE.
+ *
+ * @param expr Pointer to the expression to evaluate
+ * @param data Pointer to the JSON encoded context
+ * @param len Length of the context in bytes
+ *
+ * @return mj_result_expression_eval A result structure containing the
+ * value or error information if evaluation fails.
+ *
+ * \note The returned result should be freed using
+ * mj_result_expression_eval_free when no longer needed.
+ */
+struct mj_result_expression_eval *mj_expression_eval(struct mj_expression *expr,
+                                                     const uint8_t *data,
+                                                     uintptr_t len);
+
+/**
+ * \brief Sets whether render contexts are decoded lazily.
+ *
+ * By default, the JSON context of a render is parsed into a complete tree
+ * of values before rendering starts. In lazy mode, the context is only
+ * validated and copied, and every object and array of it locates its
+ * members on first access, while values are decoded when a template first
+ * reads them. This removes most of the parsing and allocation cost of
+ * large contexts that templates only read a few fields of.
+ *
+ * @param env Pointer to the environment to configure
+ * @param value Boolean value indicating whether to decode contexts lazily
+ *
+ * \note Lazy mode applies to the contexts of all render functions of the
+ * environment, including batches. Template handles keep the mode the
+ * environment had when they were taken. It does not apply to globals,
+ * macro arguments, expression contexts or mj_value_from_json. Templates
+ * that read most of a context are faster with the default, eager mode.
+ */
+void mj_env_set_lazy_context(struct mj_env *env, bool value);
+
+/**
+ * \brief Sets the fuel every render of the environment may consume.
+ *
+ * Every instruction a template executes consumes one unit of fuel, and a
+ * render that runs out of fuel fails with MJ_OUT_OF_FUEL. This bounds the
+ * work of templates that loop for too long, for example over a large
+ * context in a nested loop, regardless of whether they produce output.
+ *
+ * @param env Pointer to the environment to configure
+ * @param fuel Fuel of every render, or 0 for no limit
+ *
+ * \note Fuel is unlimited by default. It applies to every way of rendering
+ * a template of the environment.
+ *
+ * @see mj_env_render_with_limits Overrides the fuel of a single render
+ */
+void mj_env_set_fuel(struct mj_env *env, uint64_t fuel);
+
+/**
+ * \brief Sets the wall-clock time every render of the environment may take.
+ *
+ * A render still running when the timeout elapses fails with
+ * MJ_DEADLINE_EXCEEDED. The deadline is checked whenever a value is
+ * printed, including into blocks and macro calls, and as output is
+ * written. Only fuel bounds the time of a loop that prints nothing, such
+ * as an accidental quadratic loop, so set fuel along with a timeout to
+ * stop those too.
+ *
+ * @param env Pointer to the environment to configure
+ * @param timeout_ns Timeout of every render in nanoseconds, or 0 for no limit
+ *
+ * \note There is no timeout by default. It applies to every way of
+ * rendering a template of the environment, and to the evaluation of
+ * expressions. Template and expression handles keep the timeout the
+ * environment had when they were created. Expressions print nothing
+ * while they run, so they are only checked once they finish.
+ *
+ * @see mj_env_render_with_limits Overrides the timeout of a single render
+ */
+void mj_env_set_timeout(struct mj_env *env, uint64_t timeout_ns);
+
+/**
+ * \brief Renders a template stored in the environment with its own limits.
+ *
+ * Works like mj_env_render, except that the fuel and timeout of `limits`
+ * replace those configured on the environment for this render only.
+ *
+ * @param env Pointer to the environment holding the template
+ * @param name Null-terminated string containing the name of the template
+ * @param data Pointer to the JSON encoded context
+ * @param len Length of the context in bytes
+ * @param limits Pointer to the limits of this render
+ *
+ * @return mj_result_env_render_template A result structure containing the
+ * rendered string or error information if rendering fails, including
+ * MJ_OUT_OF_FUEL and MJ_DEADLINE_EXCEEDED when a limit is exceeded.
+ *
+ * \note The name and limits parameters must not be NULL. The returned
+ * result should be freed using mj_result_env_render_template_free when no
+ * longer needed.
+ *
+ * \remark Overriding the fuel renders a copy of the environment with that
+ * fuel. The first render with a given fuel after each change of the
+ * environment makes the copy, which costs about as much as adding a
+ * template. The copies of the last four fuel values are kept, so renders
+ * that keep to a few values share them.
+ */
+struct mj_result_env_render_template *mj_env_render_with_limits(struct mj_env *env,
+                                                               const char *name,
+                                                               const uint8_t *data,
+                                                               uintptr_t len,
+                                                               const struct mj_render_limits *limits);
+
+/**
+ * \brief Points the environment at a directory of templates.
+ *
+ * Templates that are not added explicitly are looked up in the directory
+ * the first time they are rendered or included, read and compiled once.
+ * Template names are paths relative to the directory, using '/' as
+ * separator; names that would escape it are treated as not found.
+ *
+ * This function replaces all previously configured search paths.
+ *
+ * @param env Pointer to the environment to configure
+ * @param path Null-terminated string containing the directory path
+ *
+ * \note The path parameter must not be NULL. Templates that were already
+ * loaded stay cached.
+ *
+ * @see mj_env_add_loader_path Adds a further search path
+ */
+void mj_env_set_loader_path(struct mj_env *env, const char *path);
+
+/**
+ * \brief Adds a directory to the template search paths of the environment.
+ *
+ * Search paths are tried in the order they were added, and the first one
+ * containing a template of the requested name wins.
+ *
+ * @param env Pointer to the environment to configure
+ * @param path Null-terminated string containing the directory path
+ *
+ * \note The path parameter must not be NULL.
+ *
+ * @see mj_env_set_loader_path For how templates are loaded
+ */
+void mj_env_add_loader_path(struct mj_env *env, const char *path);
+
+/**
+ * \brief Frees a queue.
+ *
+ * Waits for the renders in progress to finish, then frees the results
+ * that the consumer has not taken from the ring, the ring and the
+ * notifier.
+ *
+ * @param ptr Pointer to the queue to free
+ *
+ * \note It is safe to pass NULL to this function.
+ */
+void mj_queue_free(struct mj_queue *ptr);
+
+/**
+ * \brief Creates a queue of background renders on the environment.
+ *
+ * @param env Pointer to the environment to render with
+ * @param capacity Maximum number of renders submitted but not yet taken
+ * from the ring, rounded up to a power of two
+ * @param workers Number of worker threads, 0 for one per CPU core
+ *
+ * @return mj_queue A pointer to the new queue, or NULL if the worker
+ * threads cannot be started.
+ *
+ * \note The queue must be freed using mj_queue_free before the
+ * environment.
+ */
+struct mj_queue *mj_env_queue_new(struct mj_env *env, uintptr_t capacity, uintptr_t workers);
+
+/**
+ * \brief Submits a render to a queue.
+ *
+ * The name and context are copied, so they may be released as soon as the
+ * call returns. A worker renders the template like mj_env_render does and
+ * publishes the result to the ring of the queue under `id`.
+ *
+ * @param queue Pointer to the queue
+ * @param id Identifier of the render, returned with its completion
+ * @param name Null-terminated string containing the name of the template
+ * @param data Pointer to the JSON encoded context
+ * @param len Length of the context in bytes
+ *
+ * @return true if the render was submitted, false if the queue is full
+ * because as many completions as the ring has slots are pending. Take
+ * completions from the ring and submit again.
+ *
+ * \note The name parameter must not be NULL. Submitting to a queue from
+ * several threads at once is safe.
+ */
+bool mj_queue_submit(struct mj_queue *queue,
+                     uint64_t id,
+                     const char *name,
+                     const uint8_t *data,
+                     uintptr_t len);
+
+void mj_result_env_render_template_free(struct mj_result_env_render_template *result);
+
+void mj_result_env_get_template_free(struct mj_result_env_get_template *result);
+
+void mj_result_value_from_json_free(struct mj_result_value_from_json *result);
+
+/**
+ * \brief Enables or disables render metrics for the environment.
+ *
+ * While enabled, mj_env_render and mj_env_render_named_string record per
+ * template name the number of renders, the failures by error code, the
+ * bytes of output and latency histograms of each phase of rendering.
+ * While disabled, which is the default, renders record nothing.
+ *
+ * Renders of templates that were not found are recorded under the name
+ * "(other)", and so are the renders of names first seen after 1024
+ * others, which keeps the metrics bounded.
+ *
+ * @param env Pointer to the environment to configure
+ * @param value Boolean value indicating whether to record metrics
+ *
+ * \note Metrics recorded so far are kept when disabling them.
+ *
+ * @see mj_env_stats Takes a snapshot of the metrics
+ */
+void mj_env_set_stats(struct mj_env *env, bool value);
+
+/**
+ * \brief Takes a snapshot of the render metrics of the environment.
+ *
+ * @param env Pointer to the environment
+ *
+ * @return mj_stats The metrics of every template rendered while metrics
+ * were enabled, in no particular order.
+ *
+ * \note The returned snapshot should be freed using mj_stats_free when no
+ * longer needed.
+ */
+struct mj_stats *mj_env_stats(struct mj_env *env);
+
+/**
+ * \brief Frees a snapshot of render metrics.
+ *
+ * @param stats Pointer to the snapshot to free
+ *
+ * \note It is safe to pass NULL to this function.
+ */
+void mj_stats_free(struct mj_stats *stats);
+
+/**
+ * \brief Sets a memory budget for the compiled templates of the
+ * environment.
+ *
+ * Templates added with mj_env_add_template or a transaction stay compiled
+ * for the lifetime of the environment by default. With a budget, the
+ * least recently rendered ones are evicted while the estimated size of
+ * all compiled templates exceeds it. Rendering a template also counts as
+ * a use of the templates it includes, extends or imports by a literal
+ * name. An evicted template only keeps its source, compressed with LZ4 if
+ * `compress` is true, and is compiled again transparently the next time
+ * it is rendered or included. Templates are evicted right away when a
+ * change exceeds the budget, and on a worker thread when a render does
+ * by compiling an evicted template again.
+ *
+ * @param env Pointer to the environment to configure
+ * @param budget Byte budget of the compiled templates, or 0 for none
+ * @param compress Whether to compress the sources of evicted templates
+ *
+ * \note Templates loaded from a search path or a bundle are not counted,
+ * as they are loaded again from there. Evicted templates stay evicted when
+ * the budget is removed, until they are used again.
+ *
+ * @see mj_env_template_memory Reads the memory taken by a template
+ * @see mj_env_template_store_stats Reads the counters of all templates
+ */
+void mj_env_set_template_budget(struct mj_env *env, uintptr_t budget, bool compress);
+
+/**
+ * \brief Reads the memory taken by a template added to the environment.
+ *
+ * @param env Pointer to the environment
+ * @param name Null-terminated string containing the name of the template
+ * @param memory Pointer to the structure to fill
+ *
+ * @return true if the structure was filled, false if no template of that
+ * name was added with mj_env_add_template or a transaction.
+ *
+ * \note The name and memory parameters must not be NULL.
+ */
+bool mj_env_template_memory(struct mj_env *env,
+                            const char *name,
+                            struct mj_template_memory *memory);
+
+/**
+ * \brief Reads the counters of the templates added to the environment.
+ *
+ * @param env Pointer to the environment
+ * @param stats Pointer to the structure to fill
+ *
+ * \note The stats parameter must not be NULL.
+ */
+void mj_env_template_store_stats(struct mj_env *env, struct mj_template_store_stats *stats);
+
+/**
+ * \brief Frees the memory allocated for a template handle.
+ *
+ * @param ptr Pointer to the template handle to free
+ *
+ * \note It is safe to pass NULL to this function.
+ */
+void mj_template_free(struct mj_template *ptr);
+
+/**
+ * \brief Looks up a template once and returns a reusable handle to it.
+ *
+ * This function resolves the template by name and captures the compiled
+ * template together with the current environment snapshot, so that
+ * subsequent renders through mj_template_render skip the name lookup
+ * entirely. Taking a handle does not copy the environment.
+ *
+ * @param env Pointer to the environment holding the template
+ * @param name Null-terminated string containing the name of the template
+ *
+ * @return mj_result_env_get_template A result structure containing the
+ * template handle or error information if the template cannot be found.
+ *
+ * \note The name parameter must not be NULL. The returned handle must be
+ * freed using mj_template_free, and the result itself using
+ * mj_result_env_get_template_free.
+ */
+struct mj_result_env_get_template *mj_env_get_template(struct mj_env *env, const char *name);
+
+/**
+ * \brief Renders a template handle with the given context.
+ *
+ * @param tmpl Pointer to the template handle to render
+ * @param data Pointer to the JSON encoded context
+ * @param len Length of the context in bytes
+ *
+ * @return mj_result_env_render_template A result structure containing the
+ * rendered string or error information if rendering fails.
+ *
+ * \note The returned result should be freed using
+ * mj_result_env_render_template_free when no longer needed.
+ */
+struct mj_result_env_render_template *mj_template_render(struct mj_template *tmpl,
+                                                         const uint8_t *data,
+                                                         uintptr_t len);
+
+/**
+ * \brief Renders a template handle, streaming the output to a callback.
+ *
+ * @param tmpl Pointer to the template handle to render
+ * @param data Pointer to the JSON encoded context
+ * @param len Length of the context in bytes
+ * @param callback Callback receiving the chunks of rendered output
+ * @param user_data Opaque pointer passed through to every callback invocation
+ *
+ * @return mj_error NULL on success, or error information if rendering fails
+ * or the callback aborts it.
+ *
+ * @see mj_env_render_to_writer For the semantics of the callback
+ */
+struct mj_error *mj_template_render_to_writer(struct mj_template *tmpl,
+                                              const uint8_t *data,
+                                              uintptr_t len,
+                                              mj_write_callback callback,
+                                              void *user_data);
+
+/**
+ * \brief Renders a template handle into a caller owned buffer.
+ *
+ * @param tmpl Pointer to the template handle to render
+ * @param data Pointer to the JSON encoded context
+ * @param len Length of the context in bytes
+ * @param buf Pointer to the output buffer, may be NULL if cap is 0
+ * @param cap Capacity of the output buffer in bytes
+ * @param out_len Receives the length of the rendered output
+ *
+ * @return mj_error NULL on success, or error information if rendering fails.
+ *
+ * @see mj_env_render_into For the semantics of the output buffer
+ */
+struct mj_error *mj_template_render_into(struct mj_template *tmpl,
+                                         const uint8_t *data,
+                                         uintptr_t len,
+                                         uint8_t *buf,
+                                         uintptr_t cap,
+                                         uintptr_t *out_len);
+
+/**
+ * \brief Starts a transaction on the environment.
+ *
+ * This function waits until no other writer is active, then takes a
+ * private copy of the current environment to apply changes to.
+ *
+ * @param env Pointer to the environment to update
+ *
+ * @return mj_txn The transaction, which must be finished using either
+ * mj_txn_commit or mj_txn_abort.
+ *
+ * \note The environment must not be freed while the transaction is open.
+ */
+struct mj_txn *mj_env_begin_txn(struct mj_env *env);
+
+/**
+ * \brief Adds a template to the transaction.
+ *
+ * @param txn Pointer to the transaction
+ * @param name Null-terminated string containing the name of the template
+ * @param source Null-terminated string containing the template source code
+ *
+ * @return mj_error NULL on success, or error information if compilation
+ * fails. A failed template is not added, but the transaction stays open.
+ *
+ * @see mj_env_add_template For the semantics outside of a transaction
+ */
+struct mj_error *mj_txn_add_template(struct mj_txn *txn, const char *name, const char *source);
+
+/**
+ * \brief Removes a template from the transaction by name.
+ *
+ * @param txn Pointer to the transaction
+ * @param name Null-terminated string containing the name of the template
+ */
+void mj_txn_remove_template(struct mj_txn *txn, const char *name);
+
+/**
+ * \brief Clears all templates from the transaction.
+ *
+ * @param txn Pointer to the transaction
+ */
+void mj_txn_clear_templates(struct mj_txn *txn);
+
+/**
+ * \brief Adds a global variable to the transaction.
+ *
+ * @param txn Pointer to the transaction
+ * @param name Null-terminated string containing the name of the global
+ * @param data Pointer to the JSON encoded value of the global
+ * @param len Length of the value in bytes
+ *
+ * @return mj_error NULL on success, or error information if the value
+ * cannot be parsed.
+ *
+ * @see mj_env_add_global For the semantics outside of a transaction
+ */
+struct mj_error *mj_txn_add_global(struct mj_txn *txn,
+                                   const char *name,
+                                   const uint8_t *data,
+                                   uintptr_t len);
+
+/**
+ * \brief Removes a global variable from the transaction by name.
+ *
+ * @param txn Pointer to the transaction
+ * @param name Null-terminated string containing the name of the global
+ */
+void mj_txn_remove_global(struct mj_txn *txn, const char *name);
+
+/**
+ * \brief Publishes all changes of the transaction at once and frees it.
+ *
+ * Renders that started before the commit finish on the previous snapshot,
+ * renders that start afterwards see every change of the transaction.
+ *
+ * @param txn Pointer to the transaction to commit
+ *
+ * \note The transaction pointer becomes invalid after this call.
+ */
+void mj_txn_commit(struct mj_txn *txn);
+
+/**
+ * \brief Discards all changes of the transaction and frees it.
+ *
+ * @param txn Pointer to the transaction to abort
+ *
+ * \note It is safe to pass NULL to this function. The transaction pointer
+ * becomes invalid after this call.
+ */
+void mj_txn_abort(struct mj_txn *txn);
+
+/**
+ * \brief Frees the memory allocated for a context value.
+ *
+ * @param ptr Pointer to the value to free
+ *
+ * \note It is safe to pass NULL to this function.
+ */
+void mj_value_free(struct mj_value *ptr);
+
+/**
+ * \brief Parses a JSON encoded context once into a reusable value.
+ *
+ * @param data Pointer to the JSON encoded context
+ * @param len Length of the context in bytes
+ *
+ * @return mj_result_value_from_json A result structure containing the value
+ * or error information if the context cannot be parsed.
+ *
+ * \note The returned value must be freed using mj_value_free, and the result
+ * itself using mj_result_value_from_json_free.
+ */
+struct mj_result_value_from_json *mj_value_from_json(const uint8_t *data, uintptr_t len);
+
+/**
+ * \brief Renders a template stored in the environment with a parsed value.
+ *
+ * The optional overlay is a small JSON encoded map whose keys are layered
+ * on top of the value for this render only. The value itself is neither
+ * copied nor modified.
+ *
+ * @param env Pointer to the environment holding the template
+ * @param name Null-terminated string containing the name of the template
+ * @param value Pointer to the context value
+ * @param overlay Pointer to the JSON encoded overlay, may be NULL
+ * @param overlay_len Length of the overlay in bytes
+ *
+ * @return mj_result_env_render_template A result structure containing the
+ * rendered string or error information if rendering fails.
+ *
+ * \note The name and value parameters must not be NULL.
+ */
+struct mj_result_env_render_template *mj_env_render_value(struct mj_env *env,
+                                                          const char *name,
+                                                          const struct mj_value *value,
+                                                          const uint8_t *overlay,
+                                                          uintptr_t overlay_len);
+
+/**
+ * \brief Renders a template handle with a parsed value.
+ *
+ * @param tmpl Pointer to the template handle to render
+ * @param value Pointer to the context value
+ * @param overlay Pointer to the JSON encoded overlay, may be NULL
+ * @param overlay_len Length of the overlay in bytes
+ *
+ * @return mj_result_env_render_template A result structure containing the
+ * rendered string or error information if rendering fails.
+ *
+ * @see mj_env_render_value For the semantics of the overlay
+ */
+struct mj_result_env_render_template *mj_template_render_value(struct mj_template *tmpl,
+                                                               const struct mj_value *value,
+                                                               const uint8_t *overlay,
+                                                               uintptr_t overlay_len);
+
+void mj_result_env_template_undeclared_variables_free(struct mj_result_env_template_undeclared_variables *result);
+
+/**
+ * \brief Lists the variables a template of the environment reads from its
+ * context.
+ *
+ * The template is analyzed statically: every variable it reads without
+ * declaring it first, with `set`, as a loop variable or as a macro
+ * argument, is listed. Callers can use this to only serialize the parts of
+ * a context that a template uses.
+ *
+ * The analysis of a template runs once and is cached until the environment
+ * changes.
+ *
+ * @param env Pointer to the environment holding the template
+ * @param name Null-terminated string containing the name of the template
+ * @param nested Whether to list the attributes read from variables as
+ * dotted paths, such as `user.name`, instead of top-level names only
+ *
+ * @return mj_result_env_template_undeclared_variables A result structure
+ * containing the names or error information if the template cannot be
+ * found.
+ *
+ * \note The name parameter must not be NULL. Variables of the templates a
+ * template includes, extends or imports are not listed, which the
+ * `complete` field of the result reports.
+ */
+struct mj_result_env_template_undeclared_variables *mj_env_template_undeclared_variables(struct mj_env *env,
+                                                                                         const char *name,
+                                                                                         bool nested);
+
+/**
+ * \brief Lists the variables a template handle reads from its context.
+ *
+ * Works like mj_env_template_undeclared_variables for the template the
+ * handle was taken from. The analysis runs once per handle.
+ *
+ * @param tmpl Pointer to the template handle
+ * @param nested Whether to list the attributes read from variables as
+ * dotted paths instead of top-level names only
+ *
+ * @return mj_result_env_template_undeclared_variables A result structure
+ * containing the names.
+ */
+struct mj_result_env_template_undeclared_variables *mj_template_undeclared_variables(struct mj_template *tmpl,
+                                                                                     bool nested);
+
+/**
+ * \brief Returns a number that changes whenever the environment changes.
+ *
+ * Callers that cache what they learn about the templates of an
+ * environment, such as their variables, can compare this number to tell
+ * whether their cache is still current.
+ *
+ * @param env Pointer to the environment
+ *
+ * @return The generation of the environment
+ */
+uint64_t mj_env_generation(struct mj_env *env);
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -0,0 +1,259 @@
+use std::ffi::{CStr, CString, c_char};
+use std::sync::OnceLock;
+
+use minijinja::{Environment, Template};
+use rayon::prelude::*;
+
+use super::*;
+
+/// \brief Describes a borrowed, length-prefixed byte buffer.
+///
+/// @see mj_env_render_batch Function that takes an array of buffers
+#[repr(C)]
+pub struct mj_buffer {
+    /// Pointer to the first byte of the buffer
+    pub data: *const u8,
+    /// Length of the buffer in bytes
+    pub len: usize,
+}
+
+/// \brief Describes a single render job of a mixed batch.
+///
+/// @see mj_env_render_batch_items Function that takes an array of items
+#[repr(C)]
+pub struct mj_render_item {
+    /// Null-terminated string containing the name of the template
+    pub name: *const c_char,
+    /// Pointer to the JSON encoded context
+    pub data: *const u8,
+    /// Length of the context in bytes
+    pub len: usize,
+}
+
+/// \brief Result structure for batch rendering functions.
+///
+/// This structure holds one mj_result_env_render_template per input, in the
+/// order of the inputs. Each entry carries either its rendered string or its
+/// own error, so a failing item does not affect the others.
+///
+/// @see mj_env_render_batch Function that returns this result type
+/// @see mj_env_render_batch_items Function that returns this result type
+///
+/// \note The whole batch, including every entry, is freed using
+/// mj_result_env_render_batch_free.
+#[repr(C)]
+pub struct mj_result_env_render_batch {
+    /// Pointer to the array of per-item results
+    pub results: *mut mj_result_env_render_template,
+    /// Number of entries in the results array
+    pub len: usize,
+}
+
+/// The outcome of one render of a batch, handed back by the worker that
+/// rendered it.
+struct Rendered(Result<String, *mut mj_error>);
+
+// SAFETY: the error is owned by the outcome and only ever touched by the
+// thread that holds it.
+unsafe impl Send for Rendered {}
+
+impl mj_result_env_render_batch {
+    fn new(results: Vec<Rendered>) -> *mut Self {
+        let results = results
+            .into_iter()
+            .map(|Rendered(rv)| match rv {
+                Ok(rendered) => mj_result_env_render_template {
+                    result: CString::new(rendered)
+                        .expect("CString::new failed")
+                        .into_raw(),
+                    error: std::ptr::null_mut(),
+                },
+                Err(error) => mj_result_env_render_template {
+                    result: std::ptr::null_mut(),
+                    error,
+                },
+            })
+            .collect::<Box<[_]>>();
+        let len = results.len();
+        Box::into_raw(Box::new(mj_result_env_render_batch {
+            results: Box::into_raw(results) as *mut mj_result_env_render_template,
+            len,
+        }))
+    }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_result_env_render_batch_free(result: *mut mj_result_env_render_batch) {
+    if result.is_null() {
+        return;
+    }
+
+    unsafe {
+        let res = Box::from_raw(result);
+        let results = Box::from_raw(std::ptr::slice_from_raw_parts_mut(res.results, res.len));
+        for item in results.iter() {
+            if !item.result.is_null() {
+                drop(CString::from_raw(item.result));
+            }
+            if !item.error.is_null() {
+                mj_error::mj_error_free(item.error);
+            }
+        }
+    }
+}
+
+/// The template of a batch, looked up by the first render that misses the
+/// render cache and shared by all others.
+struct Lookup<'env>(Result<Template<'env, 'env>, *mut mj_error>);
+
+// SAFETY: the error is only read, to copy it, once the lookup is done, and
+// freed when the lookup is dropped.
+unsafe impl Send for Lookup<'_> {}
+unsafe impl Sync for Lookup<'_> {}
+
+impl Lookup<'_> {
+    fn template(&self) -> Result<Template<'_, '_>, *mut mj_error> {
+        match &self.0 {
+            Ok(template) => Ok(template.clone()),
+            Err(e) => Err(unsafe { &**e }.copy()),
+        }
+    }
+}
+
+impl Drop for Lookup<'_> {
+    fn drop(&mut self) {
+        if let Err(e) = self.0 {
+            unsafe { mj_error::mj_error_free(e) };
+        }
+    }
+}
+
+/// \brief Renders one template against many contexts in parallel.
+///
+/// The contexts are rendered on a native worker pool sized to the machine,
+/// all within a single call, which avoids paying the FFI overhead once per
+/// context. Every context is otherwise rendered like in mj_env_render,
+/// with the render cache, timeout, context decoding mode and metrics of
+/// the environment.
+///
+/// @param env Pointer to the environment holding the template
+/// @param name Null-terminated string containing the name of the template
+/// @param contexts Pointer to an array of JSON encoded contexts
+/// @param count Number of contexts in the array
+///
+/// @return mj_result_env_render_batch A result structure containing one
+/// result per context, in the order of the contexts.
+///
+/// \note The name parameter must not be NULL. The returned result should be
+/// freed using mj_result_env_render_batch_free when no longer needed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_render_batch(
+    env: *mut mj_env,
+    name: *const c_char,
+    contexts: *const mj_buffer,
+    count: usize,
+) -> *mut mj_result_env_render_batch {
+    assert!(!name.is_null());
+    let name = unsafe { CStr::from_ptr(name).to_str().expect("malformed name") };
+    let contexts = unsafe { buffers(contexts, count) }
+        .iter()
+        .map(|ctx| unsafe { context::bytes(ctx.data, ctx.len) })
+        .collect::<Vec<_>>();
+    let state = unsafe { &*env }.deref();
+
+    let generation = state.generation();
+    let deadline = limits::deadline(state.timeout(0));
+    let env_guard = state.load();
+    let env: &Environment = &env_guard;
+    // A template that cannot be found fails every item with a copy of the
+    // same error, instead of being looked up again for each.
+    let lookup = OnceLock::new();
+    let results = contexts
+        .par_iter()
+        .map(|bytes| {
+            let mut recorder = state.stats().start(name);
+            let rendered = crate::env::render_resolved(
+                state,
+                generation,
+                name,
+                bytes,
+                deadline,
+                &mut recorder,
+                || {
+                    lookup
+                        .get_or_init(|| Lookup(env.get_template(name).map_err(mj_error::new)))
+                        .template()
+                },
+            );
+            Rendered(recorder.finish(rendered))
+        })
+        .collect();
+    mj_result_env_render_batch::new(results)
+}
+
+/// \brief Renders many (template, context) pairs in parallel.
+///
+/// This is the mixed form of mj_env_render_batch, where every item names its
+/// own template.
+///
+/// @param env Pointer to the environment holding the templates
+/// @param items Pointer to an array of render items
+/// @param count Number of items in the array
+///
+/// @return mj_result_env_render_batch A result structure containing one
+/// result per item, in the order of the items.
+///
+/// \note The name of every item must not be NULL. The returned result should
+/// be freed using mj_result_env_render_batch_free when no longer needed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_render_batch_items(
+    env: *mut mj_env,
+    items: *const mj_render_item,
+    count: usize,
+) -> *mut mj_result_env_render_batch {
+    let items = unsafe { render_items(items, count) }
+        .iter()
+        .map(|item| {
+            assert!(!item.name.is_null());
+            let name = unsafe { CStr::from_ptr(item.name).to_str().expect("malformed name") };
+            (name, unsafe { context::bytes(item.data, item.len) })
+        })
+        .collect::<Vec<_>>();
+    let state = unsafe { &*env }.deref();
+
+    let generation = state.generation();
+    let deadline = limits::deadline(state.timeout(0));
+    let env_guard = state.load();
+    let env: &Environment = &env_guard;
+    let results = items
+        .par_iter()
+        .map(|(name, bytes)| {
+            let mut recorder = state.stats().start(name);
+            let rendered = crate::env::render_resolved(
+                state,
+                generation,
+                name,
+                bytes,
+                deadline,
+                &mut recorder,
+                || env.get_template(name).map_err(mj_error::new),
+            );
+            Rendered(recorder.finish(rendered))
+        })
+        .collect();
+    mj_result_env_render_batch::new(results)
+}
+
+unsafe fn buffers<'a>(ptr: *const mj_buffer, count: usize) -> &'a [mj_buffer] {
+    if ptr.is_null() || count == 0 {
+        return &[];
+    }
+    unsafe { std::slice::from_raw_parts(ptr, count) }
+}
+
+unsafe fn render_items<'a>(ptr: *const mj_render_item, count: usize) -> &'a [mj_render_item] {
+    if ptr.is_null() || count == 0 {
+        return &[];
+    }
+    unsafe { std::slice::from_raw_parts(ptr, count) }
+}
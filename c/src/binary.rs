@@ -0,0 +1,271 @@
+use std::collections::BTreeMap;
+use std::ffi::c_char;
+
+use minijinja::Value;
+
+use super::*;
+
+/// Extension type carrying a JSON encoded value, used by encoders for
+/// values that have no native representation in the binary format.
+const EXT_JSON: i8 = 1;
+
+/// Maximum nesting of arrays and maps, to keep malformed input from
+/// exhausting the stack.
+const MAX_DEPTH: usize = 512;
+
+/// Decodes a MessagePack encoded render context into a minijinja value.
+///
+/// Integers, floats, strings, binaries, arrays and maps map directly onto
+/// minijinja values without going through text. Extension type 1 holds a
+/// JSON document, which is parsed with the regular JSON path.
+pub(crate) fn from_binary(bytes: &[u8]) -> Result<Value, *mut mj_error> {
+    let mut decoder = Decoder { buf: bytes, pos: 0 };
+    decoder
+        .value(0)
+        .and_then(|value| match decoder.pos == bytes.len() {
+            true => Ok(value),
+            false => Err(format!("trailing data at offset {}", decoder.pos)),
+        })
+        .map_err(|e| mj_error::with_code(errors::mj_code::MJ_CANNOT_DESERIALIZE, e))
+}
+
+struct Decoder<'a> {
+    buf: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Decoder<'a> {
+    fn take(&mut self, n: usize) -> Result<&'a [u8], String> {
+        if self.buf.len() - self.pos < n {
+            return Err(format!("unexpected end of input at offset {}", self.pos));
+        }
+        let bytes = &self.buf[self.pos..self.pos + n];
+        self.pos += n;
+        Ok(bytes)
+    }
+
+    fn array<const N: usize>(&mut self) -> Result<[u8; N], String> {
+        Ok(self.take(N)?.try_into().unwrap())
+    }
+
+    fn u8(&mut self) -> Result<u8, String> {
+        Ok(self.take(1)?[0])
+    }
+
+    fn len16(&mut self) -> Result<usize, String> {
+        Ok(u16::from_be_bytes(self.array()?) as usize)
+    }
+
+    fn len32(&mut self) -> Result<usize, String> {
+        Ok(u32::from_be_bytes(self.array()?) as usize)
+    }
+
+    fn str(&mut self, len: usize) -> Result<Value, String> {
+        let bytes = self.take(len)?;
+        std::str::from_utf8(bytes)
+            .map(Value::from)
+            .map_err(|e| format!("invalid string at offset {}: {e}", self.pos - len))
+    }
+
+    fn seq(&mut self, len: usize, depth: usize) -> Result<Value, String> {
+        // Every element takes at least one byte, which bounds the allocation
+        // by the size of the input.
+        let mut items = Vec::with_capacity(len.min(self.buf.len() - self.pos));
+        for _ in 0..len {
+            items.push(self.value(depth + 1)?);
+        }
+        Ok(Value::from(items))
+    }
+
+    fn map(&mut self, len: usize, depth: usize) -> Result<Value, String> {
+        let mut map = BTreeMap::new();
+        for _ in 0..len {
+            let key = self.value(depth + 1)?;
+            let value = self.value(depth + 1)?;
+            map.insert(key, value);
+        }
+        Ok(Value::from(map))
+    }
+
+    fn ext(&mut self, len: usize) -> Result<Value, String> {
+        let kind = self.u8()? as i8;
+        let data = self.take(len)?;
+        match kind {
+            EXT_JSON => sonic_rs::from_slice::<Value>(data)
+                .map_err(|e| format!("invalid JSON extension: {e}")),
+            _ => Err(format!("unsupported extension type {kind}")),
+        }
+    }
+
+    fn value(&mut self, depth: usize) -> Result<Value, String> {
+        if depth > MAX_DEPTH {
+            return Err("nesting too deep".to_string());
+        }
+        let tag = self.u8()?;
+        match tag {
+            0x00..=0x7f => Ok(Value::from(tag as u64)),
+            0x80..=0x8f => self.map((tag & 0x0f) as usize, depth),
+            0x90..=0x9f => self.seq((tag & 0x0f) as usize, depth),
+            0xa0..=0xbf => self.str((tag & 0x1f) as usize),
+            0xc0 => Ok(Value::from(())),
+            0xc2 => Ok(Value::from(false)),
+            0xc3 => Ok(Value::from(true)),
+            0xc4 => {
+                let len = self.u8()? as usize;
+                Ok(Value::from_bytes(self.take(len)?.to_vec()))
+            }
+            0xc5 => {
+                let len = self.len16()?;
+                Ok(Value::from_bytes(self.take(len)?.to_vec()))
+            }
+            0xc6 => {
+                let len = self.len32()?;
+                Ok(Value::from_bytes(self.take(len)?.to_vec()))
+            }
+            0xc7 => {
+                let len = self.u8()? as usize;
+                self.ext(len)
+            }
+            0xc8 => {
+                let len = self.len16()?;
+                self.ext(len)
+            }
+            0xc9 => {
+                let len = self.len32()?;
+                self.ext(len)
+            }
+            // Go through the shortest decimal representation so a float32
+            // renders the same as it would after a JSON round trip.
+            0xca => {
+                let f = f32::from_be_bytes(self.array()?);
+                Ok(Value::from(
+                    f.to_string().parse::<f64>().unwrap_or(f as f64),
+                ))
+            }
+            0xcb => Ok(Value::from(f64::from_be_bytes(self.array()?))),
+            0xcc => Ok(Value::from(self.u8()? as u64)),
+            0xcd => Ok(Value::from(u16::from_be_bytes(self.array()?) as u64)),
+            0xce => Ok(Value::from(u32::from_be_bytes(self.array()?) as u64)),
+            0xcf => Ok(Value::from(u64::from_be_bytes(self.array()?))),
+            0xd0 => Ok(Value::from(self.u8()? as i8 as i64)),
+            0xd1 => Ok(Value::from(i16::from_be_bytes(self.array()?) as i64)),
+            0xd2 => Ok(Value::from(i32::from_be_bytes(self.array()?) as i64)),
+            0xd3 => Ok(Value::from(i64::from_be_bytes(self.array()?))),
+            0xd4 => self.ext(1),
+            0xd5 => self.ext(2),
+            0xd6 => self.ext(4),
+            0xd7 => self.ext(8),
+            0xd8 => self.ext(16),
+            0xd9 => {
+                let len = self.u8()? as usize;
+                self.str(len)
+            }
+            0xda => {
+                let len = self.len16()?;
+                self.str(len)
+            }
+            0xdb => {
+                let len = self.len32()?;
+                self.str(len)
+            }
+            0xdc => {
+                let len = self.len16()?;
+                self.seq(len, depth)
+            }
+            0xdd => {
+                let len = self.len32()?;
+                self.seq(len, depth)
+            }
+            0xde => {
+                let len = self.len16()?;
+                self.map(len, depth)
+            }
+            0xdf => {
+                let len = self.len32()?;
+                self.map(len, depth)
+            }
+            0xe0..=0xff => Ok(Value::from(tag as i8 as i64)),
+            0xc1 => Err(format!("invalid type tag 0xc1 at offset {}", self.pos - 1)),
+        }
+    }
+}
+
+/// \brief Renders a template stored in the environment with a binary
+/// encoded context.
+///
+/// The context is a MessagePack document, which is decoded straight into
+/// template values instead of being formatted to and parsed from JSON text.
+/// Values without a native MessagePack representation may be embedded as
+/// extension type 1 holding a JSON document.
+///
+/// @param env Pointer to the environment holding the template
+/// @param name Null-terminated string containing the name of the template
+/// @param data Pointer to the MessagePack encoded context
+/// @param len Length of the context in bytes
+///
+/// @return mj_result_env_render_template A result structure containing the
+/// rendered string or error information if rendering fails.
+///
+/// \note The name parameter must not be NULL. The returned result should be
+/// freed using mj_result_env_render_template_free when no longer needed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_render_binary(
+    env: *mut mj_env,
+    name: *const c_char,
+    data: *const u8,
+    len: usize,
+) -> *mut mj_result_env_render_template {
+    assert!(!name.is_null());
+    let bytes = unsafe { context::bytes(data, len) };
+    let name = unsafe {
+        std::ffi::CStr::from_ptr(name)
+            .to_str()
+            .expect("malformed name")
+    };
+    let state = unsafe { &*env }.deref();
+    let deadline = limits::deadline(state.timeout(0));
+
+    let env_guard = state.load();
+    let template = match env_guard.get_template(name) {
+        Ok(template) => template,
+        Err(e) => return mj_result_env_render_template::err(mj_error::new(e)),
+    };
+    state.template_used(name);
+    let value = match from_binary(bytes) {
+        Ok(value) => value,
+        Err(e) => return mj_result_env_render_template::err(e),
+    };
+    match limits::render(&template, &value, deadline) {
+        Ok(rendered) => mj_result_env_render_template::ok(rendered),
+        Err(e) => mj_result_env_render_template::err(e),
+    }
+}
+
+/// \brief Renders a template handle with a binary encoded context.
+///
+/// @param tmpl Pointer to the template handle to render
+/// @param data Pointer to the MessagePack encoded context
+/// @param len Length of the context in bytes
+///
+/// @return mj_result_env_render_template A result structure containing the
+/// rendered string or error information if rendering fails.
+///
+/// @see mj_env_render_binary For the format of the context
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_template_render_binary(
+    tmpl: *mut mj_template,
+    data: *const u8,
+    len: usize,
+) -> *mut mj_result_env_render_template {
+    let bytes = unsafe { context::bytes(data, len) };
+    let handle = unsafe { &*tmpl }.deref();
+    let deadline = handle.deadline();
+    let value = match from_binary(bytes) {
+        Ok(value) => value,
+        Err(e) => return mj_result_env_render_template::err(e),
+    };
+    match limits::render(handle.template(), &value, deadline) {
+        Ok(rendered) => mj_result_env_render_template::ok(rendered),
+        Err(e) => mj_result_env_render_template::err(e),
+    }
+}
@@ -0,0 +1,265 @@
+use std::collections::HashMap;
+use std::ffi::c_char;
+use std::fs::File;
+use std::ops::Range;
+
+use memmap2::Mmap;
+use minijinja::Environment;
+use rayon::prelude::*;
+
+use super::*;
+
+/// Magic bytes at the start of every bundle.
+const MAGIC: &[u8; 4] = b"GJB1";
+
+/// A set of template sources loaded from a single bundle file.
+///
+/// The layout is the magic `GJB1`, a little-endian u32 entry count, then
+/// per entry a u32 name length and a u32 source length followed by the
+/// name, and finally all sources concatenated in index order.
+pub(crate) struct Bundle {
+    data: Box<dyn AsRef<[u8]> + Send + Sync>,
+    index: HashMap<String, Range<usize>>,
+}
+
+impl Bundle {
+    fn parse(data: Box<dyn AsRef<[u8]> + Send + Sync>) -> Result<Self, String> {
+        let bytes = (*data).as_ref();
+        let mut reader = Reader { bytes, pos: 0 };
+        if reader.take(MAGIC.len())? != MAGIC {
+            return Err("not a template bundle".to_string());
+        }
+        let count = reader.u32()? as usize;
+        let mut entries = Vec::with_capacity(count.min(bytes.len() / 8));
+        for _ in 0..count {
+            let name_len = reader.u32()? as usize;
+            let source_len = reader.u32()? as usize;
+            let name = std::str::from_utf8(reader.take(name_len)?)
+                .map_err(|e| format!("malformed template name: {e}"))?;
+            entries.push((name.to_string(), source_len));
+        }
+        let mut index = HashMap::with_capacity(entries.len());
+        for (name, source_len) in entries {
+            let start = reader.pos;
+            let source = reader.take(source_len)?;
+            if std::str::from_utf8(source).is_err() {
+                return Err(format!("template {name} is not valid UTF-8"));
+            }
+            if index.contains_key(&name) {
+                return Err(format!("duplicate template {name}"));
+            }
+            index.insert(name, start..reader.pos);
+        }
+        if reader.pos != bytes.len() {
+            return Err(format!("trailing data at offset {}", reader.pos));
+        }
+        Ok(Bundle { data, index })
+    }
+
+    pub(crate) fn source(&self, name: &str) -> Option<&str> {
+        let range = self.index.get(name)?.clone();
+        // SAFETY: every source was validated as UTF-8 when parsing.
+        Some(unsafe { std::str::from_utf8_unchecked(&(*self.data).as_ref()[range]) })
+    }
+
+    fn entries(&self) -> impl Iterator<Item = (&str, &str)> {
+        self.index
+            .keys()
+            .map(|name| (name.as_str(), self.source(name).unwrap()))
+    }
+}
+
+struct Reader<'a> {
+    bytes: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Reader<'a> {
+    fn take(&mut self, n: usize) -> Result<&'a [u8], String> {
+        if self.bytes.len() - self.pos < n {
+            return Err(format!("truncated bundle at offset {}", self.pos));
+        }
+        let bytes = &self.bytes[self.pos..self.pos + n];
+        self.pos += n;
+        Ok(bytes)
+    }
+
+    fn u32(&mut self) -> Result<u32, String> {
+        Ok(u32::from_le_bytes(self.take(4)?.try_into().unwrap()))
+    }
+}
+
+/// \brief Result structure for bundle loading functions.
+///
+/// On success, errors is NULL and len is 0. On failure, errors points to an
+/// array of len errors, one for every template with a syntax error, or a
+/// single error if the bundle itself could not be read or is malformed.
+///
+/// @see mj_env_load_bundle Function that returns this result type
+/// @see mj_env_load_bundle_bytes Function that returns this result type
+///
+/// \note The result, including every error in it, is freed using
+/// mj_result_env_load_bundle_free.
+#[repr(C)]
+pub struct mj_result_env_load_bundle {
+    /// Pointer to the array of errors, or NULL on success
+    pub errors: *mut *mut mj_error,
+    /// Number of entries in the errors array
+    pub len: usize,
+}
+
+impl mj_result_env_load_bundle {
+    fn new(errors: Vec<*mut mj_error>) -> *mut Self {
+        let len = errors.len();
+        let errors = match len {
+            0 => std::ptr::null_mut(),
+            _ => Box::into_raw(errors.into_boxed_slice()) as *mut *mut mj_error,
+        };
+        Box::into_raw(Box::new(mj_result_env_load_bundle { errors, len }))
+    }
+
+    fn fail(code: errors::mj_code, message: String) -> *mut Self {
+        Self::new(vec![mj_error::with_code(code, message)])
+    }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_result_env_load_bundle_free(result: *mut mj_result_env_load_bundle) {
+    if result.is_null() {
+        return;
+    }
+
+    unsafe {
+        let res = Box::from_raw(result);
+        if res.errors.is_null() {
+            return;
+        }
+        let errors = Box::from_raw(std::ptr::slice_from_raw_parts_mut(res.errors, res.len));
+        for error in errors.iter() {
+            mj_error::mj_error_free(*error);
+        }
+    }
+}
+
+/// Compiles every template of `bundle` in parallel and, if all of them
+/// compile, installs the bundle with a single publish.
+///
+/// minijinja cannot adopt templates compiled elsewhere, so compiling here
+/// validates the syntax of every entry up front, while the templates the
+/// environment actually renders are compiled from the bundle on first use.
+fn install(state: &EnvState, bundle: Bundle) -> *mut mj_result_env_load_bundle {
+    let check = Environment::new();
+    let mut errors = bundle
+        .entries()
+        .collect::<Vec<_>>()
+        .into_par_iter()
+        .filter_map(|(name, source)| check.template_from_named_str(name, source).err())
+        .collect::<Vec<_>>();
+    if !errors.is_empty() {
+        errors.sort_by(|a, b| a.name().cmp(&b.name()).then(a.line().cmp(&b.line())));
+        return mj_result_env_load_bundle::new(errors.into_iter().map(mj_error::new).collect());
+    }
+
+    state.update_loader(|env, loader| {
+        // Entries of the bundle replace templates of the same name, whether
+        // they were added explicitly or loaded before.
+        for name in bundle.index.keys() {
+            env.remove_template(name);
+            state.templates().removed(name);
+        }
+        loader.add_bundle(bundle);
+        loader.install(env);
+    });
+    mj_result_env_load_bundle::new(Vec::new())
+}
+
+/// \brief Loads a template bundle file into the environment.
+///
+/// A bundle holds many templates in a single file, as written by the
+/// ginja-bundle command. The file is memory mapped, every template in it is
+/// validated in parallel across all cores, and all syntax errors are
+/// reported at once. Only if every template is valid is the bundle
+/// installed, in a single step; otherwise the environment is left as is.
+/// Templates are compiled on first use, like those of a search path.
+///
+/// A bundle that names a template more than once is malformed.
+///
+/// Templates of a bundle replace templates of the same name, and bundles
+/// loaded later take precedence over earlier ones.
+///
+/// The mapping stays live for as long as the environment, so a bundle file
+/// must only be replaced by renaming a new file over it, as ginja-bundle
+/// does. Truncating or rewriting it in place crashes the process with
+/// SIGBUS once a template that was not compiled yet is read from it.
+///
+/// @param env Pointer to the environment to load the bundle into
+/// @param path Null-terminated string containing the path of the bundle
+///
+/// @return mj_result_env_load_bundle A result structure listing the errors,
+/// if any.
+///
+/// \note The path parameter must not be NULL. The returned result should be
+/// freed using mj_result_env_load_bundle_free when no longer needed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_load_bundle(
+    env: *mut mj_env,
+    path: *const c_char,
+) -> *mut mj_result_env_load_bundle {
+    assert!(!path.is_null());
+    let path = unsafe {
+        std::ffi::CStr::from_ptr(path)
+            .to_str()
+            .expect("malformed path")
+    };
+    let map = match File::open(path).and_then(|file| unsafe { Mmap::map(&file) }) {
+        Ok(map) => map,
+        Err(e) => {
+            return mj_result_env_load_bundle::fail(
+                errors::mj_code::MJ_INVALID_OPERATION,
+                format!("could not read bundle {path}: {e}"),
+            );
+        }
+    };
+    let bundle = match Bundle::parse(Box::new(map)) {
+        Ok(bundle) => bundle,
+        Err(e) => {
+            return mj_result_env_load_bundle::fail(
+                errors::mj_code::MJ_CANNOT_DESERIALIZE,
+                format!("malformed bundle {path}: {e}"),
+            );
+        }
+    };
+    install(unsafe { &*env }.deref(), bundle)
+}
+
+/// \brief Loads a template bundle from memory into the environment.
+///
+/// @param env Pointer to the environment to load the bundle into
+/// @param data Pointer to the bundle
+/// @param len Length of the bundle in bytes
+///
+/// @return mj_result_env_load_bundle A result structure listing the errors,
+/// if any.
+///
+/// \note The bundle is copied, so the buffer may be released after the
+/// call.
+///
+/// @see mj_env_load_bundle For the semantics of loading a bundle
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_load_bundle_bytes(
+    env: *mut mj_env,
+    data: *const u8,
+    len: usize,
+) -> *mut mj_result_env_load_bundle {
+    let bytes = unsafe { context::bytes(data, len) };
+    let bundle = match Bundle::parse(Box::new(bytes.to_vec())) {
+        Ok(bundle) => bundle,
+        Err(e) => {
+            return mj_result_env_load_bundle::fail(
+                errors::mj_code::MJ_CANNOT_DESERIALIZE,
+                format!("malformed bundle: {e}"),
+            );
+        }
+    };
+    install(unsafe { &*env }.deref(), bundle)
+}
@@ -0,0 +1,249 @@
+use std::collections::{BTreeMap, HashMap};
+use std::hash::{BuildHasher, RandomState};
+use std::sync::Mutex;
+use std::sync::atomic::{AtomicU64, Ordering};
+
+use super::*;
+
+/// Bytes charged per entry on top of its name, context and output, for the
+/// bookkeeping of the entry itself.
+const ENTRY_OVERHEAD: usize = 96;
+
+#[derive(Clone, PartialEq, Eq, Hash)]
+struct Key {
+    name: String,
+    generation: u64,
+    hash: u64,
+}
+
+struct Entry {
+    context: Box<[u8]>,
+    rendered: String,
+    tick: u64,
+}
+
+impl Entry {
+    fn cost(key: &Key, context: &[u8], rendered: &str) -> usize {
+        key.name.len() + context.len() + rendered.len() + ENTRY_OVERHEAD
+    }
+}
+
+#[derive(Default)]
+struct Lru {
+    entries: HashMap<Key, Entry>,
+    // Keys by the tick they were last used at, oldest first.
+    order: BTreeMap<u64, Key>,
+    tick: u64,
+    bytes: usize,
+}
+
+impl Lru {
+    fn touch(&mut self, key: &Key) -> Option<&Entry> {
+        self.tick += 1;
+        let tick = self.tick;
+        let entry = self.entries.get_mut(key)?;
+        let key = self.order.remove(&entry.tick).expect("entry without order");
+        self.order.insert(tick, key);
+        entry.tick = tick;
+        Some(entry)
+    }
+
+    fn remove(&mut self, key: &Key) {
+        if let Some(entry) = self.entries.remove(key) {
+            self.order.remove(&entry.tick);
+            self.bytes -= Entry::cost(key, &entry.context, &entry.rendered);
+        }
+    }
+}
+
+/// A cache of rendered output, keyed by template name, the generation of
+/// the environment snapshot and a hash of the context bytes, bounded by a
+/// byte budget with least recently used eviction.
+///
+/// Any change published to the environment starts a new generation, which
+/// invalidates every entry rendered before it: a template may depend on
+/// templates it includes or extends and on globals, so a change anywhere
+/// can change its output. Stale entries are never hit again and age out.
+pub(crate) struct RenderCache {
+    budget: usize,
+    hasher: RandomState,
+    lru: Mutex<Lru>,
+    hits: AtomicU64,
+    misses: AtomicU64,
+    evictions: AtomicU64,
+}
+
+impl RenderCache {
+    pub(crate) fn new(budget: usize) -> Self {
+        RenderCache {
+            budget,
+            hasher: RandomState::new(),
+            lru: Mutex::default(),
+            hits: AtomicU64::new(0),
+            misses: AtomicU64::new(0),
+            evictions: AtomicU64::new(0),
+        }
+    }
+
+    pub(crate) fn budget(&self) -> usize {
+        self.budget
+    }
+
+    fn key(&self, name: &str, generation: u64, context: &[u8]) -> Key {
+        Key {
+            name: name.to_string(),
+            generation,
+            hash: self.hasher.hash_one(context),
+        }
+    }
+
+    /// Returns the output cached for rendering `name` with `context`, and
+    /// the key to insert it with on a miss.
+    pub(crate) fn get(
+        &self,
+        name: &str,
+        generation: u64,
+        context: &[u8],
+    ) -> Result<String, CacheMiss> {
+        let key = self.key(name, generation, context);
+        let mut lru = self.lru.lock().unwrap();
+        // The context is compared in full, so a hash collision is a miss.
+        let hit = match lru.touch(&key) {
+            Some(entry) if *entry.context == *context => Some(entry.rendered.clone()),
+            _ => None,
+        };
+        drop(lru);
+        match hit {
+            Some(rendered) => {
+                self.hits.fetch_add(1, Ordering::Relaxed);
+                Ok(rendered)
+            }
+            None => {
+                self.misses.fetch_add(1, Ordering::Relaxed);
+                Err(CacheMiss(key))
+            }
+        }
+    }
+
+    /// Caches `rendered` as the output for the key of a previous miss,
+    /// evicting the least recently used entries to stay within budget.
+    pub(crate) fn insert(&self, miss: CacheMiss, context: &[u8], rendered: &str) {
+        let key = miss.0;
+        let cost = Entry::cost(&key, context, rendered);
+        if cost > self.budget {
+            return;
+        }
+        let mut lru = self.lru.lock().unwrap();
+        lru.remove(&key);
+        while lru.bytes + cost > self.budget {
+            let Some((_, oldest)) = lru.order.pop_first() else {
+                break;
+            };
+            let entry = lru.entries.remove(&oldest).expect("order without entry");
+            lru.bytes -= Entry::cost(&oldest, &entry.context, &entry.rendered);
+            self.evictions.fetch_add(1, Ordering::Relaxed);
+        }
+        lru.tick += 1;
+        let tick = lru.tick;
+        lru.order.insert(tick, key.clone());
+        lru.entries.insert(
+            key,
+            Entry {
+                context: context.into(),
+                rendered: rendered.to_string(),
+                tick,
+            },
+        );
+        lru.bytes += cost;
+    }
+
+    fn stats(&self) -> mj_render_cache_stats {
+        let lru = self.lru.lock().unwrap();
+        mj_render_cache_stats {
+            hits: self.hits.load(Ordering::Relaxed),
+            misses: self.misses.load(Ordering::Relaxed),
+            evictions: self.evictions.load(Ordering::Relaxed),
+            entries: lru.entries.len(),
+            bytes: lru.bytes,
+            budget: self.budget,
+        }
+    }
+}
+
+/// The key of a render that missed the cache.
+pub(crate) struct CacheMiss(Key);
+
+/// \brief Counters of the render cache of an environment.
+///
+/// @see mj_env_render_cache_stats Function that fills this structure
+#[repr(C)]
+pub struct mj_render_cache_stats {
+    /// Number of renders served from the cache
+    pub hits: u64,
+    /// Number of renders that were not in the cache
+    pub misses: u64,
+    /// Number of entries evicted to stay within the budget
+    pub evictions: u64,
+    /// Number of cached entries
+    pub entries: usize,
+    /// Bytes charged for the cached entries
+    pub bytes: usize,
+    /// The byte budget of the cache, or 0 if it is disabled
+    pub budget: usize,
+}
+
+/// \brief Enables, resizes or disables the render cache of the environment.
+///
+/// While enabled, mj_env_render caches its output keyed by the template
+/// name and the exact context bytes. A render of the same template with
+/// byte-identical context is then served from the cache without parsing the
+/// context or rendering. Entries are evicted least recently used first to
+/// keep the cache within `budget` bytes, which covers the name, context and
+/// output of every entry.
+///
+/// Every change to the environment, such as mj_env_add_template,
+/// mj_env_remove_template, a change of globals or a committed transaction,
+/// invalidates all cached output, since templates may depend on each other
+/// and on globals.
+///
+/// @param env Pointer to the environment to configure
+/// @param budget Byte budget of the cache, or 0 to disable it
+///
+/// \note The cache is disabled by default. Setting a budget replaces the
+/// cache with a new, empty one. Only enable the cache for templates whose
+/// output depends on nothing but the context and the environment.
+///
+/// @see mj_env_render_cache_stats Reads the counters of the cache
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_set_render_cache(env: *mut mj_env, budget: usize) {
+    let state = unsafe { &*env }.deref();
+    state.set_render_cache(budget);
+}
+
+/// \brief Reads the counters of the render cache of the environment.
+///
+/// @param env Pointer to the environment
+/// @param stats Pointer to the structure to fill; all counters are 0 while
+/// the cache is disabled
+///
+/// \note The stats parameter must not be NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_render_cache_stats(
+    env: *mut mj_env,
+    stats: *mut mj_render_cache_stats,
+) {
+    assert!(!stats.is_null());
+    let state = unsafe { &*env }.deref();
+    let value = match state.render_cache().as_ref() {
+        Some(cache) => cache.stats(),
+        None => mj_render_cache_stats {
+            hits: 0,
+            misses: 0,
+            evictions: 0,
+            entries: 0,
+            bytes: 0,
+            budget: 0,
+        },
+    };
+    unsafe { stats.write(value) };
+}
@@ -0,0 +1,63 @@
+use std::sync::Arc;
+
+use minijinja::Value;
+use minijinja::value::{Enumerator, Object};
+
+use super::*;
+
+/// Borrows the context buffer passed across the FFI boundary.
+///
+/// A NULL `data` pointer is treated as an empty buffer.
+pub(crate) unsafe fn bytes<'a>(data: *const u8, len: usize) -> &'a [u8] {
+    if data.is_null() {
+        return &[];
+    }
+    unsafe { std::slice::from_raw_parts(data, len) }
+}
+
+/// Deserializes a JSON encoded render context into a minijinja value.
+pub(crate) fn from_json(bytes: &[u8]) -> Result<Value, *mut mj_error> {
+    sonic_rs::from_slice::<Value>(bytes)
+        .map_err(|e| mj_error::with_code(errors::mj_code::MJ_CANNOT_DESERIALIZE, e.to_string()))
+}
+
+/// A map that resolves keys from a per-render overlay first and falls back
+/// to a shared base value, without copying either of them.
+#[derive(Debug)]
+struct Overlay {
+    overlay: Value,
+    base: Value,
+}
+
+impl Object for Overlay {
+    fn get_value(self: &Arc<Self>, key: &Value) -> Option<Value> {
+        self.overlay
+            .get_item_opt(key)
+            .or_else(|| self.base.get_item_opt(key))
+    }
+
+    fn enumerate(self: &Arc<Self>) -> Enumerator {
+        let mut keys = self
+            .overlay
+            .try_iter()
+            .map(|iter| iter.collect::<Vec<_>>())
+            .unwrap_or_default();
+        if let Ok(iter) = self.base.try_iter() {
+            let overlaid = keys.len();
+            keys.extend(iter.filter(|key| !keys[..overlaid].contains(key)));
+        }
+        Enumerator::Values(keys)
+    }
+}
+
+/// Layers the JSON encoded `overlay` on top of `base`. An empty overlay
+/// returns the base value itself.
+pub(crate) fn with_overlay(base: &Value, overlay: &[u8]) -> Result<Value, *mut mj_error> {
+    if overlay.is_empty() {
+        return Ok(base.clone());
+    }
+    Ok(Value::from_object(Overlay {
+        overlay: from_json(overlay)?,
+        base: base.clone(),
+    }))
+}
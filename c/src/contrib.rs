@@ -0,0 +1,128 @@
+use std::fmt::Write;
+
+use minijinja::value::{Kwargs, ValueKind};
+use minijinja::{Environment, Error, ErrorKind, Value};
+
+use super::*;
+
+/// Returns whether `byte` is left as is by urlencode, besides `/` in
+/// plain strings.
+fn is_unreserved(byte: u8) -> bool {
+    byte.is_ascii_alphanumeric() || matches!(byte, b'-' | b'.' | b'_' | b'~')
+}
+
+fn percent_encode(out: &mut String, s: &str, keep_slash: bool, plus_for_space: bool) {
+    for byte in s.bytes() {
+        match byte {
+            b if is_unreserved(b) || (keep_slash && b == b'/') => out.push(b as char),
+            b' ' if plus_for_space => out.push('+'),
+            b => write!(out, "%{b:02X}").unwrap(),
+        }
+    }
+}
+
+/// Percent-encodes a string for use in a URL, keeping `/`, or a map as a
+/// query string, skipping entries whose value is none or undefined.
+fn urlencode(value: &Value) -> Result<String, Error> {
+    let mut out = String::new();
+    if value.kind() != ValueKind::Map {
+        percent_encode(&mut out, &value.to_string(), true, false);
+        return Ok(out);
+    }
+    for key in value.try_iter()? {
+        let item = value.get_item(&key)?;
+        if item.is_none() || item.is_undefined() {
+            continue;
+        }
+        if !out.is_empty() {
+            out.push('&');
+        }
+        percent_encode(&mut out, &key.to_string(), false, true);
+        out.push('=');
+        percent_encode(&mut out, &item.to_string(), false, true);
+    }
+    Ok(out)
+}
+
+/// Serializes a value as JSON that is safe to embed in HTML, indented if
+/// `indent` is given and not false.
+fn tojson(value: &Value, kwargs: Kwargs) -> Result<Value, Error> {
+    let indent = kwargs
+        .get::<Option<Value>>("indent")?
+        .is_some_and(|indent| indent.is_true());
+    kwargs.assert_all_used()?;
+    escape::to_json(value, indent).map(Value::from_safe_string)
+}
+
+/// Formats a number with a fixed number of decimals and grouped thousands,
+/// such as `1,234,567.89`.
+fn numberformat(value: &Value, kwargs: Kwargs) -> Result<String, Error> {
+    let number = f64::try_from(value.clone()).map_err(|_| {
+        Error::new(
+            ErrorKind::InvalidOperation,
+            format!("cannot format {} as a number", value.kind()),
+        )
+    })?;
+    let decimals = kwargs.get::<Option<usize>>("decimals")?.unwrap_or(0);
+    let thousands = kwargs.get::<Option<&str>>("thousands")?.unwrap_or(",");
+    let point = kwargs.get::<Option<&str>>("point")?.unwrap_or(".");
+    kwargs.assert_all_used()?;
+    if !number.is_finite() {
+        return Ok(number.to_string());
+    }
+
+    let digits = format!("{:.*}", decimals, number.abs());
+    let (int, frac) = digits.split_once('.').unwrap_or((&digits, ""));
+    let mut out = String::with_capacity(digits.len() + digits.len() / 3 * thousands.len() + 1);
+    // Rounding may turn a small negative number into zero, which has no sign.
+    if number < 0.0 && digits.bytes().any(|b| matches!(b, b'1'..=b'9')) {
+        out.push('-');
+    }
+    for (i, digit) in int.chars().enumerate() {
+        if i > 0 && (int.len() - i) % 3 == 0 {
+            out.push_str(thousands);
+        }
+        out.push(digit);
+    }
+    if !frac.is_empty() {
+        out.push_str(point);
+        out.push_str(frac);
+    }
+    Ok(out)
+}
+
+/// Registers the filters and functions of minijinja-contrib and of this
+/// crate with `env`.
+fn add_to_environment(env: &mut Environment<'static>) {
+    minijinja_contrib::add_to_environment(env);
+    env.add_filter("urlencode", urlencode);
+    env.add_filter("tojson", tojson);
+    env.add_filter("numberformat", numberformat);
+}
+
+/// \brief Adds a pack of formatting filters and functions to the environment.
+///
+/// Formatting data in the render pass saves sending it pre-formatted in
+/// the context. The pack adds:
+///
+/// - the filters and functions of minijinja-contrib, among them
+///   `datetimeformat`, `dateformat`, `timeformat` and `now` for dates and
+///   times, `filesizeformat`, `pluralize`, `truncate`, `wordcount` and
+///   `wordwrap`;
+/// - `urlencode`, which percent-encodes a string or turns a map into a
+///   query string;
+/// - `tojson`, which embeds a value as JSON that is safe inside HTML,
+///   indented with `indent=true`;
+/// - `numberformat`, which formats a number with grouped thousands, taking
+///   the keyword arguments `decimals` (0), `thousands` (",") and `point`
+///   (".").
+///
+/// @param env Pointer to the environment to add the pack to
+///
+/// \note None of these are available until the pack is added. Adding it
+/// replaces filters and functions of the same names.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_add_contrib(env: *mut mj_env) {
+    let state = unsafe { &*env }.deref();
+    state.update(add_to_environment);
+}
@@ -1,7 +1,12 @@
-use std::ffi::{CString, c_char, c_void};
-use std::sync::{Arc, RwLock};
+use std::ffi::{c_char, c_void};
+use std::time::Instant;
 
-use minijinja::{Environment, UndefinedBehavior, Value};
+use minijinja::value::ValueKind;
+use minijinja::{Environment, Template, UndefinedBehavior};
+
+use crate::limits::mj_render_limits;
+use crate::state::EnvState;
+use crate::stats::{Phase, Recorder};
 
 use super::*;
 
@@ -11,21 +16,23 @@ use super::*;
 /// @see mj_env_new This function constructs a new environment
 /// @see mj_env_free This function frees the heap memory of the environment
 ///
-/// \note The mj_env actually owns a pointer to a Arc<RwLock<minijinja::Environment>>,
-/// which is inside the Rust core code and supports concurrent access.
+/// \note The mj_env publishes its minijinja::Environment as an immutable
+/// snapshot that is swapped atomically on every change. Renders load the
+/// current snapshot without taking a lock, and changes never block renders
+/// that are already in flight; they only see the change once it is published.
 ///
 /// \remark You may use the field `inner` to check whether this is a NULL
 /// environment.
 #[repr(C)]
 pub struct mj_env {
-    /// The pointer to the Arc<RwLock<minijinja::Environment>> in the Rust code.
+    /// The pointer to the environment state in the Rust code.
     /// Only touch this on judging whether it is NULL.
     pub inner: *mut c_void,
 }
 
 impl mj_env {
-    pub(crate) fn deref(&self) -> &Arc<RwLock<Environment>> {
-        unsafe { &*(self.inner as *const Arc<RwLock<Environment>>) }
+    pub(crate) fn deref(&self) -> &EnvState {
+        unsafe { &*(self.inner as *const EnvState) }
     }
 }
 
@@ -36,7 +43,7 @@ impl mj_env {
             if ptr.is_null() {
                 return;
             }
-            drop(Box::from_raw((*ptr).inner as *mut Arc<RwLock<Environment>>));
+            drop(Box::from_raw((*ptr).inner as *mut EnvState));
             drop(Box::from_raw(ptr));
         }
     }
@@ -54,10 +61,34 @@ impl mj_env {
 /// no longer needed to prevent memory leaks.
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn mj_env_new() -> *mut mj_env {
-    let env = Environment::new();
-    let env_arc = Arc::new(RwLock::new(env));
+    let mut env = Environment::new();
+    env.set_formatter(escape::format);
+    let state = EnvState::new(env);
     Box::into_raw(Box::new(mj_env {
-        inner: Box::into_raw(Box::new(env_arc)) as *mut c_void,
+        inner: Box::into_raw(Box::new(state)) as *mut c_void,
+    }))
+}
+
+/// \brief Creates a child environment that starts out as a copy of the given
+/// one.
+///
+/// The child shares the compiled templates, globals and settings of the
+/// parent instead of copying them, so creating it costs the same regardless
+/// of how many templates the parent holds. Templates, globals and settings
+/// changed on the child override those of the parent for the child only.
+///
+/// @param env Pointer to the parent environment
+///
+/// @return mj_env The child environment.
+///
+/// \note Changes made to the parent after this call are not visible to the
+/// child. Parent and child are independent and may be freed in any order,
+/// each using mj_env_free.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_clone(env: *mut mj_env) -> *mut mj_env {
+    let state = unsafe { &*env }.deref().fork();
+    Box::into_raw(Box::new(mj_env {
+        inner: Box::into_raw(Box::new(state)) as *mut c_void,
     }))
 }
 
@@ -92,13 +123,16 @@ pub unsafe extern "C" fn mj_env_add_template(
             .to_str()
             .expect("malformed template")
     };
-    let env_arc = unsafe { &*env }.deref();
-    match env_arc
-        .write()
-        .unwrap()
-        .add_template_owned(name.to_string(), source)
-    {
-        Ok(_) => std::ptr::null_mut(),
+    let state = unsafe { &*env }.deref();
+    let added = state.try_update(|env| {
+        env.add_template_owned(name.to_string(), source)
+            .map(|_| state.templates().added(name, source))
+    });
+    match added {
+        Ok(_) => {
+            state.templates().enforce(state);
+            std::ptr::null_mut()
+        }
         Err(e) => mj_error::new(e),
     }
 }
@@ -120,8 +154,11 @@ pub unsafe extern "C" fn mj_env_remove_template(env: *mut mj_env, name: *const c
             .to_str()
             .expect("malformed name")
     };
-    let env_arc = unsafe { &*env }.deref();
-    env_arc.write().unwrap().remove_template(name);
+    let state = unsafe { &*env }.deref();
+    state.update(|env| {
+        env.remove_template(name);
+        state.templates().removed(name);
+    });
 }
 
 /// \brief Clears all templates from the environment.
@@ -132,10 +169,88 @@ pub unsafe extern "C" fn mj_env_remove_template(env: *mut mj_env, name: *const c
 /// @param env Pointer to the environment to clear templates from
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn mj_env_clear_templates(env: *mut mj_env) {
-    let env_arc = unsafe { &*env }.deref();
-    env_arc.write().unwrap().clear_templates();
+    let state = unsafe { &*env }.deref();
+    state.update(|env| {
+        env.clear_templates();
+        state.templates().cleared();
+    });
+}
+
+/// \brief Adds a global variable to the environment.
+///
+/// Globals are visible to every template rendered from the environment, so
+/// data shared by all renders (navigation, feature flags, locale tables and
+/// the like) is parsed once here instead of being part of every context.
+/// A key of the render context shadows a global of the same name.
+///
+/// @param env Pointer to the environment to add the global to
+/// @param name Null-terminated string containing the name of the global
+/// @param data Pointer to the JSON encoded value of the global
+/// @param len Length of the value in bytes
+///
+/// @return mj_error NULL on success, or error information if the value
+/// cannot be parsed.
+///
+/// \note The name parameter must not be NULL. Adding a global with an
+/// existing name replaces the previous value.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_add_global(
+    env: *mut mj_env,
+    name: *const c_char,
+    data: *const u8,
+    len: usize,
+) -> *mut mj_error {
+    assert!(!name.is_null());
+    let name = unsafe {
+        std::ffi::CStr::from_ptr(name)
+            .to_str()
+            .expect("malformed name")
+    };
+    let bytes = unsafe { context::bytes(data, len) };
+    let value = match context::from_json(bytes) {
+        Ok(value) => value,
+        Err(e) => return e,
+    };
+    let state = unsafe { &*env }.deref();
+    state.update(|env| env.add_global(name.to_string(), value));
+    std::ptr::null_mut()
 }
 
+/// \brief Removes a global variable from the environment by name.
+///
+/// @param env Pointer to the environment to remove the global from
+/// @param name Null-terminated string containing the name of the global
+///
+/// \note The name parameter must not be NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_remove_global(env: *mut mj_env, name: *const c_char) {
+    assert!(!name.is_null());
+    let name = unsafe {
+        std::ffi::CStr::from_ptr(name)
+            .to_str()
+            .expect("malformed name")
+    };
+    let state = unsafe { &*env }.deref();
+    state.update(|env| env.remove_global(name));
+}
+
+/// \brief Renders a template stored in the environment.
+///
+/// This function looks up the template by name and renders it with the
+/// JSON encoded context passed in `data`.
+///
+/// @param env Pointer to the environment holding the template
+/// @param name Null-terminated string containing the name of the template
+/// @param data Pointer to the JSON encoded context
+/// @param len Length of the context in bytes
+///
+/// @return mj_result_env_render_template A result structure containing the
+/// rendered string or error information if rendering fails.
+///
+/// \note The name parameter must not be NULL. The returned result should be
+/// freed using mj_result_env_render_template_free when no longer needed.
+///
+/// @see mj_env_get_template Looks the template up once for repeated renders
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn mj_env_render(
     env: *mut mj_env,
@@ -144,49 +259,345 @@ pub unsafe extern "C" fn mj_env_render(
     len: usize,
 ) -> *mut mj_result_env_render_template {
     assert!(!name.is_null());
-    let bytes = unsafe { std::slice::from_raw_parts(data, len) };
+    let bytes = unsafe { context::bytes(data, len) };
     let name = unsafe {
         std::ffi::CStr::from_ptr(name)
             .to_str()
             .expect("malformed name")
     };
-    let env_arc = unsafe { &*env }.deref();
+    let state = unsafe { &*env }.deref();
+    render(state, name, bytes, mj_render_limits::default())
+}
+
+/// Renders the template `name` of `state` within `limits`, through the
+/// render cache and metrics of the state.
+pub(crate) fn render(
+    state: &EnvState,
+    name: &str,
+    bytes: &[u8],
+    limits: mj_render_limits,
+) -> *mut mj_result_env_render_template {
+    let mut recorder = state.stats().start(name);
+    let deadline = limits::deadline(state.timeout(limits.timeout_ns));
+
+    // Only a render that overrides the fuel needs a snapshot of its own.
+    let (mut snapshot, mut fueled) = (None, None);
+    let (snapshot, fueled) = (&mut snapshot, &mut fueled);
+    let rendered = render_resolved(
+        state,
+        state.generation(),
+        name,
+        bytes,
+        deadline,
+        &mut recorder,
+        move || {
+            let env: &Environment<'static> = match limits.fuel {
+                0 => snapshot.insert(state.load()),
+                fuel => fueled.insert(state.fueled(fuel)),
+            };
+            env.get_template(name).map_err(mj_error::new)
+        },
+    );
+    match rendered {
+        Ok(rendered) => recorder.ok(rendered),
+        Err(e) => recorder.err(e),
+    }
+}
+
+/// Renders the template `name` of the snapshot of `generation` within
+/// `deadline`, through the render cache and with the context decoding mode
+/// of `state`, marking the phases on `recorder`.
+///
+/// The template is only resolved, by `resolve`, on a cache miss, so a hit
+/// neither looks it up nor counts as a use of it.
+pub(crate) fn render_resolved<'env, 'source>(
+    state: &EnvState,
+    generation: u64,
+    name: &str,
+    bytes: &[u8],
+    deadline: Option<Instant>,
+    recorder: &mut Recorder<'_>,
+    resolve: impl FnOnce() -> Result<Template<'env, 'source>, *mut mj_error>,
+) -> Result<String, *mut mj_error> {
+    let cache = state.render_cache();
+    let miss = match cache.as_ref() {
+        Some(cache) => match cache.get(name, generation, bytes) {
+            Ok(rendered) => return Ok(rendered),
+            Err(miss) => Some(miss),
+        },
+        None => None,
+    };
 
-    let env_guard = env_arc.read().unwrap();
+    let template = resolve()?;
+    state.template_used(name);
+    recorder.mark(Phase::Lookup);
+    let value = lazy::context(state, bytes)?;
+    recorder.mark(Phase::Parse);
+    let rendered = limits::render(&template, &value, deadline)?;
+    if let (Some(cache), Some(miss)) = (cache.as_ref(), miss) {
+        cache.insert(miss, bytes, &rendered);
+    }
+    Ok(rendered)
+}
+
+/// \brief Renders a template stored in the environment, streaming the output
+/// to a callback.
+///
+/// Instead of building the whole output in memory, the rendered output is
+/// pushed to `callback` in chunks of a fixed size as rendering progresses,
+/// so peak memory does not grow with the size of the output.
+///
+/// @param env Pointer to the environment holding the template
+/// @param name Null-terminated string containing the name of the template
+/// @param data Pointer to the JSON encoded context
+/// @param len Length of the context in bytes
+/// @param callback Callback receiving the chunks of rendered output
+/// @param user_data Opaque pointer passed through to every callback invocation
+///
+/// @return mj_error NULL on success, or error information if rendering fails
+/// or the callback aborts it.
+///
+/// \note The name and callback parameters must not be NULL. On failure, part
+/// of the output may already have been passed to the callback.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_render_to_writer(
+    env: *mut mj_env,
+    name: *const c_char,
+    data: *const u8,
+    len: usize,
+    callback: Option<mj_write_callback>,
+    user_data: *mut c_void,
+) -> *mut mj_error {
+    assert!(!name.is_null());
+    let callback = callback.expect("callback must not be NULL");
+    let bytes = unsafe { context::bytes(data, len) };
+    let name = unsafe {
+        std::ffi::CStr::from_ptr(name)
+            .to_str()
+            .expect("malformed name")
+    };
+    let state = unsafe { &*env }.deref();
+    let deadline = limits::deadline(state.timeout(0));
+
+    let env_guard = state.load();
     let template = match env_guard.get_template(name) {
         Ok(template) => template,
-        Err(e) => {
-            return Box::into_raw(Box::new(mj_result_env_render_template {
-                result: std::ptr::null_mut(),
-                error: mj_error::new(e),
-            }));
-        }
+        Err(e) => return mj_error::new(e),
     };
-    let value = match sonic_rs::from_slice::<Value>(bytes) {
+    state.template_used(name);
+    let value = match lazy::context(state, bytes) {
         Ok(value) => value,
-        Err(e) => {
-            return Box::into_raw(Box::new(mj_result_env_render_template {
-                result: std::ptr::null_mut(),
-                error: Box::into_raw(Box::new(mj_error {
-                    code: errors::mj_code::MJ_CANNOT_DESERIALIZE,
-                    message: std::ffi::CString::new(e.to_string())
-                        .expect("CString::new failed")
-                        .into_raw(),
-                })),
-            }));
+        Err(e) => return e,
+    };
+    match writer::render_to_callback(&template, &value, deadline, callback, user_data) {
+        Ok(_) => std::ptr::null_mut(),
+        Err(e) => e,
+    }
+}
+
+/// \brief Renders a template stored in the environment into a caller owned buffer.
+///
+/// The rendered output is written to `buf` without a terminating NUL byte and
+/// its length is stored in `out_len`. If the output does not fit into `cap`
+/// bytes, nothing is allocated for it: `out_len` receives the required length
+/// and the content of `buf` is unspecified, so the caller can grow the buffer
+/// and render again.
+///
+/// @param env Pointer to the environment holding the template
+/// @param name Null-terminated string containing the name of the template
+/// @param data Pointer to the JSON encoded context
+/// @param len Length of the context in bytes
+/// @param buf Pointer to the output buffer, may be NULL if cap is 0
+/// @param cap Capacity of the output buffer in bytes
+/// @param out_len Receives the length of the rendered output
+///
+/// @return mj_error NULL on success, or error information if rendering fails.
+///
+/// \note The name and out_len parameters must not be NULL. The call succeeded
+/// and the output is complete only if the error is NULL and out_len <= cap.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_render_into(
+    env: *mut mj_env,
+    name: *const c_char,
+    data: *const u8,
+    len: usize,
+    buf: *mut u8,
+    cap: usize,
+    out_len: *mut usize,
+) -> *mut mj_error {
+    assert!(!name.is_null());
+    assert!(!out_len.is_null());
+    let bytes = unsafe { context::bytes(data, len) };
+    let name = unsafe {
+        std::ffi::CStr::from_ptr(name)
+            .to_str()
+            .expect("malformed name")
+    };
+    let state = unsafe { &*env }.deref();
+    let deadline = limits::deadline(state.timeout(0));
+
+    let env_guard = state.load();
+    let template = match env_guard.get_template(name) {
+        Ok(template) => template,
+        Err(e) => return mj_error::new(e),
+    };
+    state.template_used(name);
+    let value = match lazy::context(state, bytes) {
+        Ok(value) => value,
+        Err(e) => return e,
+    };
+    match unsafe { writer::render_to_buffer(&template, &value, deadline, buf, cap) } {
+        Ok(rendered) => {
+            unsafe { *out_len = rendered };
+            std::ptr::null_mut()
         }
+        Err(e) => e,
+    }
+}
+
+/// \brief Renders a single block of a template stored in the environment.
+///
+/// The top-level code of the template is evaluated with its output
+/// discarded, which sets up the templates it extends and the variables it
+/// sets, and then only the named block is rendered into the result. This
+/// saves building, copying and returning the output of the whole page when
+/// only a fragment of it is needed.
+///
+/// @param env Pointer to the environment holding the template
+/// @param name Null-terminated string containing the name of the template
+/// @param block Null-terminated string containing the name of the block
+/// @param data Pointer to the JSON encoded context
+/// @param len Length of the context in bytes
+///
+/// @return mj_result_env_render_template A result structure containing the
+/// rendered block or error information if rendering fails. A template
+/// without the block fails with MJ_UNKNOWN_BLOCK.
+///
+/// \note The name and block parameters must not be NULL. The returned result
+/// should be freed using mj_result_env_render_template_free when no longer
+/// needed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_render_block(
+    env: *mut mj_env,
+    name: *const c_char,
+    block: *const c_char,
+    data: *const u8,
+    len: usize,
+) -> *mut mj_result_env_render_template {
+    assert!(!name.is_null());
+    assert!(!block.is_null());
+    let name = unsafe {
+        std::ffi::CStr::from_ptr(name)
+            .to_str()
+            .expect("malformed name")
+    };
+    let block = unsafe {
+        std::ffi::CStr::from_ptr(block)
+            .to_str()
+            .expect("malformed block")
     };
-    match template.render(&value) {
-        Ok(rendered) => Box::into_raw(Box::new(mj_result_env_render_template {
-            result: CString::new(rendered)
-                .expect("CString::new failed")
-                .into_raw(),
-            error: std::ptr::null_mut(),
-        })),
-        Err(e) => Box::into_raw(Box::new(mj_result_env_render_template {
-            result: std::ptr::null_mut(),
-            error: mj_error::new(e),
-        })),
+    let bytes = unsafe { context::bytes(data, len) };
+    let state = unsafe { &*env }.deref();
+    let deadline = limits::deadline(state.timeout(0));
+
+    let env_guard = state.load();
+    let template = match env_guard.get_template(name) {
+        Ok(template) => template,
+        Err(e) => return mj_result_env_render_template::err(mj_error::new(e)),
+    };
+    state.template_used(name);
+    let value = match lazy::context(state, bytes) {
+        Ok(value) => value,
+        Err(e) => return mj_result_env_render_template::err(e),
+    };
+    let rendered = limits::evaluate(deadline, || {
+        template
+            .eval_to_state(&value)
+            .and_then(|mut state| state.render_block(block))
+    });
+    match rendered {
+        Ok(rendered) => mj_result_env_render_template::ok(rendered),
+        Err(e) => mj_result_env_render_template::err(e),
+    }
+}
+
+/// \brief Calls a macro defined by a template stored in the environment.
+///
+/// The template is evaluated as for mj_env_render_block and the named macro
+/// is called with the given arguments; its output is returned.
+///
+/// @param env Pointer to the environment holding the template
+/// @param name Null-terminated string containing the name of the template
+/// @param macro_name Null-terminated string containing the name of the macro
+/// @param data Pointer to the JSON encoded context
+/// @param len Length of the context in bytes
+/// @param args Pointer to the JSON encoded array of positional arguments
+/// @param args_len Length of the arguments in bytes, 0 for no arguments
+///
+/// @return mj_result_env_render_template A result structure containing the
+/// output of the macro or error information if the call fails.
+///
+/// \note The name and macro_name parameters must not be NULL. Arguments that
+/// are not a JSON array fail with MJ_CANNOT_DESERIALIZE. The returned result
+/// should be freed using mj_result_env_render_template_free when no longer
+/// needed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_call_macro(
+    env: *mut mj_env,
+    name: *const c_char,
+    macro_name: *const c_char,
+    data: *const u8,
+    len: usize,
+    args: *const u8,
+    args_len: usize,
+) -> *mut mj_result_env_render_template {
+    assert!(!name.is_null());
+    assert!(!macro_name.is_null());
+    let name = unsafe {
+        std::ffi::CStr::from_ptr(name)
+            .to_str()
+            .expect("malformed name")
+    };
+    let macro_name = unsafe {
+        std::ffi::CStr::from_ptr(macro_name)
+            .to_str()
+            .expect("malformed macro name")
+    };
+    let bytes = unsafe { context::bytes(data, len) };
+    let args = match unsafe { context::bytes(args, args_len) } {
+        [] => Vec::new(),
+        args => match context::from_json(args) {
+            Ok(value) if value.kind() == ValueKind::Seq => value.try_iter().unwrap().collect(),
+            Ok(_) => {
+                return mj_result_env_render_template::err(mj_error::with_code(
+                    errors::mj_code::MJ_CANNOT_DESERIALIZE,
+                    "macro arguments must be a JSON array".to_string(),
+                ));
+            }
+            Err(e) => return mj_result_env_render_template::err(e),
+        },
+    };
+    let state = unsafe { &*env }.deref();
+    let deadline = limits::deadline(state.timeout(0));
+
+    let env_guard = state.load();
+    let template = match env_guard.get_template(name) {
+        Ok(template) => template,
+        Err(e) => return mj_result_env_render_template::err(mj_error::new(e)),
+    };
+    state.template_used(name);
+    let value = match lazy::context(state, bytes) {
+        Ok(value) => value,
+        Err(e) => return mj_result_env_render_template::err(e),
+    };
+    let rendered = limits::evaluate(deadline, || {
+        template
+            .eval_to_state(&value)
+            .and_then(|state| state.call_macro(macro_name, &args))
+    });
+    match rendered {
+        Ok(rendered) => mj_result_env_render_template::ok(rendered),
+        Err(e) => mj_result_env_render_template::err(e),
     }
 }
 
@@ -225,34 +636,23 @@ pub unsafe extern "C" fn mj_env_render_named_string(
             .to_str()
             .expect("malformed template")
     };
-    let bytes = unsafe { std::slice::from_raw_parts(data, len) };
-    let env_arc = unsafe { &*env }.deref();
-    let env_guard = env_arc.read().unwrap();
-    let value = match sonic_rs::from_slice::<Value>(bytes) {
+    let bytes = unsafe { context::bytes(data, len) };
+    let state = unsafe { &*env }.deref();
+    let mut recorder = state.stats().start(name);
+    let deadline = limits::deadline(state.timeout(0));
+    let env_guard = state.load();
+    let value = match lazy::context(state, bytes) {
         Ok(value) => value,
-        Err(e) => {
-            return Box::into_raw(Box::new(mj_result_env_render_template {
-                result: std::ptr::null_mut(),
-                error: Box::into_raw(Box::new(mj_error {
-                    code: errors::mj_code::MJ_CANNOT_DESERIALIZE,
-                    message: std::ffi::CString::new(e.to_string())
-                        .expect("CString::new failed")
-                        .into_raw(),
-                })),
-            }));
-        }
+        Err(e) => return recorder.err(e),
+    };
+    recorder.mark(Phase::Parse);
+    let template = match env_guard.template_from_named_str(name, source) {
+        Ok(template) => template,
+        Err(e) => return recorder.err(mj_error::new(e)),
     };
-    match env_guard.render_named_str(name, source, &value) {
-        Ok(rendered) => Box::into_raw(Box::new(mj_result_env_render_template {
-            result: CString::new(rendered)
-                .expect("CString::new failed")
-                .into_raw(),
-            error: std::ptr::null_mut(),
-        })),
-        Err(e) => Box::into_raw(Box::new(mj_result_env_render_template {
-            result: std::ptr::null_mut(),
-            error: mj_error::new(e),
-        })),
+    match limits::render(&template, &value, deadline) {
+        Ok(rendered) => recorder.ok(rendered),
+        Err(e) => recorder.err(e),
     }
 }
 
@@ -265,8 +665,8 @@ pub unsafe extern "C" fn mj_env_render_named_string(
 /// @param value Boolean value indicating whether to enable lstrip blocks
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn mj_env_set_lstrip_blocks(env: *mut mj_env, value: bool) {
-    let env_arc = unsafe { &*env }.deref();
-    env_arc.write().unwrap().set_lstrip_blocks(value);
+    let state = unsafe { &*env }.deref();
+    state.update(|env| env.set_lstrip_blocks(value));
 }
 
 /// \brief Sets whether to strip trailing whitespace from blocks.
@@ -278,8 +678,8 @@ pub unsafe extern "C" fn mj_env_set_lstrip_blocks(env: *mut mj_env, value: bool)
 /// @param value Boolean value indicating whether to enable trim blocks
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn mj_env_set_trim_blocks(env: *mut mj_env, value: bool) {
-    let env_arc = unsafe { &*env }.deref();
-    env_arc.write().unwrap().set_trim_blocks(value);
+    let state = unsafe { &*env }.deref();
+    state.update(|env| env.set_trim_blocks(value));
 }
 
 /// \brief Sets whether to keep trailing newlines in template output.
@@ -291,8 +691,8 @@ pub unsafe extern "C" fn mj_env_set_trim_blocks(env: *mut mj_env, value: bool) {
 /// @param value Boolean value indicating whether to keep trailing newlines
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn mj_env_set_keep_trailing_newline(env: *mut mj_env, value: bool) {
-    let env_arc = unsafe { &*env }.deref();
-    env_arc.write().unwrap().set_keep_trailing_newline(value);
+    let state = unsafe { &*env }.deref();
+    state.update(|env| env.set_keep_trailing_newline(value));
 }
 
 /// \brief Sets the maximum recursion depth for template rendering.
@@ -304,8 +704,8 @@ pub unsafe extern "C" fn mj_env_set_keep_trailing_newline(env: *mut mj_env, valu
 /// @param value Maximum recursion depth allowed
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn mj_env_set_recursion_limit(env: *mut mj_env, value: usize) {
-    let env_arc = unsafe { &*env }.deref();
-    env_arc.write().unwrap().set_recursion_limit(value);
+    let state = unsafe { &*env }.deref();
+    state.update(|env| env.set_recursion_limit(value));
 }
 
 /// \brief Sets whether to enable debug mode for template rendering.
@@ -317,8 +717,8 @@ pub unsafe extern "C" fn mj_env_set_recursion_limit(env: *mut mj_env, value: usi
 /// @param value Boolean value indicating whether to enable debug mode
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn mj_env_set_debug(env: *mut mj_env, value: bool) {
-    let env_arc = unsafe { &*env }.deref();
-    env_arc.write().unwrap().set_debug(value);
+    let state = unsafe { &*env }.deref();
+    state.update(|env| env.set_debug(value));
 }
 
 /// \brief Sets the undefined behavior policy for the environment.
@@ -338,6 +738,6 @@ pub unsafe extern "C" fn mj_env_set_undefined_behavior(
         mj_undefined_behavior::MJ_UNDEFINED_BEHAVIOR_STRICT => UndefinedBehavior::Strict,
         mj_undefined_behavior::MJ_UNDEFINED_BEHAVIOR_CHAINABLE => UndefinedBehavior::Chainable,
     };
-    let env_arc = unsafe { &*env }.deref();
-    env_arc.write().unwrap().set_undefined_behavior(behavior);
+    let state = unsafe { &*env }.deref();
+    state.update(|env| env.set_undefined_behavior(behavior));
 }
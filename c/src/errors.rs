@@ -1,4 +1,5 @@
-use std::ffi::{CString, c_char};
+use std::ffi::{CString, c_char, c_void};
+use std::sync::OnceLock;
 
 use minijinja::{Error, ErrorKind};
 
@@ -13,6 +14,7 @@ use minijinja::{Error, ErrorKind};
 /// \note These error codes are C-compatible and can be used for error handling
 /// in C/C++ applications.
 #[repr(C)]
+#[derive(Clone, Copy, PartialEq, Eq)]
 pub enum mj_code {
     /// Error when attempting to use a non-primitive value where a primitive is expected
     MJ_NON_PRIMITIVE,
@@ -54,6 +56,10 @@ pub enum mj_code {
     MJ_WRITE_FAILURE,
     /// Unknown or undefined block used in template
     MJ_UNKNOWN_BLOCK,
+    /// The render consumed all of its fuel
+    MJ_OUT_OF_FUEL,
+    /// The render did not finish before its deadline
+    MJ_DEADLINE_EXCEEDED,
 }
 
 impl From<ErrorKind> for mj_code {
@@ -79,6 +85,7 @@ impl From<ErrorKind> for mj_code {
             ErrorKind::CannotUnpack => mj_code::MJ_CANNOT_UNPACK,
             ErrorKind::WriteFailure => mj_code::MJ_WRITE_FAILURE,
             ErrorKind::UnknownBlock => mj_code::MJ_UNKNOWN_BLOCK,
+            ErrorKind::OutOfFuel => mj_code::MJ_OUT_OF_FUEL,
             _ => unimplemented!(
                 "The newly added ErrorKind in core crate is not handled in C bindings"
             ),
@@ -86,50 +93,149 @@ impl From<ErrorKind> for mj_code {
     }
 }
 
-/// \brief Represents a MiniJinja error with code and message information.
+/// \brief Represents a MiniJinja error with code and location information.
 ///
-/// This structure encapsulates error information from MiniJinja operations,
-/// including both an error code that categorizes the error type and a
-/// human-readable error message with full error chain details.
+/// This structure carries the error code that categorizes the error type
+/// and, for errors raised by a template, where in the template it occurred.
+/// The human-readable message with the full error chain and the template
+/// name are only formatted when requested through mj_error_message and
+/// mj_error_template_name, so creating and discarding errors stays cheap.
 ///
 /// @see mj_code The error code enumeration
+/// @see mj_error_message This function returns the error message
+/// @see mj_error_template_name This function returns the template name
 /// @see mj_error_free This function frees the heap memory of the error
 ///
-/// \note The mj_error structure owns the error message string, which must
-/// be freed using mj_error_free to prevent memory leaks.
+/// \note The mj_error structure owns its message and template name, which
+/// are freed together with it using mj_error_free.
 ///
-/// \remark The message field contains the complete error chain, including
-/// the root cause and all intermediate error causes.
+/// \remark Columns are only known for templates compiled in debug mode;
+/// see mj_env_set_debug.
 #[repr(C)]
 pub struct mj_error {
     /// The error code categorizing the type of error that occurred
     pub(crate) code: mj_code,
-    /// Pointer to a null-terminated C string containing the error message
-    pub(crate) message: *const c_char,
+    /// The 1-based line of the template the error occurred on, or 0 if
+    /// unknown
+    pub(crate) line: usize,
+    /// The 1-based column the error starts at, or 0 if unknown
+    pub(crate) column: usize,
+    /// Byte offset into the template source where the error starts
+    pub(crate) range_start: usize,
+    /// Byte offset into the template source where the error ends, equal to
+    /// range_start if the range is unknown
+    pub(crate) range_end: usize,
+    /// The pointer to the error details in the Rust code.
+    /// Only touch this on judging whether it is NULL.
+    pub(crate) inner: *mut c_void,
+}
+
+/// The parts of an error that are expensive to format, kept in their raw
+/// form until they are asked for.
+struct Details {
+    source: Source,
+    message: OnceLock<CString>,
+    name: OnceLock<Option<CString>>,
+}
+
+enum Source {
+    Error(Error),
+    Message(String),
+}
+
+impl Details {
+    fn message(&self) -> &CString {
+        self.message.get_or_init(|| {
+            let message = match &self.source {
+                Source::Error(error) => {
+                    let mut err = error as &dyn std::error::Error;
+                    let mut message = err.to_string();
+                    while let Some(cause) = err.source() {
+                        message.push_str("\nCaused by: ");
+                        message.push_str(cause.to_string().as_str());
+                        err = cause;
+                    }
+                    message
+                }
+                Source::Message(message) => message.clone(),
+            };
+            CString::new(message).expect("CString::new failed")
+        })
+    }
+
+    fn name(&self) -> Option<&CString> {
+        self.name
+            .get_or_init(|| match &self.source {
+                Source::Error(error) => error
+                    .name()
+                    .map(|name| CString::new(name).expect("CString::new failed")),
+                Source::Message(_) => None,
+            })
+            .as_ref()
+    }
 }
 
 impl mj_error {
-    pub fn new(error: Error) -> *mut Self {
-        let code = mj_code::from(error.kind());
-        let mut err = &error as &dyn std::error::Error;
-        let mut message = err.to_string();
-        while let Some(cause) = err.source() {
-            message.push_str("\nCaused by: ");
-            message.push_str(cause.to_string().as_str());
-            err = cause;
+    fn with_details(code: mj_code, source: Source) -> *mut Self {
+        let (mut line, mut column, mut range) = (0, 0, 0..0);
+        if let Source::Error(error) = &source {
+            line = error.line().unwrap_or(0);
+            if let Some(r) = error.range() {
+                range = r;
+                column = column_of(error, range.start);
+            }
         }
+        let details = Details {
+            source,
+            message: OnceLock::new(),
+            name: OnceLock::new(),
+        };
         Box::into_raw(Box::new(mj_error {
             code,
-            message: CString::new(message)
-                .expect("CString::new failed")
-                .into_raw(),
+            line,
+            column,
+            range_start: range.start,
+            range_end: range.end,
+            inner: Box::into_raw(Box::new(details)) as *mut c_void,
+        }))
+    }
+
+    pub(crate) fn with_code(code: mj_code, message: String) -> *mut Self {
+        mj_error::with_details(code, Source::Message(message))
+    }
+
+    pub fn new(error: Error) -> *mut Self {
+        mj_error::with_details(mj_code::from(error.kind()), Source::Error(error))
+    }
+
+    /// Returns a new error with the code, position, message and template
+    /// name of this one, for an error that is handed out more than once.
+    pub(crate) fn copy(&self) -> *mut Self {
+        let details = self.details();
+        let message = details.message().clone();
+        let copied = Details {
+            source: Source::Message(message.to_string_lossy().into_owned()),
+            message: OnceLock::from(message),
+            name: OnceLock::from(details.name().cloned()),
+        };
+        Box::into_raw(Box::new(mj_error {
+            code: self.code,
+            line: self.line,
+            column: self.column,
+            range_start: self.range_start,
+            range_end: self.range_end,
+            inner: Box::into_raw(Box::new(copied)) as *mut c_void,
         }))
     }
 
+    fn details(&self) -> &Details {
+        unsafe { &*(self.inner as *const Details) }
+    }
+
     /// \brief Frees the memory allocated for a MiniJinja error.
     ///
-    /// This function properly deallocates both the error structure and its
-    /// associated error message string, preventing memory leaks.
+    /// This function properly deallocates the error structure together with
+    /// its message and template name, preventing memory leaks.
     ///
     /// @param ptr Pointer to the error structure to free
     ///
@@ -142,8 +248,58 @@ impl mj_error {
             return;
         }
         unsafe {
-            drop(Box::from_raw((*ptr).message as *mut c_char));
             drop(Box::from_raw(ptr));
         }
     }
 }
+
+impl Drop for mj_error {
+    fn drop(&mut self) {
+        if !self.inner.is_null() {
+            drop(unsafe { Box::from_raw(self.inner as *mut Details) });
+        }
+    }
+}
+
+/// Returns the 1-based column of the byte `offset` in the source of the
+/// template that raised `error`, or 0 if the source is not known.
+fn column_of(error: &Error, offset: usize) -> usize {
+    let Some(source) = error.template_source() else {
+        return 0;
+    };
+    let Some(before) = source.get(..offset) else {
+        return 0;
+    };
+    let line_start = before.rfind('\n').map_or(0, |i| i + 1);
+    before[line_start..].chars().count() + 1
+}
+
+/// \brief Returns the message of the error.
+///
+/// The message includes the complete error chain, the root cause and all
+/// intermediate causes. It is formatted on the first call only.
+///
+/// @param error Pointer to the error
+///
+/// @return A null-terminated string owned by the error, valid until the
+/// error is freed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_error_message(error: *const mj_error) -> *const c_char {
+    let error = unsafe { &*error };
+    error.details().message().as_ptr()
+}
+
+/// \brief Returns the name of the template the error occurred in.
+///
+/// @param error Pointer to the error
+///
+/// @return A null-terminated string owned by the error, valid until the
+/// error is freed, or NULL if the error is not tied to a template.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_error_template_name(error: *const mj_error) -> *const c_char {
+    let error = unsafe { &*error };
+    error
+        .details()
+        .name()
+        .map_or(std::ptr::null(), |name| name.as_ptr())
+}
@@ -0,0 +1,273 @@
+use std::ffi::c_char;
+use std::fmt::Write;
+
+use minijinja::value::ValueKind;
+use minijinja::{AutoEscape, Error, ErrorKind, Output, State, Value};
+
+use crate::types::mj_auto_escape;
+
+use super::*;
+
+/// The custom auto-escape format of templates escaped as JSON.
+const JSON: &str = "json";
+
+/// Bytes escaped in HTML, indexed by byte value.
+const HTML_ESCAPED: [bool; 256] = {
+    let mut table = [false; 256];
+    table[b'<' as usize] = true;
+    table[b'>' as usize] = true;
+    table[b'&' as usize] = true;
+    table[b'"' as usize] = true;
+    table[b'\'' as usize] = true;
+    table[b'/' as usize] = true;
+    table
+};
+
+fn html_entity(byte: u8) -> &'static str {
+    match byte {
+        b'<' => "&lt;",
+        b'>' => "&gt;",
+        b'&' => "&amp;",
+        b'"' => "&quot;",
+        b'\'' => "&#x27;",
+        b'/' => "&#x2f;",
+        _ => unreachable!(),
+    }
+}
+
+fn find_scalar(bytes: &[u8]) -> Option<usize> {
+    bytes.iter().position(|&b| HTML_ESCAPED[b as usize])
+}
+
+#[cfg(target_arch = "x86_64")]
+#[target_feature(enable = "avx2")]
+unsafe fn find_avx2(bytes: &[u8]) -> Option<usize> {
+    use std::arch::x86_64::*;
+    unsafe {
+        let needles = [
+            _mm256_set1_epi8(b'<' as i8),
+            _mm256_set1_epi8(b'>' as i8),
+            _mm256_set1_epi8(b'&' as i8),
+            _mm256_set1_epi8(b'"' as i8),
+            _mm256_set1_epi8(b'\'' as i8),
+            _mm256_set1_epi8(b'/' as i8),
+        ];
+        let mut i = 0;
+        while i + 32 <= bytes.len() {
+            let chunk = _mm256_loadu_si256(bytes.as_ptr().add(i) as *const __m256i);
+            let mut hits = _mm256_setzero_si256();
+            for needle in needles {
+                hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(chunk, needle));
+            }
+            let mask = _mm256_movemask_epi8(hits) as u32;
+            if mask != 0 {
+                return Some(i + mask.trailing_zeros() as usize);
+            }
+            i += 32;
+        }
+        find_sse2(&bytes[i..]).map(|j| i + j)
+    }
+}
+
+#[cfg(target_arch = "x86_64")]
+#[target_feature(enable = "sse2")]
+unsafe fn find_sse2(bytes: &[u8]) -> Option<usize> {
+    use std::arch::x86_64::*;
+    unsafe {
+        let needles = [
+            _mm_set1_epi8(b'<' as i8),
+            _mm_set1_epi8(b'>' as i8),
+            _mm_set1_epi8(b'&' as i8),
+            _mm_set1_epi8(b'"' as i8),
+            _mm_set1_epi8(b'\'' as i8),
+            _mm_set1_epi8(b'/' as i8),
+        ];
+        let mut i = 0;
+        while i + 16 <= bytes.len() {
+            let chunk = _mm_loadu_si128(bytes.as_ptr().add(i) as *const __m128i);
+            let mut hits = _mm_setzero_si128();
+            for needle in needles {
+                hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, needle));
+            }
+            let mask = _mm_movemask_epi8(hits) as u32;
+            if mask != 0 {
+                return Some(i + mask.trailing_zeros() as usize);
+            }
+            i += 16;
+        }
+        find_scalar(&bytes[i..]).map(|j| i + j)
+    }
+}
+
+#[cfg(target_arch = "aarch64")]
+#[target_feature(enable = "neon")]
+unsafe fn find_neon(bytes: &[u8]) -> Option<usize> {
+    use std::arch::aarch64::*;
+    unsafe {
+        let needles = [
+            vdupq_n_u8(b'<'),
+            vdupq_n_u8(b'>'),
+            vdupq_n_u8(b'&'),
+            vdupq_n_u8(b'"'),
+            vdupq_n_u8(b'\''),
+            vdupq_n_u8(b'/'),
+        ];
+        let mut i = 0;
+        while i + 16 <= bytes.len() {
+            let chunk = vld1q_u8(bytes.as_ptr().add(i));
+            let mut hits = vdupq_n_u8(0);
+            for needle in needles {
+                hits = vorrq_u8(hits, vceqq_u8(chunk, needle));
+            }
+            // NEON has no movemask, so only locate the byte within a chunk
+            // that is known to hold one.
+            if vmaxvq_u8(hits) != 0 {
+                return find_scalar(&bytes[i..i + 16]).map(|j| i + j);
+            }
+            i += 16;
+        }
+        find_scalar(&bytes[i..]).map(|j| i + j)
+    }
+}
+
+/// Returns the index of the first byte of `bytes` that is escaped in HTML,
+/// comparing 32 or 16 bytes at a time where the CPU supports it.
+fn find_html(bytes: &[u8]) -> Option<usize> {
+    #[cfg(target_arch = "x86_64")]
+    {
+        if std::is_x86_feature_detected!("avx2") {
+            return unsafe { find_avx2(bytes) };
+        }
+        unsafe { find_sse2(bytes) }
+    }
+    #[cfg(target_arch = "aarch64")]
+    {
+        unsafe { find_neon(bytes) }
+    }
+    #[cfg(not(any(target_arch = "x86_64", target_arch = "aarch64")))]
+    {
+        find_scalar(bytes)
+    }
+}
+
+/// Writes `s` HTML escaped, copying runs of bytes that need no escaping as
+/// a whole. The output matches the HTML escaping of minijinja.
+pub(crate) fn write_html(out: &mut impl Write, s: &str) -> std::fmt::Result {
+    let bytes = s.as_bytes();
+    let mut start = 0;
+    while let Some(i) = find_html(&bytes[start..]) {
+        let i = start + i;
+        out.write_str(&s[start..i])?;
+        out.write_str(html_entity(bytes[i]))?;
+        start = i + 1;
+    }
+    out.write_str(&s[start..])
+}
+
+/// Serializes `value` as JSON that is safe to embed in HTML, escaping the
+/// characters that could end a script element or an attribute.
+pub(crate) fn to_json(value: &Value, pretty: bool) -> Result<String, Error> {
+    let json = match pretty {
+        true => sonic_rs::to_string_pretty(value),
+        false => sonic_rs::to_string(value),
+    }
+    .map_err(|e| Error::new(ErrorKind::BadSerialization, e.to_string()))?;
+    let mut out = String::with_capacity(json.len());
+    let mut start = 0;
+    for (i, byte) in json.bytes().enumerate() {
+        let escaped = match byte {
+            b'<' => "\\u003c",
+            b'>' => "\\u003e",
+            b'&' => "\\u0026",
+            b'\'' => "\\u0027",
+            _ => continue,
+        };
+        out.push_str(&json[start..i]);
+        out.push_str(escaped);
+        start = i + 1;
+    }
+    out.push_str(&json[start..]);
+    Ok(out)
+}
+
+/// The formatter of every environment. It escapes HTML with the vectorized
+/// escaper, adds the JSON auto-escape mode and leaves everything else to the
+/// formatter of minijinja. It also checks the deadline of the render.
+pub(crate) fn format(out: &mut Output, state: &State, value: &Value) -> Result<(), Error> {
+    limits::check()?;
+    match state.auto_escape() {
+        AutoEscape::Html if !value.is_safe() => {
+            match (value.as_str(), value.kind()) {
+                (Some(s), _) => write_html(out, s)?,
+                (
+                    None,
+                    ValueKind::Bool | ValueKind::Undefined | ValueKind::None | ValueKind::Number,
+                ) => write!(out, "{value}")?,
+                (None, _) => write_html(out, &value.to_string())?,
+            }
+            Ok(())
+        }
+        AutoEscape::Custom(JSON) if !value.is_safe() => Ok(out.write_str(&to_json(value, false)?)?),
+        AutoEscape::Custom(JSON) => Ok(write!(out, "{value}")?),
+        _ => minijinja::escape_formatter(out, state, value),
+    }
+}
+
+/// Returns the auto-escape callback for the given suffix rules. The rule
+/// with the longest matching suffix wins, and names that match no rule are
+/// escaped as minijinja does by default.
+pub(crate) fn callback(
+    rules: Vec<(String, mj_auto_escape)>,
+) -> impl Fn(&str) -> AutoEscape + Send + Sync + 'static {
+    move |name| {
+        let rule = rules
+            .iter()
+            .filter(|(suffix, _)| name.ends_with(suffix.as_str()))
+            .max_by_key(|(suffix, _)| suffix.len());
+        match rule {
+            Some((_, mj_auto_escape::MJ_AUTO_ESCAPE_NONE)) => AutoEscape::None,
+            Some((_, mj_auto_escape::MJ_AUTO_ESCAPE_HTML)) => AutoEscape::Html,
+            Some((_, mj_auto_escape::MJ_AUTO_ESCAPE_JSON)) => AutoEscape::Custom(JSON),
+            None => minijinja::default_auto_escape_callback(name),
+        }
+    }
+}
+
+/// \brief Sets how templates whose name ends with a suffix are escaped.
+///
+/// Values printed by templates matching `suffix` are escaped according to
+/// `mode`. When several suffixes match a name, the longest one applies, and
+/// setting a suffix again replaces its mode. Templates matching no suffix
+/// keep the defaults: `.html`, `.htm` and `.xml` are escaped as HTML and
+/// everything else is not escaped.
+///
+/// HTML escaping scans for the characters to escape 16 or 32 bytes at a
+/// time with SSE2, AVX2 or NEON where available, and copies the runs of
+/// text between them as a whole.
+///
+/// @param env Pointer to the environment to configure
+/// @param suffix Null-terminated suffix of template names, such as ".html"
+/// @param mode The escaping to apply to matching templates
+///
+/// \note The suffix parameter must not be NULL. An empty suffix matches
+/// every template. Values marked safe, for instance by the `safe` filter,
+/// are never escaped.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_set_auto_escape(
+    env: *mut mj_env,
+    suffix: *const c_char,
+    mode: mj_auto_escape,
+) {
+    assert!(!suffix.is_null());
+    let suffix = unsafe {
+        std::ffi::CStr::from_ptr(suffix)
+            .to_str()
+            .expect("malformed suffix")
+    };
+    let state = unsafe { &*env }.deref();
+    state.update_escape_rules(|env, rules| {
+        rules.retain(|(existing, _)| existing != suffix);
+        rules.push((suffix.to_string(), mode));
+        env.set_auto_escape_callback(callback(rules.clone()));
+    });
+}
@@ -0,0 +1,293 @@
+use std::ffi::{CString, c_char, c_void};
+use std::sync::Arc;
+
+use minijinja::value::ValueKind;
+use minijinja::{Environment, Error, ErrorKind, Expression, Value};
+
+use crate::types::mj_eval_kind;
+
+use super::*;
+
+/// \brief Represents a compiled expression that can be evaluated repeatedly.
+///
+/// @see mj_env_compile_expression This function constructs a new expression
+/// @see mj_expression_free This function frees the heap memory of the
+/// expression
+///
+/// \note Like a template handle, the expression keeps its own reference to
+/// the environment snapshot it was compiled with, so later changes to the
+/// environment, such as new filters, are not visible to it. Evaluations
+/// keep the timeout the environment had when the expression was compiled.
+///
+/// \remark The expression is safe to evaluate from multiple threads at once.
+#[repr(C)]
+pub struct mj_expression {
+    /// The pointer to the expression in the Rust code.
+    /// Only touch this on judging whether it is NULL.
+    pub inner: *mut c_void,
+}
+
+struct ExpressionHandle {
+    // Borrows from `env`, so it must be declared (and thus dropped) first.
+    expr: Expression<'static, 'static>,
+    #[allow(dead_code)]
+    env: Arc<Environment<'static>>,
+    timeout_ns: u64,
+}
+
+impl ExpressionHandle {
+    fn new(env: Arc<Environment<'static>>, source: &str, timeout_ns: u64) -> Result<Self, Error> {
+        let expr = env.compile_expression_owned(source.to_string())?;
+        // SAFETY: the expression borrows from the environment behind the
+        // `Arc`, which is kept alive (and never moved) for as long as the
+        // handle.
+        let expr = unsafe {
+            std::mem::transmute::<Expression<'_, 'static>, Expression<'static, 'static>>(expr)
+        };
+        Ok(ExpressionHandle {
+            expr,
+            env,
+            timeout_ns,
+        })
+    }
+}
+
+impl mj_expression {
+    fn deref(&self) -> &ExpressionHandle {
+        unsafe { &*(self.inner as *const ExpressionHandle) }
+    }
+}
+
+impl mj_expression {
+    /// \brief Frees the memory allocated for an expression.
+    ///
+    /// @param ptr Pointer to the expression to free
+    ///
+    /// \note It is safe to pass NULL to this function.
+    #[unsafe(no_mangle)]
+    pub unsafe extern "C" fn mj_expression_free(ptr: *mut mj_expression) {
+        unsafe {
+            if ptr.is_null() {
+                return;
+            }
+            drop(Box::from_raw((*ptr).inner as *mut ExpressionHandle));
+            drop(Box::from_raw(ptr));
+        }
+    }
+}
+
+/// \brief Result structure for expression compilation.
+///
+/// On success, the expr field contains the expression and error is NULL.
+/// On failure, expr is NULL and error contains error information.
+///
+/// @see mj_env_compile_expression Function that returns this result type
+///
+/// \note The expression is owned by the caller and must be freed using
+/// mj_expression_free, it is not released by
+/// mj_result_env_compile_expression_free.
+#[repr(C)]
+pub struct mj_result_env_compile_expression {
+    /// Pointer to the compiled expression, or NULL on failure
+    pub expr: *mut mj_expression,
+    /// Pointer to error information, or NULL on success
+    pub error: *mut mj_error,
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_result_env_compile_expression_free(
+    result: *mut mj_result_env_compile_expression,
+) {
+    if result.is_null() {
+        return;
+    }
+
+    unsafe {
+        let res = Box::from_raw(result);
+        if !res.error.is_null() {
+            drop(Box::from_raw(res.error));
+        }
+    }
+}
+
+/// \brief Result structure for expression evaluation.
+///
+/// On success, kind tells which field holds the value and error is NULL.
+/// On failure, kind is MJ_EVAL_NONE and error contains error information.
+///
+/// @see mj_expression_eval Function that returns this result type
+///
+/// \note The result, including its string, is freed using
+/// mj_result_expression_eval_free.
+#[repr(C)]
+pub struct mj_result_expression_eval {
+    /// The type of the value
+    pub kind: mj_eval_kind,
+    /// The value if kind is MJ_EVAL_BOOL
+    pub boolean: bool,
+    /// The value if kind is MJ_EVAL_INT
+    pub integer: i64,
+    /// The value if kind is MJ_EVAL_FLOAT
+    pub number: f64,
+    /// The null-terminated value if kind is MJ_EVAL_STRING or MJ_EVAL_JSON,
+    /// NULL otherwise
+    pub string: *mut c_char,
+    /// Pointer to error information, or NULL on success
+    pub error: *mut mj_error,
+}
+
+impl mj_result_expression_eval {
+    fn new(kind: mj_eval_kind) -> Self {
+        mj_result_expression_eval {
+            kind,
+            boolean: false,
+            integer: 0,
+            number: 0.0,
+            string: std::ptr::null_mut(),
+            error: std::ptr::null_mut(),
+        }
+    }
+
+    fn string(kind: mj_eval_kind, s: String) -> Self {
+        mj_result_expression_eval {
+            string: CString::new(s).expect("CString::new failed").into_raw(),
+            ..Self::new(kind)
+        }
+    }
+
+    fn ok(value: Value) -> Result<*mut Self, Error> {
+        let result = match value.kind() {
+            ValueKind::Undefined | ValueKind::None => Self::new(mj_eval_kind::MJ_EVAL_NONE),
+            ValueKind::Bool => mj_result_expression_eval {
+                boolean: value.is_true(),
+                ..Self::new(mj_eval_kind::MJ_EVAL_BOOL)
+            },
+            ValueKind::Number if value.is_integer() => match i64::try_from(value.clone()) {
+                Ok(integer) => mj_result_expression_eval {
+                    integer,
+                    ..Self::new(mj_eval_kind::MJ_EVAL_INT)
+                },
+                // Integers beyond 64 bits are only representable as JSON.
+                Err(_) => Self::string(mj_eval_kind::MJ_EVAL_JSON, value.to_string()),
+            },
+            ValueKind::Number => mj_result_expression_eval {
+                number: f64::try_from(value.clone())?,
+                ..Self::new(mj_eval_kind::MJ_EVAL_FLOAT)
+            },
+            ValueKind::String => Self::string(
+                mj_eval_kind::MJ_EVAL_STRING,
+                value.as_str().unwrap().to_string(),
+            ),
+            _ => Self::string(
+                mj_eval_kind::MJ_EVAL_JSON,
+                sonic_rs::to_string(&value)
+                    .map_err(|e| Error::new(ErrorKind::BadSerialization, e.to_string()))?,
+            ),
+        };
+        Ok(Box::into_raw(Box::new(result)))
+    }
+
+    fn err(error: *mut mj_error) -> *mut Self {
+        Box::into_raw(Box::new(mj_result_expression_eval {
+            error,
+            ..Self::new(mj_eval_kind::MJ_EVAL_NONE)
+        }))
+    }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_result_expression_eval_free(result: *mut mj_result_expression_eval) {
+    if result.is_null() {
+        return;
+    }
+
+    unsafe {
+        let res = Box::from_raw(result);
+        if !res.string.is_null() {
+            drop(CString::from_raw(res.string));
+        }
+        if !res.error.is_null() {
+            drop(Box::from_raw(res.error));
+        }
+    }
+}
+
+/// \brief Compiles an expression once for repeated evaluation.
+///
+/// Expressions use the syntax of template expressions, such as
+/// `user.age >= 18 and "beta" in user.flags`, and have access to the
+/// filters, tests, functions and globals of the environment. Evaluating a
+/// compiled expression neither parses it again nor formats its value as a
+/// string, which makes it suited to rules evaluated at a high rate.
+///
+/// @param env Pointer to the environment to compile the expression with
+/// @param source Null-terminated string containing the expression
+///
+/// @return mj_result_env_compile_expression A result structure containing
+/// the expression or error information if it does not compile.
+///
+/// \note The source parameter must not be NULL. The returned expression
+/// must be freed using mj_expression_free, and the result itself using
+/// mj_result_env_compile_expression_free.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_compile_expression(
+    env: *mut mj_env,
+    source: *const c_char,
+) -> *mut mj_result_env_compile_expression {
+    assert!(!source.is_null());
+    let source = unsafe {
+        std::ffi::CStr::from_ptr(source)
+            .to_str()
+            .expect("malformed expression")
+    };
+    let state = unsafe { &*env }.deref();
+    let (expr, error) = match ExpressionHandle::new(state.load_full(), source, state.timeout(0)) {
+        Ok(handle) => {
+            let expr = Box::into_raw(Box::new(mj_expression {
+                inner: Box::into_raw(Box::new(handle)) as *mut c_void,
+            }));
+            (expr, std::ptr::null_mut())
+        }
+        Err(e) => (std::ptr::null_mut(), mj_error::new(e)),
+    };
+    Box::into_raw(Box::new(mj_result_env_compile_expression { expr, error }))
+}
+
+/// \brief Evaluates a compiled expression with the given context.
+///
+/// Booleans, integers that fit 64 bits and floats are returned as such,
+/// strings as null-terminated strings, and everything else, such as lists
+/// and maps, as JSON. None and undefined values are returned as
+/// MJ_EVAL_NONE.
+///
+/// @param expr Pointer to the expression to evaluate
+/// @param data Pointer to the JSON encoded context
+/// @param len Length of the context in bytes
+///
+/// @return mj_result_expression_eval A result structure containing the
+/// value or error information if evaluation fails.
+///
+/// \note The returned result should be freed using
+/// mj_result_expression_eval_free when no longer needed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_expression_eval(
+    expr: *mut mj_expression,
+    data: *const u8,
+    len: usize,
+) -> *mut mj_result_expression_eval {
+    let bytes = unsafe { context::bytes(data, len) };
+    let handle = unsafe { &*expr }.deref();
+    let deadline = limits::deadline(handle.timeout_ns);
+    let value = match context::from_json(bytes) {
+        Ok(value) => value,
+        Err(e) => return mj_result_expression_eval::err(e),
+    };
+    let evaluated = match limits::evaluate(deadline, || handle.expr.eval(&value)) {
+        Ok(evaluated) => evaluated,
+        Err(e) => return mj_result_expression_eval::err(e),
+    };
+    match mj_result_expression_eval::ok(evaluated) {
+        Ok(result) => result,
+        Err(e) => mj_result_expression_eval::err(mj_error::new(e)),
+    }
+}
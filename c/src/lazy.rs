@@ -0,0 +1,211 @@
+use std::collections::HashMap;
+use std::collections::hash_map::Entry;
+use std::ops::Range;
+use std::sync::{Arc, OnceLock};
+
+use minijinja::Value;
+use minijinja::value::{Enumerator, Object, ObjectRepr};
+use serde::de::IgnoredAny;
+
+use crate::state::EnvState;
+
+use super::*;
+
+/// A JSON value that is decoded on first access, cached afterwards.
+#[derive(Debug)]
+struct Slot {
+    range: Range<usize>,
+    value: OnceLock<Value>,
+}
+
+impl Slot {
+    fn get(&self, doc: &Arc<str>) -> Value {
+        self.value
+            .get_or_init(|| decode(doc, self.range.clone()))
+            .clone()
+    }
+}
+
+/// Returns the byte range of `raw` within `doc`, which it must point into.
+fn range_of(doc: &str, raw: &str) -> Range<usize> {
+    let start = raw.as_ptr() as usize - doc.as_ptr() as usize;
+    start..start + raw.len()
+}
+
+/// Decodes the JSON value at `range` of `doc`. Objects and arrays become
+/// lazy values themselves, so only scalars are decoded right away.
+fn decode(doc: &Arc<str>, range: Range<usize>) -> Value {
+    let raw = &doc[range.clone()];
+    match raw.trim_start().as_bytes().first() {
+        Some(b'{') => Value::from_object(LazyMap {
+            doc: doc.clone(),
+            range,
+            fields: OnceLock::new(),
+        }),
+        Some(b'[') => Value::from_object(LazySeq {
+            doc: doc.clone(),
+            range,
+            items: OnceLock::new(),
+        }),
+        _ => sonic_rs::from_str::<Value>(raw).unwrap_or_default(),
+    }
+}
+
+#[derive(Debug)]
+struct Fields {
+    index: HashMap<Box<str>, usize>,
+    keys: Vec<Value>,
+    slots: Vec<Slot>,
+}
+
+/// A JSON object whose keys are located on first access and whose values
+/// are decoded on first read.
+#[derive(Debug)]
+struct LazyMap {
+    doc: Arc<str>,
+    range: Range<usize>,
+    fields: OnceLock<Fields>,
+}
+
+impl LazyMap {
+    fn fields(&self) -> &Fields {
+        self.fields.get_or_init(|| {
+            let mut fields = Fields {
+                index: HashMap::new(),
+                keys: Vec::new(),
+                slots: Vec::new(),
+            };
+            // The document was validated up front, so iterating cannot fail.
+            for (key, value) in sonic_rs::to_object_iter(&self.doc[self.range.clone()]).flatten() {
+                let slot = Slot {
+                    range: range_of(&self.doc, value.as_raw_str()),
+                    value: OnceLock::new(),
+                };
+                // Like a parsed JSON object, the last of duplicate keys wins.
+                match fields.index.entry(Box::from(&*key)) {
+                    Entry::Occupied(entry) => fields.slots[*entry.get()] = slot,
+                    Entry::Vacant(entry) => {
+                        entry.insert(fields.slots.len());
+                        fields.keys.push(Value::from(&*key));
+                        fields.slots.push(slot);
+                    }
+                }
+            }
+            // Maps parsed eagerly iterate in key order, so do the same.
+            fields.keys.sort();
+            fields
+        })
+    }
+}
+
+impl Object for LazyMap {
+    fn repr(self: &Arc<Self>) -> ObjectRepr {
+        ObjectRepr::Map
+    }
+
+    fn get_value(self: &Arc<Self>, key: &Value) -> Option<Value> {
+        let fields = self.fields();
+        let slot = &fields.slots[*fields.index.get(key.as_str()?)?];
+        Some(slot.get(&self.doc))
+    }
+
+    fn enumerate(self: &Arc<Self>) -> Enumerator {
+        Enumerator::Values(self.fields().keys.clone())
+    }
+
+    fn enumerator_len(self: &Arc<Self>) -> Option<usize> {
+        Some(self.fields().keys.len())
+    }
+}
+
+/// A JSON array whose items are located on first access and decoded on
+/// first read.
+#[derive(Debug)]
+struct LazySeq {
+    doc: Arc<str>,
+    range: Range<usize>,
+    items: OnceLock<Vec<Slot>>,
+}
+
+impl LazySeq {
+    fn items(&self) -> &[Slot] {
+        self.items.get_or_init(|| {
+            sonic_rs::to_array_iter(&self.doc[self.range.clone()])
+                .flatten()
+                .map(|value| Slot {
+                    range: range_of(&self.doc, value.as_raw_str()),
+                    value: OnceLock::new(),
+                })
+                .collect()
+        })
+    }
+}
+
+impl Object for LazySeq {
+    fn repr(self: &Arc<Self>) -> ObjectRepr {
+        ObjectRepr::Seq
+    }
+
+    fn get_value(self: &Arc<Self>, key: &Value) -> Option<Value> {
+        let slot = self.items().get(key.as_usize()?)?;
+        Some(slot.get(&self.doc))
+    }
+
+    fn enumerate(self: &Arc<Self>) -> Enumerator {
+        Enumerator::Seq(self.items().len())
+    }
+}
+
+/// Wraps a JSON encoded render context in a lazy value.
+///
+/// The context is validated and copied once, which is far cheaper than
+/// building a value tree for it. Objects and arrays then only locate their
+/// members when first accessed, and members are only decoded when a
+/// template reads them. Contexts that are not an object are parsed eagerly.
+pub(crate) fn from_json(bytes: &[u8]) -> Result<Value, *mut mj_error> {
+    let doc = match std::str::from_utf8(bytes) {
+        Ok(doc) if doc.trim_start().starts_with('{') => doc,
+        _ => return context::from_json(bytes),
+    };
+    sonic_rs::from_str::<IgnoredAny>(doc)
+        .map_err(|e| mj_error::with_code(errors::mj_code::MJ_CANNOT_DESERIALIZE, e.to_string()))?;
+    let doc: Arc<str> = Arc::from(doc);
+    let range = 0..doc.len();
+    Ok(decode(&doc, range))
+}
+
+/// Parses the JSON context of a render, lazily if `state` is in lazy mode.
+pub(crate) fn context(state: &EnvState, bytes: &[u8]) -> Result<Value, *mut mj_error> {
+    context_with(state.lazy_context(), bytes)
+}
+
+/// Parses the JSON context of a render, lazily if `lazy` is set.
+pub(crate) fn context_with(lazy: bool, bytes: &[u8]) -> Result<Value, *mut mj_error> {
+    match lazy {
+        true => from_json(bytes),
+        false => context::from_json(bytes),
+    }
+}
+
+/// \brief Sets whether render contexts are decoded lazily.
+///
+/// By default, the JSON context of a render is parsed into a complete tree
+/// of values before rendering starts. In lazy mode, the context is only
+/// validated and copied, and every object and array of it locates its
+/// members on first access, while values are decoded when a template first
+/// reads them. This removes most of the parsing and allocation cost of
+/// large contexts that templates only read a few fields of.
+///
+/// @param env Pointer to the environment to configure
+/// @param value Boolean value indicating whether to decode contexts lazily
+///
+/// \note Lazy mode applies to the contexts of all render functions of the
+/// environment, including batches. Template handles keep the mode the
+/// environment had when they were taken. It does not apply to globals,
+/// macro arguments, expression contexts or mj_value_from_json. Templates
+/// that read most of a context are faster with the default, eager mode.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_set_lazy_context(env: *mut mj_env, value: bool) {
+    let state = unsafe { &*env }.deref();
+    state.set_lazy_context(value);
+}
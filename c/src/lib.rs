@@ -5,14 +5,47 @@
 // Nearly all the functions exposed to C FFI are unsafe.
 #![allow(clippy::missing_safety_doc)]
 
+mod batch;
+mod binary;
+mod bundle;
+mod cache;
+mod context;
+mod contrib;
 mod env;
 mod errors;
+mod escape;
+mod expression;
+mod lazy;
+mod limits;
+mod loader;
+mod queue;
 mod result;
+mod state;
+mod stats;
+mod store;
+mod template;
+mod txn;
 mod types;
+mod value;
+mod variables;
+mod writer;
 
+pub use batch::{mj_buffer, mj_render_item, mj_result_env_render_batch};
+pub use bundle::mj_result_env_load_bundle;
+pub use cache::mj_render_cache_stats;
+
+pub use result::mj_result_env_get_template;
 pub use result::mj_result_env_render_template;
+pub use result::mj_result_value_from_json;
 
 pub use env::mj_env;
 pub use errors::mj_error;
+pub use limits::mj_render_limits;
+pub use stats::{mj_error_count, mj_histogram, mj_stats, mj_template_stats};
+pub use store::{mj_template_memory, mj_template_store_stats};
+pub use template::mj_template;
+pub use txn::mj_txn;
+pub use value::mj_value;
 
-pub use types::mj_undefined_behavior;
+pub use types::{mj_auto_escape, mj_undefined_behavior};
+pub use writer::mj_write_callback;
@@ -0,0 +1,259 @@
+use std::cell::Cell;
+use std::ffi::c_char;
+use std::io::{self, Write};
+use std::time::{Duration, Instant};
+
+use minijinja::{Error, ErrorKind, Template, Value};
+
+use super::*;
+
+/// Number of writes of rendered output between two checks of the deadline.
+const CHECK_INTERVAL: u32 = 64;
+
+thread_local! {
+    // The deadline of the render running on this thread, checked by the
+    // formatter on every value it writes.
+    static DEADLINE: Cell<Option<Instant>> = const { Cell::new(None) };
+}
+
+/// Makes `deadline` that of the renders on this thread until dropped, and
+/// then restores the previous one.
+struct DeadlineScope(Option<Instant>);
+
+impl DeadlineScope {
+    fn enter(deadline: Option<Instant>) -> Self {
+        DeadlineScope(DEADLINE.replace(deadline))
+    }
+}
+
+impl Drop for DeadlineScope {
+    fn drop(&mut self) {
+        DEADLINE.set(self.0);
+    }
+}
+
+/// Fails the evaluation once the deadline of the render running on this
+/// thread has passed. The formatter calls this for every value it writes,
+/// so that values printed into a block, a macro call or a filter argument,
+/// which never reach the output writer, are checked too.
+pub(crate) fn check() -> Result<(), Error> {
+    match DEADLINE.get() {
+        Some(deadline) if Instant::now() >= deadline => Err(Error::new(
+            ErrorKind::InvalidOperation,
+            "render exceeded its deadline",
+        )),
+        _ => Ok(()),
+    }
+}
+
+/// \brief Limits of a single render that override those of the environment.
+///
+/// A field of 0 keeps the limit configured on the environment, and
+/// UINT64_MAX lifts it for this render.
+///
+/// @see mj_env_render_with_limits Function that takes these limits
+#[repr(C)]
+#[derive(Clone, Copy, Default)]
+pub struct mj_render_limits {
+    /// Fuel the render may consume, see mj_env_set_fuel
+    pub fuel: u64,
+    /// Wall-clock time the render may take in nanoseconds, see mj_env_set_timeout
+    pub timeout_ns: u64,
+}
+
+/// Returns the point in time a render starting now must finish by, given a
+/// timeout in nanoseconds where 0 and u64::MAX mean no limit.
+pub(crate) fn deadline(timeout_ns: u64) -> Option<Instant> {
+    match timeout_ns {
+        0 | u64::MAX => None,
+        ns => Instant::now().checked_add(Duration::from_nanos(ns)),
+    }
+}
+
+/// Passes rendered output on to `inner` and fails the render once
+/// `deadline` passes.
+struct DeadlineWriter<W> {
+    inner: W,
+    deadline: Instant,
+    writes: u32,
+    expired: bool,
+}
+
+impl<W: Write> Write for DeadlineWriter<W> {
+    fn write(&mut self, buf: &[u8]) -> io::Result<usize> {
+        self.writes = self.writes.wrapping_add(1);
+        if self.writes % CHECK_INTERVAL == 0 && Instant::now() >= self.deadline {
+            self.expired = true;
+            return Err(io::Error::new(io::ErrorKind::TimedOut, "deadline exceeded"));
+        }
+        self.inner.write(buf)
+    }
+
+    fn flush(&mut self) -> io::Result<()> {
+        self.inner.flush()
+    }
+}
+
+fn deadline_exceeded() -> *mut mj_error {
+    mj_error::with_code(
+        errors::mj_code::MJ_DEADLINE_EXCEEDED,
+        "render exceeded its deadline".to_string(),
+    )
+}
+
+/// Renders `template` to `out` and returns it, failing with
+/// MJ_DEADLINE_EXCEEDED if the render is still running at `deadline`.
+///
+/// minijinja offers no hook into the evaluation loop, so the deadline is
+/// checked as values are printed and output is written. A render that
+/// loops without printing anything is only stopped by fuel.
+pub(crate) fn render_to_write<W: Write>(
+    template: &Template<'_, '_>,
+    value: &Value,
+    deadline: Option<Instant>,
+    mut out: W,
+) -> Result<W, *mut mj_error> {
+    let Some(deadline) = deadline else {
+        return match template.render_to_write(value, &mut out) {
+            Ok(_) => Ok(out),
+            Err(e) => Err(mj_error::new(e)),
+        };
+    };
+    if Instant::now() >= deadline {
+        return Err(deadline_exceeded());
+    }
+    let mut writer = DeadlineWriter {
+        inner: out,
+        deadline,
+        writes: 0,
+        expired: false,
+    };
+    let _scope = DeadlineScope::enter(Some(deadline));
+    match template.render_to_write(value, &mut writer) {
+        Ok(_) => Ok(writer.inner),
+        Err(_) if writer.expired || Instant::now() >= deadline => Err(deadline_exceeded()),
+        Err(e) => Err(mj_error::new(e)),
+    }
+}
+
+/// Renders `template` into a string, failing with MJ_DEADLINE_EXCEEDED if
+/// the render is still running at `deadline`.
+pub(crate) fn render(
+    template: &Template<'_, '_>,
+    value: &Value,
+    deadline: Option<Instant>,
+) -> Result<String, *mut mj_error> {
+    if deadline.is_none() {
+        return template.render(value).map_err(mj_error::new);
+    }
+    let out = render_to_write(template, value, deadline, Vec::new())?;
+    // SAFETY: minijinja only ever writes valid UTF-8.
+    Ok(unsafe { String::from_utf8_unchecked(out) })
+}
+
+/// Runs an evaluation that produces no output along the way, such as a
+/// block, a macro call or an expression, and fails it with
+/// MJ_DEADLINE_EXCEEDED if it ran past `deadline`. Values it prints are
+/// checked against the deadline as it runs.
+pub(crate) fn evaluate<T>(
+    deadline: Option<Instant>,
+    eval: impl FnOnce() -> Result<T, Error>,
+) -> Result<T, *mut mj_error> {
+    let result = {
+        let _scope = DeadlineScope::enter(deadline);
+        eval()
+    };
+    match deadline {
+        Some(deadline) if Instant::now() >= deadline => Err(deadline_exceeded()),
+        _ => result.map_err(mj_error::new),
+    }
+}
+
+/// \brief Sets the fuel every render of the environment may consume.
+///
+/// Every instruction a template executes consumes one unit of fuel, and a
+/// render that runs out of fuel fails with MJ_OUT_OF_FUEL. This bounds the
+/// work of templates that loop for too long, for example over a large
+/// context in a nested loop, regardless of whether they produce output.
+///
+/// @param env Pointer to the environment to configure
+/// @param fuel Fuel of every render, or 0 for no limit
+///
+/// \note Fuel is unlimited by default. It applies to every way of rendering
+/// a template of the environment.
+///
+/// @see mj_env_render_with_limits Overrides the fuel of a single render
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_set_fuel(env: *mut mj_env, fuel: u64) {
+    let state = unsafe { &*env }.deref();
+    state.update(|env| env.set_fuel((fuel > 0).then_some(fuel)));
+}
+
+/// \brief Sets the wall-clock time every render of the environment may take.
+///
+/// A render still running when the timeout elapses fails with
+/// MJ_DEADLINE_EXCEEDED. The deadline is checked whenever a value is
+/// printed, including into blocks and macro calls, and as output is
+/// written. Only fuel bounds the time of a loop that prints nothing, such
+/// as an accidental quadratic loop, so set fuel along with a timeout to
+/// stop those too.
+///
+/// @param env Pointer to the environment to configure
+/// @param timeout_ns Timeout of every render in nanoseconds, or 0 for no limit
+///
+/// \note There is no timeout by default. It applies to every way of
+/// rendering a template of the environment, and to the evaluation of
+/// expressions. Template and expression handles keep the timeout the
+/// environment had when they were created. Expressions print nothing
+/// while they run, so they are only checked once they finish.
+///
+/// @see mj_env_render_with_limits Overrides the timeout of a single render
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_set_timeout(env: *mut mj_env, timeout_ns: u64) {
+    let state = unsafe { &*env }.deref();
+    state.set_timeout(timeout_ns);
+}
+
+/// \brief Renders a template stored in the environment with its own limits.
+///
+/// Works like mj_env_render, except that the fuel and timeout of `limits`
+/// replace those configured on the environment for this render only.
+///
+/// @param env Pointer to the environment holding the template
+/// @param name Null-terminated string containing the name of the template
+/// @param data Pointer to the JSON encoded context
+/// @param len Length of the context in bytes
+/// @param limits Pointer to the limits of this render
+///
+/// @return mj_result_env_render_template A result structure containing the
+/// rendered string or error information if rendering fails, including
+/// MJ_OUT_OF_FUEL and MJ_DEADLINE_EXCEEDED when a limit is exceeded.
+///
+/// \note The name and limits parameters must not be NULL. The returned
+/// result should be freed using mj_result_env_render_template_free when no
+/// longer needed.
+///
+/// \remark Overriding the fuel renders a copy of the environment with that
+/// fuel. The first render with a given fuel after each change of the
+/// environment makes the copy, which costs about as much as adding a
+/// template. The copies of the last four fuel values are kept, so renders
+/// that keep to a few values share them.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_render_with_limits(
+    env: *mut mj_env,
+    name: *const c_char,
+    data: *const u8,
+    len: usize,
+    limits: *const mj_render_limits,
+) -> *mut mj_result_env_render_template {
+    assert!(!name.is_null());
+    assert!(!limits.is_null());
+    let bytes = unsafe { context::bytes(data, len) };
+    let name = unsafe {
+        std::ffi::CStr::from_ptr(name)
+            .to_str()
+            .expect("malformed name")
+    };
+    let state = unsafe { &*env }.deref();
+    crate::env::render(state, name, bytes, unsafe { *limits })
+}
@@ -0,0 +1,158 @@
+use std::ffi::c_char;
+use std::io;
+use std::path::{Path, PathBuf};
+use std::sync::Arc;
+
+use minijinja::{Environment, Error, ErrorKind};
+
+use crate::bundle::Bundle;
+use crate::store::TemplateStore;
+
+use super::*;
+
+/// The sources an environment loads templates from on demand, the first
+/// time they are rendered or included. Templates added explicitly always
+/// take precedence, including those evicted from the template store.
+#[derive(Clone)]
+pub(crate) struct LoaderState {
+    /// The templates added explicitly, for those that were evicted.
+    templates: Arc<TemplateStore>,
+    /// Bundles searched before any directory, the most recent one first.
+    bundles: Vec<Arc<Bundle>>,
+    /// Directories searched in order for a template of the requested name.
+    paths: Vec<PathBuf>,
+}
+
+impl LoaderState {
+    pub(crate) fn new(templates: Arc<TemplateStore>) -> Self {
+        LoaderState {
+            templates,
+            bundles: Vec::new(),
+            paths: Vec::new(),
+        }
+    }
+
+    fn load(&self, name: &str) -> Result<Option<String>, Error> {
+        if let Some(source) = self.templates.recompile(name) {
+            return Ok(Some(source));
+        }
+        for bundle in &self.bundles {
+            if let Some(source) = bundle.source(name) {
+                return Ok(Some(source.to_string()));
+            }
+        }
+        for base in &self.paths {
+            let Some(path) = safe_join(base, name) else {
+                return Ok(None);
+            };
+            match std::fs::read_to_string(&path) {
+                Ok(source) => return Ok(Some(source)),
+                Err(e) if e.kind() == io::ErrorKind::NotFound => continue,
+                Err(e) => {
+                    return Err(Error::new(
+                        ErrorKind::InvalidOperation,
+                        format!("could not read template {}", path.display()),
+                    )
+                    .with_source(e));
+                }
+            }
+        }
+        Ok(None)
+    }
+
+    /// Makes the templates of `bundle` take precedence over all other
+    /// loader sources.
+    pub(crate) fn add_bundle(&mut self, bundle: Bundle) {
+        self.bundles.insert(0, Arc::new(bundle));
+    }
+
+    /// Replaces the store that evicted templates are loaded from.
+    pub(crate) fn set_templates(&mut self, templates: Arc<TemplateStore>) {
+        self.templates = templates;
+    }
+
+    /// Returns whether the loader has anything to load, and so has been
+    /// installed.
+    pub(crate) fn installed(&self) -> bool {
+        !self.bundles.is_empty() || !self.paths.is_empty() || self.templates.active()
+    }
+
+    /// Installs the loader on `env`, replacing the previous one. Templates
+    /// that were already loaded stay cached.
+    pub(crate) fn install(&self, env: &mut Environment<'static>) {
+        let state = Arc::new(self.clone());
+        env.set_loader(move |name| state.load(name));
+    }
+}
+
+/// Joins a template name onto a search path, refusing names that would
+/// escape it.
+fn safe_join(base: &Path, name: &str) -> Option<PathBuf> {
+    let mut path = base.to_path_buf();
+    for segment in name.split('/') {
+        if segment.starts_with('.') || segment.contains('\\') {
+            return None;
+        }
+        if !segment.is_empty() {
+            path.push(segment);
+        }
+    }
+    Some(path)
+}
+
+/// \brief Points the environment at a directory of templates.
+///
+/// Templates that are not added explicitly are looked up in the directory
+/// the first time they are rendered or included, read and compiled once.
+/// Template names are paths relative to the directory, using '/' as
+/// separator; names that would escape it are treated as not found.
+///
+/// This function replaces all previously configured search paths.
+///
+/// @param env Pointer to the environment to configure
+/// @param path Null-terminated string containing the directory path
+///
+/// \note The path parameter must not be NULL. Templates that were already
+/// loaded stay cached.
+///
+/// @see mj_env_add_loader_path Adds a further search path
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_set_loader_path(env: *mut mj_env, path: *const c_char) {
+    assert!(!path.is_null());
+    let path = unsafe {
+        std::ffi::CStr::from_ptr(path)
+            .to_str()
+            .expect("malformed path")
+    };
+    let state = unsafe { &*env }.deref();
+    state.update_loader(|env, loader| {
+        loader.paths = vec![PathBuf::from(path)];
+        loader.install(env);
+    });
+}
+
+/// \brief Adds a directory to the template search paths of the environment.
+///
+/// Search paths are tried in the order they were added, and the first one
+/// containing a template of the requested name wins.
+///
+/// @param env Pointer to the environment to configure
+/// @param path Null-terminated string containing the directory path
+///
+/// \note The path parameter must not be NULL.
+///
+/// @see mj_env_set_loader_path For how templates are loaded
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_add_loader_path(env: *mut mj_env, path: *const c_char) {
+    assert!(!path.is_null());
+    let path = unsafe {
+        std::ffi::CStr::from_ptr(path)
+            .to_str()
+            .expect("malformed path")
+    };
+    let state = unsafe { &*env }.deref();
+    state.update_loader(|env, loader| {
+        loader.paths.push(PathBuf::from(path));
+        loader.install(env);
+    });
+}
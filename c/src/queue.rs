@@ -0,0 +1,364 @@
+use std::ffi::{CStr, c_char, c_void};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, Condvar, Mutex};
+
+use crate::limits::mj_render_limits;
+use crate::state::EnvState;
+
+use super::*;
+
+/// \brief A completed render of a queue.
+///
+/// @see mj_completion_ring The ring completions are published to
+#[repr(C)]
+pub struct mj_completion {
+    /// The id the render was submitted with
+    pub id: u64,
+    /// The result of the render, to be freed using
+    /// mj_result_env_render_template_free
+    pub result: *mut mj_result_env_render_template,
+}
+
+/// \brief A single-consumer ring the renders of a queue are published to.
+///
+/// Workers append completions at `tail`, and the consumer takes them from
+/// `head`. Both counters only grow, and completion `i` is stored in slot
+/// `i & (capacity - 1)`. The ring lives in native memory, so the consumer
+/// reads completions without calling into the library:
+///
+/// 1. Load `tail` atomically. Every completion from `head` up to `tail` is
+///    ready to be read.
+/// 2. Read and handle the completions, freeing their results.
+/// 3. Store the new `head` atomically, then load `tail` again. If it moved,
+///    continue with step 2. Otherwise, wait for the notifier of the queue
+///    before starting over.
+///
+/// All loads and stores of `head` and `tail` must be sequentially
+/// consistent. Workers only signal the notifier when they publish to a ring
+/// that the consumer has drained, which is what step 3 relies on.
+///
+/// @see mj_queue The queue that owns the ring
+#[repr(C)]
+pub struct mj_completion_ring {
+    /// Pointer to the array of slots
+    pub slots: *mut mj_completion,
+    /// Number of slots, a power of two
+    pub capacity: usize,
+    /// Number of completions taken by the consumer, written by it only
+    pub head: AtomicU64,
+    /// Number of completions published by workers, written by them only
+    pub tail: AtomicU64,
+}
+
+/// \brief A queue of renders that a native worker pool performs in the
+/// background.
+///
+/// Submitting a render with mj_queue_submit only copies its name and
+/// context and returns, so no thread of the caller is held up while it
+/// renders. Workers publish the results to `ring`, and signal `notify_fd`
+/// when the consumer has drained the ring, so that a consumer can wait for
+/// completions with poll, epoll or an event loop.
+///
+/// @see mj_env_queue_new This function constructs a new queue
+/// @see mj_queue_free This function frees the queue
+///
+/// \note Renders use the environment the queue was created from, which
+/// must outlive the queue. A queue has a single consumer.
+#[repr(C)]
+pub struct mj_queue {
+    /// The pointer to the queue in the Rust code.
+    /// Only touch this on judging whether it is NULL.
+    pub inner: *mut c_void,
+    /// Pointer to the completion ring
+    pub ring: *mut mj_completion_ring,
+    /// A non-blocking file descriptor that becomes readable when renders
+    /// complete: an eventfd on Linux and the read end of a pipe on other
+    /// Unix systems. -1 where neither is available, in which case the
+    /// consumer has to poll the ring. Read it to reset it.
+    pub notify_fd: i32,
+}
+
+/// Signals the consumer of a queue through a file descriptor.
+struct Notifier {
+    read_fd: i32,
+    write_fd: i32,
+}
+
+impl Notifier {
+    #[cfg(target_os = "linux")]
+    fn new() -> Self {
+        let fd = unsafe { libc::eventfd(0, libc::EFD_NONBLOCK | libc::EFD_CLOEXEC) };
+        Notifier {
+            read_fd: fd,
+            write_fd: fd,
+        }
+    }
+
+    #[cfg(all(unix, not(target_os = "linux")))]
+    fn new() -> Self {
+        let mut fds = [-1; 2];
+        if unsafe { libc::pipe(fds.as_mut_ptr()) } != 0 {
+            return Notifier {
+                read_fd: -1,
+                write_fd: -1,
+            };
+        }
+        for fd in fds {
+            unsafe {
+                libc::fcntl(fd, libc::F_SETFL, libc::O_NONBLOCK);
+                libc::fcntl(fd, libc::F_SETFD, libc::FD_CLOEXEC);
+            }
+        }
+        Notifier {
+            read_fd: fds[0],
+            write_fd: fds[1],
+        }
+    }
+
+    #[cfg(not(unix))]
+    fn new() -> Self {
+        Notifier {
+            read_fd: -1,
+            write_fd: -1,
+        }
+    }
+
+    fn notify(&self) {
+        #[cfg(unix)]
+        if self.write_fd >= 0 {
+            // A full eventfd or pipe already wakes the consumer, so the
+            // result is ignored.
+            let one = 1u64.to_ne_bytes();
+            let len = if self.read_fd == self.write_fd { 8 } else { 1 };
+            unsafe { libc::write(self.write_fd, one.as_ptr() as *const c_void, len) };
+        }
+    }
+}
+
+impl Drop for Notifier {
+    fn drop(&mut self) {
+        #[cfg(unix)]
+        unsafe {
+            if self.read_fd >= 0 {
+                libc::close(self.read_fd);
+            }
+            if self.write_fd >= 0 && self.write_fd != self.read_fd {
+                libc::close(self.write_fd);
+            }
+        }
+    }
+}
+
+/// The part of a queue shared with its workers.
+struct Shared {
+    state: *const EnvState,
+    ring: *mut mj_completion_ring,
+    // Serializes workers publishing to the ring.
+    publishing: Mutex<()>,
+    notifier: Notifier,
+    // The number of renders that have not been published yet.
+    rendering: Mutex<usize>,
+    idle: Condvar,
+}
+
+// SAFETY: the environment state is shared between threads anyway, and the
+// ring is only written by workers under the `publishing` lock.
+unsafe impl Send for Shared {}
+unsafe impl Sync for Shared {}
+
+impl Shared {
+    fn ring(&self) -> &mj_completion_ring {
+        unsafe { &*self.ring }
+    }
+
+    fn publish(&self, id: u64, result: *mut mj_result_env_render_template) {
+        let ring = self.ring();
+        {
+            let _guard = self.publishing.lock().unwrap();
+            let tail = ring.tail.load(Ordering::Relaxed);
+            let slot = (tail as usize) & (ring.capacity - 1);
+            unsafe { ring.slots.add(slot).write(mj_completion { id, result }) };
+            ring.tail.store(tail + 1, Ordering::SeqCst);
+            // The consumer stores head before it checks tail again, so if it
+            // has not seen this completion, it has drained everything before
+            // it and is about to wait.
+            if ring.head.load(Ordering::SeqCst) == tail {
+                self.notifier.notify();
+            }
+        }
+        let mut rendering = self.rendering.lock().unwrap();
+        *rendering -= 1;
+        if *rendering == 0 {
+            self.idle.notify_all();
+        }
+    }
+}
+
+struct Queue {
+    shared: Arc<Shared>,
+    pool: rayon::ThreadPool,
+    // The number of renders submitted so far, to bound them by the number
+    // of slots the consumer has freed.
+    submitted: AtomicU64,
+}
+
+impl mj_queue {
+    fn deref(&self) -> &Queue {
+        unsafe { &*(self.inner as *const Queue) }
+    }
+}
+
+impl mj_queue {
+    /// \brief Frees a queue.
+    ///
+    /// Waits for the renders in progress to finish, then frees the results
+    /// that the consumer has not taken from the ring, the ring and the
+    /// notifier.
+    ///
+    /// @param ptr Pointer to the queue to free
+    ///
+    /// \note It is safe to pass NULL to this function.
+    #[unsafe(no_mangle)]
+    pub unsafe extern "C" fn mj_queue_free(ptr: *mut mj_queue) {
+        unsafe {
+            if ptr.is_null() {
+                return;
+            }
+            let queue = Box::from_raw((*ptr).inner as *mut Queue);
+            {
+                let shared = &queue.shared;
+                let mut rendering = shared.rendering.lock().unwrap();
+                while *rendering > 0 {
+                    rendering = shared.idle.wait(rendering).unwrap();
+                }
+            }
+            let Queue { shared, pool, .. } = *queue;
+            drop(pool);
+            let ring = Box::from_raw(shared.ring);
+            let slots = Box::from_raw(std::ptr::slice_from_raw_parts_mut(
+                ring.slots,
+                ring.capacity,
+            ));
+            let tail = ring.tail.load(Ordering::SeqCst);
+            for i in ring.head.load(Ordering::SeqCst)..tail {
+                let completion = &slots[(i as usize) & (ring.capacity - 1)];
+                result::mj_result_env_render_template_free(completion.result);
+            }
+            drop(Box::from_raw(ptr));
+        }
+    }
+}
+
+/// \brief Creates a queue of background renders on the environment.
+///
+/// @param env Pointer to the environment to render with
+/// @param capacity Maximum number of renders submitted but not yet taken
+/// from the ring, rounded up to a power of two
+/// @param workers Number of worker threads, 0 for one per CPU core
+///
+/// @return mj_queue A pointer to the new queue, or NULL if the worker
+/// threads cannot be started.
+///
+/// \note The queue must be freed using mj_queue_free before the
+/// environment.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_queue_new(
+    env: *mut mj_env,
+    capacity: usize,
+    workers: usize,
+) -> *mut mj_queue {
+    let state = unsafe { &*env }.deref() as *const EnvState;
+    let capacity = capacity.max(1).next_power_of_two();
+    let Ok(pool) = rayon::ThreadPoolBuilder::new()
+        .num_threads(workers)
+        .thread_name(|i| format!("mj-queue-{i}"))
+        .build()
+    else {
+        return std::ptr::null_mut();
+    };
+
+    let slots: Box<[mj_completion]> = (0..capacity)
+        .map(|_| mj_completion {
+            id: 0,
+            result: std::ptr::null_mut(),
+        })
+        .collect();
+    let ring = Box::into_raw(Box::new(mj_completion_ring {
+        slots: Box::into_raw(slots) as *mut mj_completion,
+        capacity,
+        head: AtomicU64::new(0),
+        tail: AtomicU64::new(0),
+    }));
+    let notifier = Notifier::new();
+    let notify_fd = notifier.read_fd;
+    let queue = Queue {
+        shared: Arc::new(Shared {
+            state,
+            ring,
+            publishing: Mutex::new(()),
+            notifier,
+            rendering: Mutex::new(0),
+            idle: Condvar::new(),
+        }),
+        pool,
+        submitted: AtomicU64::new(0),
+    };
+    Box::into_raw(Box::new(mj_queue {
+        inner: Box::into_raw(Box::new(queue)) as *mut c_void,
+        ring,
+        notify_fd,
+    }))
+}
+
+/// \brief Submits a render to a queue.
+///
+/// The name and context are copied, so they may be released as soon as the
+/// call returns. A worker renders the template like mj_env_render does and
+/// publishes the result to the ring of the queue under `id`.
+///
+/// @param queue Pointer to the queue
+/// @param id Identifier of the render, returned with its completion
+/// @param name Null-terminated string containing the name of the template
+/// @param data Pointer to the JSON encoded context
+/// @param len Length of the context in bytes
+///
+/// @return true if the render was submitted, false if the queue is full
+/// because as many completions as the ring has slots are pending. Take
+/// completions from the ring and submit again.
+///
+/// \note The name parameter must not be NULL. Submitting to a queue from
+/// several threads at once is safe.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_queue_submit(
+    queue: *mut mj_queue,
+    id: u64,
+    name: *const c_char,
+    data: *const u8,
+    len: usize,
+) -> bool {
+    assert!(!name.is_null());
+    let name = unsafe { CStr::from_ptr(name).to_str().expect("malformed name") }.to_string();
+    let bytes = unsafe { context::bytes(data, len) }.to_vec();
+    let queue = unsafe { &*queue }.deref();
+    let shared = &queue.shared;
+
+    let capacity = shared.ring().capacity as u64;
+    let reserved = queue
+        .submitted
+        .fetch_update(Ordering::SeqCst, Ordering::SeqCst, |submitted| {
+            (submitted - shared.ring().head.load(Ordering::SeqCst) < capacity)
+                .then_some(submitted + 1)
+        });
+    if reserved.is_err() {
+        return false;
+    }
+
+    *shared.rendering.lock().unwrap() += 1;
+    let shared = shared.clone();
+    queue.pool.spawn(move || {
+        let state = unsafe { &*shared.state };
+        let result = env::render(state, &name, &bytes, mj_render_limits::default());
+        shared.publish(id, result);
+    });
+    true
+}
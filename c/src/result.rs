@@ -1,4 +1,4 @@
-use std::ffi::c_char;
+use std::ffi::{CString, c_char};
 
 use super::*;
 
@@ -20,6 +20,24 @@ pub struct mj_result_env_render_template {
     pub error: *mut mj_error,
 }
 
+impl mj_result_env_render_template {
+    pub(crate) fn ok(rendered: String) -> *mut Self {
+        Box::into_raw(Box::new(mj_result_env_render_template {
+            result: CString::new(rendered)
+                .expect("CString::new failed")
+                .into_raw(),
+            error: std::ptr::null_mut(),
+        }))
+    }
+
+    pub(crate) fn err(error: *mut mj_error) -> *mut Self {
+        Box::into_raw(Box::new(mj_result_env_render_template {
+            result: std::ptr::null_mut(),
+            error,
+        }))
+    }
+}
+
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn mj_result_env_render_template_free(
     result: *mut mj_result_env_render_template,
@@ -32,7 +50,7 @@ pub unsafe extern "C" fn mj_result_env_render_template_free(
         let res = &mut *result;
 
         if !res.result.is_null() {
-            drop(std::ffi::CString::from_raw(res.result));
+            drop(CString::from_raw(res.result));
         }
 
         if !res.error.is_null() {
@@ -41,3 +59,101 @@ pub unsafe extern "C" fn mj_result_env_render_template_free(
         drop(Box::from_raw(result));
     }
 }
+
+/// \brief Result structure for template lookup functions.
+///
+/// On success, the tmpl field contains the template handle and error is NULL.
+/// On failure, tmpl is NULL and error contains error information.
+///
+/// @see mj_env_get_template Function that returns this result type
+///
+/// \note The template handle is owned by the caller and must be freed using
+/// mj_template_free, it is not released by mj_result_env_get_template_free.
+#[repr(C)]
+pub struct mj_result_env_get_template {
+    /// Pointer to the template handle, or NULL on failure
+    pub tmpl: *mut mj_template,
+    /// Pointer to error information, or NULL on success
+    pub error: *mut mj_error,
+}
+
+impl mj_result_env_get_template {
+    pub(crate) fn ok(tmpl: *mut mj_template) -> *mut Self {
+        Box::into_raw(Box::new(mj_result_env_get_template {
+            tmpl,
+            error: std::ptr::null_mut(),
+        }))
+    }
+
+    pub(crate) fn err(error: *mut mj_error) -> *mut Self {
+        Box::into_raw(Box::new(mj_result_env_get_template {
+            tmpl: std::ptr::null_mut(),
+            error,
+        }))
+    }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_result_env_get_template_free(result: *mut mj_result_env_get_template) {
+    if result.is_null() {
+        return;
+    }
+
+    unsafe {
+        let res = &mut *result;
+
+        if !res.error.is_null() {
+            mj_error::mj_error_free(res.error);
+        }
+        drop(Box::from_raw(result));
+    }
+}
+
+/// \brief Result structure for context value construction functions.
+///
+/// On success, the value field contains the parsed value and error is NULL.
+/// On failure, value is NULL and error contains error information.
+///
+/// @see mj_value_from_json Function that returns this result type
+///
+/// \note The value is owned by the caller and must be freed using
+/// mj_value_free, it is not released by mj_result_value_from_json_free.
+#[repr(C)]
+pub struct mj_result_value_from_json {
+    /// Pointer to the parsed value, or NULL on failure
+    pub value: *mut mj_value,
+    /// Pointer to error information, or NULL on success
+    pub error: *mut mj_error,
+}
+
+impl mj_result_value_from_json {
+    pub(crate) fn ok(value: *mut mj_value) -> *mut Self {
+        Box::into_raw(Box::new(mj_result_value_from_json {
+            value,
+            error: std::ptr::null_mut(),
+        }))
+    }
+
+    pub(crate) fn err(error: *mut mj_error) -> *mut Self {
+        Box::into_raw(Box::new(mj_result_value_from_json {
+            value: std::ptr::null_mut(),
+            error,
+        }))
+    }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_result_value_from_json_free(result: *mut mj_result_value_from_json) {
+    if result.is_null() {
+        return;
+    }
+
+    unsafe {
+        let res = &mut *result;
+
+        if !res.error.is_null() {
+            mj_error::mj_error_free(res.error);
+        }
+        drop(Box::from_raw(result));
+    }
+}
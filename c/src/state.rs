@@ -0,0 +1,387 @@
+use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+use std::sync::{Arc, Condvar, Mutex};
+
+use arc_swap::{ArcSwap, ArcSwapOption, Guard};
+use minijinja::Environment;
+
+use crate::cache::RenderCache;
+use crate::loader::LoaderState;
+use crate::stats::Stats;
+use crate::store::TemplateStore;
+use crate::types::mj_auto_escape;
+use crate::variables::VariablesCache;
+
+/// The state behind an mj_env: an immutable environment snapshot that is
+/// swapped atomically on every change.
+///
+/// Readers load the current snapshot without taking a lock and keep
+/// rendering it even while a writer publishes a new one. Writers clone the
+/// snapshot, apply their change and publish the result. They are serialized
+/// among themselves so that no update is lost, but never block readers.
+pub(crate) struct EnvState {
+    current: ArcSwap<Environment<'static>>,
+    // Counts published snapshots. Bumped after the snapshot is stored, so a
+    // reader that loads it before the snapshot never pairs a generation
+    // with an older snapshot.
+    generation: AtomicU64,
+    // A writer lock that, unlike a MutexGuard, can be held across FFI calls
+    // by a transaction.
+    writing: Mutex<bool>,
+    writable: Condvar,
+    // The sources the installed loader reads from, kept to derive the next
+    // loader when they change. Only touched by writers.
+    loader: Mutex<LoaderState>,
+    // The auto-escape mode per template name suffix, kept to derive the
+    // next auto-escape callback when they change. Only touched by writers.
+    escape_rules: Mutex<Vec<(String, mj_auto_escape)>>,
+    stats: Stats,
+    render_cache: ArcSwapOption<RenderCache>,
+    // The default timeout of renders in nanoseconds, 0 for none.
+    timeout_ns: AtomicU64,
+    // Copies of the current snapshot with the fuel of the renders that
+    // overrode it, most recently used last.
+    fueled: Mutex<Fueled>,
+    // Whether render contexts are decoded lazily.
+    lazy_context: AtomicBool,
+    variables: VariablesCache,
+    // The templates added explicitly, shared with the loader, which
+    // compiles them again once they are evicted.
+    templates: Arc<TemplateStore>,
+    // Whether an eviction handed off by a render is pending on the worker
+    // pool, which must finish before the state is dropped.
+    evicting: Mutex<bool>,
+    evicted: Condvar,
+}
+
+/// A state that an eviction on the worker pool borrows.
+struct StatePtr(*const EnvState);
+
+// SAFETY: the state is only read through shared references, and it is not
+// dropped while an eviction is pending.
+unsafe impl Send for StatePtr {}
+
+/// The number of fuel overrides whose snapshot copies are kept at once.
+const FUELED_CAPACITY: usize = 4;
+
+/// Copies of the snapshot of one generation with different fuel settings.
+#[derive(Default)]
+struct Fueled {
+    generation: u64,
+    envs: Vec<(u64, Arc<Environment<'static>>)>,
+}
+
+impl Drop for EnvState {
+    fn drop(&mut self) {
+        let mut evicting = self.evicting.lock().unwrap();
+        while *evicting {
+            evicting = self.evicted.wait(evicting).unwrap();
+        }
+    }
+}
+
+/// Releases the writer lock of an EnvState when dropped.
+pub(crate) struct WriterGuard<'a> {
+    state: &'a EnvState,
+}
+
+impl WriterGuard<'_> {
+    /// Returns a private copy of the current snapshot to apply changes to.
+    pub(crate) fn snapshot(&self) -> Environment<'static> {
+        Environment::clone(&self.state.current.load())
+    }
+
+    /// Publishes `env` as the new snapshot and releases the writer lock.
+    pub(crate) fn publish(self, env: Environment<'static>) {
+        self.state.current.store(Arc::new(env));
+        self.state.generation.fetch_add(1, Ordering::Release);
+    }
+
+    /// Publishes `env` as the new snapshot without starting a new
+    /// generation, for changes that leave the output of every render as it
+    /// is, and releases the writer lock.
+    pub(crate) fn publish_unchanged(self, env: Environment<'static>) {
+        self.state.current.store(Arc::new(env));
+        // The fueled copies would keep what the change released alive.
+        self.state.fueled.lock().unwrap().envs.clear();
+    }
+}
+
+impl Drop for WriterGuard<'_> {
+    fn drop(&mut self) {
+        *self.state.writing.lock().unwrap() = false;
+        self.state.writable.notify_one();
+    }
+}
+
+impl EnvState {
+    pub(crate) fn new(env: Environment<'static>) -> Self {
+        let templates = Arc::new(TemplateStore::default());
+        EnvState {
+            current: ArcSwap::from_pointee(env),
+            generation: AtomicU64::new(0),
+            writing: Mutex::new(false),
+            writable: Condvar::new(),
+            loader: Mutex::new(LoaderState::new(templates.clone())),
+            escape_rules: Mutex::default(),
+            stats: Stats::default(),
+            render_cache: ArcSwapOption::empty(),
+            timeout_ns: AtomicU64::new(0),
+            fueled: Mutex::default(),
+            lazy_context: AtomicBool::new(false),
+            variables: VariablesCache::default(),
+            templates,
+            evicting: Mutex::new(false),
+            evicted: Condvar::new(),
+        }
+    }
+
+    /// Returns a new state that starts out with the current snapshot of this
+    /// one. The snapshot itself is shared, not copied: both states render
+    /// the same compiled templates until either of them is changed, which
+    /// only ever affects the state that was changed.
+    pub(crate) fn fork(&self) -> Self {
+        // Hold the writer lock so the snapshot and the loader sources match.
+        let _guard = self.lock_writer();
+        // The loader of the snapshot reads evicted templates from the store
+        // of this state, so the child gets its own copy of both.
+        let templates = Arc::new(self.templates.fork());
+        let mut loader = self.loader.lock().unwrap().clone();
+        let installed = loader.installed();
+        loader.set_templates(templates.clone());
+        let mut current = self.current.load_full();
+        if installed {
+            let mut env = Environment::clone(&current);
+            loader.install(&mut env);
+            current = Arc::new(env);
+        }
+        EnvState {
+            current: ArcSwap::new(current),
+            generation: AtomicU64::new(0),
+            writing: Mutex::new(false),
+            writable: Condvar::new(),
+            loader: Mutex::new(loader),
+            escape_rules: Mutex::new(self.escape_rules.lock().unwrap().clone()),
+            stats: self.stats.fork(),
+            render_cache: ArcSwapOption::new(
+                self.render_cache
+                    .load()
+                    .as_ref()
+                    .map(|cache| Arc::new(RenderCache::new(cache.budget()))),
+            ),
+            timeout_ns: AtomicU64::new(self.timeout_ns.load(Ordering::Relaxed)),
+            fueled: Mutex::default(),
+            lazy_context: AtomicBool::new(self.lazy_context.load(Ordering::Relaxed)),
+            variables: VariablesCache::default(),
+            templates,
+            evicting: Mutex::new(false),
+            evicted: Condvar::new(),
+        }
+    }
+
+    /// Returns the generation of the current snapshot. Load it before the
+    /// snapshot it is meant to describe.
+    pub(crate) fn generation(&self) -> u64 {
+        self.generation.load(Ordering::Acquire)
+    }
+
+    /// Returns the render cache, if enabled.
+    pub(crate) fn render_cache(&self) -> Guard<Option<Arc<RenderCache>>> {
+        self.render_cache.load()
+    }
+
+    /// Replaces the render cache with an empty one of `budget` bytes, or
+    /// disables it if `budget` is 0.
+    pub(crate) fn set_render_cache(&self, budget: usize) {
+        let cache = (budget > 0).then(|| Arc::new(RenderCache::new(budget)));
+        self.render_cache.store(cache);
+    }
+
+    /// Returns the timeout of a render in nanoseconds: `timeout_ns` if it
+    /// is not 0, or the default timeout otherwise.
+    pub(crate) fn timeout(&self, timeout_ns: u64) -> u64 {
+        match timeout_ns {
+            0 => self.timeout_ns.load(Ordering::Relaxed),
+            ns => ns,
+        }
+    }
+
+    /// Sets the default timeout of renders in nanoseconds, 0 for none.
+    pub(crate) fn set_timeout(&self, timeout_ns: u64) {
+        self.timeout_ns.store(timeout_ns, Ordering::Relaxed);
+    }
+
+    /// Returns whether render contexts are decoded lazily.
+    pub(crate) fn lazy_context(&self) -> bool {
+        self.lazy_context.load(Ordering::Relaxed)
+    }
+
+    /// Sets whether render contexts are decoded lazily.
+    pub(crate) fn set_lazy_context(&self, lazy: bool) {
+        self.lazy_context.store(lazy, Ordering::Relaxed);
+    }
+
+    /// Returns a copy of the current snapshot whose renders may consume
+    /// `fuel`, or any amount if `fuel` is u64::MAX.
+    ///
+    /// Making a copy clones the whole snapshot, so the copies of the last
+    /// few fuel overrides are kept until the snapshot changes, and repeated
+    /// renders with any of them share a copy.
+    pub(crate) fn fueled(&self, fuel: u64) -> Arc<Environment<'static>> {
+        let generation = self.generation();
+        {
+            let mut fueled = self.fueled.lock().unwrap();
+            if fueled.generation == generation {
+                if let Some(at) = fueled.envs.iter().position(|(f, _)| *f == fuel) {
+                    let entry = fueled.envs.remove(at);
+                    let env = entry.1.clone();
+                    fueled.envs.push(entry);
+                    return env;
+                }
+            }
+        }
+        // Copy outside the lock, so renders with other overrides go on.
+        let mut env = Environment::clone(&self.current.load());
+        env.set_fuel((fuel != u64::MAX).then_some(fuel));
+        let env = Arc::new(env);
+        let mut fueled = self.fueled.lock().unwrap();
+        if fueled.generation > generation {
+            // A render of a newer snapshot got here first.
+            return env;
+        }
+        if fueled.generation < generation {
+            fueled.generation = generation;
+            fueled.envs.clear();
+        }
+        fueled.envs.retain(|(f, _)| *f != fuel);
+        if fueled.envs.len() == FUELED_CAPACITY {
+            fueled.envs.remove(0);
+        }
+        fueled.envs.push((fuel, env.clone()));
+        env
+    }
+
+    /// Returns the cached variables of the templates of this state.
+    pub(crate) fn variables(&self) -> &VariablesCache {
+        &self.variables
+    }
+
+    /// Returns the store of the templates added to this state.
+    pub(crate) fn templates(&self) -> &TemplateStore {
+        &self.templates
+    }
+
+    /// Records a use of the template `name`. If the compiled templates
+    /// exceed the template budget, such as after the render compiled an
+    /// evicted one again, the least recently used ones are evicted on the
+    /// worker pool, off the render.
+    pub(crate) fn template_used(&self, name: &str) {
+        self.templates.touch(name);
+        if self.templates.over_budget() {
+            self.evict_later();
+        }
+    }
+
+    /// Evicts templates on the global worker pool, unless an eviction is
+    /// already pending.
+    fn evict_later(&self) {
+        let mut evicting = self.evicting.lock().unwrap();
+        if *evicting {
+            return;
+        }
+        *evicting = true;
+        let state = StatePtr(self);
+        rayon::spawn(move || {
+            let state = unsafe { &*state.0 };
+            state.templates.enforce(state);
+            // Notified while locked, as the state may be dropped as soon as
+            // the lock is released.
+            let mut evicting = state.evicting.lock().unwrap();
+            *evicting = false;
+            state.evicted.notify_all();
+        });
+    }
+
+    /// Returns the render metrics of this state.
+    pub(crate) fn stats(&self) -> &Stats {
+        &self.stats
+    }
+
+    /// Returns the current snapshot for the duration of a single call.
+    pub(crate) fn load(&self) -> Guard<Arc<Environment<'static>>> {
+        self.current.load()
+    }
+
+    /// Returns an owned reference to the current snapshot, for handles that
+    /// outlive the call.
+    pub(crate) fn load_full(&self) -> Arc<Environment<'static>> {
+        self.current.load_full()
+    }
+
+    /// Blocks until no other writer is active and takes the writer lock.
+    pub(crate) fn lock_writer(&self) -> WriterGuard<'_> {
+        let mut writing = self.writing.lock().unwrap();
+        while *writing {
+            writing = self.writable.wait(writing).unwrap();
+        }
+        *writing = true;
+        WriterGuard { state: self }
+    }
+
+    /// Takes the writer lock if no other writer is active.
+    pub(crate) fn try_lock_writer(&self) -> Option<WriterGuard<'_>> {
+        let mut writing = self.writing.lock().unwrap();
+        if *writing {
+            return None;
+        }
+        *writing = true;
+        Some(WriterGuard { state: self })
+    }
+
+    /// Applies `f` to a copy of the current snapshot and publishes the copy
+    /// if `f` succeeds.
+    pub(crate) fn try_update<T, E>(
+        &self,
+        f: impl FnOnce(&mut Environment<'static>) -> Result<T, E>,
+    ) -> Result<T, E> {
+        let guard = self.lock_writer();
+        let mut env = guard.snapshot();
+        let rv = f(&mut env)?;
+        guard.publish(env);
+        Ok(rv)
+    }
+
+    /// Applies `f` to a copy of the current snapshot and publishes the copy.
+    pub(crate) fn update<T>(&self, f: impl FnOnce(&mut Environment<'static>) -> T) -> T {
+        let guard = self.lock_writer();
+        let mut env = guard.snapshot();
+        let rv = f(&mut env);
+        guard.publish(env);
+        rv
+    }
+
+    /// Like update, but also hands out the loader sources so that `f` can
+    /// change and reinstall them.
+    pub(crate) fn update_loader<T>(
+        &self,
+        f: impl FnOnce(&mut Environment<'static>, &mut LoaderState) -> T,
+    ) -> T {
+        let guard = self.lock_writer();
+        let mut env = guard.snapshot();
+        let rv = f(&mut env, &mut self.loader.lock().unwrap());
+        guard.publish(env);
+        rv
+    }
+
+    /// Like update, but also hands out the auto-escape rules so that `f`
+    /// can change them and install a new callback.
+    pub(crate) fn update_escape_rules<T>(
+        &self,
+        f: impl FnOnce(&mut Environment<'static>, &mut Vec<(String, mj_auto_escape)>) -> T,
+    ) -> T {
+        let guard = self.lock_writer();
+        let mut env = guard.snapshot();
+        let rv = f(&mut env, &mut self.escape_rules.lock().unwrap());
+        guard.publish(env);
+        rv
+    }
+}
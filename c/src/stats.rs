@@ -0,0 +1,389 @@
+use std::collections::HashMap;
+use std::ffi::{CString, c_char};
+use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+use std::sync::{Arc, Mutex, RwLock};
+use std::time::Instant;
+
+use crate::errors::mj_code;
+
+use super::*;
+
+/// Number of latency buckets, one per power of two nanoseconds.
+const BUCKETS: usize = 64;
+
+/// Number of template names that get metrics of their own.
+const MAX_TEMPLATES: usize = 1024;
+
+/// The name the metrics of all other renders are recorded under: those of
+/// templates that were not found, and those of names beyond MAX_TEMPLATES.
+const OTHER: &str = "(other)";
+
+/// A latency histogram with power-of-two buckets that is updated without
+/// locking.
+struct Histogram {
+    count: AtomicU64,
+    sum_ns: AtomicU64,
+    buckets: [AtomicU64; BUCKETS],
+}
+
+impl Histogram {
+    fn new() -> Self {
+        Histogram {
+            count: AtomicU64::new(0),
+            sum_ns: AtomicU64::new(0),
+            buckets: std::array::from_fn(|_| AtomicU64::new(0)),
+        }
+    }
+
+    fn record(&self, ns: u64) {
+        // Bucket i holds durations below 2^i ns, down to 2^(i-1) ns.
+        let bucket = (u64::BITS - ns.leading_zeros()) as usize;
+        self.count.fetch_add(1, Ordering::Relaxed);
+        self.sum_ns.fetch_add(ns, Ordering::Relaxed);
+        self.buckets[bucket.min(BUCKETS - 1)].fetch_add(1, Ordering::Relaxed);
+    }
+
+    fn snapshot(&self) -> mj_histogram {
+        mj_histogram {
+            count: self.count.load(Ordering::Relaxed),
+            sum_ns: self.sum_ns.load(Ordering::Relaxed),
+            buckets: std::array::from_fn(|i| self.buckets[i].load(Ordering::Relaxed)),
+        }
+    }
+}
+
+/// The phases of a render that are timed separately.
+#[derive(Clone, Copy)]
+pub(crate) enum Phase {
+    Lookup,
+    Parse,
+    Render,
+    Output,
+}
+
+struct TemplateStats {
+    calls: AtomicU64,
+    output_bytes: AtomicU64,
+    errors: Mutex<Vec<(mj_code, u64)>>,
+    phases: [Histogram; 4],
+}
+
+impl TemplateStats {
+    fn new() -> Self {
+        TemplateStats {
+            calls: AtomicU64::new(0),
+            output_bytes: AtomicU64::new(0),
+            errors: Mutex::new(Vec::new()),
+            phases: std::array::from_fn(|_| Histogram::new()),
+        }
+    }
+
+    fn record_error(&self, code: mj_code) {
+        let mut errors = self.errors.lock().unwrap();
+        match errors.iter_mut().find(|(c, _)| *c == code) {
+            Some((_, count)) => *count += 1,
+            None => errors.push((code, 1)),
+        }
+    }
+}
+
+/// Render metrics of an environment, collected per template name while
+/// enabled.
+#[derive(Default)]
+pub(crate) struct Stats {
+    enabled: AtomicBool,
+    templates: RwLock<HashMap<String, Arc<TemplateStats>>>,
+}
+
+impl Stats {
+    /// Returns fresh, empty metrics that are enabled if these are.
+    pub(crate) fn fork(&self) -> Self {
+        Stats {
+            enabled: AtomicBool::new(self.enabled.load(Ordering::Relaxed)),
+            templates: RwLock::default(),
+        }
+    }
+
+    /// Starts timing a render of the template `name`. While metrics are
+    /// disabled this costs a single atomic load, and so does every method
+    /// of the returned recorder.
+    pub(crate) fn start<'a>(&'a self, name: &'a str) -> Recorder<'a> {
+        if !self.enabled.load(Ordering::Relaxed) {
+            return Recorder(None);
+        }
+        Recorder(Some(Timing {
+            stats: self,
+            name,
+            template: None,
+            last: Instant::now(),
+        }))
+    }
+
+    /// Returns the metrics of the template `name`, or those of OTHER once
+    /// MAX_TEMPLATES names have metrics of their own.
+    fn template(&self, name: &str) -> Arc<TemplateStats> {
+        if let Some(template) = self.templates.read().unwrap().get(name) {
+            return template.clone();
+        }
+        let mut templates = self.templates.write().unwrap();
+        let name = match templates.contains_key(name) || templates.len() < MAX_TEMPLATES {
+            true => name,
+            false => OTHER,
+        };
+        templates
+            .entry(name.to_string())
+            .or_insert_with(|| Arc::new(TemplateStats::new()))
+            .clone()
+    }
+}
+
+/// Times the phases of a single render.
+pub(crate) struct Recorder<'a>(Option<Timing<'a>>);
+
+struct Timing<'a> {
+    stats: &'a Stats,
+    name: &'a str,
+    // Looked up on first use, so that names that never resolve to a
+    // template get no metrics of their own.
+    template: Option<Arc<TemplateStats>>,
+    last: Instant,
+}
+
+impl Timing<'_> {
+    fn template(&mut self) -> &TemplateStats {
+        self.template
+            .get_or_insert_with(|| self.stats.template(self.name))
+    }
+
+    /// Returns the metrics a failed render is recorded in.
+    fn failed(&mut self, code: mj_code) -> &TemplateStats {
+        if self.template.is_none() && code == mj_code::MJ_TEMPLATE_NOT_FOUND {
+            self.template = Some(self.stats.template(OTHER));
+        }
+        self.template()
+    }
+}
+
+impl Recorder<'_> {
+    /// Records the time since the previous phase ended as `phase`.
+    pub(crate) fn mark(&mut self, phase: Phase) {
+        if let Some(timing) = &mut self.0 {
+            let now = Instant::now();
+            let elapsed = (now - timing.last).as_nanos() as u64;
+            timing.template().phases[phase as usize].record(elapsed);
+            timing.last = now;
+        }
+    }
+
+    /// Finishes a successful render, timing the rest as the render phase
+    /// and the conversion of the output as the output phase.
+    pub(crate) fn ok(mut self, rendered: String) -> *mut mj_result_env_render_template {
+        self.mark(Phase::Render);
+        let len = rendered.len();
+        let result = mj_result_env_render_template::ok(rendered);
+        self.mark(Phase::Output);
+        if let Some(timing) = &mut self.0 {
+            let template = timing.template();
+            template.calls.fetch_add(1, Ordering::Relaxed);
+            template
+                .output_bytes
+                .fetch_add(len as u64, Ordering::Relaxed);
+        }
+        result
+    }
+
+    /// Finishes a failed render, counting the error by its code.
+    pub(crate) fn err(mut self, error: *mut mj_error) -> *mut mj_result_env_render_template {
+        self.failed(error);
+        mj_result_env_render_template::err(error)
+    }
+
+    fn failed(&mut self, error: *mut mj_error) {
+        if let Some(timing) = &mut self.0 {
+            let code = unsafe { (*error).code };
+            let template = timing.failed(code);
+            template.calls.fetch_add(1, Ordering::Relaxed);
+            template.record_error(code);
+        }
+    }
+
+    /// Finishes a render whose output is converted along with others, such
+    /// as one of a batch, so that it has no output phase of its own.
+    pub(crate) fn finish(
+        mut self,
+        result: Result<String, *mut mj_error>,
+    ) -> Result<String, *mut mj_error> {
+        match &result {
+            Ok(rendered) => {
+                self.mark(Phase::Render);
+                if let Some(timing) = &mut self.0 {
+                    let template = timing.template();
+                    template.calls.fetch_add(1, Ordering::Relaxed);
+                    template
+                        .output_bytes
+                        .fetch_add(rendered.len() as u64, Ordering::Relaxed);
+                }
+            }
+            Err(error) => self.failed(*error),
+        }
+        result
+    }
+}
+
+/// \brief A latency histogram of one phase of rendering.
+///
+/// Bucket i counts the durations of at least 2^(i-1) and less than 2^i
+/// nanoseconds; bucket 0 counts durations of zero.
+#[repr(C)]
+pub struct mj_histogram {
+    /// Number of recorded durations
+    pub count: u64,
+    /// Sum of all recorded durations in nanoseconds
+    pub sum_ns: u64,
+    /// Number of recorded durations per power-of-two bucket
+    pub buckets: [u64; 64],
+}
+
+/// \brief The number of failed renders of a template with a given error code.
+#[repr(C)]
+pub struct mj_error_count {
+    /// The error code
+    pub code: mj_code,
+    /// Number of renders that failed with the code
+    pub count: u64,
+}
+
+/// \brief Render metrics of a single template.
+#[repr(C)]
+pub struct mj_template_stats {
+    /// Null-terminated name of the template, or "(other)"
+    pub name: *mut c_char,
+    /// Number of renders, failed ones included
+    pub calls: u64,
+    /// Total bytes of rendered output
+    pub output_bytes: u64,
+    /// Pointer to the failed render counts per error code
+    pub errors: *mut mj_error_count,
+    /// Number of entries in the errors array
+    pub errors_len: usize,
+    /// Time spent looking up the template
+    pub lookup: mj_histogram,
+    /// Time spent parsing the context
+    pub parse: mj_histogram,
+    /// Time spent rendering, including compilation for named strings
+    pub render: mj_histogram,
+    /// Time spent handing the output over to the caller
+    pub output: mj_histogram,
+}
+
+/// \brief A snapshot of the render metrics of an environment.
+///
+/// @see mj_env_stats Function that returns this type
+///
+/// \note The snapshot is freed using mj_stats_free.
+#[repr(C)]
+pub struct mj_stats {
+    /// Pointer to the metrics of every template rendered while enabled
+    pub templates: *mut mj_template_stats,
+    /// Number of entries in the templates array
+    pub len: usize,
+}
+
+/// \brief Enables or disables render metrics for the environment.
+///
+/// While enabled, mj_env_render and mj_env_render_named_string record per
+/// template name the number of renders, the failures by error code, the
+/// bytes of output and latency histograms of each phase of rendering.
+/// While disabled, which is the default, renders record nothing.
+///
+/// Renders of templates that were not found are recorded under the name
+/// "(other)", and so are the renders of names first seen after 1024
+/// others, which keeps the metrics bounded.
+///
+/// @param env Pointer to the environment to configure
+/// @param value Boolean value indicating whether to record metrics
+///
+/// \note Metrics recorded so far are kept when disabling them.
+///
+/// @see mj_env_stats Takes a snapshot of the metrics
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_set_stats(env: *mut mj_env, value: bool) {
+    let state = unsafe { &*env }.deref();
+    state.stats().enabled.store(value, Ordering::Relaxed);
+}
+
+/// \brief Takes a snapshot of the render metrics of the environment.
+///
+/// @param env Pointer to the environment
+///
+/// @return mj_stats The metrics of every template rendered while metrics
+/// were enabled, in no particular order.
+///
+/// \note The returned snapshot should be freed using mj_stats_free when no
+/// longer needed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_stats(env: *mut mj_env) -> *mut mj_stats {
+    let state = unsafe { &*env }.deref();
+    let templates = state
+        .stats()
+        .templates
+        .read()
+        .unwrap()
+        .iter()
+        .map(|(name, template)| {
+            let errors = template
+                .errors
+                .lock()
+                .unwrap()
+                .iter()
+                .map(|&(code, count)| mj_error_count { code, count })
+                .collect::<Vec<_>>();
+            let errors_len = errors.len();
+            mj_template_stats {
+                name: CString::new(name.as_str())
+                    .expect("CString::new failed")
+                    .into_raw(),
+                calls: template.calls.load(Ordering::Relaxed),
+                output_bytes: template.output_bytes.load(Ordering::Relaxed),
+                errors: Box::into_raw(errors.into_boxed_slice()) as *mut mj_error_count,
+                errors_len,
+                lookup: template.phases[Phase::Lookup as usize].snapshot(),
+                parse: template.phases[Phase::Parse as usize].snapshot(),
+                render: template.phases[Phase::Render as usize].snapshot(),
+                output: template.phases[Phase::Output as usize].snapshot(),
+            }
+        })
+        .collect::<Vec<_>>();
+    let len = templates.len();
+    Box::into_raw(Box::new(mj_stats {
+        templates: Box::into_raw(templates.into_boxed_slice()) as *mut mj_template_stats,
+        len,
+    }))
+}
+
+/// \brief Frees a snapshot of render metrics.
+///
+/// @param stats Pointer to the snapshot to free
+///
+/// \note It is safe to pass NULL to this function.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_stats_free(stats: *mut mj_stats) {
+    if stats.is_null() {
+        return;
+    }
+
+    unsafe {
+        let stats = Box::from_raw(stats);
+        let templates = Box::from_raw(std::ptr::slice_from_raw_parts_mut(
+            stats.templates,
+            stats.len,
+        ));
+        for template in templates.iter() {
+            drop(CString::from_raw(template.name));
+            drop(Box::from_raw(std::ptr::slice_from_raw_parts_mut(
+                template.errors,
+                template.errors_len,
+            )));
+        }
+    }
+}
@@ -0,0 +1,636 @@
+use std::collections::{HashMap, HashSet};
+use std::ffi::c_char;
+use std::sync::atomic::{AtomicBool, AtomicU64, AtomicUsize, Ordering};
+use std::sync::{Arc, RwLock};
+
+use crate::state::EnvState;
+
+use super::*;
+
+/// Bytes charged per compiled template on top of its source, for the
+/// bookkeeping of the template itself.
+const TEMPLATE_OVERHEAD: usize = 512;
+
+/// Estimates the memory a compiled template takes. minijinja does not
+/// expose the size of its instructions, so this assumes that a template
+/// keeps its source and adds about twice as much for instructions, names
+/// and spans.
+fn estimate(source_len: usize) -> usize {
+    source_len * 3 + TEMPLATE_OVERHEAD
+}
+
+/// Returns the names of the templates `source` includes, extends or imports
+/// by a string literal. Names that are only computed at render time are
+/// missed, and literals of other parts of those tags, such as the operands
+/// of a conditional include, are listed too.
+fn references(source: &str) -> Arc<[String]> {
+    let mut names = Vec::new();
+    for (i, _) in source.match_indices("{%") {
+        let tag = source[i + 2..].trim_start_matches(['-', '+']).trim_start();
+        let keyword = ["include", "extends", "import", "from"]
+            .iter()
+            .find(|keyword| {
+                tag.strip_prefix(**keyword).is_some_and(|rest| {
+                    !rest.starts_with(|c: char| c.is_alphanumeric() || c == '_')
+                })
+            });
+        let Some(keyword) = keyword else {
+            continue;
+        };
+        let tag = &tag[keyword.len()..];
+        let mut rest = &tag[..tag.find("%}").unwrap_or(tag.len())];
+        while let Some(start) = rest.find(['"', '\'']) {
+            let quote = rest.as_bytes()[start] as char;
+            let literal = &rest[start + 1..];
+            let Some(end) = literal.find(quote) else {
+                break;
+            };
+            names.push(literal[..end].to_string());
+            rest = &literal[end + 1..];
+        }
+    }
+    names.sort_unstable();
+    names.dedup();
+    names.into()
+}
+
+/// The source of an evicted template, kept to compile it again.
+#[derive(Clone)]
+enum Source {
+    Plain(Arc<str>),
+    Lz4(Arc<[u8]>),
+}
+
+impl Source {
+    fn new(source: &str, compress: bool) -> Self {
+        match compress {
+            true => Source::Lz4(lz4_flex::compress_prepend_size(source.as_bytes()).into()),
+            false => Source::Plain(source.into()),
+        }
+    }
+
+    fn len(&self) -> usize {
+        match self {
+            Source::Plain(source) => source.len(),
+            Source::Lz4(data) => data.len(),
+        }
+    }
+
+    fn decode(&self) -> String {
+        match self {
+            Source::Plain(source) => source.to_string(),
+            // The data was compressed from a valid string by this process.
+            Source::Lz4(data) => String::from_utf8(
+                lz4_flex::decompress_size_prepended(data).expect("corrupt template source"),
+            )
+            .expect("corrupt template source"),
+        }
+    }
+}
+
+struct Entry {
+    source_len: usize,
+    compiled: usize,
+    // The templates it includes, extends or imports.
+    references: Arc<[String]>,
+    // The templates it references, directly or through others, as of the
+    // last change to the templates of the store.
+    reach: Arc<[String]>,
+    // Whether the compiled template is part of the current snapshot.
+    resident: bool,
+    // The epoch the template was last rendered in.
+    used: AtomicU64,
+    // Set once the template has been evicted.
+    source: Option<Source>,
+}
+
+impl Entry {
+    /// Records a use in `epoch`, writing the shared stamp only once per
+    /// epoch.
+    fn stamp(&self, epoch: u64) {
+        if self.used.load(Ordering::Relaxed) < epoch {
+            self.used.store(epoch, Ordering::Relaxed);
+        }
+    }
+}
+
+/// Returns the names `name` reaches through the references of `entries`,
+/// directly or through others, without `name` itself.
+fn reach(entries: &HashMap<String, Entry>, name: &str) -> Arc<[String]> {
+    let Some(entry) = entries.get(name) else {
+        return Arc::new([]);
+    };
+    if entry.references.is_empty() {
+        return entry.references.clone();
+    }
+    let mut seen = HashSet::from([name]);
+    let mut reach = Vec::new();
+    let mut pending = entry.references.iter().collect::<Vec<_>>();
+    while let Some(reference) = pending.pop() {
+        if !seen.insert(reference.as_str()) {
+            continue;
+        }
+        reach.push(reference.clone());
+        if let Some(entry) = entries.get(reference) {
+            pending.extend(entry.references.iter());
+        }
+    }
+    reach.into()
+}
+
+/// Template changes of a transaction, applied to the store on commit.
+#[derive(Default)]
+pub(crate) struct Changes {
+    cleared: bool,
+    templates: Vec<(String, Option<(usize, Arc<[String]>)>)>,
+}
+
+impl Changes {
+    pub(crate) fn add(&mut self, name: &str, source: &str) {
+        let added = (source.len(), references(source));
+        self.templates.push((name.to_string(), Some(added)));
+    }
+
+    pub(crate) fn remove(&mut self, name: &str) {
+        self.templates.push((name.to_string(), None));
+    }
+
+    pub(crate) fn clear(&mut self) {
+        self.cleared = true;
+        self.templates.clear();
+    }
+}
+
+/// Accounts for the memory of the templates added to an environment, and
+/// keeps the compiled ones within a byte budget.
+///
+/// Above the budget, the least recently rendered templates are evicted,
+/// except for the most recent one: they are removed from the snapshot, and
+/// only their source is kept, compressed if enabled. The loader of the
+/// environment hands the source back to minijinja the next time the
+/// template is needed, which compiles it again.
+///
+/// Rendering a template also counts as a use of the templates it names in
+/// an include, extends or import tag, and of theirs in turn, so that the
+/// layouts and partials of templates in use are kept along with them. Those
+/// only reached through names computed at render time count as used when
+/// they are compiled again.
+///
+/// Uses are recorded by epoch rather than one by one, so that renders only
+/// write a stamp that is shared between cores once per epoch. The epoch
+/// advances whenever eviction runs and whenever a template is added or
+/// compiled again; templates used within the same epoch are evicted in no
+/// particular order.
+#[derive(Default)]
+pub(crate) struct TemplateStore {
+    budget: AtomicUsize,
+    compress: AtomicBool,
+    entries: RwLock<HashMap<String, Entry>>,
+    epoch: AtomicU64,
+    // Estimated bytes of the resident compiled templates, only changed
+    // while `entries` is locked for writing.
+    bytes: AtomicUsize,
+    evictions: AtomicU64,
+    recompiles: AtomicU64,
+    // Counts changes to what is resident and to the budget, which are all
+    // that can give eviction something new to do.
+    revision: AtomicU64,
+    // One more than the revision at which eviction last found nothing left
+    // to evict while above the budget, or 0.
+    settled: AtomicU64,
+}
+
+impl TemplateStore {
+    /// Returns a new store with the templates and settings of this one and
+    /// zero counters.
+    pub(crate) fn fork(&self) -> Self {
+        let entries = self.entries.read().unwrap();
+        let entries = entries
+            .iter()
+            .map(|(name, entry)| {
+                let entry = Entry {
+                    source_len: entry.source_len,
+                    compiled: entry.compiled,
+                    references: entry.references.clone(),
+                    reach: entry.reach.clone(),
+                    resident: entry.resident,
+                    used: AtomicU64::new(entry.used.load(Ordering::Relaxed)),
+                    source: entry.source.clone(),
+                };
+                (name.clone(), entry)
+            })
+            .collect();
+        TemplateStore {
+            budget: AtomicUsize::new(self.budget.load(Ordering::Relaxed)),
+            compress: AtomicBool::new(self.compress.load(Ordering::Relaxed)),
+            entries: RwLock::new(entries),
+            epoch: AtomicU64::new(self.epoch.load(Ordering::Relaxed)),
+            bytes: AtomicUsize::new(self.bytes.load(Ordering::Relaxed)),
+            evictions: AtomicU64::new(0),
+            recompiles: AtomicU64::new(0),
+            revision: AtomicU64::new(0),
+            settled: AtomicU64::new(0),
+        }
+    }
+
+    fn budget(&self) -> usize {
+        self.budget.load(Ordering::Relaxed)
+    }
+
+    /// Returns a stamp for a template that is new to the snapshot: newer
+    /// than every use so far, and older than every use from now on.
+    fn fresh(&self) -> u64 {
+        self.epoch.fetch_add(2, Ordering::Relaxed) + 1
+    }
+
+    /// Recomputes the templates every template reaches, after templates
+    /// were added.
+    fn relink(entries: &mut HashMap<String, Entry>) {
+        let reaches = entries
+            .keys()
+            .map(|name| (name.clone(), reach(entries, name)))
+            .collect::<Vec<_>>();
+        for (name, reach) in reaches {
+            if let Some(entry) = entries.get_mut(&name) {
+                entry.reach = reach;
+            }
+        }
+    }
+
+    fn changed(&self) {
+        self.revision.fetch_add(1, Ordering::Relaxed);
+    }
+
+    /// Sets the budget in bytes, 0 for none, and whether evicted sources
+    /// are compressed.
+    pub(crate) fn configure(&self, budget: usize, compress: bool) {
+        self.budget.store(budget, Ordering::Relaxed);
+        self.compress.store(compress, Ordering::Relaxed);
+        self.changed();
+    }
+
+    /// Returns whether the store may hand sources to the loader.
+    pub(crate) fn active(&self) -> bool {
+        self.budget() > 0
+            || self
+                .entries
+                .read()
+                .unwrap()
+                .values()
+                .any(|entry| entry.source.is_some())
+    }
+
+    fn insert(
+        &self,
+        entries: &mut HashMap<String, Entry>,
+        name: &str,
+        source_len: usize,
+        references: Arc<[String]>,
+    ) {
+        self.remove(entries, name);
+        let compiled = estimate(source_len);
+        self.bytes.fetch_add(compiled, Ordering::Relaxed);
+        self.changed();
+        let entry = Entry {
+            source_len,
+            compiled,
+            references,
+            reach: Arc::new([]),
+            resident: true,
+            used: AtomicU64::new(self.fresh()),
+            source: None,
+        };
+        entries.insert(name.to_string(), entry);
+    }
+
+    fn remove(&self, entries: &mut HashMap<String, Entry>, name: &str) {
+        if let Some(entry) = entries.remove(name) {
+            if entry.resident {
+                self.bytes.fetch_sub(entry.compiled, Ordering::Relaxed);
+                self.changed();
+            }
+        }
+    }
+
+    /// Records that the template `name` was added with `source`, replacing
+    /// any previous one.
+    pub(crate) fn added(&self, name: &str, source: &str) {
+        let mut entries = self.entries.write().unwrap();
+        self.insert(&mut entries, name, source.len(), references(source));
+        Self::relink(&mut entries);
+    }
+
+    /// Records that the template `name` was removed.
+    pub(crate) fn removed(&self, name: &str) {
+        self.remove(&mut self.entries.write().unwrap(), name);
+    }
+
+    /// Records that all templates were removed.
+    pub(crate) fn cleared(&self) {
+        self.entries.write().unwrap().clear();
+        self.bytes.store(0, Ordering::Relaxed);
+        self.changed();
+    }
+
+    /// Records the template changes of a committed transaction.
+    pub(crate) fn apply(&self, changes: Changes) {
+        let mut entries = self.entries.write().unwrap();
+        if changes.cleared {
+            entries.clear();
+            self.bytes.store(0, Ordering::Relaxed);
+            self.changed();
+        }
+        for (name, added) in changes.templates {
+            match added {
+                Some((source_len, references)) => {
+                    self.insert(&mut entries, &name, source_len, references)
+                }
+                None => self.remove(&mut entries, &name),
+            }
+        }
+        Self::relink(&mut entries);
+    }
+
+    /// Records a render of the template `name` while a budget is set, and
+    /// a use of the templates it reaches.
+    pub(crate) fn touch(&self, name: &str) {
+        if self.budget() == 0 {
+            return;
+        }
+        let epoch = self.epoch.load(Ordering::Relaxed);
+        let entries = self.entries.read().unwrap();
+        let Some(entry) = entries.get(name) else {
+            return;
+        };
+        for reference in entry.reach.iter() {
+            if let Some(entry) = entries.get(reference) {
+                entry.stamp(epoch);
+            }
+        }
+        entry.stamp(epoch);
+    }
+
+    /// Returns the source of the template `name` for the loader to compile,
+    /// if it has been evicted.
+    pub(crate) fn recompile(&self, name: &str) -> Option<String> {
+        let mut entries = self.entries.write().unwrap();
+        let entry = entries.get_mut(name)?;
+        let source = entry.source.as_ref()?.decode();
+        if !entry.resident {
+            entry.resident = true;
+            self.bytes.fetch_add(entry.compiled, Ordering::Relaxed);
+            self.changed();
+        }
+        entry.used.store(self.fresh(), Ordering::Relaxed);
+        self.recompiles.fetch_add(1, Ordering::Relaxed);
+        Some(source)
+    }
+
+    /// Returns whether the compiled templates exceed the budget and
+    /// eviction may have something to do about it.
+    pub(crate) fn over_budget(&self) -> bool {
+        let budget = self.budget();
+        budget > 0
+            && self.bytes.load(Ordering::Relaxed) > budget
+            && self.settled.load(Ordering::Relaxed) != self.revision.load(Ordering::Relaxed) + 1
+    }
+
+    /// Evicts the least recently used templates of `state` until the
+    /// compiled ones fit the budget.
+    ///
+    /// Eviction publishes a snapshot without the evicted templates, but
+    /// keeps the generation, as renders produce the same output. It is
+    /// skipped while another writer is active, and retried on a later use.
+    /// Once nothing is left to evict, such as when the most recent template
+    /// alone exceeds the budget, it is skipped until what is resident or
+    /// the budget changes.
+    pub(crate) fn enforce(&self, state: &EnvState) {
+        if !self.over_budget() {
+            return;
+        }
+        let budget = self.budget();
+        let revision = self.revision.load(Ordering::Relaxed);
+        let Some(guard) = state.try_lock_writer() else {
+            return;
+        };
+        // Uses from now on are newer than all that eviction compares.
+        self.epoch.fetch_add(1, Ordering::Relaxed);
+
+        let mut victims = {
+            let entries = self.entries.read().unwrap();
+            let mut resident = entries
+                .iter()
+                .filter(|(_, entry)| entry.resident)
+                .map(|(name, entry)| (entry.used.load(Ordering::Relaxed), name, entry.compiled))
+                .collect::<Vec<_>>();
+            resident.sort_unstable();
+            // The most recently used template is kept even if it alone
+            // exceeds the budget, so it is not compiled on every render.
+            resident.pop();
+            let mut bytes = self.bytes.load(Ordering::Relaxed);
+            let mut victims = HashMap::new();
+            for (_, name, compiled) in resident {
+                if bytes <= budget {
+                    break;
+                }
+                bytes -= compiled;
+                victims.insert(name.clone(), None);
+            }
+            victims
+        };
+        if victims.is_empty() {
+            self.settle(revision);
+            return;
+        }
+
+        // Sources are read from the templates already in the snapshot, as
+        // looking a missing one up would go through the loader.
+        let mut env = guard.snapshot();
+        for (name, template) in env.templates() {
+            if let Some(source) = victims.get_mut(name) {
+                *source = Some(template.source().to_string());
+            }
+        }
+        let compress = self.compress.load(Ordering::Relaxed);
+        let mut entries = self.entries.write().unwrap();
+        for (name, source) in victims.drain() {
+            let Some(entry) = entries.get_mut(&name) else {
+                continue;
+            };
+            match (&entry.source, source) {
+                (Some(_), _) => {}
+                (None, Some(source)) => entry.source = Some(Source::new(&source, compress)),
+                // Without a source, the template cannot be compiled again.
+                (None, None) => continue,
+            }
+            env.remove_template(&name);
+            entry.resident = false;
+            self.bytes.fetch_sub(entry.compiled, Ordering::Relaxed);
+            self.evictions.fetch_add(1, Ordering::Relaxed);
+        }
+        // Taken while `entries` is locked, so no change slips in between.
+        let revision = self.revision.load(Ordering::Relaxed);
+        let over = self.bytes.load(Ordering::Relaxed) > budget;
+        drop(entries);
+        guard.publish_unchanged(env);
+        if over {
+            self.settle(revision);
+        }
+    }
+
+    /// Records that eviction has nothing left to do at `revision`.
+    fn settle(&self, revision: u64) {
+        self.settled.store(revision + 1, Ordering::Relaxed);
+    }
+
+    fn memory(&self, name: &str) -> Option<mj_template_memory> {
+        let entries = self.entries.read().unwrap();
+        let entry = entries.get(name)?;
+        Some(mj_template_memory {
+            resident: entry.resident,
+            compiled_bytes: if entry.resident { entry.compiled } else { 0 },
+            source_bytes: entry.source_len,
+            stored_bytes: entry.source.as_ref().map_or(0, Source::len),
+        })
+    }
+
+    fn stats(&self) -> mj_template_store_stats {
+        let entries = self.entries.read().unwrap();
+        mj_template_store_stats {
+            evictions: self.evictions.load(Ordering::Relaxed),
+            recompiles: self.recompiles.load(Ordering::Relaxed),
+            templates: entries.len(),
+            resident: entries.values().filter(|entry| entry.resident).count(),
+            compiled_bytes: self.bytes.load(Ordering::Relaxed),
+            stored_bytes: entries
+                .values()
+                .filter_map(|entry| entry.source.as_ref())
+                .map(Source::len)
+                .sum(),
+            budget: self.budget(),
+        }
+    }
+}
+
+/// \brief Memory taken by a template added to an environment.
+///
+/// @see mj_env_template_memory Function that fills this structure
+#[repr(C)]
+pub struct mj_template_memory {
+    /// Whether the compiled template is loaded, false if it was evicted
+    pub resident: bool,
+    /// Estimated bytes of the compiled template, or 0 if it was evicted
+    pub compiled_bytes: usize,
+    /// Length of the source in bytes
+    pub source_bytes: usize,
+    /// Bytes kept to compile the template again, compressed if enabled, or
+    /// 0 if it was never evicted
+    pub stored_bytes: usize,
+}
+
+/// \brief Counters of the templates added to an environment.
+///
+/// @see mj_env_template_store_stats Function that fills this structure
+#[repr(C)]
+pub struct mj_template_store_stats {
+    /// Number of templates evicted to stay within the budget
+    pub evictions: u64,
+    /// Number of times an evicted template was compiled again
+    pub recompiles: u64,
+    /// Number of templates added
+    pub templates: usize,
+    /// Number of templates whose compiled form is loaded
+    pub resident: usize,
+    /// Estimated bytes of the loaded compiled templates
+    pub compiled_bytes: usize,
+    /// Bytes kept to compile evicted templates again
+    pub stored_bytes: usize,
+    /// The byte budget of the compiled templates, or 0 if there is none
+    pub budget: usize,
+}
+
+/// \brief Sets a memory budget for the compiled templates of the
+/// environment.
+///
+/// Templates added with mj_env_add_template or a transaction stay compiled
+/// for the lifetime of the environment by default. With a budget, the
+/// least recently rendered ones are evicted while the estimated size of
+/// all compiled templates exceeds it. Rendering a template also counts as
+/// a use of the templates it includes, extends or imports by a literal
+/// name. An evicted template only keeps its source, compressed with LZ4 if
+/// `compress` is true, and is compiled again transparently the next time
+/// it is rendered or included. Templates are evicted right away when a
+/// change exceeds the budget, and on a worker thread when a render does
+/// by compiling an evicted template again.
+///
+/// @param env Pointer to the environment to configure
+/// @param budget Byte budget of the compiled templates, or 0 for none
+/// @param compress Whether to compress the sources of evicted templates
+///
+/// \note Templates loaded from a search path or a bundle are not counted,
+/// as they are loaded again from there. Evicted templates stay evicted when
+/// the budget is removed, until they are used again.
+///
+/// @see mj_env_template_memory Reads the memory taken by a template
+/// @see mj_env_template_store_stats Reads the counters of all templates
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_set_template_budget(
+    env: *mut mj_env,
+    budget: usize,
+    compress: bool,
+) {
+    let state = unsafe { &*env }.deref();
+    state.templates().configure(budget, compress);
+    // Evicted templates are compiled again through the loader.
+    state.update_loader(|env, loader| loader.install(env));
+    state.templates().enforce(state);
+}
+
+/// \brief Reads the memory taken by a template added to the environment.
+///
+/// @param env Pointer to the environment
+/// @param name Null-terminated string containing the name of the template
+/// @param memory Pointer to the structure to fill
+///
+/// @return true if the structure was filled, false if no template of that
+/// name was added with mj_env_add_template or a transaction.
+///
+/// \note The name and memory parameters must not be NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_template_memory(
+    env: *mut mj_env,
+    name: *const c_char,
+    memory: *mut mj_template_memory,
+) -> bool {
+    assert!(!name.is_null());
+    assert!(!memory.is_null());
+    let name = unsafe {
+        std::ffi::CStr::from_ptr(name)
+            .to_str()
+            .expect("malformed name")
+    };
+    let state = unsafe { &*env }.deref();
+    match state.templates().memory(name) {
+        Some(value) => {
+            unsafe { memory.write(value) };
+            true
+        }
+        None => false,
+    }
+}
+
+/// \brief Reads the counters of the templates added to the environment.
+///
+/// @param env Pointer to the environment
+/// @param stats Pointer to the structure to fill
+///
+/// \note The stats parameter must not be NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_template_store_stats(
+    env: *mut mj_env,
+    stats: *mut mj_template_store_stats,
+) {
+    assert!(!stats.is_null());
+    let state = unsafe { &*env }.deref();
+    unsafe { stats.write(state.templates().stats()) };
+}
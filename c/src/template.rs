@@ -0,0 +1,244 @@
+use std::ffi::{c_char, c_void};
+use std::sync::{Arc, OnceLock};
+
+use minijinja::{Environment, Template, Value};
+
+use crate::state::EnvState;
+use crate::variables::Variables;
+
+use super::*;
+
+/// \brief Represents a compiled template that was looked up once from an
+/// environment and can be rendered repeatedly.
+///
+/// @see mj_env_get_template This function constructs a new template handle
+/// @see mj_template_free This function frees the heap memory of the handle
+///
+/// \note The handle keeps its own reference to the compiled template and to
+/// the environment snapshot it was looked up from, so rendering it does
+/// neither validate a name nor load the current snapshot. Later changes to
+/// the environment are not visible through an existing handle, and renders
+/// keep the timeout and context decoding mode the environment had when the
+/// handle was taken.
+///
+/// \remark The handle is safe to render from multiple threads at once.
+#[repr(C)]
+pub struct mj_template {
+    /// The pointer to the template handle in the Rust code.
+    /// Only touch this on judging whether it is NULL.
+    pub inner: *mut c_void,
+}
+
+pub(crate) struct TemplateHandle {
+    // Borrows from `env`, so it must be declared (and thus dropped) first.
+    template: Template<'static, 'static>,
+    #[allow(dead_code)]
+    env: Arc<Environment<'static>>,
+    // The top-level and the nested variables, analyzed on first request.
+    variables: [OnceLock<Variables>; 2],
+    timeout_ns: u64,
+    lazy_context: bool,
+}
+
+impl TemplateHandle {
+    /// Looks `name` up in the current snapshot of `state`, capturing the
+    /// render settings of `state` along with it.
+    pub(crate) fn new(state: &EnvState, name: &str) -> Result<Self, minijinja::Error> {
+        let env = state.load_full();
+        let template = env.get_template(name)?;
+        // SAFETY: the template borrows from the environment behind the `Arc`,
+        // which is kept alive (and never moved) for as long as the handle.
+        let template = unsafe {
+            std::mem::transmute::<Template<'_, '_>, Template<'static, 'static>>(template)
+        };
+        Ok(TemplateHandle {
+            template,
+            env,
+            variables: Default::default(),
+            timeout_ns: state.timeout(0),
+            lazy_context: state.lazy_context(),
+        })
+    }
+
+    pub(crate) fn template(&self) -> &Template<'static, 'static> {
+        &self.template
+    }
+
+    /// Returns the deadline of a render starting now.
+    pub(crate) fn deadline(&self) -> Option<std::time::Instant> {
+        limits::deadline(self.timeout_ns)
+    }
+
+    /// Parses the JSON context of a render of this handle.
+    pub(crate) fn context(&self, bytes: &[u8]) -> Result<Value, *mut mj_error> {
+        lazy::context_with(self.lazy_context, bytes)
+    }
+
+    pub(crate) fn variables(&self, nested: bool) -> &Variables {
+        self.variables[nested as usize].get_or_init(|| Variables::of(&self.template, nested))
+    }
+}
+
+impl mj_template {
+    pub(crate) fn deref(&self) -> &TemplateHandle {
+        unsafe { &*(self.inner as *const TemplateHandle) }
+    }
+}
+
+impl mj_template {
+    /// \brief Frees the memory allocated for a template handle.
+    ///
+    /// @param ptr Pointer to the template handle to free
+    ///
+    /// \note It is safe to pass NULL to this function.
+    #[unsafe(no_mangle)]
+    pub unsafe extern "C" fn mj_template_free(ptr: *mut mj_template) {
+        unsafe {
+            if ptr.is_null() {
+                return;
+            }
+            drop(Box::from_raw((*ptr).inner as *mut TemplateHandle));
+            drop(Box::from_raw(ptr));
+        }
+    }
+}
+
+/// \brief Looks up a template once and returns a reusable handle to it.
+///
+/// This function resolves the template by name and captures the compiled
+/// template together with the current environment snapshot, so that
+/// subsequent renders through mj_template_render skip the name lookup
+/// entirely. Taking a handle does not copy the environment.
+///
+/// @param env Pointer to the environment holding the template
+/// @param name Null-terminated string containing the name of the template
+///
+/// @return mj_result_env_get_template A result structure containing the
+/// template handle or error information if the template cannot be found.
+///
+/// \note The name parameter must not be NULL. The returned handle must be
+/// freed using mj_template_free, and the result itself using
+/// mj_result_env_get_template_free.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_get_template(
+    env: *mut mj_env,
+    name: *const c_char,
+) -> *mut mj_result_env_get_template {
+    assert!(!name.is_null());
+    let name = unsafe {
+        std::ffi::CStr::from_ptr(name)
+            .to_str()
+            .expect("malformed name")
+    };
+    let state = unsafe { &*env }.deref();
+    match TemplateHandle::new(state, name) {
+        Ok(handle) => {
+            state.template_used(name);
+            mj_result_env_get_template::ok(Box::into_raw(Box::new(mj_template {
+                inner: Box::into_raw(Box::new(handle)) as *mut c_void,
+            })))
+        }
+        Err(e) => mj_result_env_get_template::err(mj_error::new(e)),
+    }
+}
+
+/// \brief Renders a template handle with the given context.
+///
+/// @param tmpl Pointer to the template handle to render
+/// @param data Pointer to the JSON encoded context
+/// @param len Length of the context in bytes
+///
+/// @return mj_result_env_render_template A result structure containing the
+/// rendered string or error information if rendering fails.
+///
+/// \note The returned result should be freed using
+/// mj_result_env_render_template_free when no longer needed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_template_render(
+    tmpl: *mut mj_template,
+    data: *const u8,
+    len: usize,
+) -> *mut mj_result_env_render_template {
+    let bytes = unsafe { context::bytes(data, len) };
+    let handle = unsafe { &*tmpl }.deref();
+    let value = match handle.context(bytes) {
+        Ok(value) => value,
+        Err(e) => return mj_result_env_render_template::err(e),
+    };
+    match limits::render(handle.template(), &value, handle.deadline()) {
+        Ok(rendered) => mj_result_env_render_template::ok(rendered),
+        Err(e) => mj_result_env_render_template::err(e),
+    }
+}
+
+/// \brief Renders a template handle, streaming the output to a callback.
+///
+/// @param tmpl Pointer to the template handle to render
+/// @param data Pointer to the JSON encoded context
+/// @param len Length of the context in bytes
+/// @param callback Callback receiving the chunks of rendered output
+/// @param user_data Opaque pointer passed through to every callback invocation
+///
+/// @return mj_error NULL on success, or error information if rendering fails
+/// or the callback aborts it.
+///
+/// @see mj_env_render_to_writer For the semantics of the callback
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_template_render_to_writer(
+    tmpl: *mut mj_template,
+    data: *const u8,
+    len: usize,
+    callback: Option<mj_write_callback>,
+    user_data: *mut c_void,
+) -> *mut mj_error {
+    let callback = callback.expect("callback must not be NULL");
+    let bytes = unsafe { context::bytes(data, len) };
+    let handle = unsafe { &*tmpl }.deref();
+    let value = match handle.context(bytes) {
+        Ok(value) => value,
+        Err(e) => return e,
+    };
+    let deadline = handle.deadline();
+    match writer::render_to_callback(handle.template(), &value, deadline, callback, user_data) {
+        Ok(_) => std::ptr::null_mut(),
+        Err(e) => e,
+    }
+}
+
+/// \brief Renders a template handle into a caller owned buffer.
+///
+/// @param tmpl Pointer to the template handle to render
+/// @param data Pointer to the JSON encoded context
+/// @param len Length of the context in bytes
+/// @param buf Pointer to the output buffer, may be NULL if cap is 0
+/// @param cap Capacity of the output buffer in bytes
+/// @param out_len Receives the length of the rendered output
+///
+/// @return mj_error NULL on success, or error information if rendering fails.
+///
+/// @see mj_env_render_into For the semantics of the output buffer
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_template_render_into(
+    tmpl: *mut mj_template,
+    data: *const u8,
+    len: usize,
+    buf: *mut u8,
+    cap: usize,
+    out_len: *mut usize,
+) -> *mut mj_error {
+    assert!(!out_len.is_null());
+    let bytes = unsafe { context::bytes(data, len) };
+    let handle = unsafe { &*tmpl }.deref();
+    let value = match handle.context(bytes) {
+        Ok(value) => value,
+        Err(e) => return e,
+    };
+    let deadline = handle.deadline();
+    match unsafe { writer::render_to_buffer(handle.template(), &value, deadline, buf, cap) } {
+        Ok(rendered) => {
+            unsafe { *out_len = rendered };
+            std::ptr::null_mut()
+        }
+        Err(e) => e,
+    }
+}
@@ -0,0 +1,227 @@
+use std::ffi::{c_char, c_void};
+
+use minijinja::Environment;
+
+use crate::state::{EnvState, WriterGuard};
+use crate::store::Changes;
+
+use super::*;
+
+/// \brief Represents a pending bulk update of an environment.
+///
+/// A transaction works on a private copy of the environment. None of its
+/// changes are visible to renders until mj_txn_commit publishes all of
+/// them at once, so swapping hundreds of templates costs a single publish.
+///
+/// @see mj_env_begin_txn This function starts a new transaction
+/// @see mj_txn_commit This function publishes and frees the transaction
+/// @see mj_txn_abort This function discards and frees the transaction
+///
+/// \note Only one writer is active per environment at a time. While a
+/// transaction is open, other transactions and single-call updates such as
+/// mj_env_add_template block until it is committed or aborted, so they must
+/// not be called from the thread holding the transaction. Renders are never
+/// blocked.
+#[repr(C)]
+pub struct mj_txn {
+    /// The pointer to the transaction in the Rust code.
+    /// Only touch this on judging whether it is NULL.
+    pub inner: *mut c_void,
+}
+
+struct Transaction {
+    env: Environment<'static>,
+    guard: WriterGuard<'static>,
+    state: &'static EnvState,
+    // The template changes to record in the template store on commit.
+    changes: Changes,
+}
+
+impl mj_txn {
+    fn deref_mut(&mut self) -> &mut Transaction {
+        unsafe { &mut *(self.inner as *mut Transaction) }
+    }
+
+    unsafe fn take(ptr: *mut mj_txn) -> Transaction {
+        unsafe {
+            let txn = Box::from_raw(ptr);
+            *Box::from_raw(txn.inner as *mut Transaction)
+        }
+    }
+}
+
+/// \brief Starts a transaction on the environment.
+///
+/// This function waits until no other writer is active, then takes a
+/// private copy of the current environment to apply changes to.
+///
+/// @param env Pointer to the environment to update
+///
+/// @return mj_txn The transaction, which must be finished using either
+/// mj_txn_commit or mj_txn_abort.
+///
+/// \note The environment must not be freed while the transaction is open.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_begin_txn(env: *mut mj_env) -> *mut mj_txn {
+    // SAFETY: the caller guarantees that the environment outlives the
+    // transaction, which is all the writer lock borrows.
+    let state = unsafe { &*env }.deref() as *const EnvState;
+    let state: &'static EnvState = unsafe { &*state };
+    let guard = state.lock_writer();
+    let txn = Transaction {
+        env: guard.snapshot(),
+        guard,
+        state,
+        changes: Changes::default(),
+    };
+    Box::into_raw(Box::new(mj_txn {
+        inner: Box::into_raw(Box::new(txn)) as *mut c_void,
+    }))
+}
+
+/// \brief Adds a template to the transaction.
+///
+/// @param txn Pointer to the transaction
+/// @param name Null-terminated string containing the name of the template
+/// @param source Null-terminated string containing the template source code
+///
+/// @return mj_error NULL on success, or error information if compilation
+/// fails. A failed template is not added, but the transaction stays open.
+///
+/// @see mj_env_add_template For the semantics outside of a transaction
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_txn_add_template(
+    txn: *mut mj_txn,
+    name: *const c_char,
+    source: *const c_char,
+) -> *mut mj_error {
+    assert!(!name.is_null());
+    assert!(!source.is_null());
+    let name = unsafe {
+        std::ffi::CStr::from_ptr(name)
+            .to_str()
+            .expect("malformed name")
+    };
+    let source = unsafe {
+        std::ffi::CStr::from_ptr(source)
+            .to_str()
+            .expect("malformed template")
+    };
+    let txn = unsafe { &mut *txn }.deref_mut();
+    match txn.env.add_template_owned(name.to_string(), source) {
+        Ok(_) => {
+            txn.changes.add(name, source);
+            std::ptr::null_mut()
+        }
+        Err(e) => mj_error::new(e),
+    }
+}
+
+/// \brief Removes a template from the transaction by name.
+///
+/// @param txn Pointer to the transaction
+/// @param name Null-terminated string containing the name of the template
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_txn_remove_template(txn: *mut mj_txn, name: *const c_char) {
+    assert!(!name.is_null());
+    let name = unsafe {
+        std::ffi::CStr::from_ptr(name)
+            .to_str()
+            .expect("malformed name")
+    };
+    let txn = unsafe { &mut *txn }.deref_mut();
+    txn.env.remove_template(name);
+    txn.changes.remove(name);
+}
+
+/// \brief Clears all templates from the transaction.
+///
+/// @param txn Pointer to the transaction
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_txn_clear_templates(txn: *mut mj_txn) {
+    let txn = unsafe { &mut *txn }.deref_mut();
+    txn.env.clear_templates();
+    txn.changes.clear();
+}
+
+/// \brief Adds a global variable to the transaction.
+///
+/// @param txn Pointer to the transaction
+/// @param name Null-terminated string containing the name of the global
+/// @param data Pointer to the JSON encoded value of the global
+/// @param len Length of the value in bytes
+///
+/// @return mj_error NULL on success, or error information if the value
+/// cannot be parsed.
+///
+/// @see mj_env_add_global For the semantics outside of a transaction
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_txn_add_global(
+    txn: *mut mj_txn,
+    name: *const c_char,
+    data: *const u8,
+    len: usize,
+) -> *mut mj_error {
+    assert!(!name.is_null());
+    let name = unsafe {
+        std::ffi::CStr::from_ptr(name)
+            .to_str()
+            .expect("malformed name")
+    };
+    let bytes = unsafe { context::bytes(data, len) };
+    let value = match context::from_json(bytes) {
+        Ok(value) => value,
+        Err(e) => return e,
+    };
+    let txn = unsafe { &mut *txn }.deref_mut();
+    txn.env.add_global(name.to_string(), value);
+    std::ptr::null_mut()
+}
+
+/// \brief Removes a global variable from the transaction by name.
+///
+/// @param txn Pointer to the transaction
+/// @param name Null-terminated string containing the name of the global
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_txn_remove_global(txn: *mut mj_txn, name: *const c_char) {
+    assert!(!name.is_null());
+    let name = unsafe {
+        std::ffi::CStr::from_ptr(name)
+            .to_str()
+            .expect("malformed name")
+    };
+    let txn = unsafe { &mut *txn }.deref_mut();
+    txn.env.remove_global(name);
+}
+
+/// \brief Publishes all changes of the transaction at once and frees it.
+///
+/// Renders that started before the commit finish on the previous snapshot,
+/// renders that start afterwards see every change of the transaction.
+///
+/// @param txn Pointer to the transaction to commit
+///
+/// \note The transaction pointer becomes invalid after this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_txn_commit(txn: *mut mj_txn) {
+    assert!(!txn.is_null());
+    let txn = unsafe { mj_txn::take(txn) };
+    let state = txn.state;
+    state.templates().apply(txn.changes);
+    txn.guard.publish(txn.env);
+    state.templates().enforce(state);
+}
+
+/// \brief Discards all changes of the transaction and frees it.
+///
+/// @param txn Pointer to the transaction to abort
+///
+/// \note It is safe to pass NULL to this function. The transaction pointer
+/// becomes invalid after this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_txn_abort(txn: *mut mj_txn) {
+    if txn.is_null() {
+        return;
+    }
+    drop(unsafe { mj_txn::take(txn) });
+}
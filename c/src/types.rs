@@ -16,3 +16,41 @@ pub enum mj_undefined_behavior {
     /// Allows operations like `{{ undefined.foo.bar }}` without errors.
     MJ_UNDEFINED_BEHAVIOR_CHAINABLE,
 }
+
+/// \brief Defines how values printed by a template are escaped.
+///
+/// @see mj_env_set_auto_escape Function to choose the escaping by template name
+#[repr(C)]
+#[derive(Clone, Copy, PartialEq, Eq)]
+pub enum mj_auto_escape {
+    /// Values are printed as is.
+    MJ_AUTO_ESCAPE_NONE,
+    /// Values are escaped for HTML and XML, where `<`, `>`, `&`, `"`, `'`
+    /// and `/` are replaced by entities.
+    MJ_AUTO_ESCAPE_HTML,
+    /// Values are printed as JSON, with `<`, `>`, `&` and `'` escaped so
+    /// that the output can be embedded in HTML.
+    MJ_AUTO_ESCAPE_JSON,
+}
+
+/// \brief Defines the type of the value of an evaluated expression.
+///
+/// @see mj_expression_eval Function whose result carries this type
+#[repr(C)]
+#[derive(Clone, Copy, PartialEq, Eq)]
+pub enum mj_eval_kind {
+    /// The value is none or undefined.
+    MJ_EVAL_NONE,
+    /// The value is a boolean, stored in the boolean field.
+    MJ_EVAL_BOOL,
+    /// The value is an integer that fits 64 bits, stored in the integer
+    /// field.
+    MJ_EVAL_INT,
+    /// The value is a float, stored in the number field.
+    MJ_EVAL_FLOAT,
+    /// The value is a string, stored in the string field.
+    MJ_EVAL_STRING,
+    /// The value is of any other type, such as a list or a map, stored as
+    /// JSON in the string field.
+    MJ_EVAL_JSON,
+}
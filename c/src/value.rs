@@ -0,0 +1,151 @@
+use std::ffi::{c_char, c_void};
+
+use minijinja::Value;
+
+use super::*;
+
+/// \brief Represents a context value that was parsed once and can be
+/// rendered against any number of templates.
+///
+/// @see mj_value_from_json This function constructs a new value
+/// @see mj_value_free This function frees the heap memory of the value
+///
+/// \note The value is immutable and reference counted inside the Rust core,
+/// so it is safe to render with from multiple threads at once.
+#[repr(C)]
+pub struct mj_value {
+    /// The pointer to the minijinja::Value in the Rust code.
+    /// Only touch this on judging whether it is NULL.
+    pub inner: *mut c_void,
+}
+
+impl mj_value {
+    pub(crate) fn deref(&self) -> &Value {
+        unsafe { &*(self.inner as *const Value) }
+    }
+}
+
+impl mj_value {
+    /// \brief Frees the memory allocated for a context value.
+    ///
+    /// @param ptr Pointer to the value to free
+    ///
+    /// \note It is safe to pass NULL to this function.
+    #[unsafe(no_mangle)]
+    pub unsafe extern "C" fn mj_value_free(ptr: *mut mj_value) {
+        unsafe {
+            if ptr.is_null() {
+                return;
+            }
+            drop(Box::from_raw((*ptr).inner as *mut Value));
+            drop(Box::from_raw(ptr));
+        }
+    }
+}
+
+/// \brief Parses a JSON encoded context once into a reusable value.
+///
+/// @param data Pointer to the JSON encoded context
+/// @param len Length of the context in bytes
+///
+/// @return mj_result_value_from_json A result structure containing the value
+/// or error information if the context cannot be parsed.
+///
+/// \note The returned value must be freed using mj_value_free, and the result
+/// itself using mj_result_value_from_json_free.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_value_from_json(
+    data: *const u8,
+    len: usize,
+) -> *mut mj_result_value_from_json {
+    let bytes = unsafe { context::bytes(data, len) };
+    match context::from_json(bytes) {
+        Ok(value) => mj_result_value_from_json::ok(Box::into_raw(Box::new(mj_value {
+            inner: Box::into_raw(Box::new(value)) as *mut c_void,
+        }))),
+        Err(e) => mj_result_value_from_json::err(e),
+    }
+}
+
+/// \brief Renders a template stored in the environment with a parsed value.
+///
+/// The optional overlay is a small JSON encoded map whose keys are layered
+/// on top of the value for this render only. The value itself is neither
+/// copied nor modified.
+///
+/// @param env Pointer to the environment holding the template
+/// @param name Null-terminated string containing the name of the template
+/// @param value Pointer to the context value
+/// @param overlay Pointer to the JSON encoded overlay, may be NULL
+/// @param overlay_len Length of the overlay in bytes
+///
+/// @return mj_result_env_render_template A result structure containing the
+/// rendered string or error information if rendering fails.
+///
+/// \note The name and value parameters must not be NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_render_value(
+    env: *mut mj_env,
+    name: *const c_char,
+    value: *const mj_value,
+    overlay: *const u8,
+    overlay_len: usize,
+) -> *mut mj_result_env_render_template {
+    assert!(!name.is_null());
+    assert!(!value.is_null());
+    let name = unsafe {
+        std::ffi::CStr::from_ptr(name)
+            .to_str()
+            .expect("malformed name")
+    };
+    let overlay = unsafe { context::bytes(overlay, overlay_len) };
+    let state = unsafe { &*env }.deref();
+    let deadline = limits::deadline(state.timeout(0));
+
+    let env_guard = state.load();
+    let template = match env_guard.get_template(name) {
+        Ok(template) => template,
+        Err(e) => return mj_result_env_render_template::err(mj_error::new(e)),
+    };
+    state.template_used(name);
+    let value = match context::with_overlay(unsafe { &*value }.deref(), overlay) {
+        Ok(value) => value,
+        Err(e) => return mj_result_env_render_template::err(e),
+    };
+    match limits::render(&template, &value, deadline) {
+        Ok(rendered) => mj_result_env_render_template::ok(rendered),
+        Err(e) => mj_result_env_render_template::err(e),
+    }
+}
+
+/// \brief Renders a template handle with a parsed value.
+///
+/// @param tmpl Pointer to the template handle to render
+/// @param value Pointer to the context value
+/// @param overlay Pointer to the JSON encoded overlay, may be NULL
+/// @param overlay_len Length of the overlay in bytes
+///
+/// @return mj_result_env_render_template A result structure containing the
+/// rendered string or error information if rendering fails.
+///
+/// @see mj_env_render_value For the semantics of the overlay
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_template_render_value(
+    tmpl: *mut mj_template,
+    value: *const mj_value,
+    overlay: *const u8,
+    overlay_len: usize,
+) -> *mut mj_result_env_render_template {
+    assert!(!value.is_null());
+    let overlay = unsafe { context::bytes(overlay, overlay_len) };
+    let handle = unsafe { &*tmpl }.deref();
+    let deadline = handle.deadline();
+    let value = match context::with_overlay(unsafe { &*value }.deref(), overlay) {
+        Ok(value) => value,
+        Err(e) => return mj_result_env_render_template::err(e),
+    };
+    match limits::render(handle.template(), &value, deadline) {
+        Ok(rendered) => mj_result_env_render_template::ok(rendered),
+        Err(e) => mj_result_env_render_template::err(e),
+    }
+}
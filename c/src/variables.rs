@@ -0,0 +1,243 @@
+use std::collections::HashMap;
+use std::ffi::{CString, c_char};
+use std::sync::{Arc, Mutex};
+
+use minijinja::Template;
+
+use super::*;
+
+/// The variables a template reads from its context.
+pub(crate) struct Variables {
+    names: Vec<String>,
+    complete: bool,
+}
+
+impl Variables {
+    /// Analyzes `template` statically. Nested variables are listed as dotted
+    /// paths, such as `user.name`, if `nested` is set.
+    pub(crate) fn of(template: &Template, nested: bool) -> Self {
+        let mut names: Vec<String> = template.undeclared_variables(nested).into_iter().collect();
+        names.sort_unstable();
+        Variables {
+            names,
+            complete: !renders_others(template.source()),
+        }
+    }
+}
+
+/// Returns whether `source` has a tag that renders another template, whose
+/// variables the analysis of `source` does not cover. Tags inside comments
+/// and raw blocks count too, which errs on the safe side.
+fn renders_others(source: &str) -> bool {
+    source.match_indices("{%").any(|(i, _)| {
+        let tag = source[i + 2..].trim_start_matches(['-', '+']).trim_start();
+        ["include", "extends", "import", "from"]
+            .iter()
+            .any(|keyword| {
+                tag.strip_prefix(keyword).is_some_and(|rest| {
+                    !rest.starts_with(|c: char| c.is_alphanumeric() || c == '_')
+                })
+            })
+    })
+}
+
+/// The variables of the templates of an environment, by name and nesting.
+/// Entries are computed on first request and kept until the environment
+/// changes.
+#[derive(Default)]
+pub(crate) struct VariablesCache {
+    entries: Mutex<HashMap<(String, bool), (u64, Arc<Variables>)>>,
+}
+
+impl VariablesCache {
+    /// Returns the variables of template `name` at `generation`, analyzing
+    /// the template returned by `lookup` if they are not cached.
+    pub(crate) fn get(
+        &self,
+        generation: u64,
+        name: &str,
+        nested: bool,
+        lookup: impl FnOnce() -> Result<Arc<Variables>, minijinja::Error>,
+    ) -> Result<Arc<Variables>, minijinja::Error> {
+        let key = (name.to_string(), nested);
+        if let Some((cached, variables)) = self.entries.lock().unwrap().get(&key) {
+            if *cached == generation {
+                return Ok(variables.clone());
+            }
+        }
+        let variables = lookup()?;
+        self.entries
+            .lock()
+            .unwrap()
+            .insert(key, (generation, variables.clone()));
+        Ok(variables)
+    }
+}
+
+/// \brief Result structure for template variable functions.
+///
+/// On success, variables holds the sorted names of the variables the
+/// template reads from its context and error is NULL. On failure, variables
+/// is NULL and error contains error information.
+///
+/// @see mj_env_template_undeclared_variables Function that returns this
+/// result type
+/// @see mj_template_undeclared_variables Function that returns this result
+/// type
+///
+/// \note The result, including the names in it, is freed using
+/// mj_result_env_template_undeclared_variables_free.
+#[repr(C)]
+pub struct mj_result_env_template_undeclared_variables {
+    /// Pointer to the array of null-terminated names, or NULL if there are
+    /// none
+    pub variables: *mut *mut c_char,
+    /// Number of entries in the variables array
+    pub len: usize,
+    /// Whether the names cover every variable rendering the template reads.
+    /// False if the template includes, extends or imports other templates,
+    /// whose variables are not listed.
+    pub complete: bool,
+    /// Pointer to error information, or NULL on success
+    pub error: *mut mj_error,
+}
+
+impl mj_result_env_template_undeclared_variables {
+    pub(crate) fn ok(variables: &Variables) -> *mut Self {
+        let len = variables.names.len();
+        let names = match len {
+            0 => std::ptr::null_mut(),
+            _ => {
+                let names: Box<[*mut c_char]> = variables
+                    .names
+                    .iter()
+                    .map(|name| {
+                        CString::new(name.as_str())
+                            .expect("CString::new failed")
+                            .into_raw()
+                    })
+                    .collect();
+                Box::into_raw(names) as *mut *mut c_char
+            }
+        };
+        Box::into_raw(Box::new(mj_result_env_template_undeclared_variables {
+            variables: names,
+            len,
+            complete: variables.complete,
+            error: std::ptr::null_mut(),
+        }))
+    }
+
+    pub(crate) fn err(error: *mut mj_error) -> *mut Self {
+        Box::into_raw(Box::new(mj_result_env_template_undeclared_variables {
+            variables: std::ptr::null_mut(),
+            len: 0,
+            complete: false,
+            error,
+        }))
+    }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_result_env_template_undeclared_variables_free(
+    result: *mut mj_result_env_template_undeclared_variables,
+) {
+    if result.is_null() {
+        return;
+    }
+
+    unsafe {
+        let res = Box::from_raw(result);
+        if !res.variables.is_null() {
+            let names = Box::from_raw(std::ptr::slice_from_raw_parts_mut(res.variables, res.len));
+            for name in names.iter() {
+                drop(CString::from_raw(*name));
+            }
+        }
+        if !res.error.is_null() {
+            drop(Box::from_raw(res.error));
+        }
+    }
+}
+
+/// \brief Lists the variables a template of the environment reads from its
+/// context.
+///
+/// The template is analyzed statically: every variable it reads without
+/// declaring it first, with `set`, as a loop variable or as a macro
+/// argument, is listed. Callers can use this to only serialize the parts of
+/// a context that a template uses.
+///
+/// The analysis of a template runs once and is cached until the environment
+/// changes.
+///
+/// @param env Pointer to the environment holding the template
+/// @param name Null-terminated string containing the name of the template
+/// @param nested Whether to list the attributes read from variables as
+/// dotted paths, such as `user.name`, instead of top-level names only
+///
+/// @return mj_result_env_template_undeclared_variables A result structure
+/// containing the names or error information if the template cannot be
+/// found.
+///
+/// \note The name parameter must not be NULL. Variables of the templates a
+/// template includes, extends or imports are not listed, which the
+/// `complete` field of the result reports.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_template_undeclared_variables(
+    env: *mut mj_env,
+    name: *const c_char,
+    nested: bool,
+) -> *mut mj_result_env_template_undeclared_variables {
+    assert!(!name.is_null());
+    let name = unsafe {
+        std::ffi::CStr::from_ptr(name)
+            .to_str()
+            .expect("malformed name")
+    };
+    let state = unsafe { &*env }.deref();
+    let generation = state.generation();
+    let variables = state.variables().get(generation, name, nested, || {
+        let env = state.load();
+        Ok(Arc::new(Variables::of(&env.get_template(name)?, nested)))
+    });
+    match variables {
+        Ok(variables) => mj_result_env_template_undeclared_variables::ok(&variables),
+        Err(e) => mj_result_env_template_undeclared_variables::err(mj_error::new(e)),
+    }
+}
+
+/// \brief Lists the variables a template handle reads from its context.
+///
+/// Works like mj_env_template_undeclared_variables for the template the
+/// handle was taken from. The analysis runs once per handle.
+///
+/// @param tmpl Pointer to the template handle
+/// @param nested Whether to list the attributes read from variables as
+/// dotted paths instead of top-level names only
+///
+/// @return mj_result_env_template_undeclared_variables A result structure
+/// containing the names.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_template_undeclared_variables(
+    tmpl: *mut mj_template,
+    nested: bool,
+) -> *mut mj_result_env_template_undeclared_variables {
+    let handle = unsafe { &*tmpl }.deref();
+    mj_result_env_template_undeclared_variables::ok(handle.variables(nested))
+}
+
+/// \brief Returns a number that changes whenever the environment changes.
+///
+/// Callers that cache what they learn about the templates of an
+/// environment, such as their variables, can compare this number to tell
+/// whether their cache is still current.
+///
+/// @param env Pointer to the environment
+///
+/// @return The generation of the environment
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn mj_env_generation(env: *mut mj_env) -> u64 {
+    let state = unsafe { &*env }.deref();
+    state.generation()
+}
@@ -0,0 +1,143 @@
+use std::ffi::{c_int, c_void};
+use std::io::{self, Write};
+use std::time::Instant;
+
+use minijinja::{Error, ErrorKind, Template, Value};
+
+use super::*;
+
+/// \brief Callback receiving rendered output in chunks.
+///
+/// The callback is invoked with the user data pointer given to the render
+/// function, a pointer to the next chunk of output and its length in bytes.
+/// The chunk is only valid for the duration of the call.
+///
+/// \note Return 0 to continue rendering, any other value aborts the render
+/// with an MJ_WRITE_FAILURE error.
+pub type mj_write_callback =
+    unsafe extern "C" fn(user_data: *mut c_void, data: *const u8, len: usize) -> c_int;
+
+/// Size of the chunks handed to a mj_write_callback.
+pub(crate) const CHUNK_SIZE: usize = 8 * 1024;
+
+/// An `io::Write` that buffers output into fixed-size chunks and pushes
+/// them to a C callback, so the full output is never held in memory.
+pub(crate) struct CallbackWriter {
+    callback: mj_write_callback,
+    user_data: *mut c_void,
+    buf: Vec<u8>,
+}
+
+impl CallbackWriter {
+    pub(crate) fn new(callback: mj_write_callback, user_data: *mut c_void) -> Self {
+        CallbackWriter {
+            callback,
+            user_data,
+            buf: Vec::with_capacity(CHUNK_SIZE),
+        }
+    }
+
+    fn emit(&mut self, chunk: &[u8]) -> io::Result<()> {
+        if chunk.is_empty() {
+            return Ok(());
+        }
+        match unsafe { (self.callback)(self.user_data, chunk.as_ptr(), chunk.len()) } {
+            0 => Ok(()),
+            _ => Err(io::Error::other("write callback aborted rendering")),
+        }
+    }
+
+    fn flush_buf(&mut self) -> io::Result<()> {
+        let buf = std::mem::take(&mut self.buf);
+        let rv = self.emit(&buf);
+        self.buf = buf;
+        self.buf.clear();
+        rv
+    }
+}
+
+impl io::Write for CallbackWriter {
+    fn write(&mut self, data: &[u8]) -> io::Result<usize> {
+        if self.buf.len() + data.len() > CHUNK_SIZE {
+            self.flush_buf()?;
+        }
+        if data.len() >= CHUNK_SIZE {
+            for chunk in data.chunks(CHUNK_SIZE) {
+                self.emit(chunk)?;
+            }
+        } else {
+            self.buf.extend_from_slice(data);
+        }
+        Ok(data.len())
+    }
+
+    fn flush(&mut self) -> io::Result<()> {
+        self.flush_buf()
+    }
+}
+
+/// Renders `template` with `value` within `deadline`, streaming the output
+/// to `callback`.
+pub(crate) fn render_to_callback(
+    template: &Template<'_, '_>,
+    value: &Value,
+    deadline: Option<Instant>,
+    callback: mj_write_callback,
+    user_data: *mut c_void,
+) -> Result<(), *mut mj_error> {
+    let writer = CallbackWriter::new(callback, user_data);
+    let mut writer = limits::render_to_write(template, value, deadline, writer)?;
+    writer.flush().map_err(|e| {
+        mj_error::new(
+            Error::new(ErrorKind::WriteFailure, "failed to flush rendered output").with_source(e),
+        )
+    })
+}
+
+/// An `io::Write` over a caller provided buffer. Output that does not fit
+/// is dropped but still counted, so the caller learns the required length.
+pub(crate) struct BufferWriter<'a> {
+    buf: &'a mut [u8],
+    len: usize,
+}
+
+impl<'a> BufferWriter<'a> {
+    pub(crate) unsafe fn new(buf: *mut u8, cap: usize) -> Self {
+        let buf: &'a mut [u8] = if buf.is_null() || cap == 0 {
+            &mut []
+        } else {
+            unsafe { std::slice::from_raw_parts_mut(buf, cap) }
+        };
+        BufferWriter { buf, len: 0 }
+    }
+}
+
+impl io::Write for BufferWriter<'_> {
+    fn write(&mut self, data: &[u8]) -> io::Result<usize> {
+        if self.len < self.buf.len() {
+            let n = data.len().min(self.buf.len() - self.len);
+            self.buf[self.len..self.len + n].copy_from_slice(&data[..n]);
+        }
+        self.len += data.len();
+        Ok(data.len())
+    }
+
+    fn flush(&mut self) -> io::Result<()> {
+        Ok(())
+    }
+}
+
+/// Renders `template` with `value` within `deadline` into the caller
+/// provided buffer and returns the full length of the output, which may
+/// exceed `cap`.
+pub(crate) unsafe fn render_to_buffer(
+    template: &Template<'_, '_>,
+    value: &Value,
+    deadline: Option<Instant>,
+    buf: *mut u8,
+    cap: usize,
+) -> Result<usize, *mut mj_error> {
+    let writer = unsafe { BufferWriter::new(buf, cap) };
+    let writer = limits::render_to_write(template, value, deadline, writer)?;
+    Ok(writer.len)
+}
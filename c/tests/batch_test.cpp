@@ -0,0 +1,121 @@
+#include "test_base.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+TEST_F(MiniJinjaTest, RenderBatch)
+{
+    // Test rendering one template against many contexts
+    auto error = mj_env_add_template(env, "batch_template", "Hello {{ name }}!");
+    EXPECT_EQ(error, nullptr);
+
+    std::vector<std::string> json_data;
+    for (int i = 0; i < 100; i++) {
+        json_data.push_back("{\"name\": \"user" + std::to_string(i) + "\"}");
+    }
+    json_data[42] = "{ malformed";
+
+    std::vector<mj_buffer> contexts;
+    for (auto& data : json_data) {
+        contexts.push_back(mj_buffer { reinterpret_cast<const uint8_t*>(data.c_str()), data.length() });
+    }
+
+    auto batch = mj_env_render_batch(env, "batch_template", contexts.data(), contexts.size());
+    ASSERT_EQ(batch->len, 100u);
+    for (int i = 0; i < 100; i++) {
+        if (i == 42) {
+            ASSERT_NE(batch->results[i].error, nullptr);
+            EXPECT_EQ(batch->results[i].error->code, MJ_CANNOT_DESERIALIZE);
+            EXPECT_EQ(batch->results[i].result, nullptr);
+            continue;
+        }
+        EXPECT_EQ(batch->results[i].error, nullptr);
+        EXPECT_EQ(std::string(batch->results[i].result), "Hello user" + std::to_string(i) + "!");
+    }
+    mj_result_env_render_batch_free(batch);
+}
+
+TEST_F(MiniJinjaTest, RenderBatchTemplateNotFound)
+{
+    // Test that every item reports a missing template
+    std::string json_data = "{}";
+    mj_buffer contexts[2] = {
+        { reinterpret_cast<const uint8_t*>(json_data.c_str()), json_data.length() },
+        { reinterpret_cast<const uint8_t*>(json_data.c_str()), json_data.length() },
+    };
+
+    auto batch = mj_env_render_batch(env, "non_existent", contexts, 2);
+    ASSERT_EQ(batch->len, 2u);
+    for (uintptr_t i = 0; i < batch->len; i++) {
+        ASSERT_NE(batch->results[i].error, nullptr);
+        EXPECT_EQ(batch->results[i].error->code, MJ_TEMPLATE_NOT_FOUND);
+        // Test that every item carries its own copy of the message
+        EXPECT_NE(std::string(mj_error_message(batch->results[i].error)).find("non_existent"),
+                  std::string::npos);
+    }
+    EXPECT_NE(batch->results[0].error, batch->results[1].error);
+    mj_result_env_render_batch_free(batch);
+}
+
+TEST_F(MiniJinjaTest, RenderBatchItems)
+{
+    // Test rendering mixed (template, context) pairs
+    auto error = mj_env_add_template(env, "batch_a", "A{{ v }}");
+    EXPECT_EQ(error, nullptr);
+    error = mj_env_add_template(env, "batch_b", "B{{ v }}");
+    EXPECT_EQ(error, nullptr);
+
+    std::string json1 = R"({"v": 1})";
+    std::string json2 = R"({"v": 2})";
+    mj_render_item items[3] = {
+        { "batch_a", reinterpret_cast<const uint8_t*>(json1.c_str()), json1.length() },
+        { "batch_b", reinterpret_cast<const uint8_t*>(json2.c_str()), json2.length() },
+        { "batch_missing", reinterpret_cast<const uint8_t*>(json1.c_str()), json1.length() },
+    };
+
+    auto batch = mj_env_render_batch_items(env, items, 3);
+    ASSERT_EQ(batch->len, 3u);
+    EXPECT_STREQ(batch->results[0].result, "A1");
+    EXPECT_STREQ(batch->results[1].result, "B2");
+    ASSERT_NE(batch->results[2].error, nullptr);
+    EXPECT_EQ(batch->results[2].error->code, MJ_TEMPLATE_NOT_FOUND);
+    mj_result_env_render_batch_free(batch);
+}
+
+TEST_F(MiniJinjaTest, RenderBatchEmpty)
+{
+    // Test rendering an empty batch
+    auto batch = mj_env_render_batch(env, "batch_template", nullptr, 0);
+    EXPECT_EQ(batch->len, 0u);
+    mj_result_env_render_batch_free(batch);
+}
+
+TEST_F(MiniJinjaTest, RenderBatchSharedPaths)
+{
+    // Test that batch renders are recorded in the metrics and use the
+    // context decoding mode of the environment
+    mj_env_set_stats(env, true);
+    mj_env_set_lazy_context(env, true);
+    auto error = mj_env_add_template(env, "batch_stats", "{{ user.name }}");
+    EXPECT_EQ(error, nullptr);
+
+    std::string json = R"({"user": {"name": "lazy"}, "unused": [1, 2, 3]})";
+    mj_buffer contexts[2] = {
+        { reinterpret_cast<const uint8_t*>(json.c_str()), json.length() },
+        { reinterpret_cast<const uint8_t*>(json.c_str()), json.length() },
+    };
+    auto batch = mj_env_render_batch(env, "batch_stats", contexts, 2);
+    ASSERT_EQ(batch->len, 2u);
+    EXPECT_STREQ(batch->results[0].result, "lazy");
+    EXPECT_STREQ(batch->results[1].result, "lazy");
+    mj_result_env_render_batch_free(batch);
+
+    auto stats = mj_env_stats(env);
+    ASSERT_EQ(stats->len, 1u);
+    EXPECT_STREQ(stats->templates[0].name, "batch_stats");
+    EXPECT_EQ(stats->templates[0].calls, 2u);
+    EXPECT_EQ(stats->templates[0].output_bytes, 2 * strlen("lazy"));
+    EXPECT_EQ(stats->templates[0].render.count, 2u);
+    EXPECT_EQ(stats->templates[0].output.count, 0u);
+    mj_stats_free(stats);
+}
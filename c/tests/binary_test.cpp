@@ -0,0 +1,64 @@
+#include "test_base.h"
+#include <cstring>
+#include <vector>
+
+TEST_F(MiniJinjaTest, RenderBinaryContext)
+{
+    // Test rendering with a MessagePack encoded context
+    auto error = mj_env_add_template(env, "binary_template",
+        "{{ name }} {{ n }} {{ f }} {{ items|sum }} {{ ok }} {{ missing is none }}");
+    EXPECT_EQ(error, nullptr);
+
+    // {"name": "World", "n": -3, "f": 1.5, "items": [1, 2], "ok": true, "missing": nil}
+    std::vector<uint8_t> data = {
+        0x86,
+        0xa4, 'n', 'a', 'm', 'e', 0xa5, 'W', 'o', 'r', 'l', 'd',
+        0xa1, 'n', 0xfd,
+        0xa1, 'f', 0xcb, 0x3f, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0xa5, 'i', 't', 'e', 'm', 's', 0x92, 0x01, 0x02,
+        0xa2, 'o', 'k', 0xc3,
+        0xa7, 'm', 'i', 's', 's', 'i', 'n', 'g', 0xc0,
+    };
+    auto result = mj_env_render_binary(env, "binary_template", data.data(), data.size());
+    EXPECT_EQ(result->error, nullptr);
+    EXPECT_STREQ(result->result, "World -3 1.5 3 true true");
+    mj_result_env_render_template_free(result);
+}
+
+TEST_F(MiniJinjaTest, RenderBinaryJsonExtension)
+{
+    // Test a value embedded as JSON through extension type 1
+    auto error = mj_env_add_template(env, "binary_ext_template", "{{ meta.a }}-{{ meta.b[1] }}");
+    EXPECT_EQ(error, nullptr);
+
+    std::string json = R"({"a":1,"b":[2,3]})";
+    std::vector<uint8_t> data = { 0x81, 0xa4, 'm', 'e', 't', 'a', 0xc7,
+        static_cast<uint8_t>(json.size()), 0x01 };
+    data.insert(data.end(), json.begin(), json.end());
+
+    auto get_result = mj_env_get_template(env, "binary_ext_template");
+    ASSERT_NE(get_result->tmpl, nullptr);
+    struct mj_template* tmpl = get_result->tmpl;
+    mj_result_env_get_template_free(get_result);
+
+    auto result = mj_template_render_binary(tmpl, data.data(), data.size());
+    EXPECT_EQ(result->error, nullptr);
+    EXPECT_STREQ(result->result, "1-3");
+    mj_result_env_render_template_free(result);
+
+    mj_template_free(tmpl);
+}
+
+TEST_F(MiniJinjaTest, RenderBinaryMalformed)
+{
+    // Test rendering with a truncated context
+    auto error = mj_env_add_template(env, "binary_malformed", "{{ name }}");
+    EXPECT_EQ(error, nullptr);
+
+    std::vector<uint8_t> data = { 0x81, 0xa4, 'n', 'a', 'm', 'e', 0xa5, 'W', 'o' };
+    auto result = mj_env_render_binary(env, "binary_malformed", data.data(), data.size());
+    EXPECT_EQ(result->result, nullptr);
+    ASSERT_NE(result->error, nullptr);
+    EXPECT_EQ(result->error->code, MJ_CANNOT_DESERIALIZE);
+    mj_result_env_render_template_free(result);
+}
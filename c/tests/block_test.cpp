@@ -0,0 +1,76 @@
+#include "test_base.h"
+
+namespace {
+
+mj_result_env_render_template* renderBlock(mj_env* env, const char* name, const char* block, const std::string& json)
+{
+    return mj_env_render_block(env, name, block, reinterpret_cast<const uint8_t*>(json.data()), json.size());
+}
+
+mj_result_env_render_template* callMacro(mj_env* env, const char* name, const char* macro_name, const std::string& json, const std::string& args)
+{
+    return mj_env_call_macro(env, name, macro_name,
+        reinterpret_cast<const uint8_t*>(json.data()), json.size(),
+        reinterpret_cast<const uint8_t*>(args.data()), args.size());
+}
+
+} // namespace
+
+TEST_F(MiniJinjaTest, RenderBlock)
+{
+    auto error1 = mj_env_add_template(env, "layout.html", "<html>{% block title %}Default{% endblock %}|{% block body %}{% endblock %}</html>");
+    EXPECT_EQ(error1, nullptr);
+    auto error2 = mj_env_add_template(env, "page.html",
+        "{% extends \"layout.html\" %}{% set greeting = \"Hello\" %}"
+        "{% block body %}{{ greeting }} {{ name }}!{% endblock %}");
+    EXPECT_EQ(error2, nullptr);
+
+    // Test rendering a block of the child template, which sees its variables
+    auto result1 = renderBlock(env, "page.html", "body", R"({"name": "World"})");
+    EXPECT_EQ(result1->error, nullptr);
+    EXPECT_STREQ(result1->result, "Hello World!");
+    mj_result_env_render_template_free(result1);
+
+    // Test rendering a block inherited from the layout
+    auto result2 = renderBlock(env, "page.html", "title", R"({})");
+    EXPECT_EQ(result2->error, nullptr);
+    EXPECT_STREQ(result2->result, "Default");
+    mj_result_env_render_template_free(result2);
+
+    // Test rendering a block that does not exist
+    auto result3 = renderBlock(env, "page.html", "missing", R"({})");
+    ASSERT_NE(result3->error, nullptr);
+    EXPECT_EQ(result3->error->code, MJ_UNKNOWN_BLOCK);
+    mj_result_env_render_template_free(result3);
+}
+
+TEST_F(MiniJinjaTest, CallMacro)
+{
+    auto error = mj_env_add_template(env, "macros.html",
+        "{% macro item(label, price=0) %}<li>{{ label }}: {{ price }}{{ currency }}</li>{% endmacro %}"
+        "{% macro empty() %}none{% endmacro %}");
+    EXPECT_EQ(error, nullptr);
+
+    // Test calling a macro with positional arguments and the context
+    auto result1 = callMacro(env, "macros.html", "item", R"({"currency": "$"})", R"(["Tea", 3])");
+    EXPECT_EQ(result1->error, nullptr);
+    EXPECT_STREQ(result1->result, "<li>Tea: 3$</li>");
+    mj_result_env_render_template_free(result1);
+
+    // Test calling a macro without arguments
+    auto result2 = callMacro(env, "macros.html", "empty", R"({})", "");
+    EXPECT_EQ(result2->error, nullptr);
+    EXPECT_STREQ(result2->result, "none");
+    mj_result_env_render_template_free(result2);
+
+    // Test arguments that are not an array
+    auto result3 = callMacro(env, "macros.html", "item", R"({})", R"({"label": "Tea"})");
+    ASSERT_NE(result3->error, nullptr);
+    EXPECT_EQ(result3->error->code, MJ_CANNOT_DESERIALIZE);
+    mj_result_env_render_template_free(result3);
+
+    // Test calling a macro that does not exist
+    auto result4 = callMacro(env, "macros.html", "missing", R"({})", "");
+    EXPECT_NE(result4->error, nullptr);
+    mj_result_env_render_template_free(result4);
+}
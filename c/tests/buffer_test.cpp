@@ -0,0 +1,82 @@
+#include "test_base.h"
+#include <cstring>
+#include <vector>
+
+TEST_F(MiniJinjaTest, RenderIntoBuffer)
+{
+    // Test rendering into a buffer that is large enough
+    auto error = mj_env_add_template(env, "buffer_template", "Hello {{ name }}!");
+    EXPECT_EQ(error, nullptr);
+
+    std::vector<uint8_t> buf(64);
+    uintptr_t out_len = 0;
+    std::string json_data = R"({"name": "World"})";
+    error = mj_env_render_into(env, "buffer_template",
+        reinterpret_cast<const uint8_t*>(json_data.c_str()), json_data.length(),
+        buf.data(), buf.size(), &out_len);
+    EXPECT_EQ(error, nullptr);
+    EXPECT_EQ(out_len, strlen("Hello World!"));
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(buf.data()), out_len), "Hello World!");
+}
+
+TEST_F(MiniJinjaTest, RenderIntoBufferTooSmall)
+{
+    // Test that a short buffer reports the required length
+    auto error = mj_env_add_template(env, "buffer_small", "{{ text }}");
+    EXPECT_EQ(error, nullptr);
+
+    std::string json_data = R"({"text": "a rather long piece of text"})";
+    uintptr_t out_len = 0;
+    error = mj_env_render_into(env, "buffer_small",
+        reinterpret_cast<const uint8_t*>(json_data.c_str()), json_data.length(),
+        nullptr, 0, &out_len);
+    EXPECT_EQ(error, nullptr);
+    EXPECT_EQ(out_len, strlen("a rather long piece of text"));
+
+    std::vector<uint8_t> buf(out_len);
+    uintptr_t second_len = 0;
+    error = mj_env_render_into(env, "buffer_small",
+        reinterpret_cast<const uint8_t*>(json_data.c_str()), json_data.length(),
+        buf.data(), buf.size(), &second_len);
+    EXPECT_EQ(error, nullptr);
+    EXPECT_EQ(second_len, out_len);
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(buf.data()), second_len),
+        "a rather long piece of text");
+}
+
+TEST_F(MiniJinjaTest, RenderIntoBufferError)
+{
+    // Test error reporting when rendering into a buffer
+    uint8_t buf[16];
+    uintptr_t out_len = 0;
+    std::string json_data = "{}";
+    auto error = mj_env_render_into(env, "non_existent",
+        reinterpret_cast<const uint8_t*>(json_data.c_str()), json_data.length(),
+        buf, sizeof(buf), &out_len);
+    ASSERT_NE(error, nullptr);
+    EXPECT_EQ(error->code, MJ_TEMPLATE_NOT_FOUND);
+    mj_error_free(error);
+}
+
+TEST_F(MiniJinjaTest, TemplateHandleRenderIntoBuffer)
+{
+    // Test rendering a template handle into a buffer
+    auto error = mj_env_add_template(env, "buffer_handle", "{{ a }}-{{ b }}");
+    EXPECT_EQ(error, nullptr);
+
+    auto get_result = mj_env_get_template(env, "buffer_handle");
+    ASSERT_NE(get_result->tmpl, nullptr);
+    struct mj_template* tmpl = get_result->tmpl;
+    mj_result_env_get_template_free(get_result);
+
+    uint8_t buf[16];
+    uintptr_t out_len = 0;
+    std::string json_data = R"({"a": "x", "b": "y"})";
+    error = mj_template_render_into(tmpl,
+        reinterpret_cast<const uint8_t*>(json_data.c_str()), json_data.length(),
+        buf, sizeof(buf), &out_len);
+    EXPECT_EQ(error, nullptr);
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(buf), out_len), "x-y");
+
+    mj_template_free(tmpl);
+}
@@ -0,0 +1,108 @@
+#include "test_base.h"
+
+#include <utility>
+#include <vector>
+
+namespace {
+
+void appendU32(std::string& out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+// Builds a bundle with the layout expected by mj_env_load_bundle
+std::string makeBundle(const std::vector<std::pair<std::string, std::string>>& entries)
+{
+    std::string out = "GJB1";
+    appendU32(out, static_cast<uint32_t>(entries.size()));
+    for (const auto& entry : entries) {
+        appendU32(out, static_cast<uint32_t>(entry.first.size()));
+        appendU32(out, static_cast<uint32_t>(entry.second.size()));
+        out += entry.first;
+    }
+    for (const auto& entry : entries) {
+        out += entry.second;
+    }
+    return out;
+}
+
+mj_result_env_load_bundle* loadBundle(mj_env* env, const std::string& bundle)
+{
+    return mj_env_load_bundle_bytes(env, reinterpret_cast<const uint8_t*>(bundle.data()), bundle.size());
+}
+
+} // namespace
+
+TEST_F(MiniJinjaTest, BundleBytes)
+{
+    // Test loading several templates that refer to each other
+    auto error = mj_env_add_template(env, "hello.txt", "Added {{ name }}");
+    EXPECT_EQ(error, nullptr);
+
+    auto bundle = makeBundle({
+        { "layout.html", "<p>{% block body %}{% endblock %}</p>" },
+        { "page.html", "{% extends \"layout.html\" %}{% block body %}{{ title }}{% endblock %}" },
+        { "hello.txt", "Hello {{ name }}!" },
+    });
+    auto result = loadBundle(env, bundle);
+    EXPECT_EQ(result->errors, nullptr);
+    EXPECT_EQ(result->len, 0);
+    mj_result_env_load_bundle_free(result);
+
+    auto render_result1 = renderTemplate("page.html", R"({"title": "Home"})");
+    EXPECT_EQ(render_result1->error, nullptr);
+    EXPECT_STREQ(render_result1->result, "<p>Home</p>");
+    mj_result_env_render_template_free(render_result1);
+
+    // Test that bundle entries replace templates of the same name
+    auto render_result2 = renderTemplate("hello.txt", R"({"name": "World"})");
+    EXPECT_EQ(render_result2->error, nullptr);
+    EXPECT_STREQ(render_result2->result, "Hello World!");
+    mj_result_env_render_template_free(render_result2);
+}
+
+TEST_F(MiniJinjaTest, BundleSyntaxErrors)
+{
+    // Test that every syntax error is reported and nothing is installed
+    auto bundle = makeBundle({
+        { "good.txt", "Good {{ name }}" },
+        { "bad1.txt", "{% if %}" },
+        { "bad2.txt", "{{ name" },
+    });
+    auto result = loadBundle(env, bundle);
+    ASSERT_EQ(result->len, 2);
+    EXPECT_EQ(result->errors[0]->code, MJ_SYNTAX_ERROR);
+    EXPECT_STREQ(mj_error_template_name(result->errors[0]), "bad1.txt");
+    EXPECT_EQ(result->errors[1]->code, MJ_SYNTAX_ERROR);
+    EXPECT_STREQ(mj_error_template_name(result->errors[1]), "bad2.txt");
+    mj_result_env_load_bundle_free(result);
+
+    auto render_result = renderTemplate("good.txt", R"({"name": "World"})");
+    ASSERT_NE(render_result->error, nullptr);
+    EXPECT_EQ(render_result->error->code, MJ_TEMPLATE_NOT_FOUND);
+    mj_result_env_render_template_free(render_result);
+}
+
+TEST_F(MiniJinjaTest, BundleMalformed)
+{
+    // Test a truncated bundle
+    auto bundle = makeBundle({ { "hello.txt", "Hello {{ name }}!" } });
+    auto result1 = loadBundle(env, bundle.substr(0, bundle.size() - 1));
+    ASSERT_EQ(result1->len, 1);
+    EXPECT_EQ(result1->errors[0]->code, MJ_CANNOT_DESERIALIZE);
+    mj_result_env_load_bundle_free(result1);
+
+    // Test a missing bundle file
+    auto result2 = mj_env_load_bundle(env, "/nonexistent/templates.bundle");
+    ASSERT_EQ(result2->len, 1);
+    EXPECT_EQ(result2->errors[0]->code, MJ_INVALID_OPERATION);
+    mj_result_env_load_bundle_free(result2);
+
+    // Test a bundle that names a template twice
+    auto result3 = loadBundle(env, makeBundle({ { "a.txt", "A" }, { "a.txt", "B" } }));
+    ASSERT_EQ(result3->len, 1);
+    EXPECT_EQ(result3->errors[0]->code, MJ_CANNOT_DESERIALIZE);
+    mj_result_env_load_bundle_free(result3);
+}
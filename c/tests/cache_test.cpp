@@ -0,0 +1,90 @@
+#include "test_base.h"
+
+namespace {
+
+mj_render_cache_stats cacheStats(mj_env* env)
+{
+    mj_render_cache_stats stats;
+    mj_env_render_cache_stats(env, &stats);
+    return stats;
+}
+
+} // namespace
+
+TEST_F(MiniJinjaTest, RenderCache)
+{
+    // Test hits for byte-identical contexts and misses for different ones
+    mj_env_set_render_cache(env, 1 << 20);
+    auto error = mj_env_add_template(env, "cache_test", "Hello {{ name }}!");
+    EXPECT_EQ(error, nullptr);
+
+    for (int i = 0; i < 3; i++) {
+        auto render_result = renderTemplate("cache_test", R"({"name": "World"})");
+        EXPECT_EQ(render_result->error, nullptr);
+        EXPECT_STREQ(render_result->result, "Hello World!");
+        mj_result_env_render_template_free(render_result);
+    }
+    auto render_result1 = renderTemplate("cache_test", R"({"name": "Other"})");
+    EXPECT_EQ(render_result1->error, nullptr);
+    EXPECT_STREQ(render_result1->result, "Hello Other!");
+    mj_result_env_render_template_free(render_result1);
+
+    auto stats1 = cacheStats(env);
+    EXPECT_EQ(stats1.hits, 2);
+    EXPECT_EQ(stats1.misses, 2);
+    EXPECT_EQ(stats1.entries, 2);
+    EXPECT_GT(stats1.bytes, 0);
+    EXPECT_EQ(stats1.budget, 1 << 20);
+
+    // Test that changing the template invalidates its cached output
+    error = mj_env_add_template(env, "cache_test", "Hi {{ name }}!");
+    EXPECT_EQ(error, nullptr);
+    auto render_result2 = renderTemplate("cache_test", R"({"name": "World"})");
+    EXPECT_EQ(render_result2->error, nullptr);
+    EXPECT_STREQ(render_result2->result, "Hi World!");
+    mj_result_env_render_template_free(render_result2);
+
+    mj_env_remove_template(env, "cache_test");
+    auto render_result3 = renderTemplate("cache_test", R"({"name": "World"})");
+    ASSERT_NE(render_result3->error, nullptr);
+    EXPECT_EQ(render_result3->error->code, MJ_TEMPLATE_NOT_FOUND);
+    mj_result_env_render_template_free(render_result3);
+
+    auto stats2 = cacheStats(env);
+    EXPECT_EQ(stats2.hits, 2);
+    EXPECT_EQ(stats2.misses, 4);
+}
+
+TEST_F(MiniJinjaTest, RenderCacheEviction)
+{
+    // Test that the least recently used entries are evicted to fit the budget
+    mj_env_set_render_cache(env, 512);
+    auto error = mj_env_add_template(env, "cache_test", "{{ text }}");
+    EXPECT_EQ(error, nullptr);
+
+    std::string text(100, 'x');
+    for (int i = 0; i < 10; i++) {
+        std::string ctx = "{\"text\": \"" + text + std::to_string(i) + "\"}";
+        auto render_result = renderTemplate("cache_test", ctx);
+        EXPECT_EQ(render_result->error, nullptr);
+        mj_result_env_render_template_free(render_result);
+    }
+
+    auto stats = cacheStats(env);
+    EXPECT_LE(stats.bytes, 512);
+    EXPECT_GT(stats.evictions, 0);
+    EXPECT_EQ(stats.entries + stats.evictions, 10);
+
+    // Test that the most recent entry is still cached
+    std::string ctx = "{\"text\": \"" + text + "9\"}";
+    auto render_result = renderTemplate("cache_test", ctx);
+    EXPECT_EQ(render_result->error, nullptr);
+    mj_result_env_render_template_free(render_result);
+    EXPECT_EQ(cacheStats(env).hits, 1);
+
+    // Test disabling the cache
+    mj_env_set_render_cache(env, 0);
+    auto disabled = cacheStats(env);
+    EXPECT_EQ(disabled.budget, 0);
+    EXPECT_EQ(disabled.entries, 0);
+}
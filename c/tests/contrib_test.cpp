@@ -0,0 +1,66 @@
+#include "test_base.h"
+
+TEST_F(MiniJinjaTest, ContribNotAdded)
+{
+    // Test that the pack is opt-in
+    auto result = renderNamedString("number.txt", "{{ n | numberformat }}", R"({"n": 1})");
+    ASSERT_NE(result->error, nullptr);
+    EXPECT_EQ(result->error->code, MJ_UNKNOWN_FILTER);
+    mj_result_env_render_template_free(result);
+}
+
+TEST_F(MiniJinjaTest, ContribNumberFormat)
+{
+    mj_env_add_contrib(env);
+
+    auto result1 = renderNamedString("number.txt", "{{ n | numberformat(decimals=2) }}", R"({"n": 1234567.891})");
+    EXPECT_EQ(result1->error, nullptr);
+    EXPECT_STREQ(result1->result, "1,234,567.89");
+    mj_result_env_render_template_free(result1);
+
+    auto result2 = renderNamedString("number.txt", "{{ n | numberformat(decimals=1, thousands='.', point=',') }}", R"({"n": -1234.5})");
+    EXPECT_EQ(result2->error, nullptr);
+    EXPECT_STREQ(result2->result, "-1.234,5");
+    mj_result_env_render_template_free(result2);
+
+    auto result3 = renderNamedString("number.txt", "{{ n | numberformat }}|{{ m | numberformat }}", R"({"n": 999, "m": -0.001})");
+    EXPECT_EQ(result3->error, nullptr);
+    EXPECT_STREQ(result3->result, "999|0");
+    mj_result_env_render_template_free(result3);
+
+    auto result4 = renderNamedString("number.txt", "{{ n | numberformat }}", R"({"n": "abc"})");
+    ASSERT_NE(result4->error, nullptr);
+    EXPECT_EQ(result4->error->code, MJ_INVALID_OPERATION);
+    mj_result_env_render_template_free(result4);
+}
+
+TEST_F(MiniJinjaTest, ContribEncoding)
+{
+    mj_env_add_contrib(env);
+
+    auto result1 = renderNamedString("url.txt", "/search/{{ path | urlencode }}?{{ query | urlencode }}", R"({"path": "a b/c&d", "query": {"q": "x y&z"}})");
+    EXPECT_EQ(result1->error, nullptr);
+    EXPECT_STREQ(result1->result, "/search/a%20b/c%26d?q=x+y%26z");
+    mj_result_env_render_template_free(result1);
+
+    // Test that JSON embedded in HTML is neither escaped twice nor able to end a script
+    auto result2 = renderNamedString("page.html", "<script>var data = {{ data | tojson }};</script>", R"({"data": {"a": "</script>"}})");
+    EXPECT_EQ(result2->error, nullptr);
+    EXPECT_STREQ(result2->result, "<script>var data = {\"a\":\"\\u003c/script\\u003e\"};</script>");
+    mj_result_env_render_template_free(result2);
+}
+
+TEST_F(MiniJinjaTest, ContribMinijinja)
+{
+    mj_env_add_contrib(env);
+
+    auto result1 = renderNamedString("size.txt", "{{ size | filesizeformat }}", R"({"size": 1000000})");
+    EXPECT_EQ(result1->error, nullptr);
+    EXPECT_STREQ(result1->result, "1.0 MB");
+    mj_result_env_render_template_free(result1);
+
+    auto result2 = renderNamedString("date.txt", "{{ ts | dateformat(format='[year]-[month]-[day]', tz='UTC') }}", R"({"ts": 86400})");
+    EXPECT_EQ(result2->error, nullptr);
+    EXPECT_STREQ(result2->result, "1970-01-02");
+    mj_result_env_render_template_free(result2);
+}
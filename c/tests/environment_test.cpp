@@ -100,3 +100,92 @@ TEST_F(MiniJinjaTest, UndefinedBehavior)
     EXPECT_STREQ(render_result3->result, "");
     mj_result_env_render_template_free(render_result3);
 }
+
+TEST_F(MiniJinjaTest, Globals)
+{
+    // Test globals visible to every template of the environment
+    std::string nav = R"([{"title": "Home"}, {"title": "About"}])";
+    auto error = mj_env_add_global(env, "nav",
+        reinterpret_cast<const uint8_t*>(nav.c_str()), nav.length());
+    EXPECT_EQ(error, nullptr);
+    std::string site = R"("Example")";
+    error = mj_env_add_global(env, "site",
+        reinterpret_cast<const uint8_t*>(site.c_str()), site.length());
+    EXPECT_EQ(error, nullptr);
+
+    error = mj_env_add_template(env, "globals_test",
+        "{{ site }}:{% for item in nav %} {{ item.title }}{% endfor %}");
+    EXPECT_EQ(error, nullptr);
+
+    auto render_result1 = renderTemplate("globals_test", "{}");
+    EXPECT_EQ(render_result1->error, nullptr);
+    EXPECT_STREQ(render_result1->result, "Example: Home About");
+    mj_result_env_render_template_free(render_result1);
+
+    // Context keys shadow globals of the same name
+    auto render_result2 = renderTemplate("globals_test", R"({"site": "Other"})");
+    EXPECT_EQ(render_result2->error, nullptr);
+    EXPECT_STREQ(render_result2->result, "Other: Home About");
+    mj_result_env_render_template_free(render_result2);
+
+    mj_env_remove_global(env, "nav");
+    auto render_result3 = renderTemplate("globals_test", "{}");
+    EXPECT_EQ(render_result3->error, nullptr);
+    EXPECT_STREQ(render_result3->result, "Example:");
+    mj_result_env_render_template_free(render_result3);
+
+    // Test adding a global with a malformed value
+    std::string invalid = R"({"title": )";
+    error = mj_env_add_global(env, "invalid",
+        reinterpret_cast<const uint8_t*>(invalid.c_str()), invalid.length());
+    ASSERT_NE(error, nullptr);
+    EXPECT_EQ(error->code, MJ_CANNOT_DESERIALIZE);
+    mj_error_free(error);
+}
+
+TEST_F(MiniJinjaTest, CloneEnvironment)
+{
+    // Test a child environment sharing the templates and globals of its parent
+    std::string site = R"("Parent")";
+    auto error = mj_env_add_global(env, "site",
+        reinterpret_cast<const uint8_t*>(site.c_str()), site.length());
+    EXPECT_EQ(error, nullptr);
+    error = mj_env_add_template(env, "layout", "{{ site }}: {% block body %}{% endblock %}");
+    EXPECT_EQ(error, nullptr);
+    error = mj_env_add_template(env, "page", "{% extends \"layout\" %}{% block body %}{{ title }}{% endblock %}");
+    EXPECT_EQ(error, nullptr);
+
+    auto child = mj_env_clone(env);
+    ASSERT_NE(child, nullptr);
+    std::string ctx = R"({"title": "Home"})";
+    auto render_result1 = mj_env_render(child, "page", reinterpret_cast<const uint8_t*>(ctx.c_str()), ctx.length());
+    EXPECT_EQ(render_result1->error, nullptr);
+    EXPECT_STREQ(render_result1->result, "Parent: Home");
+    mj_result_env_render_template_free(render_result1);
+
+    // Test that overrides on the child do not affect the parent
+    std::string tenant = R"("Tenant")";
+    error = mj_env_add_global(child, "site",
+        reinterpret_cast<const uint8_t*>(tenant.c_str()), tenant.length());
+    EXPECT_EQ(error, nullptr);
+    error = mj_env_add_template(child, "layout", "[{{ site }}] {% block body %}{% endblock %}");
+    EXPECT_EQ(error, nullptr);
+
+    auto render_result2 = mj_env_render(child, "page", reinterpret_cast<const uint8_t*>(ctx.c_str()), ctx.length());
+    EXPECT_EQ(render_result2->error, nullptr);
+    EXPECT_STREQ(render_result2->result, "[Tenant] Home");
+    mj_result_env_render_template_free(render_result2);
+
+    auto render_result3 = renderTemplate("page", ctx);
+    EXPECT_EQ(render_result3->error, nullptr);
+    EXPECT_STREQ(render_result3->result, "Parent: Home");
+    mj_result_env_render_template_free(render_result3);
+
+    // Test that the parent may be changed after the child was freed
+    mj_env_free(child);
+    mj_env_remove_template(env, "page");
+    auto render_result4 = renderTemplate("page", ctx);
+    ASSERT_NE(render_result4->error, nullptr);
+    EXPECT_EQ(render_result4->error->code, MJ_TEMPLATE_NOT_FOUND);
+    mj_result_env_render_template_free(render_result4);
+}
@@ -11,8 +11,8 @@ TEST_F(MiniJinjaTest, ErrorHandling)
     // This should produce a syntax error
     EXPECT_NE(error, nullptr);
         EXPECT_EQ(error->code, MJ_SYNTAX_ERROR);
-        EXPECT_NE(error->message, nullptr);
-        EXPECT_GT(strlen(error->message), 0);
+        EXPECT_NE(mj_error_message(error), nullptr);
+        EXPECT_GT(strlen(mj_error_message(error)), 0);
 
     mj_error_free(error);
 }
@@ -27,7 +27,7 @@ TEST_F(MiniJinjaTest, TemplateNotFound)
     EXPECT_NE(render_result->error, nullptr);
     if (render_result->error != nullptr) {
         EXPECT_EQ(render_result->error->code, MJ_TEMPLATE_NOT_FOUND);
-        EXPECT_NE(render_result->error->message, nullptr);
+        EXPECT_NE(mj_error_message(render_result->error), nullptr);
     }
     mj_result_env_render_template_free(render_result);
 }
@@ -41,8 +41,8 @@ TEST_F(MiniJinjaTest, InvalidTemplateSyntax)
     EXPECT_NE(error, nullptr);
     if (error != nullptr) {
         EXPECT_EQ(error->code, MJ_SYNTAX_ERROR);
-        EXPECT_NE(error->message, nullptr);
-        EXPECT_GT(strlen(error->message), 0);
+        EXPECT_NE(mj_error_message(error), nullptr);
+        EXPECT_GT(strlen(mj_error_message(error)), 0);
         mj_error_free(error);
     }
 
@@ -52,8 +52,8 @@ TEST_F(MiniJinjaTest, InvalidTemplateSyntax)
     EXPECT_NE(error, nullptr);
     if (error != nullptr) {
         EXPECT_EQ(error->code, MJ_SYNTAX_ERROR);
-        EXPECT_NE(error->message, nullptr);
-        EXPECT_GT(strlen(error->message), 0);
+        EXPECT_NE(mj_error_message(error), nullptr);
+        EXPECT_GT(strlen(mj_error_message(error)), 0);
         mj_error_free(error);
     }
 
@@ -67,7 +67,39 @@ TEST_F(MiniJinjaTest, InvalidTemplateSyntax)
     auto render_result = renderTemplate("invalid_filter", json_data);
     if (render_result->error != nullptr) {
         EXPECT_EQ(render_result->error->code, MJ_UNKNOWN_FILTER);
-        EXPECT_NE(render_result->error->message, nullptr);
+        EXPECT_NE(mj_error_message(render_result->error), nullptr);
     }
     mj_result_env_render_template_free(render_result);
 }
+
+TEST_F(MiniJinjaTest, ErrorLocation)
+{
+    // Test the structured location of an error raised while rendering
+    mj_env_set_debug(env, true);
+    mj_env_set_undefined_behavior(env, MJ_UNDEFINED_BEHAVIOR_STRICT);
+    auto error = mj_env_add_template(env, "location_test", "a\nb {{ user.name }}");
+    EXPECT_EQ(error, nullptr);
+
+    auto render_result = renderTemplate("location_test", "{}");
+    ASSERT_NE(render_result->error, nullptr);
+    auto render_error = render_result->error;
+    EXPECT_EQ(render_error->code, MJ_UNDEFINED_ERROR);
+    EXPECT_EQ(render_error->line, 2);
+    EXPECT_GE(render_error->range_start, strlen("a\nb {{ "));
+    EXPECT_GT(render_error->range_end, render_error->range_start);
+    // The second line starts at byte offset 2
+    EXPECT_EQ(render_error->column, render_error->range_start - 1);
+    EXPECT_STREQ(mj_error_template_name(render_error), "location_test");
+    EXPECT_NE(strstr(mj_error_message(render_error), "undefined"), nullptr);
+    mj_result_env_render_template_free(render_result);
+
+    // Test an error that is not tied to a template
+    auto render_result2 = renderTemplate("location_test", R"({"user": )");
+    ASSERT_NE(render_result2->error, nullptr);
+    EXPECT_EQ(render_result2->error->code, MJ_CANNOT_DESERIALIZE);
+    EXPECT_EQ(render_result2->error->line, 0);
+    EXPECT_EQ(render_result2->error->column, 0);
+    EXPECT_EQ(mj_error_template_name(render_result2->error), nullptr);
+    EXPECT_GT(strlen(mj_error_message(render_result2->error)), 0);
+    mj_result_env_render_template_free(render_result2);
+}
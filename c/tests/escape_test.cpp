@@ -0,0 +1,61 @@
+#include "test_base.h"
+
+TEST_F(MiniJinjaTest, AutoEscapeDefaults)
+{
+    // Test that HTML templates are escaped and text templates are not
+    auto result1 = renderNamedString("page.html", "<p>{{ text }}</p>", R"({"text": "<a href=\"/x\">Tom & 'Jerry'</a>"})");
+    EXPECT_EQ(result1->error, nullptr);
+    EXPECT_STREQ(result1->result, "<p>&lt;a href=&quot;&#x2f;x&quot;&gt;Tom &amp; &#x27;Jerry&#x27;&lt;&#x2f;a&gt;</p>");
+    mj_result_env_render_template_free(result1);
+
+    auto result2 = renderNamedString("page.txt", "{{ text }}", R"({"text": "<b>"})");
+    EXPECT_EQ(result2->error, nullptr);
+    EXPECT_STREQ(result2->result, "<b>");
+    mj_result_env_render_template_free(result2);
+
+    // Test that safe values and non-string values are written as is
+    auto result3 = renderNamedString("page.html", "{{ text | safe }} {{ n }} {{ flag }}", R"({"text": "<b>", "n": 42, "flag": true})");
+    EXPECT_EQ(result3->error, nullptr);
+    EXPECT_STREQ(result3->result, "<b> 42 true");
+    mj_result_env_render_template_free(result3);
+
+    // Test a string long enough to be scanned in several chunks
+    std::string text(100, 'x');
+    text[40] = '<';
+    text[99] = '&';
+    auto result4 = renderNamedString("long.html", "{{ text }}", "{\"text\": \"" + text + "\"}");
+    EXPECT_EQ(result4->error, nullptr);
+    EXPECT_EQ(std::string(result4->result), std::string(40, 'x') + "&lt;" + std::string(58, 'x') + "&amp;");
+    mj_result_env_render_template_free(result4);
+}
+
+TEST_F(MiniJinjaTest, AutoEscapeBySuffix)
+{
+    mj_env_set_auto_escape(env, ".txt", MJ_AUTO_ESCAPE_HTML);
+    mj_env_set_auto_escape(env, ".json", MJ_AUTO_ESCAPE_JSON);
+    mj_env_set_auto_escape(env, ".raw.html", MJ_AUTO_ESCAPE_NONE);
+
+    auto result1 = renderNamedString("page.txt", "{{ text }}", R"({"text": "<b>"})");
+    EXPECT_EQ(result1->error, nullptr);
+    EXPECT_STREQ(result1->result, "&lt;b&gt;");
+    mj_result_env_render_template_free(result1);
+
+    // Test that values are printed as JSON safe to embed in HTML
+    auto result2 = renderNamedString("data.json", "{\"user\": {{ user }}, \"n\": {{ n }}}", R"({"user": {"name": "</script>"}, "n": 1})");
+    EXPECT_EQ(result2->error, nullptr);
+    EXPECT_STREQ(result2->result, "{\"user\": {\"name\":\"\\u003c/script\\u003e\"}, \"n\": 1}");
+    mj_result_env_render_template_free(result2);
+
+    // Test that the longest matching suffix wins
+    auto result3 = renderNamedString("page.raw.html", "{{ text }}", R"({"text": "<b>"})");
+    EXPECT_EQ(result3->error, nullptr);
+    EXPECT_STREQ(result3->result, "<b>");
+    mj_result_env_render_template_free(result3);
+
+    // Test replacing the mode of a suffix
+    mj_env_set_auto_escape(env, ".txt", MJ_AUTO_ESCAPE_NONE);
+    auto result4 = renderNamedString("page.txt", "{{ text }}", R"({"text": "<b>"})");
+    EXPECT_EQ(result4->error, nullptr);
+    EXPECT_STREQ(result4->result, "<b>");
+    mj_result_env_render_template_free(result4);
+}
@@ -0,0 +1,122 @@
+#include "test_base.h"
+
+#include <string>
+
+class ExpressionTest : public MiniJinjaTest {
+protected:
+  mj_expression* compile(const char* source) {
+    auto result = mj_env_compile_expression(env, source);
+    EXPECT_EQ(result->error, nullptr) << source;
+    auto expr = result->expr;
+    mj_result_env_compile_expression_free(result);
+    return expr;
+  }
+
+  mj_result_expression_eval* eval(mj_expression* expr, const std::string& json_data) {
+    return mj_expression_eval(expr, reinterpret_cast<const uint8_t*>(json_data.c_str()), json_data.length());
+  }
+};
+
+TEST_F(ExpressionTest, EvalTypes)
+{
+    const char* context = R"({"user": {"age": 21, "flags": ["beta"], "name": "Ann"}, "ratio": 0.25})";
+
+    auto expr1 = compile("user.age >= 18 and \"beta\" in user.flags");
+    auto result1 = eval(expr1, context);
+    ASSERT_EQ(result1->error, nullptr);
+    EXPECT_EQ(result1->kind, MJ_EVAL_BOOL);
+    EXPECT_TRUE(result1->boolean);
+    mj_result_expression_eval_free(result1);
+
+    auto expr2 = compile("user.age * 2");
+    auto result2 = eval(expr2, context);
+    ASSERT_EQ(result2->error, nullptr);
+    EXPECT_EQ(result2->kind, MJ_EVAL_INT);
+    EXPECT_EQ(result2->integer, 42);
+    mj_result_expression_eval_free(result2);
+
+    auto expr3 = compile("ratio * 2");
+    auto result3 = eval(expr3, context);
+    ASSERT_EQ(result3->error, nullptr);
+    EXPECT_EQ(result3->kind, MJ_EVAL_FLOAT);
+    EXPECT_DOUBLE_EQ(result3->number, 0.5);
+    mj_result_expression_eval_free(result3);
+
+    auto expr4 = compile("user.name | upper");
+    auto result4 = eval(expr4, context);
+    ASSERT_EQ(result4->error, nullptr);
+    EXPECT_EQ(result4->kind, MJ_EVAL_STRING);
+    EXPECT_STREQ(result4->string, "ANN");
+    mj_result_expression_eval_free(result4);
+
+    auto expr5 = compile("user.flags + [1]");
+    auto result5 = eval(expr5, context);
+    ASSERT_EQ(result5->error, nullptr);
+    EXPECT_EQ(result5->kind, MJ_EVAL_JSON);
+    EXPECT_STREQ(result5->string, "[\"beta\",1]");
+    mj_result_expression_eval_free(result5);
+
+    auto expr6 = compile("user.missing");
+    auto result6 = eval(expr6, context);
+    ASSERT_EQ(result6->error, nullptr);
+    EXPECT_EQ(result6->kind, MJ_EVAL_NONE);
+    EXPECT_EQ(result6->string, nullptr);
+    mj_result_expression_eval_free(result6);
+
+    mj_expression_free(expr1);
+    mj_expression_free(expr2);
+    mj_expression_free(expr3);
+    mj_expression_free(expr4);
+    mj_expression_free(expr5);
+    mj_expression_free(expr6);
+}
+
+TEST_F(ExpressionTest, EvalRepeatedly)
+{
+    auto expr = compile("country in [\"DE\", \"FR\"]");
+    const char* contexts[] = {R"({"country": "DE"})", R"({"country": "US"})", R"({"country": "FR"})"};
+    bool expected[] = {true, false, true};
+    for (int i = 0; i < 3; i++) {
+        auto result = eval(expr, contexts[i]);
+        ASSERT_EQ(result->error, nullptr);
+        EXPECT_EQ(result->boolean, expected[i]) << contexts[i];
+        mj_result_expression_eval_free(result);
+    }
+
+    // Test that the expression outlives changes to the environment
+    mj_env_clear_templates(env);
+    auto result = eval(expr, R"({"country": "DE"})");
+    ASSERT_EQ(result->error, nullptr);
+    EXPECT_TRUE(result->boolean);
+    mj_result_expression_eval_free(result);
+
+    mj_expression_free(expr);
+}
+
+TEST_F(ExpressionTest, Errors)
+{
+    // Test a syntax error
+    auto compiled = mj_env_compile_expression(env, "user.age >=");
+    ASSERT_NE(compiled->error, nullptr);
+    EXPECT_EQ(compiled->error->code, MJ_SYNTAX_ERROR);
+    EXPECT_EQ(compiled->expr, nullptr);
+    mj_result_env_compile_expression_free(compiled);
+
+    // Test an error while evaluating
+    auto expr = compile("value - \"x\"");
+    auto result = eval(expr, R"({"value": 1})");
+    ASSERT_NE(result->error, nullptr);
+    EXPECT_EQ(result->error->code, MJ_INVALID_OPERATION);
+    EXPECT_EQ(result->kind, MJ_EVAL_NONE);
+    mj_result_expression_eval_free(result);
+
+    // Test a malformed context
+    auto expr2 = compile("1 + 1");
+    auto result2 = eval(expr2, "{");
+    ASSERT_NE(result2->error, nullptr);
+    EXPECT_EQ(result2->error->code, MJ_CANNOT_DESERIALIZE);
+    mj_result_expression_eval_free(result2);
+
+    mj_expression_free(expr);
+    mj_expression_free(expr2);
+}
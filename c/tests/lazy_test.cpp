@@ -0,0 +1,65 @@
+#include "test_base.h"
+
+TEST_F(MiniJinjaTest, LazyContextAccess)
+{
+    mj_env_set_lazy_context(env, true);
+
+    // Test nested objects, arrays and decoded strings
+    auto result1 = renderNamedString("user.txt",
+        "{{ user.name }}: {% for tag in user.tags %}{{ tag }},{% endfor %} {{ user.tags | length }} {{ user.tags[1] }} {{ user.address.city }}",
+        R"({"id": 7, "user": {"name": "Café \"Jo\"", "tags": ["a", "b", "c"], "address": {"city": "Oslo"}}, "unused": [1, 2, {"x": 3}]})");
+    EXPECT_EQ(result1->error, nullptr);
+    EXPECT_STREQ(result1->result, "Café \"Jo\": a,b,c, 3 b Oslo");
+    mj_result_env_render_template_free(result1);
+
+    // Test missing keys and out of range indexes
+    auto result2 = renderNamedString("missing.txt",
+        "{{ missing is undefined }} {{ user.missing is undefined }} {{ user.tags[5] is undefined }}",
+        R"({"user": {"tags": []}})");
+    EXPECT_EQ(result2->error, nullptr);
+    EXPECT_STREQ(result2->result, "true true true");
+    mj_result_env_render_template_free(result2);
+
+    // Test that the last of duplicate keys wins
+    auto result3 = renderNamedString("dup.txt", "{{ a }} {{ m | length }}", R"({"a": 1, "m": {"x": 1, "x": 2}, "a": 2})");
+    EXPECT_EQ(result3->error, nullptr);
+    EXPECT_STREQ(result3->result, "2 1");
+    mj_result_env_render_template_free(result3);
+}
+
+TEST_F(MiniJinjaTest, LazyContextMatchesEager)
+{
+    const char* source = "{% for k in m %}{{ k }}={{ m[k] }};{% endfor %} {{ n + 1 }} {{ f }} {{ items | join('-') }}";
+    const char* json = R"({"m": {"b": 1, "a": "x", "c": null, "d": true}, "n": 41, "f": 1.5, "items": [3, 1, 2]})";
+
+    auto eager = renderNamedString("cmp.txt", source, json);
+    EXPECT_EQ(eager->error, nullptr);
+    EXPECT_STREQ(eager->result, "a=x;b=1;c=none;d=true; 42 1.5 3-1-2");
+
+    mj_env_set_lazy_context(env, true);
+    auto lazy = renderNamedString("cmp.txt", source, json);
+    EXPECT_EQ(lazy->error, nullptr);
+    EXPECT_STREQ(lazy->result, eager->result);
+
+    mj_result_env_render_template_free(eager);
+    mj_result_env_render_template_free(lazy);
+}
+
+TEST_F(MiniJinjaTest, LazyContextInvalid)
+{
+    mj_env_set_lazy_context(env, true);
+    mj_env_add_template(env, "hello", "Hello {{ name }}!");
+
+    // Test that malformed JSON is rejected up front, even where it is
+    // never read
+    auto result1 = renderTemplate("hello", R"({"name": "World", "unused": [1, })");
+    ASSERT_NE(result1->error, nullptr);
+    EXPECT_EQ(result1->error->code, MJ_CANNOT_DESERIALIZE);
+    mj_result_env_render_template_free(result1);
+
+    // Test that whitespace around the context is allowed
+    auto result2 = renderTemplate("hello", " \n{\"name\": \"World\"}\n ");
+    EXPECT_EQ(result2->error, nullptr);
+    EXPECT_STREQ(result2->result, "Hello World!");
+    mj_result_env_render_template_free(result2);
+}
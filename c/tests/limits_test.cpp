@@ -0,0 +1,133 @@
+#include "test_base.h"
+
+namespace {
+
+mj_result_env_render_template* renderWithLimits(mj_env* env, const char* name, const std::string& json, uint64_t fuel, uint64_t timeout_ns)
+{
+    mj_render_limits limits = { fuel, timeout_ns };
+    return mj_env_render_with_limits(env, name, reinterpret_cast<const uint8_t*>(json.data()), json.size(), &limits);
+}
+
+} // namespace
+
+TEST_F(MiniJinjaTest, RenderFuel)
+{
+    auto error = mj_env_add_template(env, "loop.txt", "{% for i in range(n) %}{% for j in range(n) %}.{% endfor %}{% endfor %}");
+    EXPECT_EQ(error, nullptr);
+    mj_env_set_fuel(env, 1000);
+
+    // Test a render within the fuel of the environment
+    auto result1 = renderTemplate("loop.txt", R"({"n": 2})");
+    EXPECT_EQ(result1->error, nullptr);
+    EXPECT_STREQ(result1->result, "....");
+    mj_result_env_render_template_free(result1);
+
+    // Test a render that runs out of fuel
+    auto result2 = renderTemplate("loop.txt", R"({"n": 100})");
+    ASSERT_NE(result2->error, nullptr);
+    EXPECT_EQ(result2->error->code, MJ_OUT_OF_FUEL);
+    mj_result_env_render_template_free(result2);
+
+    // Test lifting the fuel for a single render
+    auto result3 = renderWithLimits(env, "loop.txt", R"({"n": 100})", UINT64_MAX, 0);
+    EXPECT_EQ(result3->error, nullptr);
+    EXPECT_EQ(strlen(result3->result), 10000u);
+    mj_result_env_render_template_free(result3);
+
+    // Test lowering the fuel for a single render
+    auto result4 = renderWithLimits(env, "loop.txt", R"({"n": 2})", 5, 0);
+    ASSERT_NE(result4->error, nullptr);
+    EXPECT_EQ(result4->error->code, MJ_OUT_OF_FUEL);
+    mj_result_env_render_template_free(result4);
+}
+
+TEST_F(MiniJinjaTest, RenderDeadline)
+{
+    auto error = mj_env_add_template(env, "loop.txt", "{% for i in range(n) %}{% for j in range(n) %}{{ j }}{% endfor %}{% endfor %}");
+    EXPECT_EQ(error, nullptr);
+
+    // Test a render that exceeds the timeout of the environment
+    mj_env_set_timeout(env, 1);
+    auto result1 = renderTemplate("loop.txt", R"({"n": 1000})");
+    ASSERT_NE(result1->error, nullptr);
+    EXPECT_EQ(result1->error->code, MJ_DEADLINE_EXCEEDED);
+    mj_result_env_render_template_free(result1);
+
+    // Test lifting the timeout for a single render
+    auto result2 = renderWithLimits(env, "loop.txt", R"({"n": 3})", 0, UINT64_MAX);
+    EXPECT_EQ(result2->error, nullptr);
+    EXPECT_STREQ(result2->result, "012012012");
+    mj_result_env_render_template_free(result2);
+
+    // Test a generous timeout for a single render
+    mj_env_set_timeout(env, 0);
+    auto result3 = renderWithLimits(env, "loop.txt", R"({"n": 3})", 0, 10000000000ULL);
+    EXPECT_EQ(result3->error, nullptr);
+    EXPECT_STREQ(result3->result, "012012012");
+    mj_result_env_render_template_free(result3);
+
+    // Test a short timeout for a single render
+    auto result4 = renderWithLimits(env, "loop.txt", R"({"n": 1000})", 0, 1);
+    ASSERT_NE(result4->error, nullptr);
+    EXPECT_EQ(result4->error->code, MJ_DEADLINE_EXCEEDED);
+    mj_result_env_render_template_free(result4);
+}
+
+namespace {
+
+int discard(void*, const uint8_t*, uintptr_t)
+{
+    return 0;
+}
+
+} // namespace
+
+TEST_F(MiniJinjaTest, RenderDeadlineEverywhere)
+{
+    auto error = mj_env_add_template(env, "loop.txt", "{% for i in range(n) %}{% for j in range(n) %}{{ j }}{% endfor %}{% endfor %}");
+    EXPECT_EQ(error, nullptr);
+    mj_env_set_timeout(env, 1);
+    const std::string json = R"({"n": 1000})";
+    auto data = reinterpret_cast<const uint8_t*>(json.data());
+
+    // Test that streaming renders honor the timeout of the environment
+    error = mj_env_render_to_writer(env, "loop.txt", data, json.size(), discard, nullptr);
+    ASSERT_NE(error, nullptr);
+    EXPECT_EQ(error->code, MJ_DEADLINE_EXCEEDED);
+    mj_error_free(error);
+
+    // Test that a template handle keeps the timeout it was taken with
+    auto handle = mj_env_get_template(env, "loop.txt");
+    ASSERT_EQ(handle->error, nullptr);
+    mj_env_set_timeout(env, 0);
+    auto result = mj_template_render(handle->tmpl, data, json.size());
+    ASSERT_NE(result->error, nullptr);
+    EXPECT_EQ(result->error->code, MJ_DEADLINE_EXCEEDED);
+    mj_result_env_render_template_free(result);
+    mj_template_free(handle->tmpl);
+    mj_result_env_get_template_free(handle);
+
+    // Test that every item of a batch honors the timeout
+    mj_env_set_timeout(env, 1);
+    mj_buffer contexts[] = { { data, json.size() }, { data, json.size() } };
+    auto batch = mj_env_render_batch(env, "loop.txt", contexts, 2);
+    ASSERT_EQ(batch->len, 2u);
+    for (size_t i = 0; i < batch->len; i++) {
+        ASSERT_NE(batch->results[i].error, nullptr);
+        EXPECT_EQ(batch->results[i].error->code, MJ_DEADLINE_EXCEEDED);
+    }
+    mj_result_env_render_batch_free(batch);
+}
+
+TEST_F(MiniJinjaTest, RenderDeadlineCaptured)
+{
+    // Test that values printed into a block that writes no output are
+    // checked against the deadline as they are printed
+    auto error = mj_env_add_template(env, "captured.txt", "{% set body %}{% for i in range(n) %}{% for j in range(n) %}{{ j }}{% endfor %}{% endfor %}{% endset %}done");
+    EXPECT_EQ(error, nullptr);
+    mj_env_set_timeout(env, 1);
+    auto result = renderTemplate("captured.txt", R"({"n": 1000})");
+    ASSERT_NE(result->error, nullptr);
+    EXPECT_EQ(result->error->code, MJ_DEADLINE_EXCEEDED);
+    mj_result_env_render_template_free(result);
+}
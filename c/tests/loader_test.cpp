@@ -0,0 +1,64 @@
+#include "test_base.h"
+
+TEST_F(MiniJinjaTest, LoaderPath)
+{
+    // Test loading templates lazily from a directory
+    mj_env_set_loader_path(env, TEST_TEMPLATES_DIR);
+
+    auto render_result1 = renderTemplate("hello.txt", R"({"name": "World"})");
+    EXPECT_EQ(render_result1->error, nullptr);
+    EXPECT_STREQ(render_result1->result, "Hello World!");
+    mj_result_env_render_template_free(render_result1);
+
+    // Test that templates included from a loaded template are loaded too
+    auto render_result2 = renderTemplate("page.html", R"({"title": "Home"})");
+    EXPECT_EQ(render_result2->error, nullptr);
+    EXPECT_STREQ(render_result2->result, "<title>Home</title>");
+    mj_result_env_render_template_free(render_result2);
+
+    // Test that explicitly added templates take precedence
+    auto error = mj_env_add_template(env, "hello.txt", "Added {{ name }}");
+    EXPECT_EQ(error, nullptr);
+    auto render_result3 = renderTemplate("hello.txt", R"({"name": "World"})");
+    EXPECT_EQ(render_result3->error, nullptr);
+    EXPECT_STREQ(render_result3->result, "Added World");
+    mj_result_env_render_template_free(render_result3);
+}
+
+TEST_F(MiniJinjaTest, LoaderSearchPaths)
+{
+    // Test that search paths are tried in the order they were added
+    mj_env_add_loader_path(env, TEST_TEMPLATES_OVERRIDE_DIR);
+    mj_env_add_loader_path(env, TEST_TEMPLATES_DIR);
+
+    auto render_result1 = renderTemplate("hello.txt", R"({"name": "World"})");
+    EXPECT_EQ(render_result1->error, nullptr);
+    EXPECT_STREQ(render_result1->result, "Hi World!");
+    mj_result_env_render_template_free(render_result1);
+
+    auto render_result2 = renderTemplate("page.html", R"({"title": "Home"})");
+    EXPECT_EQ(render_result2->error, nullptr);
+    EXPECT_STREQ(render_result2->result, "<title>Home</title>");
+    mj_result_env_render_template_free(render_result2);
+
+    auto render_result3 = renderTemplate("only.txt", R"({"name": "World"})");
+    EXPECT_EQ(render_result3->error, nullptr);
+    EXPECT_STREQ(render_result3->result, "Only World");
+    mj_result_env_render_template_free(render_result3);
+}
+
+TEST_F(MiniJinjaTest, LoaderNotFound)
+{
+    // Test missing templates and names escaping the search path
+    mj_env_set_loader_path(env, TEST_TEMPLATES_DIR);
+
+    auto render_result1 = renderTemplate("missing.txt", "{}");
+    ASSERT_NE(render_result1->error, nullptr);
+    EXPECT_EQ(render_result1->error->code, MJ_TEMPLATE_NOT_FOUND);
+    mj_result_env_render_template_free(render_result1);
+
+    auto render_result2 = renderTemplate("../templates/hello.txt", "{}");
+    ASSERT_NE(render_result2->error, nullptr);
+    EXPECT_EQ(render_result2->error->code, MJ_TEMPLATE_NOT_FOUND);
+    mj_result_env_render_template_free(render_result2);
+}
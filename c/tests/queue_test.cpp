@@ -0,0 +1,97 @@
+#include "test_base.h"
+
+// The notifier of a queue is a file descriptor, which Windows lacks.
+#ifndef _WIN32
+
+#include <map>
+#include <string>
+
+#include <poll.h>
+#include <unistd.h>
+
+class QueueTest : public MiniJinjaTest {
+protected:
+  bool submit(mj_queue* queue, uint64_t id, const char* name, const std::string& json_data) {
+    return mj_queue_submit(queue, id, name, reinterpret_cast<const uint8_t*>(json_data.c_str()), json_data.length());
+  }
+
+  // Takes completions from the ring until `count` have been collected,
+  // waiting on the notifier whenever the ring is drained.
+  void collect(mj_queue* queue, size_t count, std::map<uint64_t, std::string>& rendered, std::map<uint64_t, mj_code>& failed) {
+    mj_completion_ring* ring = queue->ring;
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST);
+    while (rendered.size() + failed.size() < count) {
+      uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST);
+      for (; head < tail; head++) {
+        mj_completion* completion = &ring->slots[head & (ring->capacity - 1)];
+        if (completion->result->error != nullptr) {
+          failed[completion->id] = completion->result->error->code;
+        } else {
+          rendered[completion->id] = completion->result->result;
+        }
+        mj_result_env_render_template_free(completion->result);
+      }
+      __atomic_store_n(&ring->head, head, __ATOMIC_SEQ_CST);
+      if (__atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) != head) {
+        continue;
+      }
+      pollfd fd = {queue->notify_fd, POLLIN, 0};
+      ASSERT_EQ(poll(&fd, 1, 5000), 1) << "timed out waiting for completions";
+      uint64_t value;
+      ASSERT_GT(read(queue->notify_fd, &value, sizeof(value)), 0);
+    }
+  }
+};
+
+TEST_F(QueueTest, RenderInBackground)
+{
+    mj_env_add_template(env, "hello", "Hello {{ name }}!");
+    auto queue = mj_env_queue_new(env, 64, 4);
+    ASSERT_NE(queue, nullptr);
+    EXPECT_EQ(queue->ring->capacity, 64u);
+    EXPECT_GE(queue->notify_fd, 0);
+
+    for (uint64_t id = 0; id < 50; id++) {
+        EXPECT_TRUE(submit(queue, id, "hello", "{\"name\": \"" + std::to_string(id) + "\"}"));
+    }
+    EXPECT_TRUE(submit(queue, 50, "missing", "{}"));
+
+    std::map<uint64_t, std::string> rendered;
+    std::map<uint64_t, mj_code> failed;
+    collect(queue, 51, rendered, failed);
+    ASSERT_EQ(rendered.size(), 50u);
+    for (uint64_t id = 0; id < 50; id++) {
+        EXPECT_EQ(rendered[id], "Hello " + std::to_string(id) + "!");
+    }
+    ASSERT_EQ(failed.size(), 1u);
+    EXPECT_EQ(failed[50], MJ_TEMPLATE_NOT_FOUND);
+
+    mj_queue_free(queue);
+}
+
+TEST_F(QueueTest, Full)
+{
+    mj_env_add_template(env, "hello", "Hello {{ name }}!");
+    auto queue = mj_env_queue_new(env, 3, 1);
+    ASSERT_NE(queue, nullptr);
+    // Test that the capacity is rounded up to a power of two
+    EXPECT_EQ(queue->ring->capacity, 4u);
+
+    for (uint64_t id = 0; id < 4; id++) {
+        EXPECT_TRUE(submit(queue, id, "hello", R"({"name": "World"})"));
+    }
+    EXPECT_FALSE(submit(queue, 4, "hello", R"({"name": "World"})"));
+
+    std::map<uint64_t, std::string> rendered;
+    std::map<uint64_t, mj_code> failed;
+    collect(queue, 4, rendered, failed);
+    EXPECT_EQ(rendered.size(), 4u);
+
+    // Test that taking completions frees their slots
+    EXPECT_TRUE(submit(queue, 4, "hello", R"({"name": "World"})"));
+
+    // Test that freeing the queue frees completions that were not taken
+    mj_queue_free(queue);
+}
+
+#endif  // _WIN32
@@ -58,7 +58,7 @@ TEST_F(MiniJinjaTest, RenderNamedStringError)
     
     if (render_result->error != nullptr) {
         EXPECT_EQ(render_result->error->code, MJ_SYNTAX_ERROR);
-        EXPECT_NE(render_result->error->message, nullptr);
+        EXPECT_NE(mj_error_message(render_result->error), nullptr);
     }
     
     mj_result_env_render_template_free(render_result);
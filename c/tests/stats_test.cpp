@@ -0,0 +1,115 @@
+#include "test_base.h"
+
+#include <string>
+
+namespace {
+
+const mj_template_stats* findStats(const mj_stats* stats, const char* name)
+{
+    for (uintptr_t i = 0; i < stats->len; i++) {
+        if (strcmp(stats->templates[i].name, name) == 0) {
+            return &stats->templates[i];
+        }
+    }
+    return nullptr;
+}
+
+uint64_t bucketTotal(const mj_histogram& histogram)
+{
+    uint64_t total = 0;
+    for (uint64_t bucket : histogram.buckets) {
+        total += bucket;
+    }
+    return total;
+}
+
+} // namespace
+
+TEST_F(MiniJinjaTest, StatsDisabled)
+{
+    // Test that nothing is recorded unless enabled
+    auto error = mj_env_add_template(env, "stats_test", "Hello {{ name }}!");
+    EXPECT_EQ(error, nullptr);
+    auto render_result = renderTemplate("stats_test", R"({"name": "World"})");
+    EXPECT_EQ(render_result->error, nullptr);
+    mj_result_env_render_template_free(render_result);
+
+    auto stats = mj_env_stats(env);
+    EXPECT_EQ(stats->len, 0);
+    mj_stats_free(stats);
+}
+
+TEST_F(MiniJinjaTest, StatsEnabled)
+{
+    // Test per template counters and phase histograms
+    mj_env_set_stats(env, true);
+    auto error = mj_env_add_template(env, "stats_test", "Hello {{ name }}!");
+    EXPECT_EQ(error, nullptr);
+
+    for (int i = 0; i < 3; i++) {
+        auto render_result = renderTemplate("stats_test", R"({"name": "World"})");
+        EXPECT_EQ(render_result->error, nullptr);
+        mj_result_env_render_template_free(render_result);
+    }
+    auto render_result1 = renderTemplate("stats_test", R"({"name": )");
+    ASSERT_NE(render_result1->error, nullptr);
+    mj_result_env_render_template_free(render_result1);
+    auto render_result2 = renderTemplate("missing", "{}");
+    ASSERT_NE(render_result2->error, nullptr);
+    mj_result_env_render_template_free(render_result2);
+    auto render_result3 = renderNamedString("named", "{{ 1 + 1 }}", "{}");
+    EXPECT_EQ(render_result3->error, nullptr);
+    mj_result_env_render_template_free(render_result3);
+
+    auto stats = mj_env_stats(env);
+    ASSERT_EQ(stats->len, 3);
+
+    auto stats_test = findStats(stats, "stats_test");
+    ASSERT_NE(stats_test, nullptr);
+    EXPECT_EQ(stats_test->calls, 4);
+    EXPECT_EQ(stats_test->output_bytes, 3 * strlen("Hello World!"));
+    ASSERT_EQ(stats_test->errors_len, 1);
+    EXPECT_EQ(stats_test->errors[0].code, MJ_CANNOT_DESERIALIZE);
+    EXPECT_EQ(stats_test->errors[0].count, 1);
+    EXPECT_EQ(stats_test->lookup.count, 4);
+    EXPECT_EQ(stats_test->parse.count, 3);
+    EXPECT_EQ(stats_test->render.count, 3);
+    EXPECT_EQ(stats_test->output.count, 3);
+    EXPECT_EQ(bucketTotal(stats_test->render), 3);
+
+    // Test that templates that are not found share a single entry
+    EXPECT_EQ(findStats(stats, "missing"), nullptr);
+    auto missing = findStats(stats, "(other)");
+    ASSERT_NE(missing, nullptr);
+    EXPECT_EQ(missing->calls, 1);
+    ASSERT_EQ(missing->errors_len, 1);
+    EXPECT_EQ(missing->errors[0].code, MJ_TEMPLATE_NOT_FOUND);
+    EXPECT_EQ(missing->lookup.count, 0);
+
+    auto named = findStats(stats, "named");
+    ASSERT_NE(named, nullptr);
+    EXPECT_EQ(named->calls, 1);
+    EXPECT_EQ(named->output_bytes, 1);
+    EXPECT_EQ(named->lookup.count, 0);
+    EXPECT_EQ(named->render.count, 1);
+    mj_stats_free(stats);
+}
+
+TEST_F(MiniJinjaTest, StatsBounded)
+{
+    // Test that names beyond the limit are folded into a single entry
+    mj_env_set_stats(env, true);
+    for (int i = 0; i < 1100; i++) {
+        auto name = "named" + std::to_string(i);
+        auto render_result = renderNamedString(name.c_str(), "x", "{}");
+        EXPECT_EQ(render_result->error, nullptr);
+        mj_result_env_render_template_free(render_result);
+    }
+
+    auto stats = mj_env_stats(env);
+    ASSERT_EQ(stats->len, 1025);
+    auto other = findStats(stats, "(other)");
+    ASSERT_NE(other, nullptr);
+    EXPECT_EQ(other->calls, 76);
+    mj_stats_free(stats);
+}
@@ -0,0 +1,194 @@
+#include "test_base.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+class TemplateStoreTest : public MiniJinjaTest {
+protected:
+  std::string render(const char* name) {
+    auto result = renderTemplate(name, R"({"name": "World"})");
+    EXPECT_EQ(result->error, nullptr) << name;
+    std::string rendered = result->result != nullptr ? result->result : "";
+    mj_result_env_render_template_free(result);
+    return rendered;
+  }
+
+  mj_template_store_stats stats() {
+    mj_template_store_stats stats;
+    mj_env_template_store_stats(env, &stats);
+    return stats;
+  }
+
+  // Waits for the eviction that a render hands off to the worker pool.
+  mj_template_store_stats waitEvictions(uint64_t evictions) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    auto counters = stats();
+    while (counters.evictions < evictions && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      counters = stats();
+    }
+    return counters;
+  }
+};
+
+TEST_F(TemplateStoreTest, Memory)
+{
+    const char* source = "Hello {{ name }}!";
+    mj_env_add_template(env, "hello", source);
+
+    mj_template_memory memory;
+    ASSERT_TRUE(mj_env_template_memory(env, "hello", &memory));
+    EXPECT_TRUE(memory.resident);
+    EXPECT_GT(memory.compiled_bytes, strlen(source));
+    EXPECT_EQ(memory.source_bytes, strlen(source));
+    EXPECT_EQ(memory.stored_bytes, 0u);
+    EXPECT_FALSE(mj_env_template_memory(env, "missing", &memory));
+
+    auto counters = stats();
+    EXPECT_EQ(counters.templates, 1u);
+    EXPECT_EQ(counters.resident, 1u);
+    EXPECT_EQ(counters.compiled_bytes, memory.compiled_bytes);
+    EXPECT_EQ(counters.budget, 0u);
+
+    // Test that removing a template releases its memory
+    mj_env_remove_template(env, "hello");
+    EXPECT_FALSE(mj_env_template_memory(env, "hello", &memory));
+    EXPECT_EQ(stats().compiled_bytes, 0u);
+}
+
+TEST_F(TemplateStoreTest, EvictAndRecompile)
+{
+    mj_env_add_template(env, "t0", "Hello {{ name }} from t0!");
+    mj_template_memory memory;
+    ASSERT_TRUE(mj_env_template_memory(env, "t0", &memory));
+    // Leave room for two compiled templates
+    mj_env_set_template_budget(env, memory.compiled_bytes * 2 + 1, true);
+
+    for (auto name : {"t1", "t2", "t3", "t4"}) {
+        mj_env_add_template(env, name, (std::string("Hello {{ name }} from ") + name + "!").c_str());
+    }
+    auto counters = stats();
+    EXPECT_EQ(counters.templates, 5u);
+    EXPECT_EQ(counters.resident, 2u);
+    EXPECT_EQ(counters.evictions, 3u);
+    EXPECT_LE(counters.compiled_bytes, counters.budget);
+    EXPECT_GT(counters.stored_bytes, 0u);
+
+    ASSERT_TRUE(mj_env_template_memory(env, "t0", &memory));
+    EXPECT_FALSE(memory.resident);
+    EXPECT_EQ(memory.compiled_bytes, 0u);
+    EXPECT_GT(memory.stored_bytes, 0u);
+
+    // Test that an evicted template is compiled again on render, evicting
+    // the least recently used one, without starting a new generation
+    uint64_t generation = mj_env_generation(env);
+    EXPECT_EQ(render("t0"), "Hello World from t0!");
+    counters = waitEvictions(4);
+    EXPECT_EQ(mj_env_generation(env), generation);
+    EXPECT_EQ(counters.recompiles, 1u);
+    EXPECT_EQ(counters.evictions, 4u);
+    ASSERT_TRUE(mj_env_template_memory(env, "t0", &memory));
+    EXPECT_TRUE(memory.resident);
+    ASSERT_TRUE(mj_env_template_memory(env, "t3", &memory));
+    EXPECT_FALSE(memory.resident);
+
+    EXPECT_EQ(render("t4"), "Hello World from t4!");
+    EXPECT_EQ(stats().recompiles, 1u);
+}
+
+TEST_F(TemplateStoreTest, IncludeEvicted)
+{
+    mj_env_add_template(env, "partial", "[{{ name }}]");
+    mj_template_memory memory;
+    ASSERT_TRUE(mj_env_template_memory(env, "partial", &memory));
+    mj_env_set_template_budget(env, memory.compiled_bytes, false);
+    mj_env_add_template(env, "page", "Page {% include \"partial\" %}");
+
+    ASSERT_TRUE(mj_env_template_memory(env, "partial", &memory));
+    EXPECT_FALSE(memory.resident);
+    // Test that an uncompressed source is kept as is
+    EXPECT_EQ(memory.stored_bytes, memory.source_bytes);
+    EXPECT_EQ(render("page"), "Page [World]");
+    EXPECT_EQ(stats().recompiles, 1u);
+}
+
+TEST_F(TemplateStoreTest, RemoveEvicted)
+{
+    mj_env_add_template(env, "old", "Old");
+    mj_env_set_template_budget(env, 1, true);
+    mj_env_add_template(env, "new", "New");
+    EXPECT_EQ(stats().evictions, 1u);
+
+    // Test that a removed template is not compiled again from the store
+    mj_env_remove_template(env, "old");
+    auto result = renderTemplate("old", "{}");
+    ASSERT_NE(result->error, nullptr);
+    EXPECT_EQ(result->error->code, MJ_TEMPLATE_NOT_FOUND);
+    mj_result_env_render_template_free(result);
+
+    // Test that replacing an evicted template compiles the new source
+    mj_env_add_template(env, "new", "Newer");
+    EXPECT_EQ(render("new"), "Newer");
+}
+
+TEST_F(TemplateStoreTest, Transaction)
+{
+    auto txn = mj_env_begin_txn(env);
+    mj_txn_add_template(txn, "a", "A");
+    mj_txn_abort(txn);
+    EXPECT_EQ(stats().templates, 0u);
+
+    txn = mj_env_begin_txn(env);
+    mj_txn_add_template(txn, "a", "A");
+    mj_txn_add_template(txn, "b", "B");
+    mj_txn_remove_template(txn, "a");
+    mj_txn_commit(txn);
+    mj_template_memory memory;
+    EXPECT_FALSE(mj_env_template_memory(env, "a", &memory));
+    EXPECT_TRUE(mj_env_template_memory(env, "b", &memory));
+}
+
+TEST_F(TemplateStoreTest, Clone)
+{
+    mj_env_add_template(env, "hello", "Hello {{ name }}!");
+    mj_env_set_template_budget(env, 1, true);
+    mj_env_add_template(env, "other", "Other");
+    mj_template_memory memory;
+    ASSERT_TRUE(mj_env_template_memory(env, "hello", &memory));
+    EXPECT_FALSE(memory.resident);
+
+    // Test that a child compiles evicted templates from its own store
+    auto child = mj_env_clone(env);
+    mj_env_add_template(env, "hello", "Changed {{ name }}!");
+    auto result = mj_env_render(child, "hello", reinterpret_cast<const uint8_t*>("{\"name\": \"World\"}"), 17);
+    ASSERT_EQ(result->error, nullptr);
+    EXPECT_STREQ(result->result, "Hello World!");
+    mj_result_env_render_template_free(result);
+    mj_env_free(child);
+}
+
+TEST_F(TemplateStoreTest, IncludeTouched)
+{
+    mj_env_add_template(env, "partial", "[{{ name }}]");
+    mj_env_add_template(env, "page", "Page {% include 'partial' %}");
+    mj_env_add_template(env, "other", "Other {{ name }}");
+    size_t budget = 1;
+    for (auto name : {"partial", "page", "other"}) {
+        mj_template_memory memory;
+        ASSERT_TRUE(mj_env_template_memory(env, name, &memory));
+        budget += memory.compiled_bytes;
+    }
+    mj_env_set_template_budget(env, budget, false);
+    EXPECT_EQ(render("page"), "Page [World]");
+
+    // Test that rendering a template counts as a use of what it includes,
+    // so the template rendered before is evicted instead of the partial
+    mj_env_add_template(env, "extra", "Extra {{ name }}");
+    mj_template_memory memory;
+    ASSERT_TRUE(mj_env_template_memory(env, "partial", &memory));
+    EXPECT_TRUE(memory.resident);
+    ASSERT_TRUE(mj_env_template_memory(env, "other", &memory));
+    EXPECT_FALSE(memory.resident);
+    EXPECT_EQ(stats().evictions, 1u);
+}
@@ -0,0 +1,103 @@
+#include "test_base.h"
+#include <cstring>
+#include <thread>
+#include <vector>
+
+TEST_F(MiniJinjaTest, TemplateHandleRender)
+{
+    // Test looking a template up once and rendering it repeatedly
+    auto error = mj_env_add_template(env, "handle_template", "Hello {{ name }}!");
+    EXPECT_EQ(error, nullptr);
+
+    auto get_result = mj_env_get_template(env, "handle_template");
+    EXPECT_EQ(get_result->error, nullptr);
+    ASSERT_NE(get_result->tmpl, nullptr);
+    struct mj_template* tmpl = get_result->tmpl;
+    mj_result_env_get_template_free(get_result);
+
+    std::string json_data1 = R"({"name": "World"})";
+    auto render_result1 = mj_template_render(tmpl,
+        reinterpret_cast<const uint8_t*>(json_data1.c_str()), json_data1.length());
+    EXPECT_EQ(render_result1->error, nullptr);
+    EXPECT_STREQ(render_result1->result, "Hello World!");
+    mj_result_env_render_template_free(render_result1);
+
+    std::string json_data2 = R"({"name": "Alice"})";
+    auto render_result2 = mj_template_render(tmpl,
+        reinterpret_cast<const uint8_t*>(json_data2.c_str()), json_data2.length());
+    EXPECT_EQ(render_result2->error, nullptr);
+    EXPECT_STREQ(render_result2->result, "Hello Alice!");
+    mj_result_env_render_template_free(render_result2);
+
+    mj_template_free(tmpl);
+}
+
+TEST_F(MiniJinjaTest, TemplateHandleOutlivesRemoval)
+{
+    // Test that a handle keeps its own reference to the compiled template
+    auto error = mj_env_add_template(env, "removed_template", "Still {{ state }}");
+    EXPECT_EQ(error, nullptr);
+
+    auto get_result = mj_env_get_template(env, "removed_template");
+    ASSERT_NE(get_result->tmpl, nullptr);
+    struct mj_template* tmpl = get_result->tmpl;
+    mj_result_env_get_template_free(get_result);
+
+    mj_env_remove_template(env, "removed_template");
+
+    std::string json_data = R"({"state": "here"})";
+    auto render_result = mj_template_render(tmpl,
+        reinterpret_cast<const uint8_t*>(json_data.c_str()), json_data.length());
+    EXPECT_EQ(render_result->error, nullptr);
+    EXPECT_STREQ(render_result->result, "Still here");
+    mj_result_env_render_template_free(render_result);
+
+    mj_template_free(tmpl);
+}
+
+TEST_F(MiniJinjaTest, TemplateHandleNotFound)
+{
+    // Test looking up a non-existent template
+    auto get_result = mj_env_get_template(env, "non_existent");
+    EXPECT_EQ(get_result->tmpl, nullptr);
+    ASSERT_NE(get_result->error, nullptr);
+    EXPECT_EQ(get_result->error->code, MJ_TEMPLATE_NOT_FOUND);
+    mj_result_env_get_template_free(get_result);
+}
+
+TEST_F(MiniJinjaTest, TemplateHandleConcurrentRender)
+{
+    // Test rendering one handle from many threads at once
+    auto error = mj_env_add_template(env, "concurrent_template", "{{ n }}");
+    EXPECT_EQ(error, nullptr);
+
+    auto get_result = mj_env_get_template(env, "concurrent_template");
+    ASSERT_NE(get_result->tmpl, nullptr);
+    struct mj_template* tmpl = get_result->tmpl;
+    mj_result_env_get_template_free(get_result);
+
+    std::vector<std::thread> threads;
+    std::vector<int> failures(8, 0);
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([tmpl, t, &failures]() {
+            for (int i = 0; i < 100; i++) {
+                std::string json_data = "{\"n\": " + std::to_string(t * 100 + i) + "}";
+                auto render_result = mj_template_render(tmpl,
+                    reinterpret_cast<const uint8_t*>(json_data.c_str()), json_data.length());
+                if (render_result->error != nullptr
+                    || std::to_string(t * 100 + i) != render_result->result) {
+                    failures[t]++;
+                }
+                mj_result_env_render_template_free(render_result);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int t = 0; t < 8; t++) {
+        EXPECT_EQ(failures[t], 0);
+    }
+
+    mj_template_free(tmpl);
+}
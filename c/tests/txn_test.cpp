@@ -0,0 +1,104 @@
+#include "test_base.h"
+#include <string>
+#include <thread>
+
+TEST_F(MiniJinjaTest, TransactionCommit)
+{
+    // Test that a transaction publishes all of its changes at once
+    auto error = mj_env_add_template(env, "txn_old", "old");
+    EXPECT_EQ(error, nullptr);
+
+    struct mj_txn* txn = mj_env_begin_txn(env);
+    ASSERT_NE(txn, nullptr);
+    for (int i = 0; i < 10; i++) {
+        std::string name = "txn_template_" + std::to_string(i);
+        std::string source = "template {{ n }} " + std::to_string(i);
+        error = mj_txn_add_template(txn, name.c_str(), source.c_str());
+        EXPECT_EQ(error, nullptr);
+    }
+    mj_txn_remove_template(txn, "txn_old");
+    std::string global = R"("value")";
+    error = mj_txn_add_global(txn, "txn_global",
+        reinterpret_cast<const uint8_t*>(global.c_str()), global.length());
+    EXPECT_EQ(error, nullptr);
+
+    // Nothing is visible before the commit
+    auto render_result1 = renderTemplate("txn_template_0", "{}");
+    ASSERT_NE(render_result1->error, nullptr);
+    EXPECT_EQ(render_result1->error->code, MJ_TEMPLATE_NOT_FOUND);
+    mj_result_env_render_template_free(render_result1);
+    auto render_result2 = renderTemplate("txn_old", "{}");
+    EXPECT_EQ(render_result2->error, nullptr);
+    EXPECT_STREQ(render_result2->result, "old");
+    mj_result_env_render_template_free(render_result2);
+
+    mj_txn_commit(txn);
+
+    auto render_result3 = renderTemplate("txn_template_9", R"({"n": 1})");
+    EXPECT_EQ(render_result3->error, nullptr);
+    EXPECT_STREQ(render_result3->result, "template 1 9");
+    mj_result_env_render_template_free(render_result3);
+    auto render_result4 = renderTemplate("txn_old", "{}");
+    ASSERT_NE(render_result4->error, nullptr);
+    EXPECT_EQ(render_result4->error->code, MJ_TEMPLATE_NOT_FOUND);
+    mj_result_env_render_template_free(render_result4);
+    auto render_result5 = renderNamedString("txn_global_test", "{{ txn_global }}", "{}");
+    EXPECT_EQ(render_result5->error, nullptr);
+    EXPECT_STREQ(render_result5->result, "value");
+    mj_result_env_render_template_free(render_result5);
+}
+
+TEST_F(MiniJinjaTest, TransactionAbort)
+{
+    // Test that an aborted transaction leaves the environment untouched
+    struct mj_txn* txn = mj_env_begin_txn(env);
+    auto error = mj_txn_add_template(txn, "txn_aborted", "aborted");
+    EXPECT_EQ(error, nullptr);
+
+    // A syntax error is reported but keeps the transaction open
+    error = mj_txn_add_template(txn, "txn_invalid", "{% if %}");
+    ASSERT_NE(error, nullptr);
+    EXPECT_EQ(error->code, MJ_SYNTAX_ERROR);
+    mj_error_free(error);
+
+    mj_txn_abort(txn);
+
+    auto render_result = renderTemplate("txn_aborted", "{}");
+    ASSERT_NE(render_result->error, nullptr);
+    EXPECT_EQ(render_result->error->code, MJ_TEMPLATE_NOT_FOUND);
+    mj_result_env_render_template_free(render_result);
+
+    // The writer lock was released
+    error = mj_env_add_template(env, "txn_after_abort", "ok");
+    EXPECT_EQ(error, nullptr);
+}
+
+TEST_F(MiniJinjaTest, WritersSerializedBehindTransaction)
+{
+    // Test that single-call updates wait for an open transaction
+    struct mj_txn* txn = mj_env_begin_txn(env);
+    auto error = mj_txn_add_template(txn, "txn_first", "first");
+    EXPECT_EQ(error, nullptr);
+
+    std::thread writer([this]() {
+        auto error = mj_env_add_template(env, "txn_second", "second");
+        EXPECT_EQ(error, nullptr);
+    });
+
+    // Renders are not blocked by the open transaction
+    auto render_result = renderNamedString("txn_render", "rendered", "{}");
+    EXPECT_EQ(render_result->error, nullptr);
+    EXPECT_STREQ(render_result->result, "rendered");
+    mj_result_env_render_template_free(render_result);
+
+    mj_txn_commit(txn);
+    writer.join();
+
+    // The update queued behind the transaction did not discard its changes
+    auto render_result1 = renderTemplate("txn_first", "{}");
+    EXPECT_EQ(render_result1->error, nullptr);
+    mj_result_env_render_template_free(render_result1);
+    auto render_result2 = renderTemplate("txn_second", "{}");
+    EXPECT_EQ(render_result2->error, nullptr);
+    mj_result_env_render_template_free(render_result2);
+}
@@ -0,0 +1,97 @@
+#include "test_base.h"
+#include <cstring>
+#include <string>
+
+static struct mj_value* parse_value(const std::string& json)
+{
+    auto result = mj_value_from_json(reinterpret_cast<const uint8_t*>(json.c_str()), json.length());
+    EXPECT_EQ(result->error, nullptr);
+    struct mj_value* value = result->value;
+    mj_result_value_from_json_free(result);
+    return value;
+}
+
+TEST_F(MiniJinjaTest, ValueRenderMultipleTemplates)
+{
+    // Test rendering several templates against a value parsed once
+    auto error = mj_env_add_template(env, "value_title", "{{ catalog.title }}");
+    EXPECT_EQ(error, nullptr);
+    error = mj_env_add_template(env, "value_count", "{{ catalog.items|length }}");
+    EXPECT_EQ(error, nullptr);
+
+    struct mj_value* value = parse_value(R"({"catalog": {"title": "Books", "items": [1, 2, 3]}})");
+    ASSERT_NE(value, nullptr);
+
+    auto title = mj_env_render_value(env, "value_title", value, nullptr, 0);
+    EXPECT_EQ(title->error, nullptr);
+    EXPECT_STREQ(title->result, "Books");
+    mj_result_env_render_template_free(title);
+
+    auto count = mj_env_render_value(env, "value_count", value, nullptr, 0);
+    EXPECT_EQ(count->error, nullptr);
+    EXPECT_STREQ(count->result, "3");
+    mj_result_env_render_template_free(count);
+
+    mj_value_free(value);
+}
+
+TEST_F(MiniJinjaTest, ValueRenderWithOverlay)
+{
+    // Test layering a per-call overlay on top of a shared value
+    auto error = mj_env_add_template(env, "value_overlay", "{{ greeting }}, {{ name }}!");
+    EXPECT_EQ(error, nullptr);
+
+    struct mj_value* value = parse_value(R"({"greeting": "Hello", "name": "World"})");
+    ASSERT_NE(value, nullptr);
+
+    std::string overlay = R"({"name": "Alice"})";
+    auto result = mj_env_render_value(env, "value_overlay", value,
+        reinterpret_cast<const uint8_t*>(overlay.c_str()), overlay.length());
+    EXPECT_EQ(result->error, nullptr);
+    EXPECT_STREQ(result->result, "Hello, Alice!");
+    mj_result_env_render_template_free(result);
+
+    // The overlay must not leak into the base value
+    result = mj_env_render_value(env, "value_overlay", value, nullptr, 0);
+    EXPECT_EQ(result->error, nullptr);
+    EXPECT_STREQ(result->result, "Hello, World!");
+    mj_result_env_render_template_free(result);
+
+    mj_value_free(value);
+}
+
+TEST_F(MiniJinjaTest, ValueRenderTemplateHandle)
+{
+    // Test rendering a template handle against a value
+    auto error = mj_env_add_template(env, "value_handle", "{{ a }}-{{ b }}");
+    EXPECT_EQ(error, nullptr);
+
+    auto get_result = mj_env_get_template(env, "value_handle");
+    ASSERT_NE(get_result->tmpl, nullptr);
+    struct mj_template* tmpl = get_result->tmpl;
+    mj_result_env_get_template_free(get_result);
+
+    struct mj_value* value = parse_value(R"({"a": 1, "b": 2})");
+    ASSERT_NE(value, nullptr);
+
+    std::string overlay = R"({"b": 3})";
+    auto result = mj_template_render_value(tmpl, value,
+        reinterpret_cast<const uint8_t*>(overlay.c_str()), overlay.length());
+    EXPECT_EQ(result->error, nullptr);
+    EXPECT_STREQ(result->result, "1-3");
+    mj_result_env_render_template_free(result);
+
+    mj_value_free(value);
+    mj_template_free(tmpl);
+}
+
+TEST_F(MiniJinjaTest, ValueFromInvalidJson)
+{
+    // Test parsing a malformed context
+    std::string json_data = R"({"name": )";
+    auto result = mj_value_from_json(reinterpret_cast<const uint8_t*>(json_data.c_str()), json_data.length());
+    EXPECT_EQ(result->value, nullptr);
+    ASSERT_NE(result->error, nullptr);
+    EXPECT_EQ(result->error->code, MJ_CANNOT_DESERIALIZE);
+    mj_result_value_from_json_free(result);
+}
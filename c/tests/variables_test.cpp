@@ -0,0 +1,102 @@
+#include "test_base.h"
+
+#include <string>
+#include <vector>
+
+static std::vector<std::string> takeVariables(mj_result_env_template_undeclared_variables* result)
+{
+    std::vector<std::string> names;
+    for (size_t i = 0; i < result->len; i++) {
+        names.push_back(result->variables[i]);
+    }
+    return names;
+}
+
+TEST_F(MiniJinjaTest, UndeclaredVariables)
+{
+    auto err = mj_env_add_template(env, "page",
+        "{% set title = site.name %}{{ title }}: {% for item in items %}{{ item.name }} {{ loop.index }}{% endfor %}"
+        "{% macro greet(who) %}Hi {{ who }} from {{ sender }}{% endmacro %}{{ user.name }} {{ user.email }}");
+    EXPECT_EQ(err, nullptr);
+
+    auto result1 = mj_env_template_undeclared_variables(env, "page", false);
+    ASSERT_EQ(result1->error, nullptr);
+    EXPECT_TRUE(result1->complete);
+    EXPECT_EQ(takeVariables(result1), (std::vector<std::string>{"items", "sender", "site", "user"}));
+    mj_result_env_template_undeclared_variables_free(result1);
+
+    auto result2 = mj_env_template_undeclared_variables(env, "page", true);
+    ASSERT_EQ(result2->error, nullptr);
+    EXPECT_EQ(takeVariables(result2), (std::vector<std::string>{"items", "sender", "site.name", "user.email", "user.name"}));
+    mj_result_env_template_undeclared_variables_free(result2);
+
+    // Test that a changed template is analyzed again
+    err = mj_env_add_template(env, "page", "{{ other }}");
+    EXPECT_EQ(err, nullptr);
+    auto result3 = mj_env_template_undeclared_variables(env, "page", false);
+    ASSERT_EQ(result3->error, nullptr);
+    EXPECT_EQ(takeVariables(result3), (std::vector<std::string>{"other"}));
+    mj_result_env_template_undeclared_variables_free(result3);
+
+    // Test a template that reads no variables
+    err = mj_env_add_template(env, "static", "Hello");
+    EXPECT_EQ(err, nullptr);
+    auto result4 = mj_env_template_undeclared_variables(env, "static", false);
+    ASSERT_EQ(result4->error, nullptr);
+    EXPECT_EQ(result4->variables, nullptr);
+    EXPECT_EQ(result4->len, 0u);
+    mj_result_env_template_undeclared_variables_free(result4);
+}
+
+TEST_F(MiniJinjaTest, UndeclaredVariablesIncomplete)
+{
+    mj_env_add_template(env, "base", "{% block body %}{% endblock %}{{ footer }}");
+    mj_env_add_template(env, "child", "{% extends \"base\" %}{% block body %}{{ body }}{% endblock %}");
+    mj_env_add_template(env, "include", "{{ a }}{%- include \"base\" %}");
+    mj_env_add_template(env, "imports", "{% from \"macros\" import m %}{{ m(b) }}");
+    mj_env_add_template(env, "keywords", "{% set x = \"include\" %}{% if from_date %}{{ x }}{% endif %}");
+
+    const char* incomplete[] = {"child", "include", "imports"};
+    for (auto name : incomplete) {
+        auto result = mj_env_template_undeclared_variables(env, name, false);
+        ASSERT_EQ(result->error, nullptr);
+        EXPECT_FALSE(result->complete) << name;
+        mj_result_env_template_undeclared_variables_free(result);
+    }
+
+    // Test that keywords elsewhere in a tag do not count
+    auto result = mj_env_template_undeclared_variables(env, "keywords", false);
+    ASSERT_EQ(result->error, nullptr);
+    EXPECT_TRUE(result->complete);
+    mj_result_env_template_undeclared_variables_free(result);
+}
+
+TEST_F(MiniJinjaTest, UndeclaredVariablesNotFound)
+{
+    uint64_t generation = mj_env_generation(env);
+    auto result = mj_env_template_undeclared_variables(env, "missing", false);
+    ASSERT_NE(result->error, nullptr);
+    EXPECT_EQ(result->error->code, MJ_TEMPLATE_NOT_FOUND);
+    EXPECT_EQ(result->variables, nullptr);
+    mj_result_env_template_undeclared_variables_free(result);
+
+    // Test that changes bump the generation
+    mj_env_add_template(env, "hello", "{{ name }}");
+    EXPECT_NE(mj_env_generation(env), generation);
+}
+
+TEST_F(MiniJinjaTest, TemplateUndeclaredVariables)
+{
+    mj_env_add_template(env, "hello", "Hello {{ user.name }}{{ suffix }}");
+    auto lookup = mj_env_get_template(env, "hello");
+    ASSERT_EQ(lookup->error, nullptr);
+
+    auto result = mj_template_undeclared_variables(lookup->tmpl, false);
+    ASSERT_EQ(result->error, nullptr);
+    EXPECT_TRUE(result->complete);
+    EXPECT_EQ(takeVariables(result), (std::vector<std::string>{"suffix", "user"}));
+    mj_result_env_template_undeclared_variables_free(result);
+
+    mj_template_free(lookup->tmpl);
+    mj_result_env_get_template_free(lookup);
+}
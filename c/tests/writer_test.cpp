@@ -0,0 +1,101 @@
+#include "test_base.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Collector {
+    std::string output;
+    std::vector<size_t> chunks;
+};
+
+int collect(void* user_data, const uint8_t* data, uintptr_t len)
+{
+    auto collector = static_cast<Collector*>(user_data);
+    collector->output.append(reinterpret_cast<const char*>(data), len);
+    collector->chunks.push_back(len);
+    return 0;
+}
+
+int abort_write(void* user_data, const uint8_t* data, uintptr_t len)
+{
+    (void)user_data;
+    (void)data;
+    (void)len;
+    return 1;
+}
+
+} // namespace
+
+TEST_F(MiniJinjaTest, RenderToWriter)
+{
+    // Test streaming a small template to a callback
+    auto error = mj_env_add_template(env, "writer_template", "Hello {{ name }}!");
+    EXPECT_EQ(error, nullptr);
+
+    Collector collector;
+    std::string json_data = R"({"name": "World"})";
+    error = mj_env_render_to_writer(env, "writer_template",
+        reinterpret_cast<const uint8_t*>(json_data.c_str()), json_data.length(),
+        collect, &collector);
+    EXPECT_EQ(error, nullptr);
+    EXPECT_EQ(collector.output, "Hello World!");
+}
+
+TEST_F(MiniJinjaTest, RenderToWriterChunked)
+{
+    // Test that large output is delivered in bounded chunks
+    auto error = mj_env_add_template(env, "writer_large",
+        "{% for i in range(count) %}{{ line }}\n{% endfor %}");
+    EXPECT_EQ(error, nullptr);
+
+    Collector collector;
+    std::string json_data = R"({"count": 20000, "line": "0123456789abcdef"})";
+    error = mj_env_render_to_writer(env, "writer_large",
+        reinterpret_cast<const uint8_t*>(json_data.c_str()), json_data.length(),
+        collect, &collector);
+    EXPECT_EQ(error, nullptr);
+    EXPECT_EQ(collector.output.size(), 20000u * 17u);
+    EXPECT_GT(collector.chunks.size(), 1u);
+    for (auto chunk : collector.chunks) {
+        EXPECT_LE(chunk, 8192u);
+    }
+}
+
+TEST_F(MiniJinjaTest, RenderToWriterAbort)
+{
+    // Test that a failing callback aborts rendering
+    auto error = mj_env_add_template(env, "writer_abort", "Hello {{ name }}!");
+    EXPECT_EQ(error, nullptr);
+
+    std::string json_data = R"({"name": "World"})";
+    error = mj_env_render_to_writer(env, "writer_abort",
+        reinterpret_cast<const uint8_t*>(json_data.c_str()), json_data.length(),
+        abort_write, nullptr);
+    ASSERT_NE(error, nullptr);
+    EXPECT_EQ(error->code, MJ_WRITE_FAILURE);
+    mj_error_free(error);
+}
+
+TEST_F(MiniJinjaTest, TemplateHandleRenderToWriter)
+{
+    // Test streaming a template handle to a callback
+    auto error = mj_env_add_template(env, "writer_handle", "{{ a }}+{{ b }}");
+    EXPECT_EQ(error, nullptr);
+
+    auto get_result = mj_env_get_template(env, "writer_handle");
+    ASSERT_NE(get_result->tmpl, nullptr);
+    struct mj_template* tmpl = get_result->tmpl;
+    mj_result_env_get_template_free(get_result);
+
+    Collector collector;
+    std::string json_data = R"({"a": 1, "b": 2})";
+    error = mj_template_render_to_writer(tmpl,
+        reinterpret_cast<const uint8_t*>(json_data.c_str()), json_data.length(),
+        collect, &collector);
+    EXPECT_EQ(error, nullptr);
+    EXPECT_EQ(collector.output, "1+2");
+
+    mj_template_free(tmpl);
+}
@@ -0,0 +1,101 @@
+package ginja
+
+import (
+	"github.com/bytedance/sonic"
+	"github.com/bytedance/sonic/encoder"
+)
+
+// sortedJSON encodes maps with sorted keys, so that equal contexts encode
+// to identical bytes and can hit the render cache.
+var sortedJSON = sonic.Config{SortMapKeys: true}.Froze()
+
+// RenderCacheStats holds the counters of the render cache.
+type RenderCacheStats struct {
+	Hits      uint64
+	Misses    uint64
+	Evictions uint64
+	Entries   int
+	Bytes     int
+	Budget    int
+}
+
+// SetRenderCache enables the render cache with a budget of the given number
+// of bytes, or disables it if budget is 0.
+//
+// While enabled, RenderTemplate serves renders of the same template with an
+// equal context from the cache, without parsing the context or rendering.
+// Least recently used entries are evicted to stay within the budget. Every
+// change to the environment, such as adding or removing a template or a
+// global, invalidates all cached output.
+//
+// Setting a budget replaces the cache with a new, empty one. Only enable
+// the cache if the output of the templates depends on nothing but their
+// context and the environment.
+func (env *Environment) SetRenderCache(budget int) {
+	env.cached.Store(budget > 0)
+	env.ffi.MjEnvSetRenderCache(env.inner, uint(budget))
+}
+
+// RenderCacheStats returns the counters of the render cache, or zero
+// counters while it is disabled.
+func (env *Environment) RenderCacheStats() RenderCacheStats {
+	var stats mjRenderCacheStats
+	env.ffi.MjEnvRenderCacheStats(env.inner, &stats)
+	return RenderCacheStats{
+		Hits:      stats.hits,
+		Misses:    stats.misses,
+		Evictions: stats.evictions,
+		Entries:   int(stats.entries),
+		Bytes:     int(stats.bytes),
+		Budget:    int(stats.budget),
+	}
+}
+
+// marshal encodes the render context of template name, pruned while
+// context pruning is enabled and with sorted keys while the render cache is
+// enabled.
+func (env *Environment) marshal(name string, ctx map[string]any) ([]byte, error) {
+	ctx = env.prune(name, ctx)
+	if env.cached.Load() {
+		return sortedJSON.Marshal(ctx)
+	}
+	return sonic.Marshal(ctx)
+}
+
+// marshalInto appends the render context of template name to buf like
+// marshal, but writes a pruned context straight from ctx instead of
+// building a pruned copy first, so it does not allocate once buf has grown.
+func (env *Environment) marshalInto(buf *[]byte, name string, ctx map[string]any) error {
+	var opts encoder.Options
+	if env.cached.Load() {
+		opts = encoder.SortMapKeys
+	}
+	var vars *templateVariables
+	if len(ctx) > 0 {
+		vars = env.prunedVariables(name)
+	}
+	if vars == nil {
+		return encoder.EncodeInto(buf, ctx, opts)
+	}
+	// The variables are sorted, so the keys are too, and they are
+	// identifiers, which need no escaping.
+	*buf = append(*buf, '{')
+	start := len(*buf)
+	for _, key := range vars.sorted {
+		value, ok := ctx[key]
+		if !ok {
+			continue
+		}
+		if len(*buf) > start {
+			*buf = append(*buf, ',')
+		}
+		*buf = append(*buf, '"')
+		*buf = append(*buf, key...)
+		*buf = append(*buf, '"', ':')
+		if err := encoder.EncodeInto(buf, value, opts); err != nil {
+			return err
+		}
+	}
+	*buf = append(*buf, '}')
+	return nil
+}
@@ -0,0 +1,36 @@
+package ginja_test
+
+import (
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestRenderCache(assert *require.Assertions) {
+	env, err := ginja.New()
+	assert.Nil(err)
+	defer env.Close()
+	env.SetRenderCache(1 << 20)
+	assert.Nil(env.AddTemplate("cached", "{{ greeting }} {{ name }}!"))
+
+	// Equal maps hit the cache regardless of their iteration order
+	for range 5 {
+		result, err := env.RenderTemplate("cached", map[string]any{"greeting": "Hello", "name": "World", "a": 1, "b": 2, "c": 3})
+		assert.Nil(err)
+		assert.Equal("Hello World!", result)
+	}
+	stats := env.RenderCacheStats()
+	assert.Equal(uint64(4), stats.Hits)
+	assert.Equal(uint64(1), stats.Misses)
+	assert.Equal(1, stats.Entries)
+	assert.Equal(1<<20, stats.Budget)
+
+	// Changing the template invalidates its cached output
+	assert.Nil(env.AddTemplate("cached", "{{ greeting }}, {{ name }}."))
+	result, err := env.RenderTemplate("cached", map[string]any{"greeting": "Hello", "name": "World", "a": 1, "b": 2, "c": 3})
+	assert.Nil(err)
+	assert.Equal("Hello, World.", result)
+	assert.Equal(uint64(2), env.RenderCacheStats().Misses)
+
+	env.SetRenderCache(0)
+	assert.Equal(ginja.RenderCacheStats{}, env.RenderCacheStats())
+}
@@ -0,0 +1,114 @@
+// Command ginja-bundle packs a directory of templates into a single bundle
+// file, to be loaded at startup with Environment.LoadBundle.
+//
+// Usage:
+//
+//	ginja-bundle -o templates.bundle ./templates
+package main
+
+import (
+	"bufio"
+	"flag"
+	"fmt"
+	"io/fs"
+	"os"
+	"path/filepath"
+	"slices"
+
+	"go.yuchanns.xyz/ginja"
+)
+
+func main() {
+	output := flag.String("o", "templates.bundle", "path of the bundle to write")
+	flag.Usage = func() {
+		fmt.Fprintf(flag.CommandLine.Output(), "usage: %s [-o output] dir\n", os.Args[0])
+		flag.PrintDefaults()
+	}
+	flag.Parse()
+	if flag.NArg() != 1 {
+		flag.Usage()
+		os.Exit(2)
+	}
+	if err := run(flag.Arg(0), *output); err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		os.Exit(1)
+	}
+}
+
+// run writes the bundle to a temporary file next to output and renames it
+// over output, so that processes which have the previous bundle mapped
+// keep reading it unchanged.
+func run(dir, output string) (err error) {
+	f, err := os.CreateTemp(filepath.Dir(output), filepath.Base(output)+".*")
+	if err != nil {
+		return
+	}
+	defer func() {
+		if cerr := f.Close(); err == nil {
+			err = cerr
+		}
+		if err == nil {
+			err = os.Rename(f.Name(), output)
+		}
+		if err != nil {
+			os.Remove(f.Name())
+		}
+	}()
+	// Temporary files are private, the bundle is as readable as one
+	// written by os.Create.
+	if err = f.Chmod(0o644); err != nil {
+		return
+	}
+	fsys, err := exclude(dir, output, f.Name())
+	if err != nil {
+		return
+	}
+	w := bufio.NewWriter(f)
+	if err = ginja.WriteBundle(w, fsys); err != nil {
+		return
+	}
+	return w.Flush()
+}
+
+// excludeFS hides some files of one directory of a file system.
+type excludeFS struct {
+	fs.FS
+	dir   string
+	names []string
+}
+
+// exclude returns the file system of dir without the files at paths, so
+// that a bundle written into the directory it packs does not pack itself.
+func exclude(dir string, paths ...string) (fsys fs.FS, err error) {
+	fsys = os.DirFS(dir)
+	root, err := filepath.Abs(dir)
+	if err != nil {
+		return
+	}
+	e := excludeFS{FS: fsys}
+	for _, path := range paths {
+		if path, err = filepath.Abs(path); err != nil {
+			return
+		}
+		rel, err := filepath.Rel(root, filepath.Dir(path))
+		if err != nil || !filepath.IsLocal(rel) {
+			continue
+		}
+		e.dir = filepath.ToSlash(rel)
+		e.names = append(e.names, filepath.Base(path))
+	}
+	if len(e.names) > 0 {
+		fsys = e
+	}
+	return
+}
+
+func (e excludeFS) ReadDir(name string) ([]fs.DirEntry, error) {
+	entries, err := fs.ReadDir(e.FS, name)
+	if err != nil || name != e.dir {
+		return entries, err
+	}
+	return slices.DeleteFunc(entries, func(d fs.DirEntry) bool {
+		return slices.Contains(e.names, d.Name())
+	}), nil
+}
@@ -0,0 +1,13 @@
+package ginja
+
+// AddContrib adds a pack of native formatting filters and functions to the
+// Environment, so that data can be formatted while rendering instead of
+// before marshaling the context. The pack includes the filters and
+// functions of minijinja-contrib, such as datetimeformat, dateformat,
+// timeformat, now, filesizeformat, pluralize, truncate and wordwrap, plus
+// urlencode, tojson and numberformat.
+//
+// See WithContrib to add the pack when creating the Environment.
+func (env *Environment) AddContrib() {
+	env.ffi.MjEnvAddContrib(env.inner)
+}
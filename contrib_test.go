@@ -0,0 +1,32 @@
+package ginja_test
+
+import (
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestContrib(assert *require.Assertions) {
+	env, err := ginja.New(ginja.WithContrib())
+	assert.Nil(err)
+	defer env.Close()
+
+	assert.Nil(env.AddTemplate("contrib.html", `{{ price | numberformat(decimals=2) }} {{ size | filesizeformat }} <a href="/q?{{ query | urlencode }}">{{ items | tojson }}</a>`))
+	result, err := env.RenderTemplate("contrib.html", map[string]any{
+		"price": 1234.5,
+		"size":  2000,
+		"query": map[string]any{"q": "a b"},
+		"items": []string{"<x>"},
+	})
+	assert.Nil(err)
+	assert.Equal(`1,234.50 2.0 kB <a href="/q?q=a+b">["\u003cx\u003e"]</a>`, result)
+}
+
+func (s *Suite) TestContribNotAdded(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("contrib_missing.txt", "{{ n | numberformat }}"))
+	_, err := env.RenderTemplate("contrib_missing.txt", map[string]any{"n": 1})
+	var e *ginja.Error
+	assert.ErrorAs(err, &e)
+	assert.Equal(ginja.CodeUnknownFilter, e.Code())
+}
@@ -1,10 +1,11 @@
 package ginja
 
 import (
+	"sync"
+	"sync/atomic"
 	"unsafe"
 
 	"github.com/bytedance/sonic"
-	"go.yuchanns.xyz/ginja/internal/embed"
 )
 
 type templateCacheEntry struct {
@@ -16,14 +17,20 @@ type Environment struct {
 	ffi *ffi
 
 	inner unsafe.Pointer
+
+	stats  renderStats
+	cached atomic.Bool
+
+	pruned    atomic.Bool
+	variables sync.Map
 }
 
-func New() (env *Environment, err error) {
-	path, err := embed.LoadOnce()
-	if err != nil {
-		return
+func New(opts ...Option) (env *Environment, err error) {
+	var o options
+	for _, opt := range opts {
+		opt(&o)
 	}
-	ffi, err := newFFI(path)
+	ffi, err := loadFFI()
 	if err != nil {
 		return
 	}
@@ -32,14 +39,64 @@ func New() (env *Environment, err error) {
 		ffi:   ffi,
 		inner: inner,
 	}
+	if o.contrib {
+		env.AddContrib()
+	}
+	env.SetContextPruning(o.pruned)
+	for _, dir := range o.templateDirs {
+		if err = env.AddTemplateDir(dir); err != nil {
+			env.Close()
+			env = nil
+			return
+		}
+	}
+	for _, path := range o.bundles {
+		if err = env.LoadBundle(path); err != nil {
+			env.Close()
+			env = nil
+			return
+		}
+	}
 	return
 }
 
+// AddTemplateDir adds dir to the directories templates are loaded from.
+//
+// See WithTemplateDir for details.
+func (env *Environment) AddTemplateDir(dir string) (err error) {
+	dptr, err := BytePtrFromString(dir)
+	if err != nil {
+		return
+	}
+	env.ffi.MjEnvAddLoaderPath(env.inner, dptr)
+	return
+}
+
+// Fork creates a child Environment that starts out with the templates,
+// globals and settings of env. They are shared rather than copied, so
+// forking costs the same no matter how many templates env holds, which
+// makes it cheap to derive one Environment per tenant from a common base.
+//
+// Templates, globals and settings changed on the child override those of
+// env for the child only. Changes made to env after the fork are not
+// visible to the child. Both must be closed independently.
+func (env *Environment) Fork() (child *Environment, err error) {
+	child = &Environment{
+		ffi:   env.ffi,
+		inner: env.ffi.MjEnvClone(env.inner),
+	}
+	child.stats.enabled.Store(env.stats.enabled.Load())
+	child.cached.Store(env.cached.Load())
+	child.pruned.Store(env.pruned.Load())
+	return
+}
+
+// Close releases the environment. The native library stays loaded for
+// the other environments of the process.
 func (env *Environment) Close() {
 	if env.inner == nil {
 		return
 	}
-	defer FreeLibrary(env.ffi.lib)
 	env.ffi.MjEnvFree(env.inner)
 	env.inner = nil
 }
@@ -56,27 +113,68 @@ func (env *Environment) AddTemplate(name string, source string) (err error) {
 
 	ret := env.ffi.MjEnvAddTemplate(env.inner, nptr, sptr)
 	if ret != nil {
-		defer env.ffi.MjErrorFree(ret)
-		err = parseError(ret)
+		err = parseError(env.ffi, ret)
 	}
 
 	return
 }
 
+// AddGlobal registers value as a global variable visible to every template
+// of the environment. Data shared by all renders belongs here rather than in
+// each context, so it is serialized and parsed once instead of per render.
+// Keys of a render context shadow globals of the same name.
+func (env *Environment) AddGlobal(name string, value any) (err error) {
+	data, err := sonic.Marshal(value)
+	if err != nil {
+		return
+	}
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return
+	}
+
+	ret := env.ffi.MjEnvAddGlobal(env.inner, nptr, &data[0], uint(len(data)))
+	if ret != nil {
+		err = parseError(env.ffi, ret)
+	}
+
+	return
+}
+
+// RemoveGlobal removes a global variable previously added with AddGlobal.
+func (env *Environment) RemoveGlobal(name string) (err error) {
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return
+	}
+	env.ffi.MjEnvRemoveGlobal(env.inner, nptr)
+	return
+}
+
 func (env *Environment) RenderTemplate(name string, ctx map[string]any) (rendered string, err error) {
-	value, err := sonic.Marshal(ctx)
+	rec := env.stats.start(name)
+	defer func() { rec.done(err) }()
+	value, err := env.marshal(name, ctx)
 	if err != nil {
 		return
 	}
+	rec.mark(phaseMarshal)
 	nptr, err := BytePtrFromString(name)
 	if err != nil {
 		return
 	}
 	ret := env.ffi.MjEnvRender(env.inner, nptr, &value[0], uint(len(value)))
-	defer env.ffi.MjResultEnvRenderTemplateFree(ret)
-	result := (*mjResultEnvRenderTemplate)(unsafe.Pointer(ret))
+	rec.mark(phaseCall)
+	rendered, err = takeRenderResult(env.ffi, ret)
+	rec.mark(phaseCopy)
+	return
+}
+
+func takeRenderResult(ffi *ffi, ret unsafe.Pointer) (rendered string, err error) {
+	defer ffi.MjResultEnvRenderTemplateFree(ret)
+	result := (*mjResultEnvRenderTemplate)(ret)
 	if result.error != nil {
-		err = parseError(result.error)
+		err = takeError(ffi, &result.error)
 		return
 	}
 	rendered = BytePtrToString(result.rendered)
@@ -1,7 +1,10 @@
 package ginja
 
 import (
+	"context"
 	"fmt"
+	"runtime"
+	"sync"
 	"unsafe"
 )
 
@@ -28,32 +31,116 @@ const (
 	CodeCannotUnpack
 	CodeWriteFailure
 	CodeUnknownBlock
+	CodeOutOfFuel
+	CodeDeadlineExceeded
 )
 
+// Error is an error raised by the native library.
+//
+// Its code and location are read when the error is created. The message
+// and the template name are only formatted on first use, which keeps
+// failing renders cheap when only the code or location is inspected.
 type Error struct {
-	code    ErrorCode
+	code   ErrorCode
+	line   int
+	column int
+	start  int
+	end    int
+
+	once    sync.Once
+	ffi     *ffi
+	inner   unsafe.Pointer
 	message string
+	name    string
 }
 
 func (e *Error) Error() string {
-	return fmt.Sprintf("%d %s", e.code, e.message)
+	return fmt.Sprintf("%d %s", e.code, e.Message())
 }
 
 func (e *Error) Code() ErrorCode {
 	return e.code
 }
 
+// Is reports an error with CodeDeadlineExceeded as
+// context.DeadlineExceeded, so that a render that ran out of time matches
+// errors.Is like any other operation bounded by a context.
+func (e *Error) Is(target error) bool {
+	return target == context.DeadlineExceeded && e.code == CodeDeadlineExceeded
+}
+
+// Message returns the message of the error, including its chain of causes.
 func (e *Error) Message() string {
+	e.once.Do(e.format)
 	return e.message
 }
 
-func parseError(e unsafe.Pointer) (err error) {
+// TemplateName returns the name of the template the error occurred in, or
+// an empty string if the error is not tied to a template.
+func (e *Error) TemplateName() string {
+	e.once.Do(e.format)
+	return e.name
+}
+
+// Line returns the 1-based line of the template the error occurred on, or
+// 0 if unknown.
+func (e *Error) Line() int {
+	return e.line
+}
+
+// Column returns the 1-based column the error starts at, or 0 if unknown.
+// Columns are only known for environments in debug mode.
+func (e *Error) Column() int {
+	return e.column
+}
+
+// Range returns the byte offsets into the template source the error spans.
+// Both are 0 if unknown.
+func (e *Error) Range() (start, end int) {
+	return e.start, e.end
+}
+
+// format copies the lazily formatted parts of the native error and
+// releases it.
+func (e *Error) format() {
+	if e.inner == nil {
+		return
+	}
+	e.message = BytePtrToString(e.ffi.MjErrorMessage(e.inner))
+	e.name = BytePtrToString(e.ffi.MjErrorTemplateName(e.inner))
+	e.free()
+	runtime.SetFinalizer(e, nil)
+}
+
+func (e *Error) free() {
+	e.ffi.MjErrorFree(e.inner)
+	e.inner = nil
+}
+
+// parseError takes ownership of the native error e. It is released once
+// its message is formatted, or when the Error is garbage collected.
+func parseError(ffi *ffi, e unsafe.Pointer) (err error) {
 	if e == nil {
 		return
 	}
 	ret := (*mjError)(e)
-	return &Error{
-		code:    ErrorCode(ret.code),
-		message: BytePtrToString(ret.message),
+	perr := &Error{
+		code:   ErrorCode(ret.code),
+		line:   int(ret.line),
+		column: int(ret.column),
+		start:  int(ret.rangeStart),
+		end:    int(ret.rangeEnd),
+		ffi:    ffi,
+		inner:  e,
 	}
+	runtime.SetFinalizer(perr, (*Error).free)
+	return perr
+}
+
+// takeError takes ownership of the native error at *e, if any, and clears
+// the field so that freeing the result holding it leaves the error alive.
+func takeError(ffi *ffi, e *unsafe.Pointer) (err error) {
+	err = parseError(ffi, *e)
+	*e = nil
+	return
 }
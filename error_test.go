@@ -0,0 +1,29 @@
+package ginja_test
+
+import (
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestErrorLocation(assert *require.Assertions) {
+	env := s.env
+
+	err := env.AddTemplate("error_location", "Hello\n{{ name | }}")
+	var e *ginja.Error
+	assert.ErrorAs(err, &e)
+	assert.Equal(ginja.CodeSyntaxError, e.Code())
+	assert.Equal(2, e.Line())
+	start, end := e.Range()
+	assert.LessOrEqual(start, end)
+	assert.GreaterOrEqual(start, len("Hello\n"))
+	assert.Equal("error_location", e.TemplateName())
+	assert.Contains(e.Message(), "syntax error")
+	assert.Contains(err.Error(), e.Message())
+
+	// Errors that are not tied to a template carry no location
+	_, err = env.RenderTemplate("error_location_missing", map[string]any{})
+	assert.ErrorAs(err, &e)
+	assert.Equal(ginja.CodeTemplateNotFound, e.Code())
+	assert.Equal(0, e.Line())
+	assert.NotEmpty(e.Message())
+}
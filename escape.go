@@ -0,0 +1,29 @@
+package ginja
+
+// AutoEscape is how values printed by a template are escaped.
+type AutoEscape int32
+
+const (
+	// AutoEscapeNone prints values as is.
+	AutoEscapeNone AutoEscape = iota
+	// AutoEscapeHTML escapes values for HTML and XML.
+	AutoEscapeHTML
+	// AutoEscapeJSON prints values as JSON that is safe to embed in HTML.
+	AutoEscapeJSON
+)
+
+// SetAutoEscape sets how templates whose name ends with suffix escape the
+// values they print. The longest matching suffix applies. Templates that
+// match no suffix escape as HTML if their name ends with .html, .htm or
+// .xml, and do not escape otherwise.
+//
+// Escaping in the native library is much faster than escaping values in Go
+// before rendering, and values marked safe in the template are left alone.
+func (env *Environment) SetAutoEscape(suffix string, mode AutoEscape) (err error) {
+	sptr, err := BytePtrFromString(suffix)
+	if err != nil {
+		return
+	}
+	env.ffi.MjEnvSetAutoEscape(env.inner, sptr, int32(mode))
+	return
+}
@@ -0,0 +1,37 @@
+package ginja_test
+
+import (
+	"strings"
+
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestAutoEscape(assert *require.Assertions) {
+	env, err := ginja.New()
+	assert.Nil(err)
+	defer env.Close()
+
+	assert.Nil(env.AddTemplate("escape.html", "<p>{{ text }}</p>"))
+	result, err := env.RenderTemplate("escape.html", map[string]any{"text": `Tom & "Jerry" <3`})
+	assert.Nil(err)
+	assert.Equal("<p>Tom &amp; &quot;Jerry&quot; &lt;3</p>", result)
+
+	long := strings.Repeat("a", 50) + "<" + strings.Repeat("b", 50)
+	result, err = env.RenderTemplate("escape.html", map[string]any{"text": long})
+	assert.Nil(err)
+	assert.Equal("<p>"+strings.Repeat("a", 50)+"&lt;"+strings.Repeat("b", 50)+"</p>", result)
+
+	assert.Nil(env.SetAutoEscape(".txt", ginja.AutoEscapeHTML))
+	assert.Nil(env.SetAutoEscape(".json", ginja.AutoEscapeJSON))
+	assert.Nil(env.AddTemplate("escape.txt", "{{ text }}"))
+	assert.Nil(env.AddTemplate("escape.json", `{"items": {{ items }}}`))
+
+	result, err = env.RenderTemplate("escape.txt", map[string]any{"text": "<b>"})
+	assert.Nil(err)
+	assert.Equal("&lt;b&gt;", result)
+
+	result, err = env.RenderTemplate("escape.json", map[string]any{"items": []any{"</script>", 1}})
+	assert.Nil(err)
+	assert.Equal(`{"items": ["\u003c/script\u003e",1]}`, result)
+}
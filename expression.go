@@ -0,0 +1,89 @@
+package ginja
+
+import (
+	"unsafe"
+
+	"github.com/bytedance/sonic"
+)
+
+const (
+	evalNone int32 = iota
+	evalBool
+	evalInt
+	evalFloat
+	evalString
+	evalJSON
+)
+
+// Expression is a compiled expression in template syntax, such as
+// `user.age >= 18 and "beta" in user.flags`, that can be evaluated
+// repeatedly without compiling it again. It is safe to evaluate from
+// multiple goroutines at once.
+//
+// Like a Template, an Expression keeps evaluating with the filters, tests,
+// functions and globals the Environment had when it was compiled.
+type Expression struct {
+	ffi *ffi
+
+	inner unsafe.Pointer
+}
+
+// CompileExpression compiles source as an expression.
+func (env *Environment) CompileExpression(source string) (expr *Expression, err error) {
+	sptr, err := BytePtrFromString(source)
+	if err != nil {
+		return
+	}
+	ret := env.ffi.MjEnvCompileExpression(env.inner, sptr)
+	defer env.ffi.MjResultEnvCompileExpressionFree(ret)
+	result := (*mjResultEnvCompileExpression)(ret)
+	if result.error != nil {
+		err = takeError(env.ffi, &result.error)
+		return
+	}
+	expr = &Expression{
+		ffi:   env.ffi,
+		inner: result.expr,
+	}
+	return
+}
+
+// Eval evaluates the expression with ctx. The value is a bool, an int64, a
+// float64 or a string, nil for none and undefined values, and what
+// sonic.Unmarshal decodes into an any for everything else, such as lists
+// and maps.
+func (expr *Expression) Eval(ctx map[string]any) (value any, err error) {
+	data, err := sonic.Marshal(ctx)
+	if err != nil {
+		return
+	}
+	ret := expr.ffi.MjExpressionEval(expr.inner, &data[0], uint(len(data)))
+	defer expr.ffi.MjResultExpressionEvalFree(ret)
+	result := (*mjResultExpressionEval)(ret)
+	if result.error != nil {
+		err = takeError(expr.ffi, &result.error)
+		return
+	}
+	switch result.kind {
+	case evalBool:
+		value = result.boolean
+	case evalInt:
+		value = result.integer
+	case evalFloat:
+		value = result.number
+	case evalString:
+		value = BytePtrToString(result.string)
+	case evalJSON:
+		err = sonic.UnmarshalString(BytePtrToString(result.string), &value)
+	}
+	return
+}
+
+// Close releases the expression.
+func (expr *Expression) Close() {
+	if expr.inner == nil {
+		return
+	}
+	expr.ffi.MjExpressionFree(expr.inner)
+	expr.inner = nil
+}
@@ -0,0 +1,43 @@
+package ginja_test
+
+import (
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestExpression(assert *require.Assertions) {
+	ctx := map[string]any{
+		"user":  map[string]any{"age": 21, "flags": []string{"beta"}, "name": "Ann"},
+		"ratio": 0.25,
+	}
+	for _, tc := range []struct {
+		source string
+		want   any
+	}{
+		{`user.age >= 18 and "beta" in user.flags`, true},
+		{"user.age * 2", int64(42)},
+		{"ratio * 2", 0.5},
+		{"user.name | upper", "ANN"},
+		{"user.flags + [1]", []any{"beta", float64(1)}},
+		{"user.missing", nil},
+	} {
+		expr, err := s.env.CompileExpression(tc.source)
+		assert.Nil(err)
+		value, err := expr.Eval(ctx)
+		assert.Nil(err)
+		assert.Equal(tc.want, value, tc.source)
+		expr.Close()
+	}
+
+	_, err := s.env.CompileExpression("user.age >=")
+	assert.NotNil(err)
+	var e *ginja.Error
+	assert.ErrorAs(err, &e)
+	assert.Equal(ginja.CodeSyntaxError, e.Code())
+
+	expr, err := s.env.CompileExpression(`value - "x"`)
+	assert.Nil(err)
+	defer expr.Close()
+	_, err = expr.Eval(map[string]any{"value": 1})
+	assert.NotNil(err)
+}
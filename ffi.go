@@ -2,25 +2,125 @@ package ginja
 
 import (
 	"reflect"
+	"sync"
 	"unsafe"
 
 	"github.com/ebitengine/purego"
 	"github.com/iancoleman/strcase"
+	"go.yuchanns.xyz/ginja/internal/embed"
 )
 
 type ffi struct {
-	MjEnvNew  func() unsafe.Pointer
-	MjEnvFree func(env unsafe.Pointer)
+	MjEnvNew   func() unsafe.Pointer
+	MjEnvClone func(env unsafe.Pointer) unsafe.Pointer
+	MjEnvFree  func(env unsafe.Pointer)
 
 	MjEnvAddTemplate              func(env unsafe.Pointer, name *byte, source *byte) unsafe.Pointer
+	MjEnvAddLoaderPath            func(env unsafe.Pointer, path *byte)
+	MjEnvAddGlobal                func(env unsafe.Pointer, name *byte, data *byte, dataLen uint) unsafe.Pointer
+	MjEnvRemoveGlobal             func(env unsafe.Pointer, name *byte)
 	MjEnvRender                   func(env unsafe.Pointer, name *byte, data *byte, dataLen uint) unsafe.Pointer
+	MjEnvRenderToWriter           func(env unsafe.Pointer, name *byte, data *byte, dataLen uint, callback uintptr, userData uintptr) unsafe.Pointer
+	MjEnvRenderInto               func(env unsafe.Pointer, name *byte, data *byte, dataLen uint, buf *byte, bufCap uint, outLen *uint) unsafe.Pointer
+	MjEnvRenderBlock              func(env unsafe.Pointer, name *byte, block *byte, data *byte, dataLen uint) unsafe.Pointer
+	MjEnvCallMacro                func(env unsafe.Pointer, name *byte, macroName *byte, data *byte, dataLen uint, args *byte, argsLen uint) unsafe.Pointer
+	MjEnvRenderWithLimits         func(env unsafe.Pointer, name *byte, data *byte, dataLen uint, limits *mjRenderLimits) unsafe.Pointer
 	MjResultEnvRenderTemplateFree func(result unsafe.Pointer)
 
-	MjErrorFree func(err unsafe.Pointer)
+	MjEnvRenderBinary      func(env unsafe.Pointer, name *byte, data *byte, dataLen uint) unsafe.Pointer
+	MjTemplateRenderBinary func(tmpl unsafe.Pointer, data *byte, dataLen uint) unsafe.Pointer
+
+	MjEnvLoadBundle           func(env unsafe.Pointer, path *byte) unsafe.Pointer
+	MjEnvLoadBundleBytes      func(env unsafe.Pointer, data *byte, dataLen uint) unsafe.Pointer
+	MjResultEnvLoadBundleFree func(result unsafe.Pointer)
+
+	MjEnvSetFuel    func(env unsafe.Pointer, fuel uint64)
+	MjEnvSetTimeout func(env unsafe.Pointer, timeoutNs uint64)
+
+	MjEnvQueueNew func(env unsafe.Pointer, capacity uint, workers uint) unsafe.Pointer
+	MjQueueSubmit func(queue unsafe.Pointer, id uint64, name *byte, data *byte, dataLen uint) bool
+	MjQueueFree   func(queue unsafe.Pointer)
+
+	MjEnvSetAutoEscape  func(env unsafe.Pointer, suffix *byte, mode int32)
+	MjEnvAddContrib     func(env unsafe.Pointer)
+	MjEnvSetLazyContext func(env unsafe.Pointer, value bool)
+
+	MjEnvCompileExpression           func(env unsafe.Pointer, source *byte) unsafe.Pointer
+	MjResultEnvCompileExpressionFree func(result unsafe.Pointer)
+	MjExpressionEval                 func(expr unsafe.Pointer, data *byte, dataLen uint) unsafe.Pointer
+	MjResultExpressionEvalFree       func(result unsafe.Pointer)
+	MjExpressionFree                 func(expr unsafe.Pointer)
+
+	MjEnvTemplateUndeclaredVariables           func(env unsafe.Pointer, name *byte, nested bool) unsafe.Pointer
+	MjTemplateUndeclaredVariables              func(tmpl unsafe.Pointer, nested bool) unsafe.Pointer
+	MjResultEnvTemplateUndeclaredVariablesFree func(result unsafe.Pointer)
+	MjEnvGeneration                            func(env unsafe.Pointer) uint64
+
+	MjEnvSetRenderCache   func(env unsafe.Pointer, budget uint)
+	MjEnvRenderCacheStats func(env unsafe.Pointer, stats *mjRenderCacheStats)
+
+	MjEnvSetTemplateBudget  func(env unsafe.Pointer, budget uint, compress bool)
+	MjEnvTemplateMemory     func(env unsafe.Pointer, name *byte, memory *mjTemplateMemory) bool
+	MjEnvTemplateStoreStats func(env unsafe.Pointer, stats *mjTemplateStoreStats)
+
+	MjEnvRenderBatch           func(env unsafe.Pointer, name *byte, contexts *mjBuffer, count uint) unsafe.Pointer
+	MjEnvRenderBatchItems      func(env unsafe.Pointer, items *mjRenderItem, count uint) unsafe.Pointer
+	MjResultEnvRenderBatchFree func(result unsafe.Pointer)
+
+	MjEnvGetTemplate           func(env unsafe.Pointer, name *byte) unsafe.Pointer
+	MjResultEnvGetTemplateFree func(result unsafe.Pointer)
+	MjTemplateRender           func(tmpl unsafe.Pointer, data *byte, dataLen uint) unsafe.Pointer
+	MjTemplateRenderToWriter   func(tmpl unsafe.Pointer, data *byte, dataLen uint, callback uintptr, userData uintptr) unsafe.Pointer
+	MjTemplateRenderInto       func(tmpl unsafe.Pointer, data *byte, dataLen uint, buf *byte, bufCap uint, outLen *uint) unsafe.Pointer
+	MjTemplateFree             func(tmpl unsafe.Pointer)
+
+	MjEnvBeginTxn       func(env unsafe.Pointer) unsafe.Pointer
+	MjTxnAddTemplate    func(txn unsafe.Pointer, name *byte, source *byte) unsafe.Pointer
+	MjTxnRemoveTemplate func(txn unsafe.Pointer, name *byte)
+	MjTxnClearTemplates func(txn unsafe.Pointer)
+	MjTxnAddGlobal      func(txn unsafe.Pointer, name *byte, data *byte, dataLen uint) unsafe.Pointer
+	MjTxnRemoveGlobal   func(txn unsafe.Pointer, name *byte)
+	MjTxnCommit         func(txn unsafe.Pointer)
+	MjTxnAbort          func(txn unsafe.Pointer)
+
+	MjValueFromJson           func(data *byte, dataLen uint) unsafe.Pointer
+	MjResultValueFromJsonFree func(result unsafe.Pointer)
+	MjEnvRenderValue          func(env unsafe.Pointer, name *byte, value unsafe.Pointer, overlay *byte, overlayLen uint) unsafe.Pointer
+	MjTemplateRenderValue     func(tmpl unsafe.Pointer, value unsafe.Pointer, overlay *byte, overlayLen uint) unsafe.Pointer
+	MjValueFree               func(value unsafe.Pointer)
+
+	MjEnvSetStats func(env unsafe.Pointer, value bool)
+	MjEnvStats    func(env unsafe.Pointer) unsafe.Pointer
+	MjStatsFree   func(stats unsafe.Pointer)
+
+	MjErrorMessage      func(err unsafe.Pointer) *byte
+	MjErrorTemplateName func(err unsafe.Pointer) *byte
+	MjErrorFree         func(err unsafe.Pointer)
 
 	lib uintptr
 }
 
+var (
+	sharedOnce sync.Once
+	shared     *ffi
+	sharedErr  error
+)
+
+// loadFFI loads the native library and resolves its symbols the first time
+// it is called, and returns the same table to every later caller. The
+// library stays loaded for the lifetime of the process.
+func loadFFI() (*ffi, error) {
+	sharedOnce.Do(func() {
+		var path string
+		path, sharedErr = embed.LoadOnce()
+		if sharedErr != nil {
+			return
+		}
+		shared, sharedErr = newFFI(path)
+	})
+	return shared, sharedErr
+}
+
 func newFFI(path string) (FFI *ffi, err error) {
 	lib, err := LoadLibrary(path)
 	if err != nil {
@@ -0,0 +1,61 @@
+package ginja_test
+
+import (
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestFork(assert *require.Assertions) {
+	base, err := ginja.New()
+	assert.Nil(err)
+	defer base.Close()
+	assert.Nil(base.AddGlobal("site", "Base"))
+	assert.Nil(base.AddTemplate("layout", "{{ site }}: {% block body %}{% endblock %}"))
+	assert.Nil(base.AddTemplate("page", `{% extends "layout" %}{% block body %}{{ title }}{% endblock %}`))
+
+	tenant, err := base.Fork()
+	assert.Nil(err)
+	defer tenant.Close()
+
+	data := map[string]any{"title": "Home"}
+	result, err := tenant.RenderTemplate("page", data)
+	assert.Nil(err)
+	assert.Equal("Base: Home", result)
+
+	// Overrides of the tenant stay with the tenant
+	assert.Nil(tenant.AddGlobal("site", "Tenant"))
+	assert.Nil(tenant.AddTemplate("layout", "[{{ site }}] {% block body %}{% endblock %}"))
+
+	result, err = tenant.RenderTemplate("page", data)
+	assert.Nil(err)
+	assert.Equal("[Tenant] Home", result)
+
+	result, err = base.RenderTemplate("page", data)
+	assert.Nil(err)
+	assert.Equal("Base: Home", result)
+
+	// Changes to the base after the fork are not visible to the tenant
+	assert.Nil(base.Update(func(txn *ginja.Txn) error {
+		return txn.RemoveTemplate("page")
+	}))
+	_, err = base.RenderTemplate("page", data)
+	assert.NotNil(err)
+	result, err = tenant.RenderTemplate("page", data)
+	assert.Nil(err)
+	assert.Equal("[Tenant] Home", result)
+}
+
+func (s *Suite) TestNewSharesLibrary(assert *require.Assertions) {
+	// Closing an environment must not unload the library for the others
+	env, err := ginja.New()
+	assert.Nil(err)
+	env.Close()
+
+	env, err = ginja.New()
+	assert.Nil(err)
+	defer env.Close()
+	assert.Nil(env.AddTemplate("shared", "Hello {{ name }}!"))
+	result, err := env.RenderTemplate("shared", map[string]any{"name": "World"})
+	assert.Nil(err)
+	assert.Equal("Hello World!", result)
+}
@@ -0,0 +1,32 @@
+package ginja_test
+
+import (
+	"github.com/stretchr/testify/require"
+)
+
+func (s *Suite) TestGlobals(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddGlobal("global_nav", []map[string]any{
+		{"title": "Home"},
+		{"title": "About"},
+	}))
+	assert.Nil(env.AddGlobal("global_site", "Example"))
+	assert.Nil(env.AddTemplate("globals_template",
+		"{{ global_site }}:{% for item in global_nav %} {{ item.title }}{% endfor %}"))
+
+	result, err := env.RenderTemplate("globals_template", map[string]any{})
+	assert.Nil(err)
+	assert.Equal("Example: Home About", result)
+
+	result, err = env.RenderTemplate("globals_template", map[string]any{
+		"global_site": "Other",
+	})
+	assert.Nil(err)
+	assert.Equal("Other: Home About", result)
+
+	assert.Nil(env.RemoveGlobal("global_nav"))
+	result, err = env.RenderTemplate("globals_template", map[string]any{})
+	assert.Nil(err)
+	assert.Equal("Example:", result)
+}
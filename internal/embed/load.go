@@ -1,30 +1,212 @@
 package embed
 
 import (
-	"bytes"
+	"crypto/sha256"
+	"encoding/hex"
 	"fmt"
 	"io"
 	"os"
+	"path/filepath"
+	"strings"
 	"sync"
+	"sync/atomic"
+	"time"
 
 	"github.com/klauspost/compress/zstd"
 )
 
+// Source tells where the native library was loaded from.
+type Source int
+
+const (
+	// SourceCache is a copy in the persistent cache directory, reused
+	// without decompressing the embedded library.
+	SourceCache Source = iota + 1
+	// SourceCacheWrite is a copy that was decompressed into the cache
+	// directory by this process.
+	SourceCacheWrite
+	// SourceMemfd is an anonymous in-memory file, used on Linux when the
+	// cache directory is not writable.
+	SourceMemfd
+	// SourceTemp is a temporary file, used when no other source works.
+	SourceTemp
+)
+
+func (s Source) String() string {
+	switch s {
+	case SourceCache:
+		return "cache"
+	case SourceCacheWrite:
+		return "cache-write"
+	case SourceMemfd:
+		return "memfd"
+	case SourceTemp:
+		return "temp"
+	}
+	return "unknown"
+}
+
+// Info describes how the native library was made available.
+type Info struct {
+	Path     string
+	Source   Source
+	Duration time.Duration
+}
+
+// CacheDirEnv overrides the directory the native library is cached in.
+const CacheDirEnv = "GINJA_CACHE_DIR"
+
 var once = &sync.Once{}
 
-var path string
+var (
+	loaded  atomic.Pointer[Info]
+	loadErr error
+)
 
+// LoadOnce makes the embedded library available as a file and returns its
+// path. Only the first call does any work.
+//
+// The library is cached under a path keyed by the hash of the embedded
+// data, next to the hash of its content, so later processes reuse it
+// without decompressing anything once the content checks out. When
+// the cache cannot be written, the library is decompressed into memory
+// instead: an anonymous memfd on Linux, a temporary file elsewhere.
 func LoadOnce() (string, error) {
-	var err error
 	once.Do(func() {
-		var data []byte
-		data, err = decompressLib(libminijinjaZst)
+		start := time.Now()
+		var info Info
+		info, loadErr = load()
+		info.Duration = time.Since(start)
+		loaded.Store(&info)
+	})
+	return loaded.Load().Path, loadErr
+}
+
+// Stats returns how the library was loaded by LoadOnce, or the zero Info
+// if it was not loaded yet.
+func Stats() Info {
+	if info := loaded.Load(); info != nil {
+		return *info
+	}
+	return Info{}
+}
+
+func load() (info Info, err error) {
+	var header zstd.Header
+	if err = header.Decode(libminijinjaZst); err != nil {
+		err = fmt.Errorf("cannot decode zstd header: %s", err)
+		return
+	}
+	dir := cacheDir()
+	if dir != "" && header.HasFCS {
+		info.Path = filepath.Join(dir, cacheName())
+		if verifyCache(info.Path, header.FrameContentSize) {
+			info.Source = SourceCache
+			return info, nil
+		}
+	}
+
+	data, err := decompressLib(libminijinjaZst, header.FrameContentSize)
+	if err != nil {
+		return
+	}
+	if info.Path != "" && writeCache(info.Path, data) == nil {
+		info.Source = SourceCacheWrite
+		return
+	}
+	if info.Path, err = openMemfd(data); err == nil {
+		info.Source = SourceMemfd
+		return
+	}
+	info.Path, err = writeTempExec(pattern, data)
+	info.Source = SourceTemp
+	return
+}
+
+func cacheDir() string {
+	if dir := os.Getenv(CacheDirEnv); dir != "" {
+		return dir
+	}
+	dir, err := os.UserCacheDir()
+	if err != nil {
+		return ""
+	}
+	return filepath.Join(dir, "ginja")
+}
+
+// cacheName derives the file name of the cached library from the embedded
+// data, so that a new build never picks up the library of an older one.
+func cacheName() string {
+	sum := sha256.Sum256(libminijinjaZst)
+	return strings.Replace(pattern, "*", "-"+hex.EncodeToString(sum[:16]), 1)
+}
+
+// hashSuffix is appended to the path of the cached library to name the
+// file holding the hex SHA-256 of its content.
+const hashSuffix = ".sha256"
+
+// verifyCache reports whether the library cached at path is intact: it has
+// the size recorded in the frame header, and its content hashes to the sum
+// recorded next to it when it was written. A library that was truncated or
+// altered since is decompressed and written again.
+func verifyCache(path string, size uint64) bool {
+	want, err := os.ReadFile(path + hashSuffix)
+	if err != nil {
+		return false
+	}
+	f, err := os.Open(path)
+	if err != nil {
+		return false
+	}
+	defer f.Close()
+	if st, err := f.Stat(); err != nil || uint64(st.Size()) != size {
+		return false
+	}
+	h := sha256.New()
+	if _, err = io.Copy(h, f); err != nil {
+		return false
+	}
+	return hex.EncodeToString(h.Sum(nil)) == strings.TrimSpace(string(want))
+}
+
+// writeCache publishes data at path, and the hash of data next to it, each
+// through a rename, so that concurrent processes never load a partially
+// written library. The hash goes first, so a library is never published
+// without one.
+func writeCache(path string, data []byte) (err error) {
+	if err = os.MkdirAll(filepath.Dir(path), 0o755); err != nil {
+		return
+	}
+	sum := sha256.Sum256(data)
+	if err = publish(path+hashSuffix, []byte(hex.EncodeToString(sum[:])), 0o644); err != nil {
+		return
+	}
+	return publish(path, data, 0o755)
+}
+
+// publish writes data to a temporary file next to path and renames it to
+// path.
+func publish(path string, data []byte, mode os.FileMode) (err error) {
+	f, err := os.CreateTemp(filepath.Dir(path), pattern)
+	if err != nil {
+		return
+	}
+	defer func() {
 		if err != nil {
-			return
+			os.Remove(f.Name())
 		}
-		path, err = writeTempExec(pattern, data)
-	})
-	return path, err
+	}()
+	_, err = f.Write(data)
+	if cerr := f.Close(); err == nil {
+		err = cerr
+	}
+	if err != nil {
+		return
+	}
+	if err = os.Chmod(f.Name(), mode); err != nil {
+		return
+	}
+	return os.Rename(f.Name(), path)
 }
 
 func writeTempExec(pattern string, binary []byte) (path string, err error) {
@@ -48,14 +230,16 @@ func writeTempExec(pattern string, binary []byte) (path string, err error) {
 	return
 }
 
-func decompressLib(raw []byte) (data []byte, err error) {
-	decoder, err := zstd.NewReader(bytes.NewReader(raw))
+// decompressLib decodes raw in a single pass into a buffer of size bytes,
+// the content size recorded in the frame header if there is one.
+func decompressLib(raw []byte, size uint64) (data []byte, err error) {
+	decoder, err := zstd.NewReader(nil)
 	if err != nil {
 		err = fmt.Errorf("cannot create zstd reader: %s", err)
 		return
 	}
 	defer decoder.Close()
-	data, err = io.ReadAll(decoder)
+	data, err = decoder.DecodeAll(raw, make([]byte, 0, size))
 	if err != nil {
 		err = fmt.Errorf("cannot reading decompressed data: %s", err)
 	}
@@ -0,0 +1,31 @@
+package embed
+
+import (
+	"fmt"
+	"os"
+
+	"golang.org/x/sys/unix"
+)
+
+// openMemfd copies data into an anonymous in-memory file and returns a path
+// that the dynamic loader can open. The file lives as long as the process.
+func openMemfd(data []byte) (path string, err error) {
+	fd, err := unix.MemfdCreate("libminijinja_c", unix.MFD_CLOEXEC)
+	if err != nil {
+		err = fmt.Errorf("cannot create memfd: %s", err)
+		return
+	}
+	f := os.NewFile(uintptr(fd), "libminijinja_c")
+	if _, err = f.Write(data); err != nil {
+		f.Close()
+		err = fmt.Errorf("cannot write binary: %s", err)
+		return
+	}
+	memfd = f
+	path = fmt.Sprintf("/proc/self/fd/%d", fd)
+	return
+}
+
+// memfd keeps the in-memory file open, and reachable through its path, for
+// the lifetime of the process.
+var memfd *os.File
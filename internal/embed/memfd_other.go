@@ -0,0 +1,9 @@
+//go:build !linux
+
+package embed
+
+import "errors"
+
+func openMemfd(data []byte) (string, error) {
+	return "", errors.New("memfd is not supported on this platform")
+}
@@ -0,0 +1,19 @@
+package ginja
+
+// SetLazyContext sets whether the contexts of renders are decoded lazily.
+// By default, the marshaled context is parsed into a complete tree of
+// values before rendering. In lazy mode, it is only validated, and each
+// object and array of it is indexed and decoded when a template first
+// reads from it, which saves most of the parsing of large contexts that
+// templates only read a few fields of.
+//
+// Lazy mode applies to every render of the Environment, including batches
+// and queued renders. A Template keeps the mode the Environment had when
+// it was looked up. Globals, macro arguments, expression contexts and
+// NewValue always decode eagerly.
+//
+// Templates that read most of their context render faster with lazy mode
+// disabled, which is the default.
+func (env *Environment) SetLazyContext(enabled bool) {
+	env.ffi.MjEnvSetLazyContext(env.inner, enabled)
+}
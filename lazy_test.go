@@ -0,0 +1,31 @@
+package ginja_test
+
+import (
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestLazyContext(assert *require.Assertions) {
+	env, err := ginja.New()
+	assert.Nil(err)
+	defer env.Close()
+
+	assert.Nil(env.AddTemplate("lazy", `{{ user.name }}: {% for tag in user.tags %}{{ tag }},{% endfor %} {% for k in m %}{{ k }}={{ m[k] }};{% endfor %}`))
+	ctx := map[string]any{
+		"user": map[string]any{
+			"name": `Tom "<3"`,
+			"tags": []string{"a", "b"},
+		},
+		"m":      map[string]any{"b": 2, "a": 1},
+		"unused": []any{1, "x", map[string]any{"y": nil}},
+	}
+
+	eager, err := env.RenderTemplate("lazy", ctx)
+	assert.Nil(err)
+	assert.Equal(`Tom "<3": a,b, a=1;b=2;`, eager)
+
+	env.SetLazyContext(true)
+	lazy, err := env.RenderTemplate("lazy", ctx)
+	assert.Nil(err)
+	assert.Equal(eager, lazy)
+}
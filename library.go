@@ -0,0 +1,38 @@
+package ginja
+
+import (
+	"time"
+
+	"go.yuchanns.xyz/ginja/internal/embed"
+)
+
+// LibraryInfo describes how the embedded native library was made available
+// to the process.
+type LibraryInfo struct {
+	// Path the library was loaded from.
+	Path string
+	// Source is one of "cache", when a copy cached by an earlier process
+	// was reused, "cache-write", when this process decompressed it into
+	// the cache, "memfd" or "temp".
+	Source string
+	// LoadTime is the time spent on making the library available, not
+	// including loading it into the process.
+	LoadTime time.Duration
+}
+
+// Library reports how the native library was loaded. It returns the zero
+// LibraryInfo until the first Environment was created.
+//
+// The library is cached in the directory named by the GINJA_CACHE_DIR
+// environment variable, or in a ginja directory under os.UserCacheDir.
+func Library() (info LibraryInfo) {
+	stats := embed.Stats()
+	if stats.Source == 0 {
+		return
+	}
+	return LibraryInfo{
+		Path:     stats.Path,
+		Source:   stats.Source.String(),
+		LoadTime: stats.Duration,
+	}
+}
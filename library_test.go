@@ -0,0 +1,18 @@
+package ginja_test
+
+import (
+	"os"
+
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestLibrary(assert *require.Assertions) {
+	info := ginja.Library()
+	assert.Contains([]string{"cache", "cache-write", "memfd", "temp"}, info.Source)
+	assert.NotEmpty(info.Path)
+	assert.Positive(info.LoadTime)
+
+	_, err := os.Stat(info.Path)
+	assert.Nil(err)
+}
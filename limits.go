@@ -0,0 +1,96 @@
+package ginja
+
+import (
+	"context"
+	"math"
+	"time"
+)
+
+// Limits bounds a single render, overriding the limits of the Environment.
+// A zero field keeps the limit of the Environment.
+type Limits struct {
+	// Fuel is the number of instructions the render may execute, or
+	// math.MaxUint64 for no limit.
+	Fuel uint64
+	// Timeout is the wall-clock time the render may take, or a negative
+	// duration for no limit.
+	Timeout time.Duration
+}
+
+func (l Limits) native() mjRenderLimits {
+	limits := mjRenderLimits{fuel: l.Fuel}
+	switch {
+	case l.Timeout < 0:
+		limits.timeoutNs = math.MaxUint64
+	case l.Timeout > 0:
+		limits.timeoutNs = uint64(l.Timeout)
+	}
+	return limits
+}
+
+// SetFuel limits the number of instructions every render may execute.
+// A render that runs out of fuel fails with CodeOutOfFuel. Zero, the
+// default, removes the limit.
+//
+// Fuel bounds templates that loop for too long, such as nested loops over
+// a large context, whether they produce output or not.
+func (env *Environment) SetFuel(fuel uint64) {
+	env.ffi.MjEnvSetFuel(env.inner, fuel)
+}
+
+// SetTimeout limits the wall-clock time of every render of the Environment
+// and of every expression evaluation. A render still running when the
+// timeout elapses fails with CodeDeadlineExceeded. Zero, the default,
+// removes the limit. Templates and expressions keep the timeout the
+// Environment had when they were looked up or compiled.
+//
+// The deadline is checked whenever the template prints a value, including
+// into blocks and macro calls, and as it writes output. Only fuel bounds
+// the time of a loop that prints nothing, such as an accidental quadratic
+// loop, so use SetFuel along with SetTimeout to stop those too.
+func (env *Environment) SetTimeout(timeout time.Duration) {
+	env.ffi.MjEnvSetTimeout(env.inner, uint64(max(timeout, 0)))
+}
+
+// RenderTemplateWithLimits renders the template like RenderTemplate, with
+// the fuel and timeout of limits in place of those of the Environment.
+//
+// Overriding the fuel renders a copy of the Environment, made on the first
+// render with that fuel after each change and kept for the last four fuel
+// values, so stick to a few distinct values.
+func (env *Environment) RenderTemplateWithLimits(name string, ctx map[string]any, limits Limits) (rendered string, err error) {
+	value, err := env.marshal(name, ctx)
+	if err != nil {
+		return
+	}
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return
+	}
+	native := limits.native()
+	ret := env.ffi.MjEnvRenderWithLimits(env.inner, nptr, &value[0], uint(len(value)), &native)
+	return takeRenderResult(env.ffi, ret)
+}
+
+// RenderTemplateContext renders the template like RenderTemplate, bounded
+// by the deadline of c, if it has one. A render that runs past the deadline
+// fails with an error matching context.DeadlineExceeded.
+//
+// The render itself cannot be interrupted on cancellation; c is only
+// checked before it starts. The deadline is checked like that of
+// SetTimeout, so only fuel bounds the time of a loop that prints nothing.
+func (env *Environment) RenderTemplateContext(c context.Context, name string, ctx map[string]any) (rendered string, err error) {
+	if err = c.Err(); err != nil {
+		return
+	}
+	deadline, ok := c.Deadline()
+	if !ok {
+		return env.RenderTemplate(name, ctx)
+	}
+	timeout := time.Until(deadline)
+	if timeout <= 0 {
+		err = context.DeadlineExceeded
+		return
+	}
+	return env.RenderTemplateWithLimits(name, ctx, Limits{Timeout: timeout})
+}
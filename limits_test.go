@@ -0,0 +1,63 @@
+package ginja_test
+
+import (
+	"context"
+	"math"
+	"strings"
+	"time"
+
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestRenderFuel(assert *require.Assertions) {
+	env, err := ginja.New()
+	assert.Nil(err)
+	defer env.Close()
+	assert.Nil(env.AddTemplate("loop", "{% for i in range(n) %}{% for j in range(n) %}.{% endfor %}{% endfor %}"))
+	env.SetFuel(1000)
+
+	result, err := env.RenderTemplate("loop", map[string]any{"n": 2})
+	assert.Nil(err)
+	assert.Equal("....", result)
+
+	_, err = env.RenderTemplate("loop", map[string]any{"n": 100})
+	var e *ginja.Error
+	assert.ErrorAs(err, &e)
+	assert.Equal(ginja.CodeOutOfFuel, e.Code())
+
+	result, err = env.RenderTemplateWithLimits("loop", map[string]any{"n": 100}, ginja.Limits{Fuel: math.MaxUint64})
+	assert.Nil(err)
+	assert.Equal(strings.Repeat(".", 10000), result)
+}
+
+func (s *Suite) TestRenderDeadline(assert *require.Assertions) {
+	env, err := ginja.New()
+	assert.Nil(err)
+	defer env.Close()
+	assert.Nil(env.AddTemplate("loop", "{% for i in range(n) %}{% for j in range(n) %}{{ j }}{% endfor %}{% endfor %}"))
+
+	env.SetTimeout(time.Nanosecond)
+	_, err = env.RenderTemplate("loop", map[string]any{"n": 1000})
+	var e *ginja.Error
+	assert.ErrorAs(err, &e)
+	assert.Equal(ginja.CodeDeadlineExceeded, e.Code())
+	assert.ErrorIs(err, context.DeadlineExceeded)
+
+	result, err := env.RenderTemplateWithLimits("loop", map[string]any{"n": 3}, ginja.Limits{Timeout: -1})
+	assert.Nil(err)
+	assert.Equal("012012012", result)
+	env.SetTimeout(0)
+
+	ctx, cancel := context.WithTimeout(context.Background(), time.Minute)
+	defer cancel()
+	result, err = env.RenderTemplateContext(ctx, "loop", map[string]any{"n": 3})
+	assert.Nil(err)
+	assert.Equal("012012012", result)
+
+	ctx, cancel = context.WithTimeout(context.Background(), time.Nanosecond)
+	defer cancel()
+	time.Sleep(time.Millisecond)
+	_, err = env.RenderTemplateContext(ctx, "loop", map[string]any{"n": 1000})
+	assert.ErrorIs(err, context.DeadlineExceeded)
+}
@@ -0,0 +1,78 @@
+package ginja_test
+
+import (
+	"os"
+	"path/filepath"
+
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func writeTemplates(dir string, templates map[string]string) error {
+	for name, source := range templates {
+		path := filepath.Join(dir, filepath.FromSlash(name))
+		if err := os.MkdirAll(filepath.Dir(path), 0o755); err != nil {
+			return err
+		}
+		if err := os.WriteFile(path, []byte(source), 0o644); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+func (s *Suite) TestTemplateDir(assert *require.Assertions) {
+	dir, err := os.MkdirTemp("", "ginja-loader")
+	assert.Nil(err)
+	defer os.RemoveAll(dir)
+	assert.Nil(writeTemplates(dir, map[string]string{
+		"hello.txt":        "Hello {{ name }}!",
+		"layout/base.html": "<title>{% block title %}{% endblock %}</title>",
+		"page.html":        `{% extends "layout/base.html" %}{% block title %}{{ title }}{% endblock %}`,
+	}))
+
+	env, err := ginja.New(ginja.WithTemplateDir(dir))
+	assert.Nil(err)
+	defer env.Close()
+
+	result, err := env.RenderTemplate("hello.txt", map[string]any{"name": "World"})
+	assert.Nil(err)
+	assert.Equal("Hello World!", result)
+
+	result, err = env.RenderTemplate("page.html", map[string]any{"title": "Home"})
+	assert.Nil(err)
+	assert.Equal("<title>Home</title>", result)
+
+	_, err = env.RenderTemplate("missing.txt", map[string]any{})
+	var e *ginja.Error
+	assert.ErrorAs(err, &e)
+	assert.Equal(ginja.CodeTemplateNotFound, e.Code())
+}
+
+func (s *Suite) TestTemplateDirSearchOrder(assert *require.Assertions) {
+	override, err := os.MkdirTemp("", "ginja-loader-override")
+	assert.Nil(err)
+	defer os.RemoveAll(override)
+	base, err := os.MkdirTemp("", "ginja-loader-base")
+	assert.Nil(err)
+	defer os.RemoveAll(base)
+	assert.Nil(writeTemplates(override, map[string]string{
+		"hello.txt": "Hi {{ name }}!",
+	}))
+	assert.Nil(writeTemplates(base, map[string]string{
+		"hello.txt": "Hello {{ name }}!",
+		"bye.txt":   "Bye {{ name }}!",
+	}))
+
+	env, err := ginja.New(ginja.WithTemplateDir(override), ginja.WithTemplateDir(base))
+	assert.Nil(err)
+	defer env.Close()
+
+	result, err := env.RenderTemplate("hello.txt", map[string]any{"name": "World"})
+	assert.Nil(err)
+	assert.Equal("Hi World!", result)
+
+	result, err = env.RenderTemplate("bye.txt", map[string]any{"name": "World"})
+	assert.Nil(err)
+	assert.Equal("Bye World!", result)
+}
@@ -0,0 +1,54 @@
+package ginja
+
+// Option configures an Environment created by New.
+type Option func(o *options)
+
+type options struct {
+	templateDirs []string
+	bundles      []string
+	contrib      bool
+	pruned       bool
+}
+
+// WithTemplateDir makes the Environment load templates that were not added
+// explicitly from dir, the first time they are rendered or included.
+// Template names are paths relative to dir, using '/' as separator.
+//
+// The option may be given several times; directories are searched in the
+// order they were given.
+func WithTemplateDir(dir string) Option {
+	return func(o *options) {
+		o.templateDirs = append(o.templateDirs, dir)
+	}
+}
+
+// WithBundle makes the Environment load every template of the bundle file
+// at path, as written by WriteBundle. New fails with the compile errors of
+// all templates if any of them does not compile.
+//
+// See Environment.LoadBundle for details.
+func WithBundle(path string) Option {
+	return func(o *options) {
+		o.bundles = append(o.bundles, path)
+	}
+}
+
+// WithContrib adds the native formatting filters and functions to the
+// Environment.
+//
+// See Environment.AddContrib for details.
+func WithContrib() Option {
+	return func(o *options) {
+		o.contrib = true
+	}
+}
+
+// WithContextPruning makes RenderTemplate only encode the parts of a
+// context that the template reads.
+//
+// See Environment.SetContextPruning for details.
+func WithContextPruning() Option {
+	return func(o *options) {
+		o.pruned = true
+	}
+}
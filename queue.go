@@ -0,0 +1,192 @@
+package ginja
+
+import (
+	"errors"
+	"sync"
+	"sync/atomic"
+	"unsafe"
+)
+
+// ErrQueueClosed is returned when submitting to a Queue that is closed.
+var ErrQueueClosed = errors.New("ginja: queue is closed")
+
+// ErrQueueFull is returned when the native queue has no room for a render
+// submitted to a Queue.
+var ErrQueueFull = errors.New("ginja: queue is full")
+
+// Queue renders templates in the background on a native worker pool.
+//
+// Submitting a render only copies its name and context and returns a
+// channel, so the submitting goroutine neither waits for the render nor
+// holds an OS thread while it runs. Completions are published to a ring in
+// native memory, which a single goroutine of the queue drains without
+// calling into the library, waking up on an eventfd (a pipe on other Unix
+// systems) through the Go netpoller.
+type Queue struct {
+	ffi *ffi
+	env *Environment
+
+	inner  unsafe.Pointer
+	ring   *mjCompletionRing
+	waiter *waiter
+
+	// Holds a token for every render that has been submitted but whose
+	// slot in the ring has not been freed yet.
+	slots chan struct{}
+
+	mu       sync.Mutex
+	closed   bool
+	nextID   uint64
+	pending  map[uint64]chan RenderResult
+	inflight sync.WaitGroup
+	stopped  chan struct{}
+}
+
+// NewQueue starts a queue of background renders on the environment with
+// room for capacity renders in flight, rounded up to a power of two, and
+// the given number of worker threads, or one per CPU core if workers is 0.
+//
+// The queue must be closed before the Environment.
+func (env *Environment) NewQueue(capacity, workers int) (q *Queue, err error) {
+	ret := env.ffi.MjEnvQueueNew(env.inner, uint(max(capacity, 1)), uint(max(workers, 0)))
+	if ret == nil {
+		err = errors.New("ginja: cannot start queue workers")
+		return
+	}
+	native := (*mjQueue)(ret)
+	w, err := newWaiter(native.notifyFd)
+	if err != nil {
+		env.ffi.MjQueueFree(ret)
+		return
+	}
+	q = &Queue{
+		ffi:     env.ffi,
+		env:     env,
+		inner:   ret,
+		ring:    native.ring,
+		waiter:  w,
+		slots:   make(chan struct{}, native.ring.capacity),
+		pending: make(map[uint64]chan RenderResult),
+		stopped: make(chan struct{}),
+	}
+	go q.dispatch()
+	return
+}
+
+// Submit submits a render of the named template with ctx and returns a
+// channel that receives its result once. It blocks while as many renders
+// as the queue has room for are in flight, and fails with ErrQueueFull if
+// the native queue refuses the render.
+//
+// The context is encoded like that of RenderTemplate, so it shares its
+// render cache entries and context pruning.
+func (q *Queue) Submit(name string, ctx map[string]any) (result <-chan RenderResult, err error) {
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return
+	}
+	value, err := q.env.marshal(name, ctx)
+	if err != nil {
+		return
+	}
+
+	q.slots <- struct{}{}
+	q.mu.Lock()
+	if q.closed {
+		q.mu.Unlock()
+		<-q.slots
+		err = ErrQueueClosed
+		return
+	}
+	id := q.nextID
+	q.nextID++
+	ch := make(chan RenderResult, 1)
+	q.pending[id] = ch
+	q.inflight.Add(1)
+	q.mu.Unlock()
+
+	// The slots channel bounds renders in flight by the capacity of the
+	// ring, so the native queue should always have room. Should it refuse
+	// the render anyway, nothing will ever be delivered under id.
+	if !q.ffi.MjQueueSubmit(q.inner, id, nptr, &value[0], uint(len(value))) {
+		q.mu.Lock()
+		delete(q.pending, id)
+		q.mu.Unlock()
+		<-q.slots
+		q.inflight.Done()
+		err = ErrQueueFull
+		return
+	}
+	result = ch
+	return
+}
+
+// RenderTemplate renders the named template with ctx on the queue and waits
+// for the result.
+func (q *Queue) RenderTemplate(name string, ctx map[string]any) (rendered string, err error) {
+	ch, err := q.Submit(name, ctx)
+	if err != nil {
+		return
+	}
+	result := <-ch
+	return result.Rendered, result.Err
+}
+
+// dispatch drains the completion ring, delivering every result to the
+// channel returned by Submit, and waits on the notifier when it is empty.
+func (q *Queue) dispatch() {
+	defer close(q.stopped)
+	ring := q.ring
+	slots := unsafe.Slice((*mjCompletion)(ring.slots), ring.capacity)
+	mask := uint64(ring.capacity - 1)
+	head := atomic.LoadUint64(&ring.head)
+	for {
+		tail := atomic.LoadUint64(&ring.tail)
+		taken := tail - head
+		for ; head < tail; head++ {
+			completion := &slots[head&mask]
+			var result RenderResult
+			result.Rendered, result.Err = takeRenderResult(q.ffi, completion.result)
+			q.mu.Lock()
+			ch := q.pending[completion.id]
+			delete(q.pending, completion.id)
+			q.mu.Unlock()
+			ch <- result
+			q.inflight.Done()
+		}
+		atomic.StoreUint64(&ring.head, head)
+		// Tokens are only returned once head is stored, since that is what
+		// frees the slots for the native queue.
+		for range taken {
+			<-q.slots
+		}
+		if taken > 0 {
+			q.waiter.woke()
+		}
+		if atomic.LoadUint64(&ring.tail) != head {
+			continue
+		}
+		if q.waiter.wait() != nil {
+			return
+		}
+	}
+}
+
+// Close waits for the renders in flight to be delivered, then stops the
+// queue and releases its workers. Submitting to a closed queue fails with
+// ErrQueueClosed.
+func (q *Queue) Close() {
+	q.mu.Lock()
+	if q.closed {
+		q.mu.Unlock()
+		return
+	}
+	q.closed = true
+	q.mu.Unlock()
+
+	q.inflight.Wait()
+	q.waiter.close()
+	<-q.stopped
+	q.ffi.MjQueueFree(q.inner)
+	q.inner = nil
+}
@@ -0,0 +1,48 @@
+package ginja_test
+
+import (
+	"fmt"
+	"sync"
+
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestQueue(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("queue_template", "Hello, {{ name }}!"))
+	queue, err := env.NewQueue(16, 4)
+	assert.Nil(err)
+
+	// Submit more renders than the queue has room for from several
+	// goroutines, so that submitting waits for slots to be freed.
+	results := make([]ginja.RenderResult, 100)
+	var wg sync.WaitGroup
+	for i := range results {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			ch, err := queue.Submit("queue_template", map[string]any{"name": fmt.Sprintf("user%d", i)})
+			if err != nil {
+				results[i].Err = err
+				return
+			}
+			results[i] = <-ch
+		}()
+	}
+	wg.Wait()
+	for i, result := range results {
+		assert.Nil(result.Err)
+		assert.Equal(fmt.Sprintf("Hello, user%d!", i), result.Rendered)
+	}
+
+	_, err = queue.RenderTemplate("queue_missing", map[string]any{})
+	var e *ginja.Error
+	assert.ErrorAs(err, &e)
+	assert.Equal(ginja.CodeTemplateNotFound, e.Code())
+
+	queue.Close()
+	_, err = queue.Submit("queue_template", map[string]any{"name": "late"})
+	assert.ErrorIs(err, ginja.ErrQueueClosed)
+}
@@ -0,0 +1,50 @@
+//go:build !windows
+
+package ginja
+
+import (
+	"errors"
+	"os"
+
+	"golang.org/x/sys/unix"
+)
+
+// waiter blocks until the notifier of a queue is signaled.
+type waiter struct {
+	file *os.File
+}
+
+// newWaiter wraps a duplicate of the notifier in an *os.File, whose reads
+// park the goroutine on the netpoller instead of blocking a thread.
+func newWaiter(fd int32) (w *waiter, err error) {
+	if fd < 0 {
+		err = errors.New("ginja: queue has no notifier")
+		return
+	}
+	dup, err := unix.FcntlInt(uintptr(fd), unix.F_DUPFD_CLOEXEC, 0)
+	if err != nil {
+		return
+	}
+	if err = unix.SetNonblock(dup, true); err != nil {
+		unix.Close(dup)
+		return
+	}
+	w = &waiter{file: os.NewFile(uintptr(dup), "mj_queue")}
+	return
+}
+
+// wait returns once the notifier is signaled, or with an error once the
+// waiter is closed.
+func (w *waiter) wait() error {
+	var buf [8]byte
+	_, err := w.file.Read(buf[:])
+	return err
+}
+
+// woke is called once completions were taken from the ring, which the
+// notifier needs no reaction to.
+func (w *waiter) woke() {}
+
+func (w *waiter) close() {
+	w.file.Close()
+}
@@ -0,0 +1,59 @@
+//go:build windows
+
+package ginja
+
+import (
+	"os"
+	"time"
+)
+
+// minPollInterval and maxPollInterval bound how often the completion ring
+// is checked without a notifier. The interval starts at the minimum after
+// every completion and doubles while the ring stays empty, so an idle
+// queue wakes up 250 times a second rather than 20,000.
+const (
+	minPollInterval = 50 * time.Microsecond
+	maxPollInterval = 4 * time.Millisecond
+)
+
+// waiter polls the completion ring of a queue, since Windows has no
+// notifier.
+type waiter struct {
+	done     chan struct{}
+	timer    *time.Timer
+	interval time.Duration
+}
+
+func newWaiter(fd int32) (w *waiter, err error) {
+	timer := time.NewTimer(maxPollInterval)
+	timer.Stop()
+	w = &waiter{
+		done:     make(chan struct{}),
+		timer:    timer,
+		interval: minPollInterval,
+	}
+	return
+}
+
+// wait returns after the poll interval, or with an error once the waiter
+// is closed.
+func (w *waiter) wait() error {
+	w.timer.Reset(w.interval)
+	w.interval = min(w.interval*2, maxPollInterval)
+	select {
+	case <-w.done:
+		w.timer.Stop()
+		return os.ErrClosed
+	case <-w.timer.C:
+		return nil
+	}
+}
+
+// woke resets the poll interval once completions were taken from the ring.
+func (w *waiter) woke() {
+	w.interval = minPollInterval
+}
+
+func (w *waiter) close() {
+	close(w.done)
+}
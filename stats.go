@@ -0,0 +1,213 @@
+package ginja
+
+import (
+	"math"
+	"math/bits"
+	"sort"
+	"sync"
+	"sync/atomic"
+	"time"
+	"unsafe"
+)
+
+// Histogram is a latency histogram with power-of-two buckets.
+type Histogram struct {
+	// Count is the number of recorded durations.
+	Count uint64
+	// Sum is the total of all recorded durations.
+	Sum time.Duration
+	// Buckets[i] counts the durations of at least 2^(i-1) and less than
+	// 2^i nanoseconds; Buckets[0] counts durations of zero.
+	Buckets [64]uint64
+}
+
+// UpperBound returns the exclusive upper bound of bucket i, for instance
+// to export the histogram with cumulative bucket boundaries.
+func (h *Histogram) UpperBound(i int) time.Duration {
+	if i >= 63 {
+		return math.MaxInt64
+	}
+	return time.Duration(1) << i
+}
+
+// TemplateStats holds the render metrics of a single template.
+//
+// A render is split into phases, each timed separately. Marshal, Call and
+// Copy are measured in Go: encoding the context, the call into the native
+// library, and copying the output into a Go string. Lookup, Parse, Render
+// and Output are measured inside the call: finding the template, parsing
+// the context, rendering, and handing the output back.
+type TemplateStats struct {
+	Name        string
+	Calls       uint64
+	Errors      map[ErrorCode]uint64
+	OutputBytes uint64
+
+	Marshal Histogram
+	Call    Histogram
+	Copy    Histogram
+
+	Lookup Histogram
+	Parse  Histogram
+	Render Histogram
+	Output Histogram
+}
+
+// SetStats enables or disables render metrics. While disabled, which is
+// the default, renders record nothing. Metrics recorded so far are kept.
+//
+// Metrics are recorded by RenderTemplate and by the native render calls
+// underneath it. Renders of templates that are not found are recorded
+// under the name "(other)", and so are the renders of names first seen
+// after 1024 others, which keeps the metrics bounded.
+func (env *Environment) SetStats(enabled bool) {
+	env.stats.enabled.Store(enabled)
+	env.ffi.MjEnvSetStats(env.inner, enabled)
+}
+
+// Stats returns a snapshot of the render metrics of every template that was
+// rendered while metrics were enabled, ordered by name.
+func (env *Environment) Stats() (stats []TemplateStats) {
+	ret := env.ffi.MjEnvStats(env.inner)
+	defer env.ffi.MjStatsFree(ret)
+	result := (*mjStats)(ret)
+	stats = make([]TemplateStats, 0, result.len)
+	for _, t := range unsafe.Slice((*mjTemplateStats)(result.templates), result.len) {
+		s := TemplateStats{
+			Name:        BytePtrToString(t.name),
+			Calls:       t.calls,
+			Errors:      make(map[ErrorCode]uint64, t.errorsLen),
+			OutputBytes: t.outputBytes,
+			Lookup:      t.lookup.histogram(),
+			Parse:       t.parse.histogram(),
+			Render:      t.render.histogram(),
+			Output:      t.output.histogram(),
+		}
+		for _, e := range unsafe.Slice((*mjErrorCount)(t.errors), t.errorsLen) {
+			s.Errors[ErrorCode(e.code)] = e.count
+		}
+		if v, ok := env.stats.templates.Load(s.Name); ok {
+			phases := v.(*phaseStats)
+			s.Marshal = phases[phaseMarshal].snapshot()
+			s.Call = phases[phaseCall].snapshot()
+			s.Copy = phases[phaseCopy].snapshot()
+		}
+		stats = append(stats, s)
+	}
+	sort.Slice(stats, func(i, j int) bool { return stats[i].Name < stats[j].Name })
+	return
+}
+
+func (h *mjHistogram) histogram() Histogram {
+	return Histogram{
+		Count:   h.count,
+		Sum:     time.Duration(h.sumNs),
+		Buckets: h.buckets,
+	}
+}
+
+const (
+	phaseMarshal = iota
+	phaseCall
+	phaseCopy
+)
+
+// The native metrics record at most maxTemplates names, and everything
+// else under otherTemplate; the Go side follows suit.
+const (
+	maxTemplates  = 1024
+	otherTemplate = "(other)"
+)
+
+// renderStats records the phases of a render that happen on the Go side.
+type renderStats struct {
+	enabled   atomic.Bool
+	templates sync.Map // string -> *phaseStats
+	names     atomic.Int64
+}
+
+type phaseStats [3]histogram
+
+type histogram struct {
+	count   atomic.Uint64
+	sum     atomic.Uint64
+	buckets [64]atomic.Uint64
+}
+
+func (h *histogram) record(d time.Duration) {
+	ns := uint64(max(d, 0))
+	h.count.Add(1)
+	h.sum.Add(ns)
+	h.buckets[min(bits.Len64(ns), 63)].Add(1)
+}
+
+func (h *histogram) snapshot() (s Histogram) {
+	s.Count = h.count.Load()
+	s.Sum = time.Duration(h.sum.Load())
+	for i := range h.buckets {
+		s.Buckets[i] = h.buckets[i].Load()
+	}
+	return
+}
+
+func (s *renderStats) phases(name string) *phaseStats {
+	v, ok := s.templates.Load(name)
+	if !ok && s.names.Load() >= maxTemplates {
+		name = otherTemplate
+		v, ok = s.templates.Load(name)
+	}
+	if !ok {
+		var loaded bool
+		v, loaded = s.templates.LoadOrStore(name, new(phaseStats))
+		if !loaded {
+			s.names.Add(1)
+		}
+	}
+	return v.(*phaseStats)
+}
+
+// recorder times the phases of a single render, and records them once the
+// render is done, so that templates that are not found get no metrics of
+// their own. The zero recorder, which start returns while metrics are
+// disabled, records nothing.
+type recorder struct {
+	stats   *renderStats
+	name    string
+	last    time.Time
+	elapsed [3]time.Duration
+	marked  [3]bool
+}
+
+func (s *renderStats) start(name string) recorder {
+	if !s.enabled.Load() {
+		return recorder{}
+	}
+	return recorder{stats: s, name: name, last: time.Now()}
+}
+
+func (r *recorder) mark(phase int) {
+	if r.stats == nil {
+		return
+	}
+	now := time.Now()
+	r.elapsed[phase] = now.Sub(r.last)
+	r.marked[phase] = true
+	r.last = now
+}
+
+// done records the phases marked so far for a render that ended with err.
+func (r *recorder) done(err error) {
+	if r.stats == nil {
+		return
+	}
+	name := r.name
+	if e, ok := err.(*Error); ok && e.Code() == CodeTemplateNotFound {
+		name = otherTemplate
+	}
+	phases := r.stats.phases(name)
+	for phase, marked := range r.marked {
+		if marked {
+			phases[phase].record(r.elapsed[phase])
+		}
+	}
+}
@@ -0,0 +1,56 @@
+package ginja_test
+
+import (
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestStats(assert *require.Assertions) {
+	env, err := ginja.New()
+	assert.Nil(err)
+	defer env.Close()
+	assert.Nil(env.AddTemplate("stats", "Hello {{ name }}!"))
+
+	// Nothing is recorded until metrics are enabled
+	_, err = env.RenderTemplate("stats", map[string]any{"name": "World"})
+	assert.Nil(err)
+	assert.Empty(env.Stats())
+
+	env.SetStats(true)
+	for range 3 {
+		_, err = env.RenderTemplate("stats", map[string]any{"name": "World"})
+		assert.Nil(err)
+	}
+	_, err = env.RenderTemplate("missing", map[string]any{})
+	assert.NotNil(err)
+
+	stats := env.Stats()
+	assert.Len(stats, 2)
+	other, hello := stats[0], stats[1]
+
+	assert.Equal("stats", hello.Name)
+	assert.Equal(uint64(3), hello.Calls)
+	assert.Empty(hello.Errors)
+	assert.Equal(uint64(3*len("Hello World!")), hello.OutputBytes)
+	for _, h := range []ginja.Histogram{hello.Marshal, hello.Call, hello.Copy, hello.Lookup, hello.Parse, hello.Render, hello.Output} {
+		assert.Equal(uint64(3), h.Count)
+		var total uint64
+		for _, n := range h.Buckets {
+			total += n
+		}
+		assert.Equal(h.Count, total)
+	}
+	assert.GreaterOrEqual(hello.Call.Sum, hello.Render.Sum)
+
+	// Templates that are not found share a single entry
+	assert.Equal("(other)", other.Name)
+	assert.Equal(uint64(1), other.Calls)
+	assert.Equal(map[ginja.ErrorCode]uint64{ginja.CodeTemplateNotFound: 1}, other.Errors)
+	assert.Equal(uint64(1), other.Call.Count)
+
+	// Recorded metrics are kept once disabled
+	env.SetStats(false)
+	_, err = env.RenderTemplate("stats", map[string]any{"name": "World"})
+	assert.Nil(err)
+	assert.Equal(uint64(3), env.Stats()[1].Calls)
+}
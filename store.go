@@ -0,0 +1,78 @@
+package ginja
+
+// TemplateMemory is the memory taken by a template added to an Environment.
+type TemplateMemory struct {
+	// Resident is false while the compiled template is evicted.
+	Resident bool
+	// CompiledBytes estimates the size of the compiled template, 0 while
+	// it is evicted.
+	CompiledBytes int
+	// SourceBytes is the length of the source.
+	SourceBytes int
+	// StoredBytes is what is kept to compile the template again, 0 until
+	// it is first evicted.
+	StoredBytes int
+}
+
+// TemplateStoreStats holds the counters of the templates added to an
+// Environment.
+type TemplateStoreStats struct {
+	Evictions     uint64
+	Recompiles    uint64
+	Templates     int
+	Resident      int
+	CompiledBytes int
+	StoredBytes   int
+	Budget        int
+}
+
+// SetTemplateBudget limits the estimated size of the compiled templates
+// added with AddTemplate or a transaction to budget bytes, or lifts the
+// limit if budget is 0.
+//
+// Above the budget, the least recently rendered templates are evicted and
+// only keep their source, compressed with LZ4 if compress is true.
+// Rendering a template also counts as a use of the templates it includes,
+// extends or imports by a literal name. An evicted template is compiled
+// again transparently the next time it is rendered or included. Templates
+// are evicted right away when a change exceeds the budget, and in the
+// background when a render does by compiling an evicted template again.
+// Templates loaded from a search path or a bundle are not counted.
+func (env *Environment) SetTemplateBudget(budget int, compress bool) {
+	env.ffi.MjEnvSetTemplateBudget(env.inner, uint(budget), compress)
+}
+
+// TemplateMemory returns the memory taken by the named template, and false
+// if no template of that name was added.
+func (env *Environment) TemplateMemory(name string) (memory TemplateMemory, ok bool) {
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return
+	}
+	var value mjTemplateMemory
+	if !env.ffi.MjEnvTemplateMemory(env.inner, nptr, &value) {
+		return
+	}
+	return TemplateMemory{
+		Resident:      value.resident,
+		CompiledBytes: int(value.compiledBytes),
+		SourceBytes:   int(value.sourceBytes),
+		StoredBytes:   int(value.storedBytes),
+	}, true
+}
+
+// TemplateStoreStats returns the counters of the templates added to the
+// environment.
+func (env *Environment) TemplateStoreStats() TemplateStoreStats {
+	var stats mjTemplateStoreStats
+	env.ffi.MjEnvTemplateStoreStats(env.inner, &stats)
+	return TemplateStoreStats{
+		Evictions:     stats.evictions,
+		Recompiles:    stats.recompiles,
+		Templates:     int(stats.templates),
+		Resident:      int(stats.resident),
+		CompiledBytes: int(stats.compiledBytes),
+		StoredBytes:   int(stats.storedBytes),
+		Budget:        int(stats.budget),
+	}
+}
@@ -0,0 +1,50 @@
+package ginja_test
+
+import (
+	"fmt"
+
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestTemplateBudget(assert *require.Assertions) {
+	env, err := ginja.New()
+	assert.Nil(err)
+	defer env.Close()
+
+	assert.Nil(env.AddTemplate("t0", "Hello {{ name }} from t0!"))
+	memory, ok := env.TemplateMemory("t0")
+	assert.True(ok)
+	assert.True(memory.Resident)
+	assert.Equal(len("Hello {{ name }} from t0!"), memory.SourceBytes)
+	assert.Zero(memory.StoredBytes)
+	_, ok = env.TemplateMemory("missing")
+	assert.False(ok)
+
+	// Leave room for two compiled templates
+	env.SetTemplateBudget(memory.CompiledBytes*2+1, true)
+	for i := 1; i < 5; i++ {
+		assert.Nil(env.AddTemplate(fmt.Sprintf("t%d", i), fmt.Sprintf("Hello {{ name }} from t%d!", i)))
+	}
+	stats := env.TemplateStoreStats()
+	assert.Equal(5, stats.Templates)
+	assert.Equal(2, stats.Resident)
+	assert.Equal(uint64(3), stats.Evictions)
+	assert.LessOrEqual(stats.CompiledBytes, stats.Budget)
+
+	memory, ok = env.TemplateMemory("t0")
+	assert.True(ok)
+	assert.False(memory.Resident)
+	assert.Positive(memory.StoredBytes)
+
+	// Evicted templates are compiled again on render, which evicts the
+	// least recently used ones, so that each of them is compiled again
+	for i := range 5 {
+		result, err := env.RenderTemplate(fmt.Sprintf("t%d", i), map[string]any{"name": "World"})
+		assert.Nil(err)
+		assert.Equal(fmt.Sprintf("Hello World from t%d!", i), result)
+	}
+	stats = env.TemplateStoreStats()
+	assert.Equal(uint64(5), stats.Recompiles)
+	assert.LessOrEqual(stats.CompiledBytes, stats.Budget)
+}
@@ -0,0 +1,58 @@
+package ginja
+
+import (
+	"unsafe"
+
+	"github.com/bytedance/sonic"
+)
+
+// Template is a handle to a compiled template that was looked up once from
+// an Environment. Rendering it skips the name lookup, and it is safe to
+// render from multiple goroutines at once.
+//
+// A Template keeps rendering the template as it was when GetTemplate was
+// called; later changes to the Environment are not visible through it.
+type Template struct {
+	ffi *ffi
+
+	inner unsafe.Pointer
+}
+
+func (env *Environment) GetTemplate(name string) (tmpl *Template, err error) {
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return
+	}
+	ret := env.ffi.MjEnvGetTemplate(env.inner, nptr)
+	defer env.ffi.MjResultEnvGetTemplateFree(ret)
+	result := (*mjResultEnvGetTemplate)(ret)
+	if result.error != nil {
+		err = takeError(env.ffi, &result.error)
+		return
+	}
+	tmpl = &Template{
+		ffi:   env.ffi,
+		inner: result.template,
+	}
+	return
+}
+
+func (tmpl *Template) Render(ctx map[string]any) (rendered string, err error) {
+	value, err := sonic.Marshal(ctx)
+	if err != nil {
+		return
+	}
+	ret := tmpl.ffi.MjTemplateRender(tmpl.inner, &value[0], uint(len(value)))
+	return takeRenderResult(tmpl.ffi, ret)
+}
+
+// Close releases the template handle. The handle keeps the compiled
+// template alive on its own, so it may be closed before or after the
+// Environment it was obtained from, but must not be rendered once closed.
+func (tmpl *Template) Close() {
+	if tmpl.inner == nil {
+		return
+	}
+	tmpl.ffi.MjTemplateFree(tmpl.inner)
+	tmpl.inner = nil
+}
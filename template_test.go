@@ -0,0 +1,74 @@
+package ginja_test
+
+import (
+	"fmt"
+	"sync"
+
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestTemplateRender(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("handle_template", "Hello, {{ name }}!"))
+	tmpl, err := env.GetTemplate("handle_template")
+	assert.Nil(err)
+	defer tmpl.Close()
+
+	result, err := tmpl.Render(map[string]any{
+		"name": "World",
+	})
+	assert.Nil(err)
+	assert.Equal("Hello, World!", result)
+
+	result, err = tmpl.Render(map[string]any{
+		"name": "Alice",
+	})
+	assert.Nil(err)
+	assert.Equal("Hello, Alice!", result)
+}
+
+func (s *Suite) TestTemplateNotFound(assert *require.Assertions) {
+	env := s.env
+
+	tmpl, err := env.GetTemplate("handle_template_missing")
+	assert.Nil(tmpl)
+	var e *ginja.Error
+	assert.ErrorAs(err, &e)
+	assert.Equal(ginja.CodeTemplateNotFound, e.Code())
+}
+
+func (s *Suite) TestTemplateConcurrentRender(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("handle_concurrent_template", "{{ n }}"))
+	tmpl, err := env.GetTemplate("handle_concurrent_template")
+	assert.Nil(err)
+	defer tmpl.Close()
+
+	var wg sync.WaitGroup
+	errs := make([]error, 8)
+	for g := range 8 {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for i := range 100 {
+				n := g*100 + i
+				result, err := tmpl.Render(map[string]any{"n": n})
+				if err != nil {
+					errs[g] = err
+					return
+				}
+				if result != fmt.Sprint(n) {
+					errs[g] = fmt.Errorf("unexpected result %q for %d", result, n)
+					return
+				}
+			}
+		}()
+	}
+	wg.Wait()
+	for _, err := range errs {
+		assert.Nil(err)
+	}
+}
@@ -0,0 +1,120 @@
+package ginja
+
+import (
+	"unsafe"
+
+	"github.com/bytedance/sonic"
+)
+
+// Txn is a bulk update of an Environment. Its changes are applied to a
+// private copy of the environment and become visible to renders all at
+// once on Commit, so swapping many templates costs a single publish.
+//
+// Renders are never blocked by a Txn. Other writers, including the
+// single-call methods such as Environment.AddTemplate, wait until the Txn
+// is committed or aborted, so they must not be called while holding it.
+type Txn struct {
+	ffi *ffi
+
+	inner unsafe.Pointer
+}
+
+// Begin starts a transaction, waiting for any other writer to finish.
+// The returned Txn must be finished with either Commit or Abort.
+func (env *Environment) Begin() *Txn {
+	return &Txn{
+		ffi:   env.ffi,
+		inner: env.ffi.MjEnvBeginTxn(env.inner),
+	}
+}
+
+// Update runs fn in a transaction, which is committed if fn returns nil and
+// aborted otherwise.
+func (env *Environment) Update(fn func(txn *Txn) error) (err error) {
+	txn := env.Begin()
+	// A no-op once committed, and aborts when fn fails or panics.
+	defer txn.Abort()
+	if err = fn(txn); err != nil {
+		return
+	}
+	txn.Commit()
+	return
+}
+
+// AddTemplate adds a template to the transaction. A template that fails to
+// compile is not added, but the transaction stays usable.
+func (txn *Txn) AddTemplate(name string, source string) (err error) {
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return
+	}
+	sptr, err := BytePtrFromString(source)
+	if err != nil {
+		return
+	}
+
+	ret := txn.ffi.MjTxnAddTemplate(txn.inner, nptr, sptr)
+	if ret != nil {
+		err = parseError(txn.ffi, ret)
+	}
+
+	return
+}
+
+func (txn *Txn) RemoveTemplate(name string) (err error) {
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return
+	}
+	txn.ffi.MjTxnRemoveTemplate(txn.inner, nptr)
+	return
+}
+
+func (txn *Txn) ClearTemplates() {
+	txn.ffi.MjTxnClearTemplates(txn.inner)
+}
+
+func (txn *Txn) AddGlobal(name string, value any) (err error) {
+	data, err := sonic.Marshal(value)
+	if err != nil {
+		return
+	}
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return
+	}
+
+	ret := txn.ffi.MjTxnAddGlobal(txn.inner, nptr, &data[0], uint(len(data)))
+	if ret != nil {
+		err = parseError(txn.ffi, ret)
+	}
+
+	return
+}
+
+func (txn *Txn) RemoveGlobal(name string) (err error) {
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return
+	}
+	txn.ffi.MjTxnRemoveGlobal(txn.inner, nptr)
+	return
+}
+
+// Commit publishes all changes of the transaction at once.
+func (txn *Txn) Commit() {
+	if txn.inner == nil {
+		return
+	}
+	txn.ffi.MjTxnCommit(txn.inner)
+	txn.inner = nil
+}
+
+// Abort discards all changes of the transaction.
+func (txn *Txn) Abort() {
+	if txn.inner == nil {
+		return
+	}
+	txn.ffi.MjTxnAbort(txn.inner)
+	txn.inner = nil
+}
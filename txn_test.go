@@ -0,0 +1,65 @@
+package ginja_test
+
+import (
+	"errors"
+	"fmt"
+
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestTxnCommit(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("txn_old", "old"))
+
+	txn := env.Begin()
+	for i := range 10 {
+		assert.Nil(txn.AddTemplate(fmt.Sprintf("txn_template_%d", i), fmt.Sprintf("{{ n }}-%d", i)))
+	}
+	assert.Nil(txn.RemoveTemplate("txn_old"))
+
+	_, err := env.RenderTemplate("txn_template_0", map[string]any{})
+	var e *ginja.Error
+	assert.ErrorAs(err, &e)
+	assert.Equal(ginja.CodeTemplateNotFound, e.Code())
+
+	txn.Commit()
+
+	result, err := env.RenderTemplate("txn_template_9", map[string]any{"n": 1})
+	assert.Nil(err)
+	assert.Equal("1-9", result)
+
+	_, err = env.RenderTemplate("txn_old", map[string]any{})
+	assert.ErrorAs(err, &e)
+	assert.Equal(ginja.CodeTemplateNotFound, e.Code())
+}
+
+func (s *Suite) TestTxnUpdate(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.Update(func(txn *ginja.Txn) error {
+		if err := txn.AddGlobal("txn_site", "Example"); err != nil {
+			return err
+		}
+		return txn.AddTemplate("txn_update", "{{ txn_site }}")
+	}))
+
+	result, err := env.RenderTemplate("txn_update", map[string]any{})
+	assert.Nil(err)
+	assert.Equal("Example", result)
+
+	errAbort := errors.New("abort")
+	err = env.Update(func(txn *ginja.Txn) error {
+		if err := txn.AddTemplate("txn_aborted", "aborted"); err != nil {
+			return err
+		}
+		return errAbort
+	})
+	assert.ErrorIs(err, errAbort)
+
+	_, err = env.RenderTemplate("txn_aborted", map[string]any{})
+	var e *ginja.Error
+	assert.ErrorAs(err, &e)
+	assert.Equal(ginja.CodeTemplateNotFound, e.Code())
+}
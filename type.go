@@ -3,11 +3,144 @@ package ginja
 import "unsafe"
 
 type mjError struct {
-	code    int32
-	message *byte
+	code       int32
+	line       uint
+	column     uint
+	rangeStart uint
+	rangeEnd   uint
+	inner      unsafe.Pointer
 }
 
 type mjResultEnvRenderTemplate struct {
 	rendered *byte
 	error    unsafe.Pointer
 }
+
+type mjResultEnvGetTemplate struct {
+	template unsafe.Pointer
+	error    unsafe.Pointer
+}
+
+type mjResultValueFromJson struct {
+	value unsafe.Pointer
+	error unsafe.Pointer
+}
+
+type mjBuffer struct {
+	data *byte
+	len  uint
+}
+
+type mjRenderItem struct {
+	name *byte
+	data *byte
+	len  uint
+}
+
+type mjResultEnvRenderBatch struct {
+	results unsafe.Pointer
+	len     uint
+}
+
+type mjResultEnvLoadBundle struct {
+	errors unsafe.Pointer
+	len    uint
+}
+
+type mjHistogram struct {
+	count   uint64
+	sumNs   uint64
+	buckets [64]uint64
+}
+
+type mjErrorCount struct {
+	code  int32
+	count uint64
+}
+
+type mjTemplateStats struct {
+	name        *byte
+	calls       uint64
+	outputBytes uint64
+	errors      unsafe.Pointer
+	errorsLen   uint
+	lookup      mjHistogram
+	parse       mjHistogram
+	render      mjHistogram
+	output      mjHistogram
+}
+
+type mjStats struct {
+	templates unsafe.Pointer
+	len       uint
+}
+
+type mjRenderCacheStats struct {
+	hits      uint64
+	misses    uint64
+	evictions uint64
+	entries   uint
+	bytes     uint
+	budget    uint
+}
+
+type mjRenderLimits struct {
+	fuel      uint64
+	timeoutNs uint64
+}
+
+type mjTemplateMemory struct {
+	resident      bool
+	compiledBytes uint
+	sourceBytes   uint
+	storedBytes   uint
+}
+
+type mjTemplateStoreStats struct {
+	evictions     uint64
+	recompiles    uint64
+	templates     uint
+	resident      uint
+	compiledBytes uint
+	storedBytes   uint
+	budget        uint
+}
+
+type mjCompletion struct {
+	id     uint64
+	result unsafe.Pointer
+}
+
+type mjCompletionRing struct {
+	slots    unsafe.Pointer
+	capacity uint
+	head     uint64
+	tail     uint64
+}
+
+type mjQueue struct {
+	inner    unsafe.Pointer
+	ring     *mjCompletionRing
+	notifyFd int32
+}
+
+type mjResultEnvTemplateUndeclaredVariables struct {
+	variables unsafe.Pointer
+	len       uint
+	complete  bool
+	error     unsafe.Pointer
+}
+
+type mjResultEnvCompileExpression struct {
+	expr  unsafe.Pointer
+	error unsafe.Pointer
+}
+
+type mjResultExpressionEval struct {
+	kind    int32
+	boolean bool
+	integer int64
+	number  float64
+	string  *byte
+	error   unsafe.Pointer
+}
@@ -0,0 +1,86 @@
+package ginja
+
+import (
+	"unsafe"
+
+	"github.com/bytedance/sonic"
+)
+
+// Value is a render context that was encoded and parsed by the native
+// library once, so it can be rendered against any number of templates
+// without paying the JSON round trip again.
+//
+// A Value is immutable and safe to render from multiple goroutines at once.
+type Value struct {
+	ffi *ffi
+
+	inner unsafe.Pointer
+}
+
+// NewValue parses ctx into a reusable Value.
+func (env *Environment) NewValue(ctx map[string]any) (value *Value, err error) {
+	data, err := sonic.Marshal(ctx)
+	if err != nil {
+		return
+	}
+	ret := env.ffi.MjValueFromJson(&data[0], uint(len(data)))
+	defer env.ffi.MjResultValueFromJsonFree(ret)
+	result := (*mjResultValueFromJson)(ret)
+	if result.error != nil {
+		err = takeError(env.ffi, &result.error)
+		return
+	}
+	value = &Value{
+		ffi:   env.ffi,
+		inner: result.value,
+	}
+	return
+}
+
+// RenderValue renders the named template with value. The keys of overlay,
+// which may be nil, take precedence over those of value for this render
+// only; value itself is neither copied nor modified.
+func (env *Environment) RenderValue(name string, value *Value, overlay map[string]any) (rendered string, err error) {
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return
+	}
+	optr, olen, err := marshalOverlay(overlay)
+	if err != nil {
+		return
+	}
+	ret := env.ffi.MjEnvRenderValue(env.inner, nptr, value.inner, optr, olen)
+	return takeRenderResult(env.ffi, ret)
+}
+
+// RenderValue renders the template with value and an optional overlay.
+//
+// See Environment.RenderValue for details.
+func (tmpl *Template) RenderValue(value *Value, overlay map[string]any) (rendered string, err error) {
+	optr, olen, err := marshalOverlay(overlay)
+	if err != nil {
+		return
+	}
+	ret := tmpl.ffi.MjTemplateRenderValue(tmpl.inner, value.inner, optr, olen)
+	return takeRenderResult(tmpl.ffi, ret)
+}
+
+// Close releases the value.
+func (value *Value) Close() {
+	if value.inner == nil {
+		return
+	}
+	value.ffi.MjValueFree(value.inner)
+	value.inner = nil
+}
+
+func marshalOverlay(overlay map[string]any) (ptr *byte, n uint, err error) {
+	if len(overlay) == 0 {
+		return
+	}
+	data, err := sonic.Marshal(overlay)
+	if err != nil {
+		return
+	}
+	return &data[0], uint(len(data)), nil
+}
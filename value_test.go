@@ -0,0 +1,110 @@
+package ginja_test
+
+import (
+	"fmt"
+	"sync"
+
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestRenderValue(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("value_title", "{{ catalog.title }}"))
+	assert.Nil(env.AddTemplate("value_count", "{{ catalog.items|length }}"))
+
+	value, err := env.NewValue(map[string]any{
+		"catalog": map[string]any{
+			"title": "Books",
+			"items": []int{1, 2, 3},
+		},
+	})
+	assert.Nil(err)
+	defer value.Close()
+
+	result, err := env.RenderValue("value_title", value, nil)
+	assert.Nil(err)
+	assert.Equal("Books", result)
+
+	result, err = env.RenderValue("value_count", value, nil)
+	assert.Nil(err)
+	assert.Equal("3", result)
+}
+
+func (s *Suite) TestRenderValueOverlay(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("value_overlay", "{{ greeting }}, {{ name }}!"))
+
+	value, err := env.NewValue(map[string]any{
+		"greeting": "Hello",
+		"name":     "World",
+	})
+	assert.Nil(err)
+	defer value.Close()
+
+	result, err := env.RenderValue("value_overlay", value, map[string]any{"name": "Alice"})
+	assert.Nil(err)
+	assert.Equal("Hello, Alice!", result)
+
+	result, err = env.RenderValue("value_overlay", value, nil)
+	assert.Nil(err)
+	assert.Equal("Hello, World!", result)
+
+	tmpl, err := env.GetTemplate("value_overlay")
+	assert.Nil(err)
+	defer tmpl.Close()
+
+	result, err = tmpl.RenderValue(value, map[string]any{"greeting": "Hi"})
+	assert.Nil(err)
+	assert.Equal("Hi, World!", result)
+}
+
+func (s *Suite) TestRenderValueNotFound(assert *require.Assertions) {
+	env := s.env
+
+	value, err := env.NewValue(map[string]any{})
+	assert.Nil(err)
+	defer value.Close()
+
+	_, err = env.RenderValue("value_missing", value, nil)
+	var e *ginja.Error
+	assert.ErrorAs(err, &e)
+	assert.Equal(ginja.CodeTemplateNotFound, e.Code())
+}
+
+func (s *Suite) TestRenderValueConcurrent(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("value_concurrent", "{{ prefix }}{{ n }}"))
+
+	value, err := env.NewValue(map[string]any{"prefix": "#"})
+	assert.Nil(err)
+	defer value.Close()
+
+	var wg sync.WaitGroup
+	errs := make([]error, 8)
+	for g := range 8 {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for i := range 100 {
+				n := g*100 + i
+				result, err := env.RenderValue("value_concurrent", value, map[string]any{"n": n})
+				if err != nil {
+					errs[g] = err
+					return
+				}
+				if result != fmt.Sprintf("#%d", n) {
+					errs[g] = fmt.Errorf("unexpected result %q for %d", result, n)
+					return
+				}
+			}
+		}()
+	}
+	wg.Wait()
+	for _, err := range errs {
+		assert.Nil(err)
+	}
+}
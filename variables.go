@@ -0,0 +1,134 @@
+package ginja
+
+import "unsafe"
+
+// templateVariables are the top-level variables of a template as of a
+// generation of the environment.
+type templateVariables struct {
+	generation uint64
+	// names and sorted are nil if the template renders other templates,
+	// whose variables are unknown.
+	names  map[string]struct{}
+	sorted []string
+}
+
+// TemplateVariables returns the sorted names of the variables the template
+// reads from its context, found by analyzing it statically. With nested
+// set, attributes read from variables are listed as dotted paths such as
+// "user.name" instead.
+//
+// Variables of templates that the template includes, extends or imports
+// are not listed, in which case complete is false.
+func (env *Environment) TemplateVariables(name string, nested bool) (vars []string, complete bool, err error) {
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return
+	}
+	ret := env.ffi.MjEnvTemplateUndeclaredVariables(env.inner, nptr, nested)
+	return takeVariablesResult(env.ffi, ret)
+}
+
+// Variables returns the sorted names of the top-level variables the
+// template reads from its context. The analysis runs once per Template.
+//
+// See Environment.TemplateVariables for details.
+func (tmpl *Template) Variables() (vars []string) {
+	ret := tmpl.ffi.MjTemplateUndeclaredVariables(tmpl.inner, false)
+	vars, _, _ = takeVariablesResult(tmpl.ffi, ret)
+	return
+}
+
+func takeVariablesResult(ffi *ffi, ret unsafe.Pointer) (vars []string, complete bool, err error) {
+	defer ffi.MjResultEnvTemplateUndeclaredVariablesFree(ret)
+	result := (*mjResultEnvTemplateUndeclaredVariables)(ret)
+	if result.error != nil {
+		err = takeError(ffi, &result.error)
+		return
+	}
+	vars = make([]string, 0, result.len)
+	for _, name := range unsafe.Slice((**byte)(result.variables), result.len) {
+		vars = append(vars, BytePtrToString(name))
+	}
+	complete = result.complete
+	return
+}
+
+// SetContextPruning enables or disables context pruning, which is
+// disabled by default.
+//
+// While enabled, RenderTemplate, RenderTemplateWithLimits,
+// RenderTemplateContext, RenderTo, AppendRender, RenderBatch,
+// RenderBatchItems and Queue.Submit only encode the top-level keys of a
+// context that the template reads, as reported by TemplateVariables, which
+// saves encoding and parsing the rest. Other render calls, such as those of
+// a Template, RenderBlock and CallMacro, always send the whole context, and
+// so do templates that include, extends or import other templates. The
+// variables of a template are looked up once and kept until the
+// Environment changes.
+//
+// Only enable pruning if no filter or function reads context variables
+// that the templates do not mention.
+func (env *Environment) SetContextPruning(enabled bool) {
+	env.pruned.Store(enabled)
+}
+
+// prune returns the entries of ctx that template name reads, or ctx itself
+// if pruning is disabled or the variables of the template are unknown.
+func (env *Environment) prune(name string, ctx map[string]any) map[string]any {
+	if len(ctx) == 0 {
+		return ctx
+	}
+	vars := env.prunedVariables(name)
+	if vars == nil {
+		return ctx
+	}
+	pruned := make(map[string]any, min(len(ctx), len(vars.names)))
+	if len(ctx) < len(vars.names) {
+		for key, value := range ctx {
+			if _, ok := vars.names[key]; ok {
+				pruned[key] = value
+			}
+		}
+	} else {
+		for key := range vars.names {
+			if value, ok := ctx[key]; ok {
+				pruned[key] = value
+			}
+		}
+	}
+	return pruned
+}
+
+// prunedVariables returns the variables of template name that its context
+// is pruned to, or nil if pruning is disabled or the variables of the
+// template are unknown.
+func (env *Environment) prunedVariables(name string) *templateVariables {
+	if !env.pruned.Load() {
+		return nil
+	}
+	// Load the generation first, so that variables fetched afterwards are
+	// never newer than the generation they are stored with.
+	generation := env.ffi.MjEnvGeneration(env.inner)
+	cached, ok := env.variables.Load(name)
+	vars, _ := cached.(*templateVariables)
+	if !ok || vars.generation != generation {
+		names, complete, err := env.TemplateVariables(name, false)
+		if err != nil {
+			// Let the render report the error.
+			return nil
+		}
+		vars = &templateVariables{generation: generation}
+		if complete {
+			vars.names = make(map[string]struct{}, len(names))
+			for _, name := range names {
+				vars.names[name] = struct{}{}
+			}
+			vars.sorted = names
+		}
+		env.variables.Store(name, vars)
+	}
+	if vars.names == nil {
+		return nil
+	}
+	return vars
+}
@@ -0,0 +1,80 @@
+package ginja_test
+
+import (
+	"strings"
+
+	"github.com/stretchr/testify/require"
+	"go.yuchanns.xyz/ginja"
+)
+
+func (s *Suite) TestTemplateVariables(assert *require.Assertions) {
+	env, err := ginja.New()
+	assert.Nil(err)
+	defer env.Close()
+
+	assert.Nil(env.AddTemplate("vars", `{% set greeting = "Hi" %}{{ greeting }} {{ user.name }}{% for item in items %}{{ item.id }}{% endfor %}`))
+	vars, complete, err := env.TemplateVariables("vars", false)
+	assert.Nil(err)
+	assert.True(complete)
+	assert.Equal([]string{"items", "user"}, vars)
+
+	vars, _, err = env.TemplateVariables("vars", true)
+	assert.Nil(err)
+	assert.Equal([]string{"items", "user.name"}, vars)
+
+	assert.Nil(env.AddTemplate("layout", `{% include "vars" %}`))
+	_, complete, err = env.TemplateVariables("layout", false)
+	assert.Nil(err)
+	assert.False(complete)
+
+	_, _, err = env.TemplateVariables("missing", false)
+	assert.NotNil(err)
+
+	tmpl, err := env.GetTemplate("vars")
+	assert.Nil(err)
+	defer tmpl.Close()
+	assert.Equal([]string{"items", "user"}, tmpl.Variables())
+}
+
+func (s *Suite) TestContextPruning(assert *require.Assertions) {
+	env, err := ginja.New(ginja.WithContextPruning())
+	assert.Nil(err)
+	defer env.Close()
+
+	assert.Nil(env.AddTemplate("pruned", "{{ name }}"))
+	// The unused key cannot be encoded, so the render only succeeds if it
+	// is pruned.
+	ctx := map[string]any{"name": "World", "unused": func() {}}
+	result, err := env.RenderTemplate("pruned", ctx)
+	assert.Nil(err)
+	assert.Equal("World", result)
+
+	// Test that the other render calls of the environment prune too
+	var sb strings.Builder
+	assert.Nil(env.RenderTo("pruned", ctx, &sb))
+	assert.Equal("World", sb.String())
+	buf, err := env.AppendRender(nil, "pruned", ctx)
+	assert.Nil(err)
+	assert.Equal("World", string(buf))
+	results, err := env.RenderBatch("pruned", []map[string]any{ctx})
+	assert.Nil(err)
+	assert.Nil(results[0].Err)
+	assert.Equal("World", results[0].Rendered)
+
+	// Test that a changed template is analyzed again
+	assert.Nil(env.AddTemplate("pruned", "{{ name }} {{ other }}"))
+	result, err = env.RenderTemplate("pruned", map[string]any{"name": "World", "other": 1})
+	assert.Nil(err)
+	assert.Equal("World 1", result)
+
+	// Test that templates rendering others get the whole context
+	assert.Nil(env.AddTemplate("outer", `{% include "inner" %}`))
+	assert.Nil(env.AddTemplate("inner", "{{ name }}"))
+	result, err = env.RenderTemplate("outer", map[string]any{"name": "World"})
+	assert.Nil(err)
+	assert.Equal("World", result)
+
+	env.SetContextPruning(false)
+	_, err = env.RenderTemplate("pruned", ctx)
+	assert.NotNil(err)
+}
@@ -0,0 +1,92 @@
+package ginja
+
+import (
+	"io"
+	"sync"
+	"sync/atomic"
+	"unsafe"
+
+	"github.com/bytedance/sonic"
+	"github.com/ebitengine/purego"
+)
+
+// streamWriter is the Go side of an in-flight streaming render.
+type streamWriter struct {
+	w   io.Writer
+	err error
+}
+
+var (
+	// streams maps the user data passed through mj_write_callback back to
+	// the io.Writer of the render, as Go pointers cannot cross the FFI.
+	streams   sync.Map
+	streamSeq atomic.Uintptr
+
+	// purego callbacks are never released, so a single trampoline is
+	// shared by every streaming render in the process.
+	writeCallback = sync.OnceValue(func() uintptr {
+		return purego.NewCallback(writeTrampoline)
+	})
+)
+
+func writeTrampoline(userData uintptr, data *byte, n uint) uintptr {
+	v, ok := streams.Load(userData)
+	if !ok {
+		return 1
+	}
+	sw := v.(*streamWriter)
+	if _, err := sw.w.Write(unsafe.Slice(data, n)); err != nil {
+		sw.err = err
+		return 1
+	}
+	return 0
+}
+
+// renderStream registers w for the duration of render and translates the
+// result, preferring the error returned by w over the native write failure.
+func renderStream(ffi *ffi, w io.Writer, render func(callback uintptr, userData uintptr) unsafe.Pointer) (err error) {
+	sw := &streamWriter{w: w}
+	id := streamSeq.Add(1)
+	streams.Store(id, sw)
+	defer streams.Delete(id)
+
+	ret := render(writeCallback(), id)
+	if ret != nil {
+		if sw.err != nil {
+			ffi.MjErrorFree(ret)
+			return sw.err
+		}
+		err = parseError(ffi, ret)
+	}
+	return
+}
+
+// RenderTo renders the named template and streams the output to w in
+// fixed-size chunks as it is produced, without buffering the whole output.
+// If rendering fails part of the output may already have been written.
+func (env *Environment) RenderTo(name string, ctx map[string]any, w io.Writer) (err error) {
+	value, err := env.marshal(name, ctx)
+	if err != nil {
+		return
+	}
+	nptr, err := BytePtrFromString(name)
+	if err != nil {
+		return
+	}
+	return renderStream(env.ffi, w, func(callback uintptr, userData uintptr) unsafe.Pointer {
+		return env.ffi.MjEnvRenderToWriter(env.inner, nptr, &value[0], uint(len(value)), callback, userData)
+	})
+}
+
+// RenderTo renders the template and streams the output to w.
+//
+// See Environment.RenderTo for details.
+func (tmpl *Template) RenderTo(ctx map[string]any, w io.Writer) (err error) {
+	value, err := sonic.Marshal(ctx)
+	if err != nil {
+		return
+	}
+	return renderStream(tmpl.ffi, w, func(callback uintptr, userData uintptr) unsafe.Pointer {
+		return tmpl.ffi.MjTemplateRenderToWriter(tmpl.inner, &value[0], uint(len(value)), callback, userData)
+	})
+}
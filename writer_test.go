@@ -0,0 +1,79 @@
+package ginja_test
+
+import (
+	"bytes"
+	"errors"
+	"strings"
+
+	"github.com/stretchr/testify/require"
+)
+
+type chunkRecorder struct {
+	bytes.Buffer
+	chunks []int
+}
+
+func (r *chunkRecorder) Write(p []byte) (int, error) {
+	r.chunks = append(r.chunks, len(p))
+	return r.Buffer.Write(p)
+}
+
+type failingWriter struct{}
+
+var errWriterClosed = errors.New("writer closed")
+
+func (failingWriter) Write(p []byte) (int, error) {
+	return 0, errWriterClosed
+}
+
+func (s *Suite) TestRenderTo(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("render_to_template", "Hello, {{ name }}!"))
+	var buf bytes.Buffer
+	err := env.RenderTo("render_to_template", map[string]any{
+		"name": "World",
+	}, &buf)
+	assert.Nil(err)
+	assert.Equal("Hello, World!", buf.String())
+}
+
+func (s *Suite) TestRenderToChunked(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("render_to_large", "{% for i in range(count) %}{{ line }}\n{% endfor %}"))
+	var rec chunkRecorder
+	err := env.RenderTo("render_to_large", map[string]any{
+		"count": 20000,
+		"line":  "0123456789abcdef",
+	}, &rec)
+	assert.Nil(err)
+	assert.Equal(strings.Repeat("0123456789abcdef\n", 20000), rec.String())
+	assert.Greater(len(rec.chunks), 1)
+	for _, n := range rec.chunks {
+		assert.LessOrEqual(n, 8192)
+	}
+}
+
+func (s *Suite) TestRenderToWriterError(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("render_to_failing", "Hello, {{ name }}!"))
+	err := env.RenderTo("render_to_failing", map[string]any{
+		"name": "World",
+	}, failingWriter{})
+	assert.ErrorIs(err, errWriterClosed)
+}
+
+func (s *Suite) TestTemplateRenderTo(assert *require.Assertions) {
+	env := s.env
+
+	assert.Nil(env.AddTemplate("render_to_handle", "{{ a }}+{{ b }}"))
+	tmpl, err := env.GetTemplate("render_to_handle")
+	assert.Nil(err)
+	defer tmpl.Close()
+
+	var buf bytes.Buffer
+	assert.Nil(tmpl.RenderTo(map[string]any{"a": 1, "b": 2}, &buf))
+	assert.Equal("1+2", buf.String())
+}